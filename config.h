@@ -0,0 +1,47 @@
+# config.h for cpptraj
+# configured using: ./configure -openmp -nonetcdf -nofftw3 -noreadline gnu
+
+CPPTRAJHOME="/root/repo"
+CPPTRAJBIN="/root/repo/bin"
+CPPTRAJLIB="/root/repo/lib"
+
+INSTALL_TARGETS= install_cpptraj
+
+SHARED_SUFFIX=.so
+DIRECTIVES= -D_LARGEFILE_SOURCE -D_FILE_OFFSET_BITS=64 -DBUILDTYPE='"GitHub"' -DGITHASH='"0bd7031aaface1213d65f698dff220d8e9010f3e"' -DHASBZ2 -DHASGZ -DNO_READLINE
+INCLUDE= -Iarpack -Ixdrfile
+
+LIBCPPTRAJ_TARGET=nolibcpptraj
+
+CUDA_TARGET=
+
+READLINE_TARGET=noreadline
+READLINE_LIB=-lreadline
+
+XDRFILE_TARGET=xdrfile/libxdrfile.a
+
+ARPACK_TARGET=arpack/libarpack.a
+
+FFT_TARGET=pub_fft.o
+
+CPPTRAJ_LIB= arpack/libarpack.a -llapack -lblas -lgfortran
+LDFLAGS= -lbz2 -lz xdrfile/libxdrfile.a  -fopenmp  
+SFX=.OMP
+EXE=
+
+CC=gcc
+CFLAGS= -Wall -fopenmp -O3    $(DBGFLAGS)
+
+.c.o:
+	@echo CC $<
+	@$(CC) $(DIRECTIVES) $(INCLUDE) $(CFLAGS) -c -o $@ $<
+
+CXX=g++
+CXXFLAGS= -Wall -fopenmp -O3     -std=gnu++11 $(DBGFLAGS)
+
+.cpp.o:
+	@echo CXX $<
+	@$(CXX) $(DIRECTIVES) $(INCLUDE) $(CXXFLAGS) -c -o $@ $<
+
+FC=gfortran
+FFLAGS= -Wall -fopenmp -O3  -ffree-form   $(DBGFLAGS)
@@ -0,0 +1,3 @@
+export CPPTRAJHOME="/root/repo"
+export PATH=/root/repo/bin:${PATH}
+export LD_LIBRARY_PATH=/root/repo/lib:${LD_LIBRARY_PATH}
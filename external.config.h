@@ -0,0 +1,23 @@
+# CPPTRAJ config for external libraries.
+# configured using: ./configure -openmp -nonetcdf -nofftw3 -noreadline gnu
+NVCC=
+NVCCFLAGS=
+
+%.o : %.cu
+	@echo NVCC $<
+	@$(NVCC) $(DBGFLAGS) $(NVCCFLAGS) -c -o $@ $<
+
+CC=gcc
+CFLAGS= -Wall -fopenmp -O3    $(DBGFLAGS)
+
+.c.o:
+	@echo CC $<
+	@$(CC) $(DIRECTIVES) $(INCLUDE) $(CFLAGS) -c -o $@ $<
+
+FC=gfortran
+F77FLAGS= -Wall -fopenmp -O3    $(DBGFLAGS)
+
+.f.o:
+	@echo FC $<
+	@$(FC) $(DIRECTIVES) $(INCLUDE) $(F77FLAGS) -c -o $@ $<
+
@@ -53,6 +53,12 @@ class Action : public DispatchObject {
       * necessary post-trajectory processing calculations.
       */
     virtual void Print() = 0;
+    /// \return Optional Frame components (CoordinateInfo::ComponentType) used by this Action.
+    /** Trajectory readers may skip reading any components not used by any
+      * Action or output trajectory. Actions that use e.g. velocities, or
+      * that write/store whole frames, must override this.
+      */
+    virtual int ComponentsNeeded() const { return CoordinateInfo::NO_COMPONENTS; }
 #   ifdef MPI
     /// Sync Action data to master when running in parallel across trajectories.
     virtual int SyncAction() { return 0; } // TODO: pure virtual
@@ -61,6 +67,18 @@ class Action : public DispatchObject {
     typedef std::vector<Frame> FArray;
     /// Process array of frames before start required by ranks > 0 (not called by master)
     virtual int ParallelPreloadFrames(FArray const&) { return 0; } // TODO: pure virtual
+#   endif
+#   ifdef _OPENMP
+    /// \return True if copies of this Action can process separate blocks of frames in threads.
+    /** Used by 'framethreads' processing. DataSets created by a copy of the
+      * Action are appended to the corresponding DataSets of the original
+      * in frame order after processing, so an Action that only adds one
+      * value per frame to its DataSets may return true. Any other data
+      * accumulated over frames must be merged in SyncThreadAction().
+      */
+    virtual bool FrameThreadsOK() const { return false; }
+    /// Merge data from copy of this Action that processed the following block of frames.
+    virtual int SyncThreadAction(Action*) { return 0; }
 #   endif
   protected:
     /// Print a warning that imaging will not be possible if coordinates are being rotated.
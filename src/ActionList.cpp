@@ -3,7 +3,7 @@
 #include "CpptrajStdio.h"
 
 // CONSTRUCTOR
-ActionList::ActionList() : debug_(0), actionsAreSilent_(false) {}
+ActionList::ActionList() : debug_(0), actionsAreSilent_(false), timing_(false) {}
 
 // DESTRUCTOR
 ActionList::~ActionList() { Clear(); }
@@ -15,6 +15,15 @@ void ActionList::Clear() {
   actionList_.clear();
 }
 
+// ActionList::SetTiming()
+void ActionList::SetTiming(bool timingIn) {
+  timing_ = timingIn;
+  for (Aarray::iterator act = actionList_.begin(); act != actionList_.end(); ++act) {
+    act->time_ = ActionTime();
+    act->time_.name_ = act->args_.ArgLine();
+  }
+}
+
 // ActionList::AddAction()
 int ActionList::AddAction(Action* actIn, ArgList& argIn, ActionInit& init)
 {
@@ -27,6 +36,9 @@ int ActionList::AddAction(Action* actIn, ArgList& argIn, ActionInit& init)
   ActHolder act;
   act.ptr_ = actIn;
   act.args_ = argIn;
+  act.time_.name_ = argIn.ArgLine();
+  unsigned int nsets = 0;
+  if (init.DslPtr() != 0) nsets = init.DSL().size();
   // Attempt to initialize action
   if ( act.ptr_->Init( argIn, init, debug_ ) != Action::OK ) {
     mprinterr("Error: Could not initialize action [%s]\n", argIn.Command());
@@ -34,6 +46,11 @@ int ActionList::AddAction(Action* actIn, ArgList& argIn, ActionInit& init)
     err = 1;
   } else {
     act.status_ = INIT;
+    // Record any DataSets created by the action.
+    if (init.DslPtr() != 0) {
+      for (unsigned int idx = nsets; idx < init.DSL().size(); idx++)
+        act.sets_.push_back( init.DSL()[idx] );
+    }
     actionList_.push_back( act );
     if (argIn.CheckForMoreArgs()) err = 1;
   }
@@ -57,7 +74,9 @@ int ActionList::SetupActions(ActionSetup& setup, bool exitOnError) {
     if (act->status_ != INACTIVE) {
       mprintf("  %li: [%s]\n", act - actionList_.begin(), act->args_.ArgLine());
       act->status_ = SETUP;
+      if (timing_) act->time_.setup_.Start();
       Action::RetType err = act->ptr_->Setup(setup);
+      if (timing_) act->time_.setup_.Stop();
       if (err == Action::ERR) {
         mprinterr("Error: Setup failed for [%s]\n", act->args_.Command());
         if (exitOnError) return 1;
@@ -77,13 +96,15 @@ int ActionList::SetupActions(ActionSetup& setup, bool exitOnError) {
 
 // ActionList::DoActions()
 /** Perform actions in the action list on the given Frame. Skip actions not 
-  * initialized or not setup. 
+  * initialized or not setup. The neighbor grid shared by all actions is
+  * attached to the frame here and marked out of date.
   * \param frameNumIn The current frame number.
   * \param frm Contains current Frame.
   * \return true if coordinate output should be suppressed, false if coordinate
   *         output should be performed.
   */
 bool ActionList::DoActions(int frameNumIn, ActionFrame& frm) {
+  frm.SetNeighborGrid( &grid_ );
   ActionFrame OriginalFrame = frm;
   //fprintf(stdout,"DEBUG: Performing %i actions on frame %i.\n",Naction,frameNumIn);
   for (Aarray::iterator act = actionList_.begin(); act != actionList_.end(); ++act) 
@@ -91,7 +112,14 @@ bool ActionList::DoActions(int frameNumIn, ActionFrame& frm) {
     // Only do actions which were properly set up
     if (act->status_ == SETUP) { 
       // Perform action on frame
-      Action::RetType err = act->ptr_->DoAction(frameNumIn, frm);
+      Action::RetType err;
+      if (timing_) {
+        act->time_.frames_.Start();
+        err = act->ptr_->DoAction(frameNumIn, frm);
+        act->time_.frames_.Stop();
+        act->time_.nframes_++;
+      } else
+        err = act->ptr_->DoAction(frameNumIn, frm);
       // Check for action special conditions/errors
       if (err == Action::USE_ORIGINAL_FRAME) {
         // Return to original frame
@@ -111,12 +139,27 @@ bool ActionList::DoActions(int frameNumIn, ActionFrame& frm) {
   return false;
 }
 
+// ActionList::ComponentsNeeded()
+int ActionList::ComponentsNeeded() const {
+  int needs = CoordinateInfo::NO_COMPONENTS;
+  for (Aarray::const_iterator act = actionList_.begin(); act != actionList_.end(); ++act)
+    if (act->status_ == SETUP)
+      needs |= act->ptr_->ComponentsNeeded();
+  return needs;
+}
+
 // ActionList::Print()
 void ActionList::PrintActions() {
-  for (Aarray::const_iterator act = actionList_.begin(); act != actionList_.end(); ++act)
+  for (Aarray::iterator act = actionList_.begin(); act != actionList_.end(); ++act)
   { // Skip deactivated actions
-    if (act->status_ != INACTIVE)
-      act->ptr_->Print();
+    if (act->status_ != INACTIVE) {
+      if (timing_) {
+        act->time_.print_.Start();
+        act->ptr_->Print();
+        act->time_.print_.Stop();
+      } else
+        act->ptr_->Print();
+    }
   }
 }
 #ifdef MPI
@@ -149,16 +192,91 @@ int ActionList::ParallelProcessPreload(Action::FArray const& preload_frames) {
 }
 
 void ActionList::SyncActions() {
-  for (Aarray::const_iterator act = actionList_.begin(); act != actionList_.end(); ++act)
+  for (Aarray::iterator act = actionList_.begin(); act != actionList_.end(); ++act)
   { // Skip deactivated actions
     if (act->status_ != INACTIVE) {
       //rprintf("DEBUG: Calling SyncAction() for '%s'\n", act->args_.Command());
+      if (timing_) act->time_.sync_.Start();
       if (act->ptr_->SyncAction())
         rprintf("Warning: Sync failed for Action '%s'\n", act->args_.Command());
+      if (timing_) act->time_.sync_.Stop();
     }
   }
 }
 #endif
+#ifdef _OPENMP
+// ActionList::FrameThreadsOK()
+bool ActionList::FrameThreadsOK() const {
+  bool isOK = true;
+  for (Aarray::const_iterator act = actionList_.begin(); act != actionList_.end(); ++act)
+  {
+    if (!act->ptr_->FrameThreadsOK()) {
+      mprintf("Warning: Action '%s' cannot process frames in separate threads.\n",
+              act->args_.Command());
+      isOK = false;
+    }
+  }
+  return isOK;
+}
+
+// ActionList::SyncThreadActions()
+/** Append DataSets created by each Action in the given list to the
+  * corresponding DataSets of the Action in this list, then call
+  * SyncThreadAction() so any other data can be merged. The given list must
+  * have been created from the same Actions as this list and processed the
+  * frames following those processed by this list. If timing is enabled,
+  * Setup() and DoAction() time and frame counts of each copy are added to
+  * those of the original, so reported times are summed over all threads.
+  */
+int ActionList::SyncThreadActions(ActionList& copyList) {
+  if (copyList.actionList_.size() != actionList_.size()) {
+    mprinterr("Internal Error: SyncThreadActions: Action list sizes do not match.\n");
+    return 1;
+  }
+  int err = 0;
+  for (unsigned int idx = 0; idx != actionList_.size(); idx++)
+  { // Skip deactivated actions
+    ActHolder& act = actionList_[idx];
+    ActHolder const& copy = copyList.actionList_[idx];
+    if (act.status_ != INACTIVE) {
+      if (timing_) {
+        act.time_.setup_.AddTotal( copy.time_.setup_ );
+        act.time_.frames_.AddTotal( copy.time_.frames_ );
+        act.time_.nframes_ += copy.time_.nframes_;
+        act.time_.sync_.Start();
+      }
+      if (act.sets_.size() != copy.sets_.size()) {
+        mprinterr("Internal Error: Action '%s' copy has %zu sets, expected %zu.\n",
+                  act.args_.Command(), copy.sets_.size(), act.sets_.size());
+        return 1;
+      }
+      for (unsigned int is = 0; is != act.sets_.size(); is++) {
+        if (!copy.sets_[is]->Empty() && act.sets_[is]->Append( copy.sets_[is] )) {
+          mprinterr("Error: Could not append data from set '%s' to '%s'\n",
+                    copy.sets_[is]->legend(), act.sets_[is]->legend());
+          err++;
+        }
+      }
+      if (act.ptr_->SyncThreadAction( copy.ptr_ )) {
+        mprinterr("Error: Sync failed for Action '%s'\n", act.args_.Command());
+        err++;
+      }
+      if (timing_) act.time_.sync_.Stop();
+    }
+  }
+  return err;
+}
+#endif
+// ActionList::TimingData()
+ActionList::TimeArray ActionList::TimingData() const {
+  TimeArray times;
+  if (timing_) {
+    for (Aarray::const_iterator act = actionList_.begin(); act != actionList_.end(); ++act)
+      times.push_back( act->time_ );
+  }
+  return times;
+}
+
 void ActionList::List() const {
   if (!actionList_.empty()) {
     mprintf("\nACTIONS (%zu total):\n", actionList_.size());
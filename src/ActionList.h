@@ -1,6 +1,7 @@
 #ifndef INC_ACTIONLIST_H
 #define INC_ACTIONLIST_H
 #include "Action.h"
+#include "Timer.h"
 /// Hold Actions that will be performed every frame.
 /** This class is responsible for holding all Actions that will be performed
   * during the course of trajectory processing.
@@ -15,12 +16,16 @@ class ActionList {
     void SetDebug(int d) { debug_ = d; }
     /// Set whether to supress Action Init/Setup output.
     void SetSilent(bool b) { actionsAreSilent_ = b; }
+    /// Set whether to record time spent in each Action; resets timing data.
+    void SetTiming(bool);
     /// Add given action to the action list and initialize.
     int AddAction(Action*, ArgList&, ActionInit&);
     /// Set up Actions for the given Topology.
     int SetupActions(ActionSetup&, bool);
     /// Perform Actions on the given Frame.
     bool DoActions(int, ActionFrame&);
+    /// \return Optional Frame components (CoordinateInfo::ComponentType) used by set-up Actions.
+    int ComponentsNeeded() const;
     /// Call print for each Action.
     void PrintActions();
 #   ifdef MPI
@@ -30,6 +35,12 @@ class ActionList {
     int ParallelProcessPreload(Action::FArray const&);
     /// Call sync for each Action (parallel only)
     void SyncActions();
+#   endif
+#   ifdef _OPENMP
+    /// \return True if all Actions can process separate blocks of frames in threads.
+    bool FrameThreadsOK() const;
+    /// Merge data from list of copies of these Actions that processed the following frames.
+    int SyncThreadActions(ActionList&);
 #   endif
     /// List all Actions in the list.
     void List() const;
@@ -44,6 +55,20 @@ class ActionList {
     ArgList const& ActionArgs(int i) const { return actionList_[i].args_;    }
     /// \return Uninitialized copy of existing Action (for ensemble).
     Action* ActionAlloc(int i)       const { return (Action*)actionList_[i].ptr_->Alloc(); }
+    /// Time spent in a single Action.
+    class ActionTime {
+      public:
+        ActionTime() : nframes_(0) {}
+        std::string name_; ///< Action command line.
+        Timer setup_;      ///< Time spent in Setup().
+        Timer frames_;     ///< Time spent in DoAction().
+        Timer print_;      ///< Time spent in Print().
+        Timer sync_;       ///< Time spent in SyncAction() (parallel only).
+        int nframes_;      ///< Number of frames DoAction() was called for.
+    };
+    typedef std::vector<ActionTime> TimeArray;
+    /// \return Timing data for each Action; empty if timing not enabled.
+    TimeArray TimingData() const;
   private:
     /// Action initialization and setup status.
     enum ActionStatusType { NO_INIT=0, INIT, SETUP, INACTIVE };
@@ -51,10 +76,14 @@ class ActionList {
       Action* ptr_;             ///< Pointer to Action.
       ArgList args_;            ///< Arguments associated with Action.
       ActionStatusType status_; ///< Current Action status.
+      ActionTime time_;         ///< Time spent in Action if timing enabled.
+      std::vector<DataSet*> sets_; ///< DataSets created by Action during Init().
     };
     typedef std::vector<ActHolder> Aarray;
     Aarray actionList_;     ///< List of Actions
+    NeighborGrid grid_;     ///< Neighbor grid shared by all Actions for current frame.
     int debug_;             ///< Default debug level for new Actions
     bool actionsAreSilent_; ///< If true suppress all Init/Setup output from Actions.
+    bool timing_;           ///< If true record time spent in each Action.
 };
 #endif
@@ -1,6 +1,7 @@
 #ifndef INC_ACTIONSTATE_H
 #define INC_ACTIONSTATE_H
 #include "DataFileList.h"
+#include "NeighborGrid.h"
 /*! \file ActionState.h
     \brief Classes used to wrap arguments passed to Actions.
  */
@@ -59,19 +60,34 @@ class ActionSetup {
     CoordinateInfo* cInfo_;
     int nFrames_;
 };
-/** The ActionFrame class is used to pass in the current Frame. */
+/** The ActionFrame class is used to pass in the current Frame. It also
+  * provides access to a spatial grid of the current Frame that can be
+  * shared by all Actions; the grid is built when first requested and is
+  * invalidated whenever the Frame may have been modified or replaced.
+  */
 class ActionFrame {
   public:
-    ActionFrame() : frm_(0), trajoutNum_(0) {}
-    ActionFrame(Frame* fIn, int t) : frm_(fIn), trajoutNum_(t) {}
+    ActionFrame() : frm_(0), grid_(0), trajoutNum_(0) {}
+    ActionFrame(Frame* fIn, int t) : frm_(fIn), grid_(0), trajoutNum_(t) {}
     Frame const& Frm()  const { return *frm_; }
-    Frame& ModifyFrm()        { return *frm_; }
+    Frame& ModifyFrm()        { Invalidate(); return *frm_; }
     int TrajoutNum()    const { return trajoutNum_; }
     // NOTE: Used during ensemble.
-    Frame* FramePtr()         { return frm_;  }
-    void SetFrame( Frame* f ) { frm_ = f;     }
+    Frame* FramePtr()         { Invalidate(); return frm_;  }
+    void SetFrame( Frame* f ) { Invalidate(); frm_ = f;     }
+    /// Use given grid as the shared neighbor grid for this frame.
+    void SetNeighborGrid( NeighborGrid* g ) { grid_ = g; Invalidate(); }
+    /// \return Neighbor grid of current Frame, built with given cutoff if not current.
+    /** A grid must have been attached with SetNeighborGrid(). */
+    NeighborGrid const& Neighbors(double cut) {
+      grid_->Update( *frm_, cut );
+      return *grid_;
+    }
   private:
+    void Invalidate() { if (grid_ != 0) grid_->Invalidate(); }
+
     Frame* frm_;
+    NeighborGrid* grid_; ///< Neighbor grid shared by all Actions; 0 if none attached.
     int trajoutNum_; ///< Current output trajectory frame number.
 };
 #endif
@@ -13,6 +13,7 @@ class Action_AtomMap : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
 
     DataSet_Coords_REF* TgtFrame_; ///< Coordinates to be re-mapped.
     DataSet_Coords_REF* RefFrame_; ///< Coordinates to be mapped to.
@@ -148,6 +148,18 @@ int Action_Average::SyncAction() {
 }
 #endif
 
+#ifdef _OPENMP
+// Action_Average::SyncThreadAction()
+int Action_Average::SyncThreadAction(Action* actIn) {
+  Action_Average const& copy = static_cast<Action_Average const&>( *actIn );
+  if (copy.Nframes_ > 0) {
+    AvgFrame_ += copy.AvgFrame_;
+    Nframes_ += copy.Nframes_;
+  }
+  return 0;
+}
+#endif
+
 // Action_Average::Print()
 void Action_Average::Print() {
   if (Nframes_ < 1) return;
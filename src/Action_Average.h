@@ -17,6 +17,10 @@ class Action_Average: public Action, ActionFrameCounter {
     // NOTE: In parallel no need to pass comm to outtraj_ since write is done in Print()
     int SyncAction();
     Parallel::Comm trajComm_;
+#   endif
+#   ifdef _OPENMP
+    bool FrameThreadsOK() const { return true; }
+    int SyncThreadAction(Action*);
 #   endif
     void Print();
 
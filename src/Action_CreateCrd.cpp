@@ -27,7 +27,7 @@ Action::RetType Action_CreateCrd::Init(ArgList& actionArgs, ActionInit& init, in
   if (setname == "_DEFAULTCRD_") {
     // Special case: Creation of COORDS DataSet has been requested by an
     //               analysis and should already be present.
-    coords_ = (DataSet_Coords_CRD*)init.DSL().FindSetOfType(setname, DataSet::COORDS);
+    coords_ = (DataSet_Coords*)init.DSL().FindSetOfType(setname, DataSet::COORDS);
   } else {
     if (!setname.empty()) {
       DataSet* ds = init.DSL().FindSetOfType( setname, DataSet::COORDS );
@@ -39,12 +39,12 @@ Action::RetType Action_CreateCrd::Init(ArgList& actionArgs, ActionInit& init, in
         }
 #       endif
         append = true;
-        coords_ = (DataSet_Coords_CRD*)ds;
+        coords_ = (DataSet_Coords*)ds;
         pindex_ = coords_->Top().Pindex();
       }
     }
     if (coords_ == 0)
-      coords_ = (DataSet_Coords_CRD*)init.DSL().AddSet(DataSet::COORDS, setname, "CRD");
+      coords_ = (DataSet_Coords*)init.DSL().AddSet(DataSet::COORDS, setname, "CRD");
     if (coords_ == 0) return Action::ERR;
   }
   // Do not set topology here since it may be modified later.
@@ -70,9 +70,12 @@ Action::RetType Action_CreateCrd::Setup(ActionSetup& setup) {
   if (setup.Top().Pindex() == pindex_ && coords_->Top().Natom() == 0) {
     coords_->CoordsSetup( setup.Top(), setup.CoordInfo() );
     // Estimate memory usage
-    mprintf("\tEstimated memory usage (%i frames): %s\n",
-            setup.Nframes(),
-            ByteString(coords_->EstSizeInBytes(setup.Nframes()), BYTE_DECIMAL).c_str());
+    size_t estSize = coords_->EstSizeInBytes(setup.Nframes());
+    if (estSize > 0)
+      mprintf("\tEstimated memory usage (%i frames): %s\n",
+              setup.Nframes(), ByteString(estSize, BYTE_DECIMAL).c_str());
+    else
+      mprintf("\tCoordinates will be cached to disk.\n");
   }
   // If # atoms in currentParm does not match coords, warn user.
   if (setup.Top().Natom() != coords_->Top().Natom()) {
@@ -92,5 +95,6 @@ Action::RetType Action_CreateCrd::Setup(ActionSetup& setup) {
 Action::RetType Action_CreateCrd::DoAction(int frameNum, ActionFrame& frm) 
 {
   coords_->AddFrame( frm.Frm() );
+  if (coords_->AddFrameFailed()) return Action::ERR;
   return Action::OK;
 }
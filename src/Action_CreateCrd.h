@@ -1,7 +1,7 @@
 #ifndef ACTION_CREATECRD_H
 #define ACTION_CREATECRD_H
 #include "Action.h"
-#include "DataSet_Coords_CRD.h"
+#include "DataSet_Coords.h"
 class Action_CreateCrd : public Action {
   public:
     Action_CreateCrd();
@@ -12,8 +12,9 @@ class Action_CreateCrd : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
 
-    DataSet_Coords_CRD* coords_;
+    DataSet_Coords* coords_;
     int pindex_;
     bool check_;
 };
@@ -15,6 +15,7 @@ class Action_CreateReservoir : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
     // -------------------------------------------
     RemdReservoirNC reservoir_;   ///< Output structure reservoir file
     Topology* original_trajparm_; ///< Topology corresponding to frames to be used. 
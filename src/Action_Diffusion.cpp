@@ -1,8 +1,15 @@
 #include <cmath> // sqrt
+#include <algorithm> // std::min, std::max
 #include "Action_Diffusion.h"
 #include "CpptrajStdio.h"
-#include "StringRoutines.h" // validDouble
+#include "StringRoutines.h" // validDouble, ByteString
 #include "DataSet_1D.h" // LinearRegression
+#include "DataSet_double.h"
+#include "Corr.h"
+#include "File_TempName.h"
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 #ifdef TIMER
 # include "Timer.h"
 #endif
@@ -22,12 +29,25 @@ Action_Diffusion::Action_Diffusion() :
   outputx_(0), outputy_(0), outputz_(0), outputr_(0), outputa_(0),
   diffout_(0),
   boxcenter_(0.0),
-  masterDSL_(0)
+  masterDSL_(0),
+  multiOrigin_(false),
+  maxMem_(0),
+  nMOatoms_(0),
+  nMOframes_(0),
+  maxMOframes_(0),
+  mo_x_(0), mo_y_(0), mo_z_(0), mo_r_(0)
 {}
 
+// DESTRUCTOR
+Action_Diffusion::~Action_Diffusion() {
+  if (spill_.IsOpen()) spill_.CloseFile();
+  if (!tfname_.empty()) File::FreeTempName( tfname_ );
+}
+
 static inline void ShortHelp() {
   mprintf("\t[{out <filename> | separateout <suffix>}] [time <time per frame>] [noimage]\n"
-          "\t[<mask>] [<set name>] [individual] [diffout <filename>] [nocalc]\n");
+          "\t[<mask>] [<set name>] [individual] [diffout <filename>] [nocalc]\n"
+          "\t[multiorigin [maxmem <MB>] [msdout <filename>]]\n");
 }
 
 void Action_Diffusion::Help() const {
@@ -35,7 +55,12 @@ void Action_Diffusion::Help() const {
   mprintf("  Compute a mean square displacement plot for the atoms in the <mask>.\n"
           "  By default the average displacements are calculated unless 'individual'\n"
           "  is specified. Diffusion constants will be calculated from best-fit linear\n"
-          "  regression lines of MSDs vs time unless 'nocalc' is specified.\n");
+          "  regression lines of MSDs vs time unless 'nocalc' is specified.\n"
+          "  If 'multiorigin' is specified, the MSD vs lag time averaged over all\n"
+          "  time origins is also calculated (via FFT) at the end of the run. This\n"
+          "  requires storing unwrapped positions of selected atoms for every frame;\n"
+          "  once they exceed 'maxmem' MB (default 1000) they are written to a\n"
+          "  temporary file.\n");
 }
 
 static inline int CheckTimeArg(double dt) {
@@ -54,6 +79,7 @@ Action::RetType Action_Diffusion::Init(ArgList& actionArgs, ActionInit& init, in
 # endif
   debug_ = debugIn;
   image_.InitImaging( !(actionArgs.hasKey("noimage")) );
+  DataFile* msdout = 0;
   // Determine if this is old syntax or new.
   if (actionArgs.Nargs() > 2 && actionArgs.ArgIsMask(1) && validDouble(actionArgs[2]))
   {
@@ -80,6 +106,7 @@ Action::RetType Action_Diffusion::Init(ArgList& actionArgs, ActionInit& init, in
   } else {
     // New syntax: [{separateout <suffix> | out <filename>}] [time <time per frame>]
     //             [<mask>] [<set name>] [individual] [diffout <filename>] [nocalc]
+    //             [multiorigin [maxmem <MB>] [msdout <filename>]]
     printIndividual_ = actionArgs.hasKey("individual");
     calcDiffConst_ = !(actionArgs.hasKey("nocalc"));
     std::string suffix = actionArgs.GetStringKey("separateout");
@@ -89,10 +116,27 @@ Action::RetType Action_Diffusion::Init(ArgList& actionArgs, ActionInit& init, in
       return Action::ERR;
     }
     diffout_ = init.DFL().AddDataFile(actionArgs.GetStringKey("diffout"));
+    multiOrigin_ = actionArgs.hasKey("multiorigin");
+    if (multiOrigin_) {
+      double maxmb = actionArgs.getKeyDouble("maxmem", 1000.0);
+      if (maxmb <= 0.0) {
+        mprinterr("Error: 'maxmem' must be > 0.0\n");
+        return Action::ERR;
+      }
+      maxMem_ = (size_t)(maxmb * 1000000.0);
+#     ifdef MPI
+      if (trajComm_.Size() > 1) {
+        mprinterr("Error: 'multiorigin' for 'diffusion' is not supported in parallel.\n");
+        return Action::ERR;
+      }
+#     endif
+    }
     time_ = actionArgs.getKeyDouble("time", 1.0);
     if (CheckTimeArg(time_)) return Action::ERR;
     mask_.SetMaskString( actionArgs.GetMaskNext() );
     // Open output files.
+    if (multiOrigin_)
+      msdout = init.DFL().AddDataFile(actionArgs.GetStringKey("msdout"), actionArgs);
     if (!suffix.empty()) {
       FileName FName( suffix );
       outputx_ = init.DFL().AddDataFile(FName.PrependFileName("x_"), actionArgs);
@@ -131,6 +175,34 @@ Action::RetType Action_Diffusion::Init(ArgList& actionArgs, ActionInit& init, in
   avg_z_->SetDim(Dimension::X, Xdim_);
   avg_r_->SetDim(Dimension::X, Xdim_);
   avg_a_->SetDim(Dimension::X, Xdim_);
+  // Add DataSets for multiple time origin MSD. These are calculated at the
+  // end from all frames, so are not time series.
+  if (multiOrigin_) {
+    MetaData::tsType ts = MetaData::NOT_TS;
+    mo_x_ = init.DSL().AddSet(DataSet::DOUBLE, MetaData(dsname_, "MOX", ts));
+    mo_y_ = init.DSL().AddSet(DataSet::DOUBLE, MetaData(dsname_, "MOY", ts));
+    mo_z_ = init.DSL().AddSet(DataSet::DOUBLE, MetaData(dsname_, "MOZ", ts));
+    mo_r_ = init.DSL().AddSet(DataSet::DOUBLE, MetaData(dsname_, "MOR", ts));
+    if (mo_x_ == 0 || mo_y_ == 0 || mo_z_ == 0 || mo_r_ == 0)
+      return Action::ERR;
+    Dimension Ldim(0.0, time_, "Lag");
+    mo_x_->SetDim(Dimension::X, Ldim);
+    mo_y_->SetDim(Dimension::X, Ldim);
+    mo_z_->SetDim(Dimension::X, Ldim);
+    mo_r_->SetDim(Dimension::X, Ldim);
+#   ifdef MPI
+    mo_x_->SetNeedsSync( false );
+    mo_y_->SetNeedsSync( false );
+    mo_z_->SetNeedsSync( false );
+    mo_r_->SetNeedsSync( false );
+#   endif
+    if (msdout != 0) {
+      msdout->AddDataSet( mo_r_ );
+      msdout->AddDataSet( mo_x_ );
+      msdout->AddDataSet( mo_y_ );
+      msdout->AddDataSet( mo_z_ );
+    }
+  }
   // Add DataSets for diffusion constant calc
   if (calcDiffConst_) {
     MetaData::tsType ts = MetaData::NOT_TS;
@@ -191,6 +263,13 @@ Action::RetType Action_Diffusion::Init(ArgList& actionArgs, ActionInit& init, in
             outputa_->DataFilename().full());
   }
   mprintf("\tThe time between frames is %g ps.\n", time_);
+  if (multiOrigin_) {
+    mprintf("\tMSD averaged over all time origins will be calculated.\n"
+            "\t  Positions will be written to a temporary file if they exceed %s.\n",
+            ByteString(maxMem_, BYTE_DECIMAL).c_str());
+    if (msdout != 0)
+      mprintf("\tMulti-origin MSD output to '%s'\n", msdout->DataFilename().full());
+  }
   if (calcDiffConst_) {
     mprintf("\tCalculating diffusion constants by fitting slope to MSD vs time\n"
             "\t  and multiplying by 10.0/2*N (where N is # of dimensions), units\n"
@@ -237,6 +316,22 @@ Action::RetType Action_Diffusion::Setup(ActionSetup& setup) {
   } else
     mprintf("\tImaging disabled.\n");
 
+  // Stored positions are only meaningful if the same number of atoms is
+  // selected for every topology.
+  if (multiOrigin_) {
+    if (nMOatoms_ == 0) {
+      nMOatoms_ = (unsigned int)mask_.Nselected();
+      size_t frameBytes = (size_t)nMOatoms_ * 3 * sizeof(double);
+      maxMOframes_ = (unsigned int)std::max((size_t)1, maxMem_ / frameBytes);
+      mprintf("\tUp to %u frames of positions will be kept in memory.\n", maxMOframes_);
+    } else if ((unsigned int)mask_.Nselected() != nMOatoms_) {
+      mprinterr("Error: Number of selected atoms (%i) differs from first topology (%u);\n"
+                "Error:   cannot calculate multi-origin MSD.\n",
+                mask_.Nselected(), nMOatoms_);
+      return Action::ERR;
+    }
+  }
+
   // Allocate the delta array
   delta_.assign( mask_.Nselected() * 3, 0.0 );
 
@@ -414,6 +509,8 @@ Action::RetType Action_Diffusion::DoAction(int frameNum, ActionFrame& frm) {
       dely = XYZ[1] - iXYZ[1];
       delz = XYZ[2] - iXYZ[2];
     }
+    if (multiOrigin_)
+      StoreDisplacement(delx, dely, delz);
     // Calc distances for this atom
     double distx = delx * delx;
     double disty = dely * dely;
@@ -443,6 +540,12 @@ Action::RetType Action_Diffusion::DoAction(int frameNum, ActionFrame& frm) {
     previous_[idx+1] = XYZ[1];
     previous_[idx+2] = XYZ[2];
   } // END loop over selected atoms
+  if (multiOrigin_) {
+    ++nMOframes_;
+    if (positions_.size() >= (size_t)maxMOframes_ * nMOatoms_ * 3) {
+      if (SpillPositions()) return Action::ERR;
+    }
+  }
   // Calc averages
   double dNselected = 1.0 / (double)mask_.Nselected();
   avgx *= dNselected;
@@ -461,6 +564,10 @@ Action::RetType Action_Diffusion::DoAction(int frameNum, ActionFrame& frm) {
 
 // Action_Diffusion::Print()
 void Action_Diffusion::Print() {
+  if (multiOrigin_) {
+    if (CalcMultiOriginMSD())
+      mprinterr("Error: Could not calculate multi-origin MSD.\n");
+  }
   if (!calcDiffConst_) return;
   mprintf("    DIFFUSION: Calculating diffusion constants from slopes.\n");
   std::string const& name = avg_r_->Meta().Name();
@@ -469,6 +576,12 @@ void Action_Diffusion::Print() {
   CalcDiffusionConst( set, avg_x_, 1, name + "_AvgDx" );
   CalcDiffusionConst( set, avg_y_, 1, name + "_AvgDy" );
   CalcDiffusionConst( set, avg_z_, 1, name + "_AvgDz" );
+  if (multiOrigin_ && mo_r_->Size() > 0) {
+    CalcDiffusionConst( set, mo_r_, 3, name + "_MODr" );
+    CalcDiffusionConst( set, mo_x_, 1, name + "_MODx" );
+    CalcDiffusionConst( set, mo_y_, 1, name + "_MODy" );
+    CalcDiffusionConst( set, mo_z_, 1, name + "_MODz" );
+  }
   if (printIndividual_) {
     CalcDiffForSet( set, atom_r_, 3, name + "_dr" );
     CalcDiffForSet( set, atom_x_, 3, name + "_dx" );
@@ -505,3 +618,191 @@ void Action_Diffusion::CalcDiffusionConst(unsigned int& set, DataSet* ds, int Nd
   diffCorrl_->Add(set  , &corr);
   diffLabel_->Add(set++, label.c_str());
 }
+
+// -----------------------------------------------------------------------------
+/** Save displacement of current atom from its initial position. */
+void Action_Diffusion::StoreDisplacement(double dx, double dy, double dz) {
+  positions_.push_back( dx );
+  positions_.push_back( dy );
+  positions_.push_back( dz );
+}
+
+/** Append positions currently in memory to the temporary file, opening it
+  * if necessary.
+  */
+int Action_Diffusion::SpillPositions() {
+  if (positions_.empty()) return 0;
+  if (!spill_.IsOpen()) {
+    tfname_ = File::GenTempName();
+    if (tfname_.empty()) {
+      mprinterr("Internal Error: Could not get temporary file name for diffusion positions.\n");
+      return 1;
+    }
+    if (spill_.OpenWrite( tfname_ )) {
+      mprinterr("Error: Could not open temporary file '%s' for diffusion positions.\n",
+                tfname_.full());
+      return 1;
+    }
+    mprintf("\tDiffusion positions exceed %s, writing to temporary file '%s'\n",
+            ByteString(maxMem_, BYTE_DECIMAL).c_str(), tfname_.full());
+  }
+  if (spill_.Write( &positions_[0], positions_.size() * sizeof(double) )) {
+    mprinterr("Error: Could not write diffusion positions to '%s'\n", tfname_.full());
+    return 1;
+  }
+  positions_.clear();
+  return 0;
+}
+
+/** Add MSD of one coordinate of one atom vs lag time, averaged over all
+  * time origins, to msd. Uses the algorithm of Kneller et al., Comp. Phys.
+  * Comm. (1995) 91, 191-214:
+  *   MSD(m) = S1(m) - 2*S2(m)
+  * where S2(m) is the autocorrelation of the coordinate (via FFT) and S1(m)
+  * is calculated recursively from the squared coordinates, both divided by
+  * the number of time origins N - m.
+  * \param fft FFT correlation, set up for at least N points.
+  * \param data Scratch space from fft.
+  * \param pos First coordinate.
+  * \param stride Distance between coordinates of consecutive frames.
+  * \param N Number of frames.
+  * \param msd Output MSD array, size N.
+  */
+static void AtomMSD(CorrF_FFT& fft, ComplexArray& data, const double* pos,
+                    size_t stride, int N, double* msd)
+{
+  double sumD = 0.0;
+  const double* ptr = pos;
+  for (int i = 0; i < N; i++, ptr += stride) {
+    data[2*i  ] = *ptr;
+    data[2*i+1] = 0.0;
+    sumD += (*ptr) * (*ptr);
+  }
+  data.PadWithZero( N );
+  fft.AutoCorr( data );
+  double Q = 2.0 * sumD;
+  for (int m = 0; m < N; m++) {
+    if (m > 0) {
+      double rlo = pos[(size_t)(m-1) * stride];
+      double rhi = pos[(size_t)(N-m) * stride];
+      Q -= (rlo * rlo) + (rhi * rhi);
+    }
+    double norm = 1.0 / (double)(N - m);
+    msd[m] += (Q - 2.0 * data[2*m]) * norm;
+  }
+}
+
+/** Calculate MSD vs lag time averaged over all time origins for each atom
+  * using stored positions, then average over atoms. If positions were
+  * written to disk they are read back in blocks of atoms that fit in
+  * memory.
+  */
+int Action_Diffusion::CalcMultiOriginMSD() {
+  int N = (int)nMOframes_;
+  // Need at least 2 frames for any lag; also avoids CorrSetup(1).
+  if (N < 2 || nMOatoms_ < 1) {
+    mprintf("Warning: Less than 2 frames stored; cannot calculate multi-origin MSD.\n");
+    return 0;
+  }
+  size_t frameSize = (size_t)nMOatoms_ * 3;
+  bool onDisk = spill_.IsOpen();
+  unsigned int blockAtoms = nMOatoms_;
+  if (onDisk) {
+    if (SpillPositions()) return 1;
+    spill_.CloseFile();
+    if (spill_.OpenRead( tfname_ )) return 1;
+    size_t atomBytes = (size_t)N * 3 * sizeof(double);
+    blockAtoms = (unsigned int)std::min((size_t)nMOatoms_,
+                                        std::max((size_t)1, maxMem_ / atomBytes));
+  }
+  mprintf("\tCalculating multi-origin MSD for %u atoms over %i frames", nMOatoms_, N);
+  if (onDisk)
+    mprintf(" (%u atoms at a time from disk)", blockAtoms);
+  mprintf(".\n");
+  // FFT setup must happen outside the parallel region.
+  int numthreads = 1;
+# ifdef _OPENMP
+# pragma omp parallel
+  {
+  if (omp_get_thread_num() == 0)
+    numthreads = omp_get_num_threads();
+  }
+# endif
+  std::vector<CorrF_FFT> thread_fft( numthreads );
+  std::vector<ComplexArray> thread_data( numthreads );
+  std::vector<Darray> thread_msd( numthreads );
+  for (int t = 0; t < numthreads; t++) {
+    if (thread_fft[t].CorrSetup( N )) return 1;
+    thread_data[t] = thread_fft[t].Array();
+    thread_msd[t].assign( 3 * N, 0.0 );
+  }
+  Darray block;
+  for (unsigned int a0 = 0; a0 < nMOatoms_; a0 += blockAtoms) {
+    int nb = (int)std::min(blockAtoms, nMOatoms_ - a0);
+    const double* base;
+    size_t stride;
+    if (onDisk) {
+      // Read the positions of this block of atoms from every frame.
+      stride = (size_t)nb * 3;
+      block.resize( (size_t)N * stride );
+      int nbytes = (int)(stride * sizeof(double));
+      for (int f = 0; f < N; f++) {
+        off_t offset = (off_t)(((size_t)f * frameSize + (size_t)a0 * 3) * sizeof(double));
+        if (spill_.Seek( offset ) ||
+            spill_.Read( &block[0] + (size_t)f * stride, nbytes ) != nbytes)
+        {
+          mprinterr("Error: Could not read diffusion positions from '%s'\n", tfname_.full());
+          return 1;
+        }
+      }
+      base = &block[0];
+    } else {
+      stride = frameSize;
+      base = &positions_[0] + (size_t)a0 * 3;
+    }
+    int at;
+    int mythread = 0;
+#   ifdef _OPENMP
+#   pragma omp parallel private(at, mythread)
+    {
+    mythread = omp_get_thread_num();
+#   pragma omp for
+#   endif
+    for (at = 0; at < nb; at++) {
+      double* msd = &(thread_msd[mythread][0]);
+      const double* apos = base + (size_t)at * 3;
+      AtomMSD(thread_fft[mythread], thread_data[mythread], apos,   stride, N, msd);
+      AtomMSD(thread_fft[mythread], thread_data[mythread], apos+1, stride, N, msd + N);
+      AtomMSD(thread_fft[mythread], thread_data[mythread], apos+2, stride, N, msd + 2*N);
+    }
+#   ifdef _OPENMP
+    } // END omp parallel
+#   endif
+  }
+  if (onDisk) {
+    spill_.CloseFile();
+    File::FreeTempName( tfname_ );
+    tfname_.clear();
+  }
+  // Sum over threads and average over atoms.
+  DataSet_double& msdx = static_cast<DataSet_double&>( *mo_x_ );
+  DataSet_double& msdy = static_cast<DataSet_double&>( *mo_y_ );
+  DataSet_double& msdz = static_cast<DataSet_double&>( *mo_z_ );
+  DataSet_double& msdr = static_cast<DataSet_double&>( *mo_r_ );
+  msdx.Resize( N );
+  msdy.Resize( N );
+  msdz.Resize( N );
+  msdr.Resize( N );
+  double norm = 1.0 / (double)nMOatoms_;
+  for (int m = 0; m < N; m++) {
+    double sum[3] = {0.0, 0.0, 0.0};
+    for (int t = 0; t < numthreads; t++)
+      for (int i = 0; i < 3; i++)
+        sum[i] += thread_msd[t][i*N + m];
+    msdx[m] = sum[0] * norm;
+    msdy[m] = sum[1] * norm;
+    msdz[m] = sum[2] * norm;
+    msdr[m] = (sum[0] + sum[1] + sum[2]) * norm;
+  }
+  return 0;
+}
@@ -2,9 +2,11 @@
 #define INC_ACTION_DIFFUSION_H
 #include "Action.h"
 #include "ImagedAction.h"
+#include "CpptrajFile.h"
 class Action_Diffusion : public Action {
   public:
     Action_Diffusion();
+    ~Action_Diffusion();
     DispatchObject* Alloc() const { return (DispatchObject*)new Action_Diffusion(); }
     void Help() const;
   private:
@@ -19,6 +21,9 @@ class Action_Diffusion : public Action {
     inline void LoadInitial(Frame const&);
     void CalcDiffForSet(unsigned int&, Dlist const&, int, std::string const&) const;
     void CalcDiffusionConst(unsigned int&, DataSet*, int, std::string const&) const;
+    inline void StoreDisplacement(double, double, double);
+    int SpillPositions();
+    int CalcMultiOriginMSD();
 
     ImagedAction image_; ///< Imaging routines
     Frame initial_;   ///< Initial frame (all atoms)
@@ -54,6 +59,19 @@ class Action_Diffusion : public Action {
     DataSetList* masterDSL_;
     std::string dsname_;
     Dimension Xdim_;
+    // Multiple time origin MSD
+    bool multiOrigin_;     ///< If true calculate MSD averaged over all time origins
+    size_t maxMem_;        ///< Max memory in bytes for stored positions before spilling to disk
+    Darray positions_;     ///< Unwrapped displacements from initial frame; frame-major
+    unsigned int nMOatoms_;  ///< Number of atoms in positions_
+    unsigned int nMOframes_; ///< Total number of frames stored (memory + disk)
+    unsigned int maxMOframes_; ///< Max frames held in memory before spilling to disk
+    FileName tfname_;      ///< Temporary file for spilled positions
+    CpptrajFile spill_;    ///< Spilled positions
+    DataSet* mo_x_;        ///< Multi-origin MSD in X direction vs lag time
+    DataSet* mo_y_;        ///< Multi-origin MSD in Y direction vs lag time
+    DataSet* mo_z_;        ///< Multi-origin MSD in Z direction vs lag time
+    DataSet* mo_r_;        ///< Multi-origin overall MSD vs lag time
 #   ifdef MPI
     Parallel::Comm trajComm_;
 #   endif
@@ -12,6 +12,9 @@ class Action_Distance: public Action {
     Action::RetType Init(ArgList&, ActionInit&, int);
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
+#   ifdef _OPENMP
+    bool FrameThreadsOK() const { return true; }
+#   endif
     void Print() {}
 
     enum ModeType { NORMAL = 0, REF, POINT };
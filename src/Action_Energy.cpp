@@ -4,9 +4,12 @@
 #include "Ewald_ParticleMesh.h"
 
 /// CONSTRUCTOR
-Action_Energy::Action_Energy() : currentParm_(0), debug_(0), EW_(0)
+Action_Energy::Action_Energy() : currentParm_(0), debug_(0), EW_(0), boxTol_(0.0), compared_(false)
 {
   std::fill(mlimits_, mlimits_+3, 0);
+  std::fill(cmpCut_, cmpCut_+2, 0.0);
+  std::fill(cmpFull_, cmpFull_+2, 0.0);
+  std::fill(cmpTime_, cmpTime_+2, 0.0);
 }
 
 /// DESTRUCTOR
@@ -18,16 +21,22 @@ void Action_Energy::Help() const {
   mprintf("\t[<name>] [<mask1>] [out <filename>]\n"
           "\t[bond] [angle] [dihedral] {[nb14] | [e14] | [v14]}\n"
           "\t{[nonbond] | [elec] [vdw]} [kinetic [ketype {vel|vv}] [dt <dt>]]\n"
-          "\t[ etype { simple |\n"
+          "\t[ etype { simple [cut <rc> [shift | switch <ron>]] |\n"
           "\t          directsum [npoints <N>] |\n"
           "\t          ewald [cut <cutoff>] [dsumtol <dtol>] [rsumtol <rtol>]\n"
           "\t                [ewcoeff <coeff>] [maxexp <max>] [skinnb <skinnb>]\n"
           "\t                [mlimits <X>,<Y>,<Z>] [erfcdx <dx>]\n"
           "\t          pme [cut <cutoff>] [dsumtol <dtol>] [order <order>] [ljswidth <width>]\n"
           "\t              [ewcoeff <coeff>] [ljpme] [ewcoefflj] [skinnb <skinnb>]\n"
-          "\t              [nfft <nfft1>,<nfft2>,<nfft3>] [erfcdx <dx>]\n"
+          "\t              [nfft <nfft1>,<nfft2>,<nfft3>] [erfcdx <dx>] [boxtol <tol>]\n"
           "\t        } ]\n"
-          "  Calculate energy for atoms in mask.\n");
+          "  Calculate energy for atoms in mask.\n"
+          "  For 'simple' electrostatics (or VDW only), if 'cut' is specified only\n"
+          "  non-imaged pairs within <rc> are calculated; energies may be shifted to\n"
+          "  zero at <rc> or switched to zero between <ron> and <rc>. The cutoff\n"
+          "  energies are compared to the full sum for the first frame.\n"
+          "  For 'pme', if 'boxtol' is specified the previous FFT grid size is\n"
+          "  reused while box lengths/angles change by less than <tol> (relative).\n");
 }
 
 /// Corresponds to Etype 
@@ -148,6 +157,7 @@ Action::RetType Action_Energy::Init(ArgList& actionArgs, ActionInit& init, int d
       skinnb_ = actionArgs.getKeyDouble("skinnb", 2.0);
       erfcDx_ = actionArgs.getKeyDouble("erfcdx", 0.0);
       npoints_ = actionArgs.getKeyInt("order", 6);
+      boxTol_ = actionArgs.getKeyDouble("boxtol", 0.0);
       std::string marg = actionArgs.GetStringKey("nfft");
       if (!marg.empty()) {
         ArgList mlim(marg, ",");
@@ -228,6 +238,12 @@ Action::RetType Action_Energy::Init(ArgList& actionArgs, ActionInit& init, int d
   }
   if (lj_longrange_correction && lwcoeff_ >= 0.0)
     lj_longrange_correction = false;
+  // Cutoff for simple nonbond calc
+  if (elecType_ == SIMPLE || elecType_ == NO_ELE) {
+    if (nbcut_.GetArgs( actionArgs )) return Action::ERR;
+  }
+  ENE_.SetCutoff( nbcut_ );
+  compared_ = false;
 
   // Get Masks
   if (Mask1_.SetMaskString( actionArgs.GetMaskNext() )) return Action::ERR;
@@ -252,6 +268,8 @@ Action::RetType Action_Energy::Init(ArgList& actionArgs, ActionInit& init, int d
   mprintf("\n");
   if (elecType_ != NO_ELE)
     mprintf("\tElectrostatics method: %s\n", ElecStr[elecType_]);
+  if (termEnabled[ELEC] || termEnabled[VDW])
+    nbcut_.PrintInfo();
   if (elecType_ == DIRECTSUM) {
     if (npoints_ < 0)
       mprintf("\tDirect sum energy for up to %i unit cells in each direction will be calculated.\n",
@@ -353,7 +371,7 @@ Action::RetType Action_Energy::Setup(ActionSetup& setup) {
   else if (elecType_ == PME) {
     if (((Ewald_ParticleMesh*)EW_)->Init(setup.CoordInfo().TrajBox(), cutoff_, dsumtol_,
                                          ewcoeff_, lwcoeff_, ljswidth_, skinnb_, erfcDx_, npoints_,
-                                         debug_, mlimits_))
+                                         debug_, mlimits_, boxTol_))
       return Action::ERR;
     EW_->Setup( setup.Top(), Imask_ );
   }
@@ -395,6 +413,29 @@ double Action_Energy::Dbg_Direct(Frame const& frameIn, int maxpoints) {
   return lastEQ;
 }
 
+/** Calculate nonbond energy for all pairs with the cutoff disabled and
+  * save it along with the cutoff energy and timings so the accuracy and
+  * speed of the cutoff can be reported.
+  */
+void Action_Energy::CompareFullSum(Frame const& frameIn, double evdw, double eelec) {
+  cmpCut_[0] = evdw;
+  cmpCut_[1] = eelec;
+  cmpTime_[0] = time_NB_.Total();
+  ENE_.SetCutoff( NonbondCutoff() );
+  Timer time_full;
+  time_full.Start();
+  if (Energy_[VDW] != 0 && Energy_[ELEC] != 0)
+    cmpFull_[0] = ENE_.E_Nonbond(frameIn, *currentParm_, Imask_, cmpFull_[1]);
+  else if (Energy_[VDW] != 0)
+    cmpFull_[0] = ENE_.E_VDW(frameIn, *currentParm_, Imask_);
+  else
+    cmpFull_[1] = ENE_.E_Elec(frameIn, *currentParm_, Imask_);
+  time_full.Stop();
+  cmpTime_[1] = time_full.Total();
+  ENE_.SetCutoff( nbcut_ );
+  compared_ = true;
+}
+
 // Action_Energy::DoAction()
 Action::RetType Action_Energy::DoAction(int frameNum, ActionFrame& frm) {
   time_total_.Start();
@@ -439,6 +480,7 @@ Action::RetType Action_Energy::DoAction(int frameNum, ActionFrame& frm) {
         Energy_[VDW]->Add(frameNum, &ene);
         Energy_[ELEC]->Add(frameNum, &ene2);
         Etot += (ene + ene2);
+        if (nbcut_.Active() && !compared_) CompareFullSum(frm.Frm(), ene, ene2);
         break;
       case C_LJ:
         time_NB_.Start();
@@ -446,6 +488,7 @@ Action::RetType Action_Energy::DoAction(int frameNum, ActionFrame& frm) {
         time_NB_.Stop();
         Energy_[VDW]->Add(frameNum, &ene);
         Etot += ene;
+        if (nbcut_.Active() && !compared_) CompareFullSum(frm.Frm(), ene, 0.0);
         break;
       case C_COULOMB:
         time_NB_.Start();
@@ -453,6 +496,7 @@ Action::RetType Action_Energy::DoAction(int frameNum, ActionFrame& frm) {
         time_NB_.Stop();
         Energy_[ELEC]->Add(frameNum, &ene);
         Etot += ene;
+        if (nbcut_.Active() && !compared_) CompareFullSum(frm.Frm(), 0.0, ene);
         break;
       case C_DIRECT:
         time_NB_.Start();
@@ -522,7 +566,25 @@ void Action_Energy::Print() {
     time_NB_.WriteTiming(1,    "NONBOND     :", time_total_.Total());
     if (elecType_ == EWALD || elecType_ == PME)
       EW_->Timing(time_NB_.Total());
+#   ifdef LIBPME
+    if (elecType_ == PME && boxTol_ > 0.0)
+      mprintf("\tPME FFT grid reused for %i frames.\n",
+              ((Ewald_ParticleMesh*)EW_)->NgridReused());
+#   endif
   }
   if (time_ke_.Total() > 0.0)
     time_ke_.WriteTiming(1,    "KE          :", time_total_.Total());
+  if (compared_) {
+    mprintf("  Nonbond cutoff %.4f Ang. vs full sum, first frame:\n", nbcut_.Cut());
+    if (Energy_[VDW] != 0)
+      mprintf("\tVDW  : cutoff= %14.4f  full= %14.4f  diff= %12.4f kcal/mol\n",
+              cmpCut_[0], cmpFull_[0], cmpCut_[0] - cmpFull_[0]);
+    if (Energy_[ELEC] != 0)
+      mprintf("\tElec.: cutoff= %14.4f  full= %14.4f  diff= %12.4f kcal/mol\n",
+              cmpCut_[1], cmpFull_[1], cmpCut_[1] - cmpFull_[1]);
+    mprintf("\tTime : cutoff= %.4f s  full= %.4f s", cmpTime_[0], cmpTime_[1]);
+    if (cmpTime_[0] > 0.0)
+      mprintf("  speedup= %.2fx", cmpTime_[1] / cmpTime_[0]);
+    mprintf("\n");
+  }
 }
@@ -15,12 +15,15 @@ class Action_Energy: public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY | CoordinateInfo::FORCE; }
     /// Corresponds to data sets.
     enum Etype { BOND = 0, ANGLE, DIHEDRAL, V14, Q14, VDW, ELEC, KE, TOTAL};
     /// Add energy data set of specified type.
     int AddSet(Etype, DataSetList&, DataFile*, std::string const&);
     /// For debugging the direct sum convergence
     double Dbg_Direct(Frame const&,int);
+    /// Calculate full nonbond sum for comparison to cutoff energies.
+    void CompareFullSum(Frame const&, double, double);
     /// Corresponds to calculations.
     enum CalcType { C_BND = 0, C_ANG, C_DIH, C_N14, C_NBD, C_LJ,
                     C_COULOMB, C_DIRECT, C_EWALD, C_PME, C_KEAUTO, C_KEVEL, C_KEVV };
@@ -50,9 +53,15 @@ class Action_Energy: public Action {
     double maxexp_;
     double skinnb_;                ///< Size of non-bonded "skin"
     double erfcDx_;                ///< Spacing for ERFC table (default 1/5000)
+    double boxTol_;                ///< PME: reuse recip box while box change is below this
     double dt_;                    ///< Time step for estimating kinetic energy (leapfrog)
     int mlimits_[3];               ///< mlimits (reg. Ewald) or nfft (PME)
     bool need_lj_params_;          ///< True if LJ parameters needed.
+    NonbondCutoff nbcut_;          ///< Cutoff for simple nonbond calc.
+    bool compared_;                ///< True once cutoff energies compared to full sum.
+    double cmpCut_[2];             ///< Cutoff VDW/Elec. energies for comparison frame.
+    double cmpFull_[2];            ///< Full sum VDW/Elec. energies for comparison frame.
+    double cmpTime_[2];            ///< Cutoff/full sum nonbond time for comparison frame.
     Timer time_total_;
     Timer time_bond_;
     Timer time_angle_;
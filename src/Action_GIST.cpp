@@ -5,6 +5,7 @@
 #include "Constants.h"
 #include "DataSet_GridFlt.h"
 #include "DataSet_GridDbl.h"
+#include "DataSet_GridSparse.h"
 #include "ProgressBar.h"
 #include "StringRoutines.h"
 #ifdef _OPENMP
@@ -44,7 +45,8 @@ Action_GIST::Action_GIST() :
   doOrder_(false),
   doEij_(false),
   skipE_(false),
-  includeIons_(true)
+  includeIons_(true),
+  sparse_(false)
 {}
 
 void Action_GIST::Help() const {
@@ -52,8 +54,12 @@ void Action_GIST::Help() const {
           "\t[noimage] [gridcntr <xval> <yval> <zval>] [excludeions]\n"
           "\t[griddim <xval> <yval> <zval>] [gridspacn <spaceval>]\n"
           "\t[prefix <filename prefix>] [ext <grid extension>] [out <output>]\n"
-          "\t[info <info>]\n"
-          "Perform Grid Inhomogenous Solvation Theory calculation.\n");
+          "\t[info <info>] [sparse]\n"
+          "Perform Grid Inhomogenous Solvation Theory calculation.\n"
+          "  If 'sparse' is specified the single-precision grids (gO, gH, Esw, Eww,\n"
+          "  dTStrans, dTSorient, dTSsix, neighbor, dipole) and the per-voxel water\n"
+          "  coordinates, orientations, energies, and neighbor counts are stored in\n"
+          "  8x8x8 voxel bricks that are only allocated when first written to.\n");
 }
 
 Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int debugIn)
@@ -99,6 +105,7 @@ Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int deb
   doOrder_ = actionArgs.hasKey("doorder");
   doEij_ = actionArgs.hasKey("doeij");
   skipE_ = actionArgs.hasKey("skipE");
+  sparse_ = actionArgs.hasKey("sparse");
   if (skipE_) {
     if (doEij_) {
       mprinterr("Error: 'doeij' cannot be specified if 'skipE' is specified.\n");
@@ -146,15 +153,17 @@ Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int deb
     dsname = init.DSL().GenerateDefaultName("GIST");
 
   // Set up DataSets.
-  gO_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "gO"));
-  gH_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "gH"));
-  Esw_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "Esw"));
-  Eww_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "Eww"));
-  dTStrans_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "dTStrans"));
-  dTSorient_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "dTSorient"));
-  dTSsix_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "dTSsix"));
-  neighbor_norm_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "neighbor"));
-  dipole_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, MetaData(dsname, "dipole"));
+  DataSet::DataType fltType = DataSet::GRID_FLT;
+  if (sparse_) fltType = DataSet::GRID_SPARSE;
+  gO_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "gO"));
+  gH_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "gH"));
+  Esw_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "Esw"));
+  Eww_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "Eww"));
+  dTStrans_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "dTStrans"));
+  dTSorient_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "dTSorient"));
+  dTSsix_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "dTSsix"));
+  neighbor_norm_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "neighbor"));
+  dipole_ = (DataSet_3D*)init.DSL().AddSet(fltType, MetaData(dsname, "dipole"));
 
   order_norm_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_DBL, MetaData(dsname, "order"));
   dipolex_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_DBL, MetaData(dsname, "dipolex"));
@@ -217,8 +226,8 @@ Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int deb
                  (double)nz * gridspacing + 1.5 );
   N_waters_.assign( MAX_GRID_PT_, 0 );
   N_hydrogens_.assign( MAX_GRID_PT_, 0 );
-  voxel_xyz_.resize( MAX_GRID_PT_ ); // [] = X Y Z
-  voxel_Q_.resize( MAX_GRID_PT_ ); // [] = W4 X4 Y4 Z4
+  voxel_xyz_.Allocate( nx, ny, nz, sparse_ ); // [] = X Y Z
+  voxel_Q_.Allocate( nx, ny, nz, sparse_ ); // [] = W4 X4 Y4 Z4
 
   int numthreads = 1;
 # ifdef _OPENMP
@@ -236,11 +245,11 @@ Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int deb
     E_VV_Elec_.resize( numthreads );
     neighbor_.resize( numthreads );
     for (int thread = 0; thread != numthreads; thread++) {
-      E_UV_VDW_[thread].assign( MAX_GRID_PT_, 0 );
-      E_UV_Elec_[thread].assign( MAX_GRID_PT_, 0 );
-      E_VV_VDW_[thread].assign( MAX_GRID_PT_, 0 );
-      E_VV_Elec_[thread].assign( MAX_GRID_PT_, 0 );
-      neighbor_[thread].assign( MAX_GRID_PT_, 0 );
+      E_UV_VDW_[thread].Allocate( nx, ny, nz, sparse_ );
+      E_UV_Elec_[thread].Allocate( nx, ny, nz, sparse_ );
+      E_VV_VDW_[thread].Allocate( nx, ny, nz, sparse_ );
+      E_VV_Elec_[thread].Allocate( nx, ny, nz, sparse_ );
+      neighbor_[thread].Allocate( nx, ny, nz, sparse_ );
     }
 #   ifdef _OPENMP
     if (doEij_) {
@@ -278,6 +287,8 @@ Action::RetType Action_GIST::Init(ArgList& actionArgs, ActionInit& init, int deb
     if (numthreads > 1)
       mprintf("\tParallelizing energy calculation with %i threads.\n", numthreads);
   }
+  if (sparse_)
+    mprintf("\tFloat grids and per-voxel arrays will be allocated in bricks on first write.\n");
   if (includeIons_)
     mprintf("\tIons will be included in the solute region.\n");
   else
@@ -501,11 +512,15 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
 
 //  mprintf("DEBUG: NSolventAtoms= %zu  NwatAtomsOnGrid= %u\n", O_idxs_.size()*nMolAtoms_, N_ON_GRID_);
 
-  double* E_UV_VDW  = &(E_UV_VDW_[0][0]);
-  double* E_UV_Elec = &(E_UV_Elec_[0][0]);
-  double* E_VV_VDW  = &(E_VV_VDW_[0][0]);
-  double* E_VV_Elec = &(E_VV_Elec_[0][0]);
-  float* Neighbor = &(neighbor_[0][0]);
+  Dvoxels* E_UV_VDW  = &(E_UV_VDW_[0]);
+  Dvoxels* E_UV_Elec = &(E_UV_Elec_[0]);
+  Dvoxels* E_VV_VDW  = &(E_VV_VDW_[0]);
+  Dvoxels* E_VV_Elec = &(E_VV_Elec_[0]);
+  Fvoxels* Neighbor = &(neighbor_[0]);
+  // Position of the voxel of each on-grid solvent atom in the per-voxel arrays.
+  std::vector<size_t> OnGrid_elt( N_ON_GRID_ );
+  for (unsigned int gidx = 0; gidx < N_ON_GRID_; gidx++)
+    OnGrid_elt[gidx] = E_UV_VDW_[0].StorageIndex( atom_voxel_[OnGrid_idxs_[gidx]] );
   double Evdw, Eelec;
   int aidx;
   int maxAidx = (int)A_idxs_.size();
@@ -518,11 +533,11 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
 # pragma omp parallel private(aidx, mythread, E_UV_VDW, E_UV_Elec, E_VV_VDW, E_VV_Elec, Neighbor, Evdw, Eelec, eij_v1, eij_v2, eij_en)
   {
   mythread = omp_get_thread_num();
-  E_UV_VDW = &(E_UV_VDW_[mythread][0]);
-  E_UV_Elec = &(E_UV_Elec_[mythread][0]);
-  E_VV_VDW = &(E_VV_VDW_[mythread][0]);
-  E_VV_Elec = &(E_VV_Elec_[mythread][0]);
-  Neighbor = (&neighbor_[mythread][0]);
+  E_UV_VDW = &(E_UV_VDW_[mythread]);
+  E_UV_Elec = &(E_UV_Elec_[mythread]);
+  E_VV_VDW = &(E_VV_VDW_[mythread]);
+  E_VV_Elec = &(E_VV_Elec_[mythread]);
+  Neighbor = &(neighbor_[mythread]);
   if (doEij_) {
     eij_v1 = &(EIJ_V1_[mythread]);
     eij_v2 = &(EIJ_V2_[mythread]);
@@ -537,6 +552,9 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
   {
     int a1 = A_idxs_[aidx];            // Index of atom1
     int a1_voxel = atom_voxel_[a1];    // Voxel of atom1
+    size_t a1_elt = 0;                 // Position of atom1 voxel in per-voxel arrays
+    if (a1_voxel > -1)
+      a1_elt = E_UV_VDW_[0].StorageIndex( a1_voxel );
     int a1_mol = topIn[ a1 ].MolNum(); // Molecule # of atom 1
     Vec3 A1_XYZ( frameIn.XYZ( a1 ) );  // Coord of atom1
     double qA1 = topIn[ a1 ].Charge(); // Charge of atom1
@@ -565,6 +583,7 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
       if (a1_mol != a2_mol)
       {
         int a2_voxel = atom_voxel_[a2];                  // Voxel of on-grid solvent
+        size_t a2_elt = OnGrid_elt[gidx];                // Position of a2_voxel in per-voxel arrays
         const double* A2_XYZ = (&OnGrid_XYZ_[0])+gidx*3; // Coord of on-grid solvent
         if ( a1_voxel == SOLUTE_ ) {
           // Solute to on-grid solvent energy
@@ -589,8 +608,8 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
           //gist_nonbond_UV_.Start();
           // Calculate energy
           Ecalc( rij2, qA1, topIn[ a2 ].Charge(), topIn.GetLJparam(a1, a2), Evdw, Eelec );
-          E_UV_VDW[a2_voxel]  += Evdw;
-          E_UV_Elec[a2_voxel] += Eelec;
+          E_UV_VDW->Element(a2_elt)  += Evdw;
+          E_UV_Elec->Element(a2_elt) += Eelec;
           //gist_nonbond_UV_.Stop();
         } else {
           // Off-grid/on-grid solvent to on-grid solvent energy
@@ -619,18 +638,18 @@ void Action_GIST::NonbondEnergy(Frame const& frameIn, Topology const& topIn)
             // Calculate energy
             Ecalc( rij2, qA1, topIn[ a2 ].Charge(), topIn.GetLJparam(a1, a2), Evdw, Eelec );
             //mprintf("DEBUG1: v1= %i v2= %i EVV %i %i Vdw= %f Elec= %f\n", a2_voxel, a1_voxel, a2, a1, Evdw, Eelec);
-            E_VV_VDW[a2_voxel] += Evdw;
-            E_VV_Elec[a2_voxel] += Eelec;
+            E_VV_VDW->Element(a2_elt) += Evdw;
+            E_VV_Elec->Element(a2_elt) += Eelec;
             // Store water neighbor using only O-O distance
             bool is_O_O = (a1IsO && (topIn[ a2 ].Element() == Atom::OXYGEN));
             if (is_O_O && rij2 < NeighborCut2_)
-              Neighbor[a2_voxel] += 1.0;
+              Neighbor->Element(a2_elt) += 1.0;
             // If water atom1 was also on the grid update its energy as well.
             if ( a1_voxel != OFF_GRID_ ) {
-              E_VV_VDW[a1_voxel] += Evdw;
-              E_VV_Elec[a1_voxel] += Eelec;
+              E_VV_VDW->Element(a1_elt) += Evdw;
+              E_VV_Elec->Element(a1_elt) += Eelec;
               if (is_O_O && rij2 < NeighborCut2_)
-                Neighbor[a1_voxel] += 1.0;
+                Neighbor->Element(a1_elt) += 1.0;
               if (doEij_) {
                 if (a1_voxel != a2_voxel) {
 #                 ifdef _OPENMP
@@ -941,27 +960,38 @@ void Action_GIST::TransEntropy(float VX, float VY, float VZ,
 
 // Action_GIST::SumEVV()
 void Action_GIST::SumEVV() {
-  if (E_VV_VDW_.size() > 1) {
-    for (unsigned int gr_pt = 0; gr_pt != MAX_GRID_PT_; gr_pt++) {
-      for (unsigned int thread = 1; thread < E_VV_VDW_.size(); thread++) {
-        E_UV_VDW_[0][gr_pt]  += E_UV_VDW_[thread][gr_pt];
-        E_UV_Elec_[0][gr_pt] += E_UV_Elec_[thread][gr_pt];
-        E_VV_VDW_[0][gr_pt]  += E_VV_VDW_[thread][gr_pt];
-        E_VV_Elec_[0][gr_pt] += E_VV_Elec_[thread][gr_pt];
-        neighbor_[0][gr_pt]  += neighbor_[thread][gr_pt];
-      }
-    }
+  for (unsigned int thread = 1; thread < E_VV_VDW_.size(); thread++) {
+    E_UV_VDW_[0].Add( E_UV_VDW_[thread] );
+    E_UV_Elec_[0].Add( E_UV_Elec_[thread] );
+    E_VV_VDW_[0].Add( E_VV_VDW_[thread] );
+    E_VV_Elec_[0].Add( E_VV_Elec_[thread] );
+    neighbor_[0].Add( neighbor_[thread] );
   }
 }
 
+/** Set voxel of a GIST float grid. Zeros are not stored in sparse grids so
+  * that only bricks with nonzero voxels are allocated.
+  */
+static inline void SetGridVal(DataSet_3D& grid, unsigned int idx, double val) {
+  if (grid.Type() == DataSet::GRID_SPARSE) {
+    size_t i, j, k;
+    grid.ReverseIndex( idx, i, j, k );
+    static_cast<DataSet_GridSparse&>( grid ).SetElement( i, j, k, (float)val );
+  } else
+    static_cast<DataSet_GridFlt&>( grid )[idx] = (float)val;
+}
+
 // Action_GIST::Print()
 void Action_GIST::Print() {
   gist_print_.Start();
   double Vvox = gO_->Bin().VoxelVolume();
 
   mprintf("    GIST OUTPUT:\n");
+  if (sparse_)
+    mprintf("\tWater data allocated for %zu of %zu 8x8x8 voxel bricks.\n",
+            voxel_xyz_.NbricksAllocated(), voxel_xyz_.Nbricks());
   // Calculate orientational entropy
-  DataSet_GridFlt& dTSorient_dens = static_cast<DataSet_GridFlt&>( *dTSorient_ );
+  DataSet_3D& dTSorient_dens = *dTSorient_;
   Farray dTSorient_norm( MAX_GRID_PT_, 0.0 );
   double dTSorienttot = 0;
   int nwtt = 0;
@@ -971,24 +1001,25 @@ void Action_GIST::Print() {
   ProgressBar oe_progress( MAX_GRID_PT_ );
   for (unsigned int gr_pt = 0; gr_pt < MAX_GRID_PT_; gr_pt++) {
     oe_progress.Update( gr_pt );
-    dTSorient_dens[gr_pt] = 0;
+    SetGridVal( dTSorient_dens, gr_pt, 0 );
     dTSorient_norm[gr_pt] = 0;
     int nw_total = N_waters_[gr_pt]; // Total number of waters that have been in this voxel.
     nwtt += nw_total;
     //mprintf("DEBUG1: %u nw_total %i\n", gr_pt, nw_total);
     if (nw_total > 1) {
+      Farray const& V_Q = voxel_Q_[gr_pt];
       for (int n0 = 0; n0 < nw_total; n0++)
       {
         double NNr = 10000;
-        int q0 = n0 * 4; // Index into voxel_Q_ for n0
+        int q0 = n0 * 4; // Index into V_Q for n0
         for (int n1 = 0; n1 < nw_total; n1++)
         {
           if (n0 != n1) {
-            int q1 = n1 * 4; // Index into voxel_Q_ for n1
-            double rR = 2.0 * acos(  voxel_Q_[gr_pt][q1  ] * voxel_Q_[gr_pt][q0  ]
-                                   + voxel_Q_[gr_pt][q1+1] * voxel_Q_[gr_pt][q0+1]
-                                   + voxel_Q_[gr_pt][q1+2] * voxel_Q_[gr_pt][q0+2]
-                                   + voxel_Q_[gr_pt][q1+3] * voxel_Q_[gr_pt][q0+3] );
+            int q1 = n1 * 4; // Index into V_Q for n1
+            double rR = 2.0 * acos(  V_Q[q1  ] * V_Q[q0  ]
+                                   + V_Q[q1+1] * V_Q[q0+1]
+                                   + V_Q[q1+2] * V_Q[q0+2]
+                                   + V_Q[q1+3] * V_Q[q0+3] );
             //mprintf("DEBUG1: %g\n", rR);
             if (rR > 0 && rR < NNr) NNr = rR;
           }
@@ -1005,7 +1036,7 @@ void Action_GIST::Print() {
       dTSorient_norm[gr_pt] = Constants::GASK_KCAL * temperature_ * 
                                ((dTSorient_norm[gr_pt]/nw_total) + Constants::EULER_MASC);
       double dtso_norm_nw = (double)dTSorient_norm[gr_pt] * (double)nw_total;
-      dTSorient_dens[gr_pt] = (dtso_norm_nw / (NFRAME_ * Vvox));
+      SetGridVal( dTSorient_dens, gr_pt, dtso_norm_nw / (NFRAME_ * Vvox) );
       dTSorienttot += dTSorient_dens[gr_pt];
       //mprintf("DEBUG1: %f\n", dTSorienttot);
     }
@@ -1027,10 +1058,10 @@ void Action_GIST::Print() {
   unsigned int addx = ny * nz;
   unsigned int addy = nz;
   unsigned int addz = 1;
-  DataSet_GridFlt& gO = static_cast<DataSet_GridFlt&>( *gO_ );
-  DataSet_GridFlt& gH = static_cast<DataSet_GridFlt&>( *gH_ );
-  DataSet_GridFlt& dTStrans = static_cast<DataSet_GridFlt&>( *dTStrans_ );
-  DataSet_GridFlt& dTSsix = static_cast<DataSet_GridFlt&>( *dTSsix_ );
+  DataSet_3D& gO = *gO_;
+  DataSet_3D& gH = *gH_;
+  DataSet_3D& dTStrans = *dTStrans_;
+  DataSet_3D& dTSsix = *dTSsix_;
   Farray dTStrans_norm( MAX_GRID_PT_, 0.0 );
   Farray dTSsix_norm( MAX_GRID_PT_, 0.0 );
   // Loop over all grid points
@@ -1040,37 +1071,39 @@ void Action_GIST::Print() {
     te_progress.Update( gr_pt );
     int numplane = gr_pt / addx;
     double W_dens = 1.0 * N_waters_[gr_pt] / (NFRAME_*Vvox);
-    gO[gr_pt] = W_dens / BULK_DENS_;
-    gH[gr_pt] = 1.0 * N_hydrogens_[gr_pt] / (NFRAME_*Vvox*2*BULK_DENS_);
+    SetGridVal( gO, gr_pt, W_dens / BULK_DENS_ );
+    SetGridVal( gH, gr_pt, 1.0 * N_hydrogens_[gr_pt] / (NFRAME_*Vvox*2*BULK_DENS_) );
 
     int nw_total = N_waters_[gr_pt]; // Total number of waters that have been in this voxel.
     for (int n0 = 0; n0 < nw_total; n0++)
     {
       double NNd = 10000;
       double NNs = 10000;
-      int i0 = n0 * 3; // index into voxel_xyz_ for n0
-      float VX = voxel_xyz_[gr_pt][i0  ];
-      float VY = voxel_xyz_[gr_pt][i0+1];
-      float VZ = voxel_xyz_[gr_pt][i0+2];
-      int q0 = n0 * 4;  // index into voxel_Q_ for n0
-      float W4 = voxel_Q_[gr_pt][q0  ];
-      float X4 = voxel_Q_[gr_pt][q0+1];
-      float Y4 = voxel_Q_[gr_pt][q0+2];
-      float Z4 = voxel_Q_[gr_pt][q0+3];
+      Farray const& V_XYZ = voxel_xyz_[gr_pt];
+      Farray const& V_Q   = voxel_Q_[gr_pt];
+      int i0 = n0 * 3; // index into V_XYZ for n0
+      float VX = V_XYZ[i0  ];
+      float VY = V_XYZ[i0+1];
+      float VZ = V_XYZ[i0+2];
+      int q0 = n0 * 4;  // index into V_Q for n0
+      float W4 = V_Q[q0  ];
+      float X4 = V_Q[q0+1];
+      float Y4 = V_Q[q0+2];
+      float Z4 = V_Q[q0+3];
       // First do own voxel
       for (int n1 = 0; n1 < nw_total; n1++) {
         if ( n1 != n0) {
-          int i1 = n1 * 3; // index into voxel_xyz_ for n1
-          double dx = (double)(VX - voxel_xyz_[gr_pt][i1  ]);
-          double dy = (double)(VY - voxel_xyz_[gr_pt][i1+1]);
-          double dz = (double)(VZ - voxel_xyz_[gr_pt][i1+2]);
+          int i1 = n1 * 3; // index into V_XYZ for n1
+          double dx = (double)(VX - V_XYZ[i1  ]);
+          double dy = (double)(VY - V_XYZ[i1+1]);
+          double dz = (double)(VZ - V_XYZ[i1+2]);
           double dd = dx*dx+dy*dy+dz*dz;
           if (dd < NNd && dd > 0) { NNd = dd; }
-          int q1 = n1 * 4; // index into voxel_Q_ for n1
-          double rR = 2 * acos( W4*voxel_Q_[gr_pt][q1  ] +
-                                X4*voxel_Q_[gr_pt][q1+1] +
-                                Y4*voxel_Q_[gr_pt][q1+2] +
-                                Z4*voxel_Q_[gr_pt][q1+3] );
+          int q1 = n1 * 4; // index into V_Q for n1
+          double rR = 2 * acos( W4*V_Q[q1  ] +
+                                X4*V_Q[q1+1] +
+                                Y4*V_Q[q1+2] +
+                                Z4*V_Q[q1+3] );
           double ds = rR*rR + dd;
           if (ds < NNs && ds > 0) { NNs = ds; }
         }
@@ -1127,9 +1160,9 @@ void Action_GIST::Print() {
                                                                Constants::EULER_MASC );
     }
     double dtst_norm_nw = (double)dTStrans_norm[gr_pt] * (double)nw_total;
-    dTStrans[gr_pt] = (dtst_norm_nw / (NFRAME_*Vvox));
+    SetGridVal( dTStrans, gr_pt, dtst_norm_nw / (NFRAME_*Vvox) );
     double dtss_norm_nw = (double)dTSsix_norm[gr_pt] * (double)nw_total;
-    dTSsix[gr_pt] = (dtss_norm_nw / (NFRAME_*Vvox));
+    SetGridVal( dTSsix, gr_pt, dtss_norm_nw / (NFRAME_*Vvox) );
     dTStranstot += dTStrans[gr_pt];
   } // END loop over all grid points (voxels)
 
@@ -1151,10 +1184,10 @@ void Action_GIST::Print() {
 
   // Compute average voxel energy. Allocate these sets even if skipping energy
   // to be consistent with previous output.
-  DataSet_GridFlt& Esw_dens = static_cast<DataSet_GridFlt&>( *Esw_ );
-  DataSet_GridFlt& Eww_dens = static_cast<DataSet_GridFlt&>( *Eww_ );
-  DataSet_GridFlt& neighbor_norm = static_cast<DataSet_GridFlt&>( *neighbor_norm_ );
-  DataSet_GridFlt& pol = static_cast<DataSet_GridFlt&>( *dipole_ );
+  DataSet_3D& Esw_dens = *Esw_;
+  DataSet_3D& Eww_dens = *Eww_;
+  DataSet_3D& neighbor_norm = *neighbor_norm_;
+  DataSet_3D& pol = *dipole_;
   DataSet_GridDbl& qtet = static_cast<DataSet_GridDbl&>( *order_norm_ );
   DataSet_GridDbl& dipolex = static_cast<DataSet_GridDbl&>( *dipolex_ );
   DataSet_GridDbl& dipoley = static_cast<DataSet_GridDbl&>( *dipoley_ );
@@ -1163,11 +1196,11 @@ void Action_GIST::Print() {
   Farray Eww_norm( MAX_GRID_PT_, 0.0 );
   Farray neighbor_dens( MAX_GRID_PT_, 0.0 );
   if (!skipE_) {
-    Darray const& E_UV_VDW = E_UV_VDW_[0];
-    Darray const& E_UV_Elec = E_UV_Elec_[0];
-    Darray const& E_VV_VDW = E_VV_VDW_[0];
-    Darray const& E_VV_Elec = E_VV_Elec_[0];
-    Farray const& Neighbor = neighbor_[0];
+    Dvoxels const& E_UV_VDW = E_UV_VDW_[0];
+    Dvoxels const& E_UV_Elec = E_UV_Elec_[0];
+    Dvoxels const& E_VV_VDW = E_VV_VDW_[0];
+    Dvoxels const& E_VV_Elec = E_VV_Elec_[0];
+    Fvoxels const& Neighbor = neighbor_[0];
     // Sum values from other threads if necessary
     SumEVV();
     static const double DEBYE_EA = 0.20822678; // 1 Debye in eA
@@ -1181,32 +1214,32 @@ void Action_GIST::Print() {
       //mprintf("DEBUG1: VV vdw=%f elec=%f\n", E_VV_VDW_[gr_pt], E_VV_Elec_[gr_pt]);
       int nw_total = N_waters_[gr_pt]; // Total number of waters that have been in this voxel.
       if (nw_total > 1) {
-        Esw_dens[gr_pt] = (E_UV_VDW[gr_pt]  + E_UV_Elec[gr_pt]) / (NFRAME_ * Vvox);
+        SetGridVal( Esw_dens, gr_pt, (E_UV_VDW[gr_pt]  + E_UV_Elec[gr_pt]) / (NFRAME_ * Vvox) );
         Esw_norm[gr_pt] = (E_UV_VDW[gr_pt]  + E_UV_Elec[gr_pt]) / nw_total;
-        Eww_dens[gr_pt] = (E_VV_VDW[gr_pt]  + E_VV_Elec[gr_pt]) / (2 * NFRAME_ * Vvox);
+        SetGridVal( Eww_dens, gr_pt, (E_VV_VDW[gr_pt]  + E_VV_Elec[gr_pt]) / (2 * NFRAME_ * Vvox) );
         Eww_norm[gr_pt] = (E_VV_VDW[gr_pt]  + E_VV_Elec[gr_pt]) / (2 * nw_total);
         Eswtot += Esw_dens[gr_pt];
         Ewwtot += Eww_dens[gr_pt];
       } else {
-        Esw_dens[gr_pt]=0;
+        SetGridVal( Esw_dens, gr_pt, 0 );
         Esw_norm[gr_pt]=0;
         Eww_norm[gr_pt]=0;
-        Eww_dens[gr_pt]=0;
+        SetGridVal( Eww_dens, gr_pt, 0 );
       }
       // Compute the average number of water neighbor, average order parameter,
       // and average dipole density
       if (nw_total > 0) {
         qtet[gr_pt] /= nw_total;
         //mprintf("DEBUG1: neighbor= %8.1f  nw_total= %8i\n", neighbor[gr_pt], nw_total);
-        neighbor_norm[gr_pt] = 1.0 * Neighbor[gr_pt] / nw_total;
+        SetGridVal( neighbor_norm, gr_pt, 1.0 * Neighbor[gr_pt] / nw_total );
       }
       neighbor_dens[gr_pt] = 1.0 * Neighbor[gr_pt] / (NFRAME_ * Vvox);
       dipolex[gr_pt] /= (DEBYE_EA * NFRAME_ * Vvox);
       dipoley[gr_pt] /= (DEBYE_EA * NFRAME_ * Vvox);
       dipolez[gr_pt] /= (DEBYE_EA * NFRAME_ * Vvox);
-      pol[gr_pt] = sqrt( dipolex[gr_pt]*dipolex[gr_pt] +
-                         dipoley[gr_pt]*dipoley[gr_pt] +
-                         dipolez[gr_pt]*dipolez[gr_pt] );
+      SetGridVal( pol, gr_pt, sqrt( dipolex[gr_pt]*dipolex[gr_pt] +
+                                    dipoley[gr_pt]*dipoley[gr_pt] +
+                                    dipolez[gr_pt]*dipolez[gr_pt] ) );
     } // END loop over all grid points (voxels)
     Eswtot *= Vvox;
     Ewwtot *= Vvox;
@@ -5,6 +5,7 @@
 #include "DataSet_3D.h"
 #include "DataSet_MatrixFlt.h"
 #include "Timer.h"
+#include "VoxelArray.h"
 /// Class for applying Grid Inhomogenous Solvation Theory
 /** \author Daniel R. Roe
   */
@@ -69,21 +70,23 @@ class Action_GIST : public Action {
 #   endif
 
     typedef std::vector<float> Farray;
-    std::vector<Farray> neighbor_; ///< Number of water neighbors within 3.5 Ang.*
+    typedef VoxelArray<float> Fvoxels;
+    std::vector<Fvoxels> neighbor_; ///< Number of water neighbors within 3.5 Ang.*
 #   ifdef _OPENMP
     std::vector<Farray> EIJ_EN_;   ///< Hold any interaction energies each frame.*
 #   endif
 
-    typedef std::vector<Farray> Xarray;
+    typedef VoxelArray<Farray> Xarray;
     Xarray voxel_xyz_; ///< Coords for all waters in each voxel.*
     Xarray voxel_Q_;   ///< w4, x4, y4, z4 for all waters in each voxel.*
 
     typedef std::vector<double> Darray;
-    Darray OnGrid_XYZ_;             ///< XYZ coordinates for on-grid waters.*
-    std::vector<Darray> E_UV_VDW_;  ///< Solute-solvent van der Waals energy for each voxel.*
-    std::vector<Darray> E_UV_Elec_; ///< Solute-solvent electrostatic energy for each voxel.*
-    std::vector<Darray> E_VV_VDW_;  ///< Solvent-solvent van der Waals energy for each voxel.*
-    std::vector<Darray> E_VV_Elec_; ///< Solvent-solvent electrostatic energy for each voxel.*
+    typedef VoxelArray<double> Dvoxels;
+    Darray OnGrid_XYZ_;              ///< XYZ coordinates for on-grid waters.*
+    std::vector<Dvoxels> E_UV_VDW_;  ///< Solute-solvent van der Waals energy for each voxel.*
+    std::vector<Dvoxels> E_UV_Elec_; ///< Solute-solvent electrostatic energy for each voxel.*
+    std::vector<Dvoxels> E_VV_VDW_;  ///< Solvent-solvent van der Waals energy for each voxel.*
+    std::vector<Dvoxels> E_VV_Elec_; ///< Solvent-solvent electrostatic energy for each voxel.*
 
     Vec3 G_max_; ///< Grid max + 1.5 Ang.
 
@@ -121,5 +124,6 @@ class Action_GIST : public Action {
     bool doEij_;               ///< If true do the i-j energy calc
     bool skipE_;               ///< If true skip the nonbond energy calc
     bool includeIons_;         ///< If true include ions in solute region.
+    bool sparse_;              ///< If true allocate float grids/per-voxel arrays in bricks.
 };
 #endif
@@ -16,15 +16,18 @@ Action_Grid::Action_Grid() :
   debug_(0),
   invert_(false),
   pdbfile_(0),
-  grid_(0)
+  grid_(0),
+  sparse_(false)
 {}
 
 void Action_Grid::Help() const {
   mprintf("\t[out <filename>]\n%s\n", GridAction::HelpText);
   mprintf("\t<mask> [normframe | normdensity [density <density>]]\n"
           "\t[pdb <pdbout> [max <fraction>]] [{byres|mymol}]\n"
-          "\t[[smoothdensity <value>] [invert]] [madura <madura>]\n"
-          "  Bin atoms in <mask> into a 3D grid written to <filename>.\n");
+          "\t[[smoothdensity <value>] [invert]] [madura <madura>] [sparse]\n"
+          "  Bin atoms in <mask> into a 3D grid written to <filename>.\n"
+          "  If 'sparse' is specified, grid memory is only allocated for regions\n"
+          "  where atoms are binned.\n");
 }
 
 // Action_Grid::Init()
@@ -35,10 +38,19 @@ Action::RetType Action_Grid::Init(ArgList& actionArgs, ActionInit& init, int deb
   // Get output filename
   std::string filename = actionArgs.GetStringKey("out");
   // Get grid options
-  grid_ = GridInit( "GRID", actionArgs, init.DSL() );
+  sparse_ = actionArgs.hasKey("sparse");
+  if (sparse_)
+    grid_ = GridInit( "GRID", actionArgs, init.DSL(), DataSet::GRID_SPARSE );
+  else
+    grid_ = GridInit( "GRID", actionArgs, init.DSL(), DataSet::GRID_FLT );
   if (grid_ == 0) return Action::ERR;
 # ifdef MPI
-  if (ParallelGridInit(init.TrajComm(), grid_)) return Action::ERR;
+  int perr;
+  if (sparse_)
+    perr = ParallelGridInit(init.TrajComm(), (DataSet_GridSparse*)grid_);
+  else
+    perr = ParallelGridInit(init.TrajComm(), (DataSet_GridFlt*)grid_);
+  if (perr != 0) return Action::ERR;
 # endif
   // Get extra options
   max_ = actionArgs.getKeyDouble("max", 0.80);
@@ -55,6 +67,12 @@ Action::RetType Action_Grid::Init(ArgList& actionArgs, ActionInit& init, int deb
     init.DSL().RemoveSet( grid_ );
     return Action::ERR;
   }
+  if (sparse_ && invert_ && smooth_ > 0.0) {
+    // Inverted smoothing gives every empty voxel a value.
+    mprinterr("Error: 'sparse' is not compatible with 'smoothdensity' + 'invert'.\n");
+    init.DSL().RemoveSet( grid_ );
+    return Action::ERR;
+  }
   if (actionArgs.hasKey("byres"))
     mArray_.SetType( Cpptraj::MaskArray::BY_RESIDUE );
   else if (actionArgs.hasKey("bymol"))
@@ -87,6 +105,8 @@ Action::RetType Action_Grid::Init(ArgList& actionArgs, ActionInit& init, int deb
     mprintf("\tGridding the center of mass of molecules selected by the mask.\n");
   if (outfile != 0) mprintf("\tGrid will be printed to file %s\n", outfile->DataFilename().full());
   mprintf("\tGrid data set: '%s'\n", grid_->legend());
+  if (sparse_)
+    mprintf("\tGrid memory will only be allocated where atoms are binned.\n");
   mprintf("\tMask expression: [%s]\n",mask_.MaskString());
   if (pdbfile_ != 0)
       mprintf("\tPseudo-PDB will be printed to %s\n", pdbfile_->Filename().full());
@@ -126,34 +146,43 @@ Action::RetType Action_Grid::Setup(ActionSetup& setup) {
   return Action::OK;
 }
 
-// Action_Grid::DoAction()
-Action::RetType Action_Grid::DoAction(int frameNum, ActionFrame& frm) {
+/** Bin selected atoms, or centers of mass of selected residues/molecules. */
+template <class GRID> void Action_Grid::BinFrame(Frame const& frameIn, GRID& grid) {
   if (useMaskArray_) {
     Vec3 offset(0.0);
     if (GridMode() == BOX)
-      offset = frm.Frm().BoxCrd().Center();
+      offset = frameIn.BoxCrd().Center();
     else if (GridMode() == MASKCENTER)
-      offset = frm.Frm().VGeometricCenter( CenterMask() );
+      offset = frameIn.VGeometricCenter( CenterMask() );
     for (Cpptraj::MaskArray::const_iterator mask = mArray_.begin();
                                             mask != mArray_.end(); ++mask)
-      grid_->Increment( frm.Frm().VCenterOfMass(*mask) - offset, Increment() );
+      grid.Increment( frameIn.VCenterOfMass(*mask) - offset, Increment() );
   } else {
-    GridFrame( frm.Frm(), mask_, *grid_ );
+    GridFrame( frameIn, mask_, grid );
   }
+}
+
+// Action_Grid::DoAction()
+Action::RetType Action_Grid::DoAction(int frameNum, ActionFrame& frm) {
+  if (sparse_)
+    BinFrame( frm.Frm(), static_cast<DataSet_GridSparse&>( *grid_ ) );
+  else
+    BinFrame( frm.Frm(), static_cast<DataSet_GridFlt&>( *grid_ ) );
   ++nframes_;
   return Action::OK;
 }
 
-// Action_Grid::print()
-void Action_Grid::Print() {
-  if (nframes_ < 1) return;
+/** Perform normalization or smoothing. For sparse grids only voxels in
+  * allocated bricks are visited; empty voxels stay zero.
+  */
+template <class GRID> double Action_Grid::NormalizeGrid(GRID& grid) {
   // Perform normalization and find max.
   double gridMax = 0.0;
   if (normalize_ == NONE) {
     mprintf("    GRID: No normalization");
     if (smooth_ > 0.0) mprintf(", smoothing factor (%g)", smooth_);
     mprintf(".\n");
-    for (DataSet_GridFlt::iterator gval = grid_->begin(); gval != grid_->end(); ++gval) {
+    for (typename GRID::iterator gval = grid.begin(); gval != grid.end(); ++gval) {
       double gridval = (double)(*gval);
       // ----- SMOOTHING -----
       if (smooth_ > 0.0) {
@@ -194,20 +223,31 @@ void Action_Grid::Print() {
     mprintf("    GRID: Normalization");
     double dens = 1.0;
     if (normalize_ == TO_DENSITY) {
-      dens = grid_->Bin().VoxelVolume() * density_;
+      dens = grid.Bin().VoxelVolume() * density_;
       mprintf(" to density %g molecules/Ang^3, voxel volume= %g Ang^3, %g mols/voxel,",
-              density_, grid_->Bin().VoxelVolume(), dens);
+              density_, grid.Bin().VoxelVolume(), dens);
     } else
       mprintf(" to");
     mprintf(" number of frames %u", nframes_);
     double norm = 1.0 / ((double)nframes_ * dens);
     mprintf(", normalization factor= %g\n",norm);
-    for (DataSet_GridFlt::iterator gval = grid_->begin(); gval != grid_->end(); ++gval) {
+    for (typename GRID::iterator gval = grid.begin(); gval != grid.end(); ++gval) {
       double gridval = (double)(*gval) * norm;
       gridMax = std::max(gridval, gridMax);
       *gval = (float)gridval;
     }
   }
+  return gridMax;
+}
+
+// Action_Grid::print()
+void Action_Grid::Print() {
+  if (nframes_ < 1) return;
+  double gridMax;
+  if (sparse_)
+    gridMax = NormalizeGrid( static_cast<DataSet_GridSparse&>( *grid_ ) );
+  else
+    gridMax = NormalizeGrid( static_cast<DataSet_GridFlt&>( *grid_ ) );
   mprintf("\tGrid max is %g\n", gridMax);
   // PDBfile output
   PrintPDB( gridMax );
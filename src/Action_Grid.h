@@ -2,6 +2,7 @@
 #define INC_ACTION_GRID_H
 #include "Action.h"
 #include "DataSet_GridFlt.h"
+#include "DataSet_GridSparse.h"
 #include "GridAction.h"
 #include "MaskArray.h"
 class Action_Grid : public Action, private GridAction {
@@ -16,6 +17,10 @@ class Action_Grid : public Action, private GridAction {
     void Print();
 
     void PrintPDB(double);
+    /// Bin current frame into grid.
+    template <class GRID> void BinFrame(Frame const&, GRID&);
+    /// Normalize/smooth grid; \return grid max.
+    template <class GRID> double NormalizeGrid(GRID&);
 
     enum NormType { NONE=0, TO_FRAME, TO_DENSITY };
     NormType normalize_;
@@ -30,6 +35,7 @@ class Action_Grid : public Action, private GridAction {
     Cpptraj::MaskArray mArray_; ///< For by residue/molecule selection
     bool useMaskArray_;         ///< True if using mask array
     CpptrajFile* pdbfile_;
-    DataSet_GridFlt* grid_;
+    DataSet_3D* grid_;          ///< DataSet_GridFlt, or DataSet_GridSparse if sparse_
+    bool sparse_;               ///< True if grid only allocated where atoms are binned
 };
 #endif
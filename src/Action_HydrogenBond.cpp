@@ -521,6 +521,19 @@ Action::RetType Action_HydrogenBond::Setup(ActionSetup& setup) {
       }
     }
     mprintf("\t%u solvent hydrogens, %u ions.\n", hcount, icount);
+    // Solute site index for each atom, used to find solute sites near
+    // solvent sites via neighbor grid.
+    soluteSite_.assign( setup.Top().Natom(), -1 );
+    allSites_.clear();
+    int nsites = (int)Both_.size();
+    for (int sidx = 0; sidx != nsites; sidx++) {
+      soluteSite_[ Both_[sidx].Idx() ] = sidx;
+      allSites_.push_back( sidx );
+    }
+    for (unsigned int aidx = 0; aidx != Acceptor_.size(); aidx++) {
+      soluteSite_[ Acceptor_[aidx] ] = nsites + (int)aidx;
+      allSites_.push_back( nsites + (int)aidx );
+    }
   }
 
   mprintf("\tEstimated max potential memory usage: %s\n",
@@ -834,9 +847,15 @@ Action::RetType Action_HydrogenBond::DoAction(int frameNum, ActionFrame& frm) {
     numHB = 0;
     int vidx;
     int vidxend = (int)SolventSites_.size();
+    // Use the shared neighbor grid to find solute sites near each solvent
+    // site when it results in fewer distance calculations.
+    double dcut = sqrt(dcut2_);
+    NeighborGrid const& grid = frm.Neighbors( dcut );
+    bool useGrid = ( grid.AvgCandidates( dcut ) < (double)allSites_.size() );
+    Iarray nbrs, sites;
 #   ifdef _OPENMP
     // Use numHB to track thread. Will be actually counted after the parallel section.
-#   pragma omp parallel private(vidx, numHB)
+#   pragma omp parallel private(vidx, numHB, nbrs, sites)
     {
     numHB = omp_get_thread_num();
 #   pragma omp for
@@ -845,36 +864,49 @@ Action::RetType Action_HydrogenBond::DoAction(int frameNum, ActionFrame& frm) {
     {
       Site const& Vsite = SolventSites_[vidx];
       const double* VXYZ = frm.Frm().XYZ( Vsite.Idx() );
-      // Loop over solute sites that can be both donor and acceptor
-      for (unsigned int sidx = 0; sidx < bothEnd_; sidx++)
-      {
-        const double* UXYZ = frm.Frm().XYZ( Both_[sidx].Idx() );
-        double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
-        if ( !(dist2 > dcut2_) )
-        {
-          // Solvent site donor, solute site acceptor
-          CalcSolvHbonds(frameNum, dist2, Vsite, VXYZ, Both_[sidx].Idx(), UXYZ, frm.Frm(), numHB, false);
-          // Solvent site acceptor, solute site donor
-          CalcSolvHbonds(frameNum, dist2, Both_[sidx], UXYZ, Vsite.Idx(), VXYZ, frm.Frm(), numHB, true);
-        }
-      }
-      // Loop over solute sites that are donor only
-      for (unsigned int sidx = bothEnd_; sidx < Both_.size(); sidx++)
-      {
-        const double* UXYZ = frm.Frm().XYZ( Both_[sidx].Idx() );
-        double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
-        if ( !(dist2 > dcut2_) )
-          // Solvent site acceptor, solute site donor
-          CalcSolvHbonds(frameNum, dist2, Both_[sidx], UXYZ, Vsite.Idx(), VXYZ, frm.Frm(), numHB, true);
+      // Get solute sites near this solvent site in the same order as Both_
+      // then Acceptor_ so that hydrogen bonds are found in the same order
+      // as when looping over all solute sites.
+      if (useGrid) {
+        grid.GetCandidates( VXYZ, dcut, nbrs );
+        sites.clear();
+        for (Iarray::const_iterator at = nbrs.begin(); at != nbrs.end(); ++at)
+          if (soluteSite_[*at] > -1)
+            sites.push_back( soluteSite_[*at] );
+        std::sort( sites.begin(), sites.end() );
       }
-      // Loop over solute sites that are acceptor only
-      for (Iarray::const_iterator a_atom = Acceptor_.begin(); a_atom != Acceptor_.end(); ++a_atom)
+      Iarray const& Usites = (useGrid) ? sites : allSites_;
+      for (Iarray::const_iterator sidx = Usites.begin(); sidx != Usites.end(); ++sidx)
       {
-        const double* UXYZ = frm.Frm().XYZ( *a_atom );
-        double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
-        if ( !(dist2 > dcut2_) )
-          // Solvent site donor, solute site acceptor
-          CalcSolvHbonds(frameNum, dist2, Vsite, VXYZ, *a_atom, UXYZ, frm.Frm(), numHB, false);
+        if (*sidx < (int)bothEnd_) {
+          // Solute site that can be both donor and acceptor
+          Site const& Usite = Both_[*sidx];
+          const double* UXYZ = frm.Frm().XYZ( Usite.Idx() );
+          double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
+          if ( !(dist2 > dcut2_) )
+          {
+            // Solvent site donor, solute site acceptor
+            CalcSolvHbonds(frameNum, dist2, Vsite, VXYZ, Usite.Idx(), UXYZ, frm.Frm(), numHB, false);
+            // Solvent site acceptor, solute site donor
+            CalcSolvHbonds(frameNum, dist2, Usite, UXYZ, Vsite.Idx(), VXYZ, frm.Frm(), numHB, true);
+          }
+        } else if (*sidx < (int)Both_.size()) {
+          // Solute site that is donor only
+          Site const& Usite = Both_[*sidx];
+          const double* UXYZ = frm.Frm().XYZ( Usite.Idx() );
+          double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
+          if ( !(dist2 > dcut2_) )
+            // Solvent site acceptor, solute site donor
+            CalcSolvHbonds(frameNum, dist2, Usite, UXYZ, Vsite.Idx(), VXYZ, frm.Frm(), numHB, true);
+        } else {
+          // Solute site that is acceptor only
+          int a_atom = Acceptor_[*sidx - (int)Both_.size()];
+          const double* UXYZ = frm.Frm().XYZ( a_atom );
+          double dist2 = DIST2( VXYZ, UXYZ, Image_.ImageType(), frm.Frm().BoxCrd(), ucell_, recip_ );
+          if ( !(dist2 > dcut2_) )
+            // Solvent site donor, solute site acceptor
+            CalcSolvHbonds(frameNum, dist2, Vsite, VXYZ, a_atom, UXYZ, frm.Frm(), numHB, false);
+        }
       }
     } // END loop over solvent sites
 #   ifdef _OPENMP
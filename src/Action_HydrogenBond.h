@@ -57,6 +57,8 @@ class Action_HydrogenBond : public Action {
     Sarray Both_;         ///< Array of donor sites that can also be acceptors
     Iarray Acceptor_;     ///< Array of acceptor-only atom indices
     Sarray SolventSites_; ///< Array of solvent donor/acceptor sites
+    Iarray soluteSite_;   ///< Solute site index for each atom: Both_ index, then Acceptor_ index + Both_ size; -1 if none.
+    Iarray allSites_;     ///< All solute site indices in order, for when neighbor grid is not used.
 
     UUmapType UU_Map_;        ///< Map solute donorH/acceptor pair to UU hbond
     UVmapType UV_Map_;        ///< Map solute donorH or solute acceptor to UV hbond
@@ -13,6 +13,7 @@ class Action_InfraredSpectrum : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY; }
 
     typedef DataSet_Vector VelArray;
     VelArray* Vel_;         ///< Hold velocity*charge for selected atoms at each frame.
@@ -14,6 +14,7 @@ class Action_LESsplit : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
 
     bool lesAverage_;           ///< If true, create LES average
     bool lesSplit_;             ///< If true, split LES frames
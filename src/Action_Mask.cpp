@@ -114,13 +114,14 @@ Action::RetType Action_Mask::Init(ArgList& actionArgs, ActionInit& init, int deb
 Action::RetType Action_Mask::Setup(ActionSetup& setup) {
   CurrentParm_ = setup.TopAddress();
   cInfo_ = setup.CoordInfo();
+  maskCache_.Clear();
   return Action::OK;
 }
 
 // Action_Mask::DoAction()
 Action::RetType Action_Mask::DoAction(int frameNum, ActionFrame& frm) {
   // Get atom selection
-  if ( CurrentParm_->SetupCharMask(Mask1_, frm.Frm()) ) {
+  if ( CurrentParm_->SetupCharMask(Mask1_, frm.Frm(), maskCache_) ) {
     mprintf("Warning: Could not set up atom mask [%s]\n",
             Mask1_.MaskString());
     return Action::ERR;
@@ -23,6 +23,7 @@ class Action_Mask: public Action {
     void Print() {}
 
     CharMask Mask1_;         ///< Atoms which will be selected each frame
+    MaskSelectionCache maskCache_; ///< Selection state reused between frames
     CpptrajFile* outfile_;   ///< File to write selected atom info to
     DataSet* fnum_;          ///< Hold frame numbers for selections
     DataSet* anum_;          ///< Hold selected atom numbers
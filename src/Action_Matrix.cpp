@@ -1,4 +1,5 @@
 #include <cmath> // sqrt
+#include <algorithm> // std::min
 #include "Action_Matrix.h"
 #include "CpptrajStdio.h"
 #include "DistRoutines.h"
@@ -13,6 +14,9 @@ Action_Matrix::Action_Matrix() :
   outtype_(BYATOM),
   debug_(0),
   order_(2),
+  blockSize_(32),
+  nBuffered_(0),
+  bufStride_(0),
   useMask2_(false),
   useMass_(false)
 {}
@@ -23,7 +27,7 @@ void Action_Matrix::Help() const {
           "\t[ ired [order <#>] ]\n"
           "\t[ {distcovar | idea} <mask1> ]\n"
           "\t[ {dist | correl | covar | mwcovar} <mask1> [<mask2>] ]\n"
-          "\t[ dihcovar dihedrals <dataset arg> ]\n"
+          "\t[ dihcovar dihedrals <dataset arg> ] [blocksize <#frames>]\n"
           "  Calculate a matrix of the specified type from input coordinates.\n"
           "    dist: Distance matrix (default).\n"
           "    correl: Correlation matrix (aka dynamic cross correlation).\n"
@@ -32,7 +36,9 @@ void Action_Matrix::Help() const {
           "    distcovar: Distance covariance matrix.\n"
           "    idea: Isotropically Distributed Ensemble Analysis matrix.\n"
           "    ired: Isotropic Reorientational Eigenmode Dynamics matrix.\n"
-          "    dihcovar: Dihedral covariance matrix.\n");
+          "    dihcovar: Dihedral covariance matrix.\n"
+          "  For correl, covar, mwcovar, and distcovar, the matrix is updated every\n"
+          "  <#frames> frames (default 32); 'blocksize 1' updates every frame.\n");
 }
 
 // Action_Matrix::Init()
@@ -85,6 +91,11 @@ Action::RetType Action_Matrix::Init(ArgList& actionArgs, ActionInit& init, int d
   std::string name = actionArgs.GetStringKey("name");
   // UseMass
   useMass_ = actionArgs.hasKey("mass");
+  blockSize_ = actionArgs.getKeyInt("blocksize", 32);
+  if (blockSize_ < 1) {
+    mprinterr("Error: matrix: blocksize must be > 0.\n");
+    return Action::ERR;
+  }
   // NOTE: Determine matrix kind here so subsequent Actions/Analyses know about it.
   DataSet_2D::MatrixKindType mkind = DataSet_2D::HALF;
   if (mtype == MetaData::IREDMAT) { // IRED matrix
@@ -191,6 +202,8 @@ Action::RetType Action_Matrix::Init(ArgList& actionArgs, ActionInit& init, int d
   if (byMaskOut_ != 0)
     mprintf("\tAveraged by mask output to %s\n", byMaskOut_->Filename().full());
   mprintf("\tMatrix data set is '%s'\n", Mat_->legend());
+  if (UsesFrameBuffer())
+    mprintf("\tMatrix will be updated every %i frames.\n", blockSize_);
   if (matByRes_ != 0)
     mprintf("\tAveraged by residue matrix data set is '%s'\n", matByRes_->legend());
   FrameCounterInfo();
@@ -256,6 +269,8 @@ Action_Matrix::MatResArray Action_Matrix::MaskToMatResArray(Topology const& curr
 Action::RetType Action_Matrix::Setup(ActionSetup& setup) {
   size_t mask1tot = 0; // Will be # of columns
   size_t mask2tot = 0; // Will be # of rows if not symmetric matrix
+  // Frames buffered with the previous topology still need to be added.
+  FlushFrameBuffer();
 
   // Set up masks.
   if (Mat_->Meta().ScalarType() == MetaData::IREDMAT) {
@@ -368,6 +383,19 @@ Action::RetType Action_Matrix::Setup(ActionSetup& setup) {
       return Action::ERR;
     }
   }
+  // Allocate frame buffer. For CORREL each frame contributes X, Y, and Z
+  // values to the dot product for each atom.
+  if (UsesFrameBuffer()) {
+    size_t nelements = vectsize;
+    int rowsPerFrame = 1;
+    if (Mat_->Meta().ScalarType() == MetaData::CORREL) {
+      nelements = mask1tot + mask2tot;
+      rowsPerFrame = 3;
+    }
+    bufStride_ = blockSize_ * rowsPerFrame;
+    frameBuf_.assign( nelements * bufStride_, 0.0 );
+    nBuffered_ = 0;
+  }
 # ifdef _OPENMP
   if (
        ( Mat_->Meta().ScalarType() == MetaData::COVAR ||
@@ -795,6 +823,136 @@ void Action_Matrix::CalcDistanceCovarianceMatrix(Frame const& currentFrame) {
   }
 }
 
+// -----------------------------------------------------------------------------
+/** \return true if matrix elements are accumulated from blocks of frames. */
+bool Action_Matrix::UsesFrameBuffer() const {
+  if (blockSize_ < 2) return false;
+  MetaData::scalarType mtype = Mat_->Meta().ScalarType();
+  return (mtype == MetaData::COVAR || mtype == MetaData::MWCOVAR ||
+          mtype == MetaData::CORREL || mtype == MetaData::DISTCOVAR);
+}
+
+/** Store the values that make up matrix elements for the current frame in
+  * the frame buffer; the average (and average squared) vectors are updated
+  * right away. Each element (coordinate, atom, or distance) has bufStride_
+  * consecutive values in the buffer, one per frame (3 per frame for CORREL,
+  * X Y and Z), so that matrix element ij is updated with the dot product
+  * of the values of elements i and j.
+  */
+void Action_Matrix::BufferFrame(Frame const& currentFrame) {
+  v_iterator v1 = Mat_->v1begin();
+  v_iterator v2 = vect2_.begin();
+  switch (Mat_->Meta().ScalarType()) {
+    case MetaData::COVAR    :
+    case MetaData::MWCOVAR  : {
+      double* buf = &frameBuf_[0] + nBuffered_;
+      int nmasks = (useMask2_) ? 2 : 1;
+      for (int im = 0; im != nmasks; im++) {
+        AtomMask const& mask = (im == 0) ? mask1_ : mask2_;
+        for (AtomMask::const_iterator atom = mask.begin(); atom != mask.end(); ++atom) {
+          const double* XYZ = currentFrame.XYZ( *atom );
+          StoreVec(v1, v2, XYZ);
+          buf[0]              = XYZ[0];
+          buf[bufStride_]     = XYZ[1];
+          buf[2 * bufStride_] = XYZ[2];
+          buf += 3 * bufStride_;
+        }
+      }
+      break;
+    }
+    case MetaData::CORREL   : {
+      double* buf = &frameBuf_[0] + 3 * nBuffered_;
+      int nmasks = (useMask2_) ? 2 : 1;
+      for (int im = 0; im != nmasks; im++) {
+        AtomMask const& mask = (im == 0) ? mask1_ : mask2_;
+        for (AtomMask::const_iterator atom = mask.begin(); atom != mask.end(); ++atom) {
+          const double* XYZ = currentFrame.XYZ( *atom );
+          StoreVec(v1, v2, XYZ);
+          buf[0] = XYZ[0];
+          buf[1] = XYZ[1];
+          buf[2] = XYZ[2];
+          buf += bufStride_;
+        }
+      }
+      break;
+    }
+    case MetaData::DISTCOVAR: {
+      double* buf = &frameBuf_[0] + nBuffered_;
+      AtomMask::const_iterator mask1end = mask1_.end() - 1;
+      for (AtomMask::const_iterator atom1 = mask1_.begin(); atom1 != mask1end; ++atom1)
+        for (AtomMask::const_iterator atom2 = atom1 + 1; atom2 != mask1_.end(); ++atom2) {
+          double dist = sqrt(DIST2_NoImage(currentFrame.XYZ(*atom1), currentFrame.XYZ(*atom2)));
+          *(v1++) += dist;
+          *buf = dist;
+          buf += bufStride_;
+        }
+      break;
+    }
+    default: return; // Sanity check
+  }
+  if (++nBuffered_ == blockSize_)
+    FlushFrameBuffer();
+}
+
+/// \return Dot product of the first n values of two buffered elements.
+static inline double BufferDot(const double* vi, const double* vj, int n) {
+  double sum = 0.0;
+  for (int k = 0; k != n; k++)
+    sum += vi[k] * vj[k];
+  return sum;
+}
+
+/** Add contributions of all buffered frames to the matrix at once, i.e. a
+  * rank-N update with N the number of buffered frames (times 3 for CORREL).
+  * Compared to updating the matrix every frame this reads and writes each
+  * matrix element once per block instead of once per frame. Elements are
+  * processed in tiles so that the buffer values of a tile of columns stay
+  * in cache while the rows of a tile are updated.
+  */
+void Action_Matrix::FlushFrameBuffer() {
+  if (nBuffered_ < 1) return;
+  static const int TILE = 64;
+  int nvals = nBuffered_ * (bufStride_ / blockSize_);
+  int ncols = (int)Mat_->Ncols();
+  bool isHalf = (Mat_->MatrixKind() == DataSet_2D::HALF);
+  // For FULL matrix, row elements follow the column (mask1) elements in buffer.
+  int nrows = (isHalf) ? ncols : (int)Mat_->Nrows();
+  size_t rowOffset = (isHalf) ? 0 : (size_t)ncols;
+  int nRowTiles = (nrows + TILE - 1) / TILE;
+  int nColTiles = (ncols + TILE - 1) / TILE;
+  const double* buf = &frameBuf_[0];
+  double* matrix = &((*Mat_)[0]);
+  int rt, ct, row, col, colBeg, colEnd;
+  size_t midx;
+  const double* vi;
+# ifdef _OPENMP
+# pragma omp parallel private(rt, ct, row, col, colBeg, colEnd, midx, vi)
+  {
+# pragma omp for schedule(dynamic)
+# endif
+  for (rt = 0; rt < nRowTiles; rt++) {
+    int rowEnd = std::min(nrows, (rt + 1) * TILE);
+    for (ct = (isHalf) ? rt : 0; ct < nColTiles; ct++) {
+      for (row = rt * TILE; row < rowEnd; row++) {
+        colBeg = ct * TILE;
+        if (isHalf && colBeg < row) colBeg = row;
+        colEnd = std::min(ncols, (ct + 1) * TILE);
+        if (isHalf) // Row starts at diagonal
+          midx = (size_t)row * ncols - ((size_t)row * (row - 1)) / 2 + (colBeg - row);
+        else
+          midx = (size_t)row * ncols + colBeg;
+        vi = buf + (rowOffset + row) * bufStride_;
+        for (col = colBeg; col < colEnd; col++, midx++)
+          matrix[midx] += BufferDot(vi, buf + (size_t)col * bufStride_, nvals);
+      }
+    }
+  }
+# ifdef _OPENMP
+  } // END pragma omp parallel
+# endif
+  nBuffered_ = 0;
+}
+
 // Action_Matrix::DoAction()
 Action::RetType Action_Matrix::DoAction(int frameNum, ActionFrame& frm) {
   // Check if this frame should be processed
@@ -802,6 +960,11 @@ Action::RetType Action_Matrix::DoAction(int frameNum, ActionFrame& frm) {
   // Increment number of snapshots
   Mat_->IncrementSnapshots();
 
+  if (UsesFrameBuffer()) {
+    BufferFrame(frm.Frm());
+    return Action::OK;
+  }
+
   switch (Mat_->Meta().ScalarType()) {
     case MetaData::DIST     : CalcDistanceMatrix(frm.Frm()); break;
     case MetaData::COVAR    :
@@ -819,6 +982,7 @@ Action::RetType Action_Matrix::DoAction(int frameNum, ActionFrame& frm) {
 
 #ifdef MPI
 int Action_Matrix::SyncAction() {
+  FlushFrameBuffer();
   if (!vect2_.empty()) {
     if (trajComm_.Master()) {
       Darray buf( vect2_.size() );
@@ -978,6 +1142,7 @@ double Action_Matrix::ByMaskAverage(unsigned int ColMax, unsigned int RowMax) co
 
 // Action_Matrix::Print()
 void Action_Matrix::Print() {
+  FlushFrameBuffer();
   if (debug_ > 1) {
     mprintf("Raw Matrix Elements:\n");
     for (unsigned int i = 0; i < Mat_->Size(); i++)
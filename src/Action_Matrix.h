@@ -44,6 +44,11 @@ class Action_Matrix : public Action, ActionFrameCounter {
     Darray mass2_; ///< Atom masses corresponding to mask2_.
 
     Darray vect2_; ///< Hold diagonal elements squared.
+    // COVAR, MWCOVAR, CORREL, and DISTCOVAR only
+    Darray frameBuf_;  ///< Buffered frame values, element-major (bufStride_ values per element).
+    int blockSize_;    ///< Number of frames to buffer before updating matrix.
+    int nBuffered_;    ///< Number of frames currently in frameBuf_.
+    int bufStride_;    ///< Values per element in frameBuf_; blockSize_ * rows per frame.
 #   ifdef _OPENMP
     /// For OPENMP only, save coord indices (X-Y) for speed 
     std::vector<int> crd_indices_;
@@ -72,6 +77,9 @@ class Action_Matrix : public Action, ActionFrameCounter {
     void CalcIdeaMatrix(Frame const&);
     void CalcCorrelationMatrix(Frame const&);
     void CalcDistanceCovarianceMatrix(Frame const&);
+    bool UsesFrameBuffer() const;
+    void BufferFrame(Frame const&);
+    void FlushFrameBuffer();
     void Vect2MinusVect();
     void FinishCovariance(size_t);
     inline void DotProdAndNorm(DataSet_MatrixDbl::iterator&, v_iterator&,
@@ -15,6 +15,7 @@ class Action_Outtraj: public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
 #   ifdef MPI
     int SyncAction();
     Parallel::Comm trajComm_;
@@ -1,11 +1,12 @@
 // Action_Pairwise
 #include <cmath> //sqrt
-#include <algorithm> // max, min
+#include <algorithm> // max, min, sort
 #include "Action_Pairwise.h"
 #include "CpptrajStdio.h"
 #include "Trajout_Single.h"
 #include "Constants.h" // ELECTOAMBER
 #include "StringRoutines.h" // ByteString()
+#include "DistRoutines.h" // DIST2_NoImage()
 
 // CONSTRUCTOR
 Action_Pairwise::Action_Pairwise() :
@@ -29,7 +30,8 @@ Action_Pairwise::Action_Pairwise() :
 
 void Action_Pairwise::Help() const {
   mprintf("\t[<name>] [<mask>] [out <filename>] [cuteelec <ecut>] [cutevdw <vcut>]\n"
-          "\t[ %s ] [cutout <cut mol2 prefix>]\n", DataSetList::RefArgs);
+          "\t[ %s ] [cutout <cut mol2 prefix>]\n"
+          "\t%s\n", DataSetList::RefArgs, NonbondCutoff::Keywords());
   mprintf("\t[vmapout <vdw map>] [emapout <elec map>] [avgout <avg file>]\n"
           "\t[eout <eout file>] [pdbout <pdb file> [scalepdbe]] [printmode {only|or|and}]\n"
           "  Calculate pairwise (non-bonded) energy for atoms in <mask>.\n"
@@ -39,7 +41,10 @@ void Action_Pairwise::Help() const {
           "  <vcut> (by default 1.0 kcal/mol) will be printed.\n"
           "  printmode only : Only print energy cutoff is satisfied.\n"
           "            or   : Print both energies if either cutoff is satisfied.\n"
-          "            and  : Print both energies if both cutoffs are satisfied.\n");
+          "            and  : Print both energies if both cutoffs are satisfied.\n"
+          "  If 'cut' is specified only non-imaged pairs within <rc> are calculated;\n"
+          "  energies may be shifted to zero at <rc> or switched to zero between <ron>\n"
+          "  and <rc>. Cannot be used with a reference.\n");
 }
 
 const double Action_Pairwise::QFAC = Constants::ELECTOAMBER * Constants::ELECTOAMBER;
@@ -78,6 +83,7 @@ Action::RetType Action_Pairwise::Init(ArgList& actionArgs, ActionInit& init, int
       return Action::ERR;
     }
   }
+  if (nbcut_.GetArgs( actionArgs )) return Action::ERR;
   ReferenceFrame REF = init.DSL().GetReferenceFrame( actionArgs );
   
   // Get Masks
@@ -110,6 +116,10 @@ Action::RetType Action_Pairwise::Init(ArgList& actionArgs, ActionInit& init, int
   // Get reference structure
   if (REF.error()) return Action::ERR;
   if (!REF.empty()) { 
+    if (nbcut_.Active()) {
+      mprinterr("Error: 'cut' cannot be used with a reference structure.\n");
+      return Action::ERR;
+    }
     // Set up reference mask
     if ( REF.Parm().SetupIntegerMask(RefMask_) ) return Action::ERR;
     if (RefMask_.None()) {
@@ -157,6 +167,7 @@ Action::RetType Action_Pairwise::Init(ArgList& actionArgs, ActionInit& init, int
     mprintf("\tBoth energy components will be printed if either satisfy cutoffs.\n");
   else if (printMode_ == AND_CUT)
     mprintf("\tBoth energy components will be printed if both satisfy cutoffs.\n");
+  nbcut_.PrintInfo();
   mprintf("\tEelec print absolute cutoff (kcal/mol): %.4f\n", cut_eelec_);
   mprintf("\tEvdw print absolute cutoff (kcal/mol) : %.4f\n", cut_evdw_);
   if (!mol2Prefix_.empty())
@@ -273,6 +284,12 @@ Action::RetType Action_Pairwise::Setup(ActionSetup& setup) {
   atom_eelec_.resize(Mask0_.Nselected(), 0.0);
   atom_evdw_.clear();
   atom_evdw_.resize(Mask0_.Nselected(), 0.0);
+  // Set up atom to mask index map for cutoff
+  if (nbcut_.Active()) {
+    maskIdx_.assign( setup.Top().Natom(), -1 );
+    for (int idx = 0; idx != Mask0_.Nselected(); idx++)
+      maskIdx_[Mask0_[idx]] = idx;
+  }
   // Print pairwise info for this parm
   Mask0_.MaskInfo();
   CurrentParm_ = setup.TopAddress();
@@ -297,6 +314,26 @@ void Action_Pairwise::WriteEnergies(Topology const& parmIn, int atom1, int atom2
   }
 }
 
+// Action_Pairwise::AddPairEnergy()
+/** Write pair energy if needed, add to matrices, and divide it evenly
+  * between both atoms in the cumulative arrays.
+  */
+void Action_Pairwise::AddPairEnergy(Topology const& parmIn, int idx1, int idx2,
+                                    int atom1, int atom2, double evdw, double eelec,
+                                    const char* etype)
+{
+  if (Eout_ != 0)
+    WriteEnergies(parmIn, atom1, atom2, evdw, eelec, etype);
+  vdwMat_->Element(idx1, idx2) += evdw;
+  eleMat_->Element(idx1, idx2) += eelec;
+  double delta2 = evdw * 0.5;
+  atom_evdw_[idx1] += delta2;
+  atom_evdw_[idx2] += delta2;
+  delta2 = eelec * 0.5;
+  atom_eelec_[idx1] += delta2;
+  atom_eelec_[idx2] += delta2;
+}
+
 // Action_Pairwise::NonbondEnergy()
 /** Calculate non-bonded energy using the nonbondParm array. The total
   * LJ (vdw) energy is put in ELJ, and the total Coulomb (elec) energy
@@ -309,7 +346,6 @@ void Action_Pairwise::WriteEnergies(Topology const& parmIn, int atom1, int atom2
 void Action_Pairwise::NonbondEnergy(Frame const& frameIn, Topology const& parmIn, 
                                     AtomMask const& maskIn)
 {
-  double delta2;
   NonbondEnergyType refE;
 
   ELJ_ = 0.0;
@@ -370,32 +406,11 @@ void Action_Pairwise::NonbondEnergy(Frame const& frameIn, Topology const& parmIn
           // dEelec
           double delta_eelec = refpair->eelec - e_elec;
           // Output
-          if (Eout_ != 0)
-            WriteEnergies(parmIn, maskatom1, maskatom2, delta_vdw, delta_eelec, "d");
-          vdwMat_->Element(idx1, idx2) += delta_vdw;
-          eleMat_->Element(idx1, idx2) += delta_eelec;
-          // Divide the total pair dEvdw between both atoms.
-          delta2 = delta_vdw * 0.5;
-          atom_evdw_[idx1] += delta2;
-          atom_evdw_[idx2] += delta2;
-          // Divide the total pair dEelec between both atoms.
-          delta2 = delta_eelec * 0.5;
-          atom_eelec_[idx1] += delta2;
-          atom_eelec_[idx2] += delta2;
+          AddPairEnergy(parmIn, idx1, idx2, maskatom1, maskatom2,
+                        delta_vdw, delta_eelec, "d");
         } else if (nb_calcType_ == NORMAL) {
           // 2 - No reference, just cumulative Energy on atoms
-          if (Eout_ != 0)
-            WriteEnergies(parmIn, maskatom1, maskatom2, e_vdw, e_elec, "");
-          vdwMat_->Element(idx1, idx2) += e_vdw;
-          eleMat_->Element(idx1, idx2) += e_elec;
-          // Cumulative evdw - divide between both atoms
-          delta2 = e_vdw * 0.5;
-          atom_evdw_[idx1] += delta2;
-          atom_evdw_[idx2] += delta2;
-          // Cumulative eelec - divide between both atoms
-          delta2 = e_elec * 0.5;
-          atom_eelec_[idx1] += delta2;
-          atom_eelec_[idx2] += delta2;
+          AddPairEnergy(parmIn, idx1, idx2, maskatom1, maskatom2, e_vdw, e_elec, "");
         } else { // if nb_calcType_ == SET_REF
           // 3 - Store the reference nonbond energy for this pair
           refE.evdw = e_vdw;
@@ -409,6 +424,61 @@ void Action_Pairwise::NonbondEnergy(Frame const& frameIn, Topology const& parmIn
   } // END Outer loop
 }
 
+// Action_Pairwise::NonbondEnergyCut()
+/** Calculate non-bonded energy for pairs within the cutoff, found with a
+  * cell list of the selected atoms. Pairs are visited in the same order
+  * as in NonbondEnergy() so that output is ordered the same way.
+  */
+void Action_Pairwise::NonbondEnergyCut(Frame const& frameIn, Topology const& parmIn,
+                                       AtomMask const& maskIn)
+{
+  ELJ_ = 0.0;
+  Eelec_ = 0.0;
+  double cut = nbcut_.Cut();
+  double cut2 = nbcut_.Cut2();
+  grid_.Setup( frameIn.xAddress(), maskIn.Selected(), cut );
+  Iarray nbrs;
+  for (int idx1 = 0; idx1 != maskIn.Nselected(); idx1++)
+  {
+    int maskatom1 = maskIn[idx1];
+    const double* crd1 = frameIn.XYZ( maskatom1 );
+    // Get mask indices of candidates after this atom, in order.
+    grid_.GetCandidates( crd1, cut, nbrs );
+    unsigned int nkeep = 0;
+    for (unsigned int n = 0; n != nbrs.size(); n++) {
+      int idx2 = maskIdx_[nbrs[n]];
+      if (idx2 > idx1)
+        nbrs[nkeep++] = idx2;
+    }
+    nbrs.resize( nkeep );
+    std::sort( nbrs.begin(), nbrs.end() );
+    // Set up exclusion list for this atom
+    Atom::excluded_iterator excluded_atom = parmIn[maskatom1].excludedbegin();
+    for (Iarray::const_iterator it = nbrs.begin(); it != nbrs.end(); ++it)
+    {
+      int idx2 = *it;
+      int maskatom2 = maskIn[idx2];
+      // Advance excluded list up to current selected atom
+      while (excluded_atom != parmIn[maskatom1].excludedend() && *excluded_atom < maskatom2)
+        ++excluded_atom;
+      if ( excluded_atom != parmIn[maskatom1].excludedend() && maskatom2 == *excluded_atom )
+        ++excluded_atom;
+      else {
+        double rij2 = DIST2_NoImage( crd1, frameIn.XYZ( maskatom2 ) );
+        if (rij2 < cut2) {
+          NonbondType const& LJ = parmIn.GetLJparam(maskatom1, maskatom2);
+          double e_vdw = nbcut_.Evdw( LJ.A(), LJ.B(), rij2 );
+          ELJ_ += e_vdw;
+          double qiqj = QFAC * parmIn[maskatom1].Charge() * parmIn[maskatom2].Charge();
+          double e_elec = nbcut_.Eelec( qiqj, sqrt(rij2), rij2 );
+          Eelec_ += e_elec;
+          AddPairEnergy(parmIn, idx1, idx2, maskatom1, maskatom2, e_vdw, e_elec, "");
+        }
+      }
+    }
+  }
+}
+
 // Action_Pairwise::WriteCutFrame()
 /** Write file containing only cut atoms and energies as charges. */
 int Action_Pairwise::WriteCutFrame(int frameNum, Topology const& Parm, AtomMask const& CutMask, 
@@ -490,7 +560,10 @@ Action::RetType Action_Pairwise::DoAction(int frameNum, ActionFrame& frm) {
   atom_eelec_.assign(Mask0_.Nselected(), 0.0);
   atom_evdw_.assign(Mask0_.Nselected(), 0.0);
   if (Eout_ != 0) Eout_->Printf("PAIRWISE: Frame %i\n",frm.TrajoutNum());
-  NonbondEnergy( frm.Frm(), *CurrentParm_, Mask0_ );
+  if (nbcut_.Active())
+    NonbondEnergyCut( frm.Frm(), *CurrentParm_, Mask0_ );
+  else
+    NonbondEnergy( frm.Frm(), *CurrentParm_, Mask0_ );
   nframes_++;
   // Write cumulative energy arrays
   if (PrintCutAtoms( frm.Frm(), frm.TrajoutNum(), VDWOUT, atom_evdw_, cut_evdw_ ))
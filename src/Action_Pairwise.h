@@ -3,6 +3,8 @@
 #include "Action.h"
 #include "PDBfile.h"
 #include "DataSet_MatrixDbl.h"
+#include "NonbondCutoff.h"
+#include "NeighborGrid.h"
 // Class: Pairwise 
 /// Action to calculate nonbonded energy between pairs of atoms.
 /** Functions in two ways:
@@ -11,6 +13,8 @@
   * - Calculate the Lennard-Jones and Coulomb energy between each
   *   pair of atoms in a reference structure. Calculate the difference
   *   in each pair from frame to reference (d = Ref - Frame). 
+  * Without a reference, energies may be calculated only for pairs
+  * within a cutoff.
   */
 class Action_Pairwise: public Action {
   public:
@@ -34,6 +38,7 @@ class Action_Pairwise: public Action {
     };
     typedef std::vector<NonbondEnergyType> Narray;
     typedef std::vector<double> Darray;
+    typedef std::vector<int> Iarray;
 
     /// Count number of pairwise interactions that will actually be calcd.
     static int SetupNonbondParm(AtomMask const&, Topology const&);
@@ -41,6 +46,10 @@ class Action_Pairwise: public Action {
     inline void WriteEnergies(Topology const&, int, int, double, double, const char*);
     /// Calculate nonbond energy using nonbondParm for given frame
     void NonbondEnergy(Frame const&, Topology const&, AtomMask const&);
+    /// Calculate nonbond energy for pairs within cutoff for given frame
+    void NonbondEnergyCut(Frame const&, Topology const&, AtomMask const&);
+    /// Add energy of pair to matrices and atoms, write to Eout
+    inline void AddPairEnergy(Topology const&, int, int, int, int, double, double, const char*);
     /// Write mol2 file with atoms satisfying cutoff
     int WriteCutFrame(int, Topology const&, AtomMask const&, Darray const&, 
                       Frame const&, std::string const&);
@@ -71,5 +80,8 @@ class Action_Pairwise: public Action {
     CpptrajFile* Eout_;        ///< Output file for atom energies.
     static const double QFAC;  ///< Convert charges to kcal/mol units
     bool scalePdbE_;           ///< If true scale PDB energy each frame between 0 and 100
+    NonbondCutoff nbcut_;      ///< Nonbond cutoff
+    NeighborGrid grid_;        ///< Cell list for finding pairs within cutoff
+    Iarray maskIdx_;           ///< Index into Mask0_ for each atom, -1 if not selected
 };
 #endif  
@@ -1,4 +1,5 @@
 #include <cmath> // sqrt
+#include <algorithm> // std::min, std::fill
 #include "Action_Projection.h"
 #include "CpptrajStdio.h"
 #include "StringRoutines.h" // integerToString
@@ -8,13 +9,19 @@
 Action_Projection::Action_Projection() :
   modinfo_(0),
   beg_(0),
-  end_(0)
+  end_(0),
+  batch_(1),
+  nbuf_(0)
 {}
 
 void Action_Projection::Help() const {
   mprintf("\t[<name>] evecs <evecs dataset> [out <outfile>] [beg <beg>] [end <end>]\n"
-          "\t[<mask>] [dihedrals <dataset arg>]\n\t%s\n"
-          "  Calculate projection along given eigenvectors.\n", ActionFrameCounter::HelpText);
+          "\t[<mask>] [dihedrals <dataset arg>] [batch <#frames>]\n\t%s\n"
+          "  Calculate projection along given eigenvectors.\n"
+          "  For COVAR/MWCOVAR, 'batch' frames are projected onto all modes at once.\n"
+          "  Projection data sets are then only filled every <#frames> frames, so\n"
+          "  'batch' should not be used if subsequent actions need the projection\n"
+          "  of the current frame (e.g. 'filter').\n", ActionFrameCounter::HelpText);
 }
 
 // Action_Projection::Init()
@@ -24,6 +31,11 @@ Action::RetType Action_Projection::Init(ArgList& actionArgs, ActionInit& init, i
   // NOTE: Must get 'end' before InitFrameCounter since the latter checks for 'end'
   beg_ = actionArgs.getKeyInt("beg", 1) - 1;
   end_ = actionArgs.getKeyInt("end", 2);
+  batch_ = actionArgs.getKeyInt("batch", 1);
+  if (batch_ < 1) {
+    mprinterr("Error: 'batch' must be > 0\n");
+    return Action::ERR;
+  }
   if (InitFrameCounter(actionArgs)) return Action::ERR;
 
   std::string modesname = actionArgs.GetStringKey("modes"); // For backwards compat.
@@ -130,6 +142,16 @@ Action::RetType Action_Projection::Init(ArgList& actionArgs, ActionInit& init, i
     mprintf("\t%zu dihedral data sets.\n", DihedralSets_.size());
   else
     mprintf("\tAtom Mask: [%s]\n", mask_.MaskString());
+  if ( modinfo_->Meta().ScalarType() == MetaData::COVAR ||
+       modinfo_->Meta().ScalarType() == MetaData::MWCOVAR )
+  {
+    if (batch_ > 1)
+      mprintf("\tProjecting %i frames at a time.\n", batch_);
+    nbuf_ = 0;
+    dxBuf_.assign( (size_t)batch_ * modinfo_->NavgCrd(), 0.0 );
+    frameNums_.assign( batch_, 0 );
+    projBuf_.assign( (size_t)batch_ * (end_ - beg_), 0.0 );
+  }
 
   return Action::OK;
 }
@@ -194,22 +216,21 @@ Action::RetType Action_Projection::DoAction(int frameNum, ActionFrame& frm) {
   if ( modinfo_->Meta().ScalarType() == MetaData::COVAR || 
        modinfo_->Meta().ScalarType() == MetaData::MWCOVAR ) 
   {
-    for (int mode = beg_; mode < end_; ++mode) {
-      DataSet_Modes::AvgIt Avg = modinfo_->AvgBegin();
-      double proj = 0;
-      std::vector<double>::const_iterator sqrtmass = sqrtmasses_.begin();
-      for (AtomMask::const_iterator atom = mask_.begin(); atom != mask_.end(); ++atom)
-      {
-        const double* XYZ = frm.Frm().XYZ( *atom );
-        double mass = *(sqrtmass++);
-        proj += (XYZ[0] - *(Avg++)) * mass * Vec[0]; 
-        proj += (XYZ[1] - *(Avg++)) * mass * Vec[1]; 
-        proj += (XYZ[2] - *(Avg++)) * mass * Vec[2]; 
-        Vec += 3;
-      }
-      float fproj = (float)proj;
-      project_[mode]->Add( frameNum, &fproj );
+    // Store mass-weighted deviation from average; projected in FlushProjections()
+    double* dx = &dxBuf_[0] + (size_t)nbuf_ * modinfo_->NavgCrd();
+    DataSet_Modes::AvgIt Avg = modinfo_->AvgBegin();
+    std::vector<double>::const_iterator sqrtmass = sqrtmasses_.begin();
+    for (AtomMask::const_iterator atom = mask_.begin(); atom != mask_.end(); ++atom)
+    {
+      const double* XYZ = frm.Frm().XYZ( *atom );
+      double mass = *(sqrtmass++);
+      *(dx++) = (XYZ[0] - *(Avg++)) * mass;
+      *(dx++) = (XYZ[1] - *(Avg++)) * mass;
+      *(dx++) = (XYZ[2] - *(Avg++)) * mass;
     }
+    frameNums_[nbuf_] = frameNum;
+    if (++nbuf_ == batch_)
+      FlushProjections();
   } else if (modinfo_->Meta().ScalarType() == MetaData::DIHCOVAR ) {
     for (int mode = beg_; mode < end_; ++mode) {
       DataSet_Modes::AvgIt Avg = modinfo_->AvgBegin();
@@ -224,7 +245,7 @@ Action::RetType Action_Projection::DoAction(int frameNum, ActionFrame& frm) {
       }
       // TODO: Convert to degrees?
       float fproj = (float)proj;
-      project_[mode]->Add( frameNum, &fproj );
+      project_[mode - beg_]->Add( frameNum, &fproj );
     }
   } else { // if modinfo_.ScalarType() == IDEA
     int ip = 0;
@@ -252,3 +273,53 @@ Action::RetType Action_Projection::DoAction(int frameNum, ActionFrame& frm) {
   }
   return Action::OK;
 }
+
+/** Project all buffered frames onto modes beg_ to end_-1, i.e. the matrix
+  * product of buffered deviations (frames x coords) and eigenvectors
+  * (coords x modes). Coordinates are processed in tiles so that a tile of
+  * an eigenvector stays in cache while it is applied to all buffered frames.
+  * Within each projection terms are summed in coordinate order.
+  */
+void Action_Projection::FlushProjections() {
+  if (nbuf_ < 1) return;
+  static const int TILE = 512;
+  int ncoords = modinfo_->NavgCrd();
+  int nmodes = end_ - beg_;
+  const double* Evecs = modinfo_->Eigenvector(beg_);
+  std::fill( projBuf_.begin(), projBuf_.end(), 0.0 );
+  int mode;
+# ifdef _OPENMP
+# pragma omp parallel for private(mode) if (nmodes > 1)
+# endif
+  for (mode = 0; mode < nmodes; mode++) {
+    const double* Vec = Evecs + (size_t)mode * modinfo_->VectorSize();
+    for (int k0 = 0; k0 < ncoords; k0 += TILE) {
+      int k1 = std::min(ncoords, k0 + TILE);
+      for (int ib = 0; ib < nbuf_; ib++) {
+        const double* dx = &dxBuf_[0] + (size_t)ib * ncoords;
+        double proj = projBuf_[(size_t)ib * nmodes + mode];
+        for (int k = k0; k < k1; k++)
+          proj += dx[k] * Vec[k];
+        projBuf_[(size_t)ib * nmodes + mode] = proj;
+      }
+    }
+  }
+  for (int ib = 0; ib < nbuf_; ib++)
+    for (mode = 0; mode < nmodes; mode++) {
+      float fproj = (float)projBuf_[(size_t)ib * nmodes + mode];
+      project_[mode]->Add( frameNums_[ib], &fproj );
+    }
+  nbuf_ = 0;
+}
+
+#ifdef MPI
+int Action_Projection::SyncAction() {
+  // Buffered projections must be in data sets before they are synced.
+  FlushProjections();
+  return 0;
+}
+#endif
+
+void Action_Projection::Print() {
+  FlushProjections();
+}
@@ -14,7 +14,12 @@ class Action_Projection : public Action, ActionFrameCounter {
     Action::RetType Init(ArgList&, ActionInit&, int);
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
-    void Print() {}
+#   ifdef MPI
+    int SyncAction();
+#   endif
+    void Print();
+
+    void FlushProjections();
 
     typedef std::vector<DataSet*> Darray;
     Darray project_;
@@ -24,5 +29,11 @@ class Action_Projection : public Action, ActionFrameCounter {
     std::vector<double> sqrtmasses_;
     AtomMask mask_;
     Array1D DihedralSets_;
+    // COVAR/MWCOVAR only
+    int batch_;                  ///< Number of frames to project at once.
+    int nbuf_;                   ///< Number of frames currently buffered.
+    std::vector<double> dxBuf_;  ///< Mass-weighted deviations from average for buffered frames.
+    std::vector<int> frameNums_; ///< Frame numbers of buffered frames.
+    std::vector<double> projBuf_; ///< Projections of buffered frames, frame-major.
 };
 #endif
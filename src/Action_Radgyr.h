@@ -11,6 +11,9 @@ class Action_Radgyr: public Action {
     Action::RetType Init(ArgList&, ActionInit&, int);
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
+#   ifdef _OPENMP
+    bool FrameThreadsOK() const { return true; }
+#   endif
     void Print() {}
 
     DataSet* rog_;
@@ -16,6 +16,7 @@ Action_Radial::Action_Radial() :
   intramol_distances_(0),
   useVolume_(false),
   volume_(0),
+  maximum_(0),
   maximum2_(0),
   spacing_(-1),
   one_over_spacing_(-1),
@@ -112,6 +113,7 @@ Action::RetType Action_Radial::Init(ArgList& actionArgs, ActionInit& init, int d
   }
   // Store max^2, distances^2 greater than max^2 do not need to be
   // binned and therefore do not need a sqrt calc.
+  maximum_ = maximum;
   maximum2_ = maximum * maximum;
 
   // Get First Mask
@@ -374,6 +376,10 @@ Action::RetType Action_Radial::Setup(ActionSetup& setup) {
     mprinterr("Internal Error: Action_Radial: No mode set!\n");
     return Action::ERR;
   }
+  // Flag inner mask atoms; needed when searching for neighbors via grid.
+  isInner_.assign( setup.Top().Natom(), false );
+  for (AtomMask::const_iterator atom = InnerMask_.begin(); atom != InnerMask_.end(); ++atom)
+    isInner_[*atom] = true;
   // If ignoring intra-molecular distances, need to count how many we
   // are ignoring.
   if (rmode_ == NO_INTRAMOL) {
@@ -437,12 +443,18 @@ Action::RetType Action_Radial::DoAction(int frameNum, ActionFrame& frm) {
     if (useVolume_)  volume_ += D;
   }
   // ---------------------------------------------
-  if ( rmode_ == NORMAL ) { 
-    // Calculation of all atoms in Mask1 to all atoms in Mask2
+  if ( rmode_ == NORMAL || rmode_ == NO_INTRAMOL ) {
+    // Calculation of all atoms in Mask1 to all atoms in Mask2, optionally
+    // ignoring intra-molecular distances. Use the shared neighbor grid to
+    // find atoms in Mask2 near each atom in Mask1 when it results in fewer
+    // distance calculations than looping over every atom in Mask2.
+    NeighborGrid const& grid = frm.Neighbors( maximum_ );
+    bool useGrid = ( grid.AvgCandidates( maximum_ ) < (double)InnerMask_.Nselected() );
+    bool noIntramol = (rmode_ == NO_INTRAMOL);
+    std::vector<int> nbrs;
     int outer_max = OuterMask_.Nselected();
-    int inner_max = InnerMask_.Nselected();
 #   ifdef _OPENMP
-#   pragma omp parallel private(nmask1,nmask2,atom1,atom2,D,idx,mythread)
+#   pragma omp parallel private(nmask1,atom1,atom2,D,idx,mythread,nbrs)
     {
     //mprintf("OPENMP: %i threads\n",omp_get_num_threads());
     mythread = omp_get_thread_num();
@@ -450,61 +462,27 @@ Action::RetType Action_Radial::DoAction(int frameNum, ActionFrame& frm) {
 #   endif
     for (nmask1 = 0; nmask1 < outer_max; nmask1++) {
       atom1 = OuterMask_[nmask1];
-      for (nmask2 = 0; nmask2 < inner_max; nmask2++) {
-        atom2 = InnerMask_[nmask2];
-        if (atom1 != atom2) {
-          D = DIST2( frm.Frm().XYZ(atom1), frm.Frm().XYZ(atom2),
-                     image_.ImageType(), frm.Frm().BoxCrd(), ucell, recip);
-          if (D <= maximum2_) {
-            // NOTE: Can we modify the histogram to store D^2?
-            D = sqrt(D);
-            //mprintf("MASKLOOP: %10i %10i %10.4f\n",atom1,atom2,D);
-            idx = (int) (D * one_over_spacing_);
-            if (idx > -1 && idx < numBins_)
-#             ifdef _OPENMP
-              ++rdf_thread_[mythread][idx];
-#             else
-              ++RDF_[idx];
-#             endif
-          }
-        }
-      } // END loop over 2nd mask
-    } // END loop over 1st mask
-#   ifdef _OPENMP
-    } // END pragma omp parallel
-#   endif
-  // ---------------------------------------------
-  } else if ( rmode_ == NO_INTRAMOL ) {
-    // Calculation of all atoms in Mask1 to all atoms in Mask2, ignoring
-    // intra-molecular distances.
-    int outer_max = OuterMask_.Nselected();
-    int inner_max = InnerMask_.Nselected();
-#   ifdef _OPENMP
-#   pragma omp parallel private(nmask1,nmask2,atom1,atom2,D,idx,mythread)
-    {
-    //mprintf("OPENMP: %i threads\n",omp_get_num_threads());
-    mythread = omp_get_thread_num();
-#   pragma omp for
-#   endif
-    for (nmask1 = 0; nmask1 < outer_max; nmask1++) {
-      atom1 = OuterMask_[nmask1];
-      for (nmask2 = 0; nmask2 < inner_max; nmask2++) {
-        atom2 = InnerMask_[nmask2];
-        if ( (*currentParm_)[atom1].MolNum() != (*currentParm_)[atom2].MolNum() ) {
-          D = DIST2( frm.Frm().XYZ(atom1), frm.Frm().XYZ(atom2),
-                     image_.ImageType(), frm.Frm().BoxCrd(), ucell, recip);
-          if (D <= maximum2_) {
-            // NOTE: Can we modify the histogram to store D^2?
-            D = sqrt(D);
-            //mprintf("MASKLOOP: %10i %10i %10.4f\n",atom1,atom2,D);
-            idx = (int) (D * one_over_spacing_);
-            if (idx > -1 && idx < numBins_)
-#             ifdef _OPENMP
-              ++rdf_thread_[mythread][idx];
-#             else
-              ++RDF_[idx];
-#             endif
-          }
+      if (useGrid)
+        grid.GetCandidates( frm.Frm().XYZ(atom1), maximum_, nbrs );
+      std::vector<int> const& atoms2 = (useGrid) ? nbrs : InnerMask_.Selected();
+      for (std::vector<int>::const_iterator it = atoms2.begin(); it != atoms2.end(); ++it) {
+        atom2 = *it;
+        if (atom1 == atom2 || !isInner_[atom2]) continue;
+        if (noIntramol && (*currentParm_)[atom1].MolNum() == (*currentParm_)[atom2].MolNum())
+          continue;
+        D = DIST2( frm.Frm().XYZ(atom1), frm.Frm().XYZ(atom2),
+                   image_.ImageType(), frm.Frm().BoxCrd(), ucell, recip);
+        if (D <= maximum2_) {
+          // NOTE: Can we modify the histogram to store D^2?
+          D = sqrt(D);
+          //mprintf("MASKLOOP: %10i %10i %10.4f\n",atom1,atom2,D);
+          idx = (int) (D * one_over_spacing_);
+          if (idx > -1 && idx < numBins_)
+#           ifdef _OPENMP
+            ++rdf_thread_[mythread][idx];
+#           else
+            ++RDF_[idx];
+#           endif
         }
       } // END loop over 2nd mask
     } // END loop over 1st mask
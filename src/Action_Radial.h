@@ -28,6 +28,7 @@ class Action_Radial: public Action {
     AtomMask Mask2_;          ///< Optional mask to calc RDF to atoms in Mask1.
     AtomMask OuterMask_;      ///< Mask with the most atoms.
     AtomMask InnerMask_;      ///< Mask with the fewest atoms.
+    std::vector<bool> isInner_; ///< True for each atom selected by InnerMask_.
     typedef std::vector<AtomMask> Marray;
     Marray Sites1_;
     Marray Sites2_;
@@ -40,6 +41,7 @@ class Action_Radial: public Action {
     int intramol_distances_;  ///< # of intra-molecular distances for NO_INTERMOL.
     bool useVolume_;          ///< If true normalize based on input volume.
     double volume_;           ///< Hold sum of volume for averaging.
+    double maximum_;          ///< Largest distance that can be binned.
     double maximum2_;         ///< Largest distance squared that can be binned.
     double spacing_;          ///< Bin spacing.
     double one_over_spacing_; ///< 1/spacing, used to avoid man division ops.
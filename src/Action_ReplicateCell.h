@@ -15,6 +15,7 @@ class Action_ReplicateCell: public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::ALL_COMPONENTS; }
 
     ImagedAction image_;       ///< Imaging routines
     Matrix_3x3 ucell_, recip_; ///< Matrices for imaging
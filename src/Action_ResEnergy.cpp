@@ -0,0 +1,374 @@
+#include <cmath> // sqrt, cos
+#include <algorithm> // sort, lower_bound
+#include "Action_ResEnergy.h"
+#include "CpptrajStdio.h"
+#include "Constants.h" // ELECTOAMBER
+#include "DistRoutines.h"
+#include "TorsionRoutines.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+const double Action_ResEnergy::QFAC = Constants::ELECTOAMBER * Constants::ELECTOAMBER;
+
+/** Corresponds to TermType */
+static const char* TermStr[] = { "vdw", "elec", "bonded", "total" };
+
+// CONSTRUCTOR
+Action_ResEnergy::Action_ResEnergy() :
+  currentParm_(0),
+  nframes_(0),
+  numthreads_(1),
+  doBonded_(true)
+{
+  std::fill(avg_, avg_+NTERMS, (DataSet_MatrixDbl*)0);
+  std::fill(sd_, sd_+NTERMS, (DataSet_MatrixDbl*)0);
+}
+
+void Action_ResEnergy::Help() const {
+  mprintf("\t[<name>] [<mask>] [out <file>] [nobonded]\n"
+          "\t%s\n", NonbondCutoff::Keywords());
+  mprintf("  Calculate the average and standard deviation of the van der Waals,\n"
+          "  electrostatic, bonded, and total energy between each pair of residues\n"
+          "  in <mask> (diagonal elements are intra-residue energies). Results are\n"
+          "  stored in matrices <name>[vdw], <name>[elec], <name>[bonded], and\n"
+          "  <name>[total]; standard deviations in <name>[<term>sd].\n"
+          "  Bonded energies are assigned to the residues of the end atoms of each\n"
+          "  bond, angle, and dihedral; 1-4 energies are added to the van der Waals\n"
+          "  and electrostatic terms. If 'nobonded' is specified bond, angle, and\n"
+          "  dihedral energies are skipped but 1-4 energies are still calculated.\n"
+          "  If 'cut' is specified only non-imaged pairs within <rc> are calculated.\n");
+}
+
+// Action_ResEnergy::Init()
+Action::RetType Action_ResEnergy::Init(ArgList& actionArgs, ActionInit& init, int debugIn)
+{
+# ifdef MPI
+  if (init.TrajComm().Size() > 1) {
+    mprinterr("Error: 'resenergy' action does not work with > 1 process (%i processes currently).\n",
+              init.TrajComm().Size());
+    return Action::ERR;
+  }
+# endif
+  DataFile* outfile = init.DFL().AddDataFile( actionArgs.GetStringKey("out"), actionArgs );
+  doBonded_ = !actionArgs.hasKey("nobonded");
+  if (nbcut_.GetArgs( actionArgs )) return Action::ERR;
+  if (mask_.SetMaskString( actionArgs.GetMaskNext() )) return Action::ERR;
+  std::string dsname = actionArgs.GetStringNext();
+  if (dsname.empty())
+    dsname = init.DSL().GenerateDefaultName("RESENE");
+  for (int t = 0; t != (int)NTERMS; t++) {
+    avg_[t] = (DataSet_MatrixDbl*)init.DSL().AddSet(DataSet::MATRIX_DBL,
+                                                    MetaData(dsname, TermStr[t]));
+    sd_[t]  = (DataSet_MatrixDbl*)init.DSL().AddSet(DataSet::MATRIX_DBL,
+                                                    MetaData(dsname, std::string(TermStr[t]) + "sd"));
+    if (avg_[t] == 0 || sd_[t] == 0) return Action::ERR;
+    avg_[t]->ModifyDim(Dimension::X).SetLabel("Res");
+    sd_[t]->ModifyDim(Dimension::X).SetLabel("Res");
+    if (outfile != 0) {
+      outfile->AddDataSet( avg_[t] );
+      outfile->AddDataSet( sd_[t] );
+    }
+  }
+  nframes_ = 0;
+  numthreads_ = 1;
+# ifdef _OPENMP
+# pragma omp parallel
+  {
+  if (omp_get_thread_num() == 0)
+    numthreads_ = omp_get_num_threads();
+  }
+# endif
+
+  mprintf("    RESENERGY: Residue pair energy decomposition for atoms in mask '%s'\n",
+          mask_.MaskString());
+  if (doBonded_)
+    mprintf("\tBonded terms will be calculated.\n");
+  else
+    mprintf("\tBonded terms will not be calculated; 1-4 terms will be.\n");
+  nbcut_.PrintInfo();
+  mprintf("\tAverage energy matrices: %s[<term>], std. dev. matrices: %s[<term>sd]\n",
+          dsname.c_str(), dsname.c_str());
+  if (outfile != 0)
+    mprintf("\tOutput to '%s'\n", outfile->DataFilename().full());
+  if (numthreads_ > 1)
+    mprintf("\tParallelizing calculation over residues with %i threads.\n", numthreads_);
+  return Action::OK;
+}
+
+// Action_ResEnergy::AddBterm()
+void Action_ResEnergy::AddBterm(Bterm const& term, int at1, int at2) {
+  int r1 = atomRes_[at1];
+  int r2 = atomRes_[at2];
+  bterms_[ std::min(r1, r2) ].push_back( term );
+}
+
+// Action_ResEnergy::AddBonds()
+void Action_ResEnergy::AddBonds(BondArray const& bonds) {
+  for (BondArray::const_iterator b = bonds.begin(); b != bonds.end(); ++b)
+    if (b->Idx() > -1 && atomRes_[b->A1()] > -1 && atomRes_[b->A2()] > -1)
+      AddBterm( Bterm(b->A1(), b->A2(), -1, -1, b->Idx(), B_BOND), b->A1(), b->A2() );
+}
+
+// Action_ResEnergy::AddAngles()
+void Action_ResEnergy::AddAngles(AngleArray const& angles) {
+  for (AngleArray::const_iterator a = angles.begin(); a != angles.end(); ++a)
+    if (a->Idx() > -1 && atomRes_[a->A1()] > -1 && atomRes_[a->A2()] > -1 &&
+        atomRes_[a->A3()] > -1)
+      AddBterm( Bterm(a->A1(), a->A2(), a->A3(), -1, a->Idx(), B_ANGLE), a->A1(), a->A3() );
+}
+
+// Action_ResEnergy::AddDihedrals()
+/** Only dihedrals with type NORMAL have a 1-4 interaction. If bonded terms
+  * are not being calculated only those dihedrals are needed.
+  */
+void Action_ResEnergy::AddDihedrals(DihedralArray const& dihedrals) {
+  for (DihedralArray::const_iterator d = dihedrals.begin(); d != dihedrals.end(); ++d)
+    if (d->Idx() > -1 && atomRes_[d->A1()] > -1 && atomRes_[d->A2()] > -1 &&
+        atomRes_[d->A3()] > -1 && atomRes_[d->A4()] > -1)
+    {
+      BondedKind kind = (d->Type() == DihedralType::NORMAL) ? B_DIHEDRAL14 : B_DIHEDRAL;
+      if (doBonded_ || kind == B_DIHEDRAL14)
+        AddBterm( Bterm(d->A1(), d->A2(), d->A3(), d->A4(), d->Idx(), kind), d->A1(), d->A4() );
+    }
+}
+
+// Action_ResEnergy::Setup()
+Action::RetType Action_ResEnergy::Setup(ActionSetup& setup) {
+  if (setup.Top().SetupIntegerMask( mask_ )) return Action::ERR;
+  mask_.MaskInfo();
+  if (mask_.None()) {
+    mprintf("Warning: Mask '%s' selects no atoms.\n", mask_.MaskString());
+    return Action::SKIP;
+  }
+  if (!setup.Top().Nonbond().HasNonbond()) {
+    mprinterr("Error: Topology '%s' does not have LJ parameters.\n", setup.Top().c_str());
+    return Action::ERR;
+  }
+  // Group selected atoms by residue.
+  maskBeg_.clear();
+  atomRes_.assign( setup.Top().Natom(), -1 );
+  int lastRes = -1;
+  for (int idx = 0; idx != mask_.Nselected(); idx++) {
+    int rnum = setup.Top()[ mask_[idx] ].ResNum();
+    if (rnum != lastRes) {
+      maskBeg_.push_back( idx );
+      lastRes = rnum;
+    }
+    atomRes_[ mask_[idx] ] = (int)maskBeg_.size() - 1;
+  }
+  int nres = (int)maskBeg_.size();
+  maskBeg_.push_back( mask_.Nselected() );
+  // Allocate/check matrices
+  if (rows_.empty()) {
+    for (int t = 0; t != (int)NTERMS; t++) {
+      avg_[t]->AllocateHalf( nres );
+      sd_[t]->AllocateHalf( nres );
+    }
+    rows_.resize( nres );
+  } else if (nres != (int)rows_.size()) {
+    mprinterr("Error: Number of selected residues (%i) != previous number (%zu).\n"
+              "Error:   This can occur when different #s of residues are selected in\n"
+              "Error:   different topology files.\n", nres, rows_.size());
+    return Action::ERR;
+  }
+  // Bonded terms. Dihedrals are always needed for 1-4 terms.
+  bterms_.clear();
+  bterms_.resize( nres );
+  if (doBonded_) {
+    AddBonds( setup.Top().Bonds() );
+    AddBonds( setup.Top().BondsH() );
+    AddAngles( setup.Top().Angles() );
+    AddAngles( setup.Top().AnglesH() );
+  }
+  AddDihedrals( setup.Top().Dihedrals() );
+  AddDihedrals( setup.Top().DihedralsH() );
+  unsigned int nbterms = 0;
+  for (std::vector<Barray>::const_iterator it = bterms_.begin(); it != bterms_.end(); ++it)
+    nbterms += it->size();
+  // Per-thread buffers
+  buffers_.resize( numthreads_ );
+  for (std::vector<RowBuffer>::iterator buf = buffers_.begin(); buf != buffers_.end(); ++buf)
+    buf->Setup( nres );
+  currentParm_ = setup.TopAddress();
+  if (doBonded_)
+    mprintf("\t%i residues selected, %u bonded terms.\n", nres, nbterms);
+  else
+    mprintf("\t%i residues selected, %u 1-4 terms.\n", nres, nbterms);
+  return Action::OK;
+}
+
+/** Assumes atom2 is not excluded from atom1 and within cutoff if cutoff is active. */
+void Action_ResEnergy::AddPair(int atom1, int atom2, double rij2, RowBuffer& buf) const {
+  Topology const& top = *currentParm_;
+  NonbondType const& LJ = top.GetLJparam(atom1, atom2);
+  double qiqj = QFAC * top[atom1].Charge() * top[atom2].Charge();
+  int r2 = atomRes_[atom2];
+  buf.Add( r2, VDW,  nbcut_.Evdw( LJ.A(), LJ.B(), rij2 ) );
+  buf.Add( r2, ELEC, nbcut_.Eelec( qiqj, sqrt(rij2), rij2 ) );
+}
+
+// Action_ResEnergy::AddBonded()
+void Action_ResEnergy::AddBonded(Bterm const& term, Frame const& frameIn, RowBuffer& buf) const
+{
+  Topology const& top = *currentParm_;
+  switch (term.Kind()) {
+    case B_BOND: {
+      BondParmType const& bp = top.BondParm()[ term.Pidx() ];
+      double r = sqrt( DIST2_NoImage( frameIn.XYZ(term.A1()), frameIn.XYZ(term.A2()) ) );
+      double rdiff = r - bp.Req();
+      buf.Add( std::max(atomRes_[term.A1()], atomRes_[term.A2()]), BONDED,
+               bp.Rk() * (rdiff * rdiff) );
+      break;
+    }
+    case B_ANGLE: {
+      AngleParmType const& ap = top.AngleParm()[ term.Pidx() ];
+      double theta = CalcAngle( frameIn.XYZ(term.A1()), frameIn.XYZ(term.A2()),
+                                frameIn.XYZ(term.A3()) );
+      double tdiff = theta - ap.Teq();
+      buf.Add( std::max(atomRes_[term.A1()], atomRes_[term.A3()]), BONDED,
+               ap.Tk() * (tdiff * tdiff) );
+      break;
+    }
+    case B_DIHEDRAL:
+    case B_DIHEDRAL14: {
+      DihedralParmType const& dp = top.DihedralParm()[ term.Pidx() ];
+      int r2 = std::max(atomRes_[term.A1()], atomRes_[term.A4()]);
+      if (doBonded_) {
+        double phi = Torsion( frameIn.XYZ(term.A1()), frameIn.XYZ(term.A2()),
+                              frameIn.XYZ(term.A3()), frameIn.XYZ(term.A4()) );
+        buf.Add( r2, BONDED, dp.Pk() * (1.0 + cos(dp.Pn() * phi - dp.Phase())) );
+      }
+      if (term.Kind() == B_DIHEDRAL14) {
+        double rij2 = DIST2_NoImage( frameIn.XYZ(term.A1()), frameIn.XYZ(term.A4()) );
+        NonbondType const& LJ = top.GetLJparam(term.A1(), term.A4());
+        double r2inv = 1.0 / rij2;
+        double r6    = r2inv * r2inv * r2inv;
+        buf.Add( r2, VDW, (LJ.A() * r6 * r6 - LJ.B() * r6) / dp.SCNB() );
+        double qiqj = QFAC * top[term.A1()].Charge() * top[term.A4()].Charge();
+        buf.Add( r2, ELEC, qiqj / sqrt(rij2) / dp.SCEE() );
+      }
+      break;
+    }
+  }
+}
+
+/** Calculate nonbonded energy between atoms of given residue and all
+  * selected atoms after them, plus the bonded terms assigned to the
+  * residue. Energies go into the row buffer by partner residue.
+  */
+void Action_ResEnergy::CalcResidue(int ridx, Frame const& frameIn, RowBuffer& buf) const
+{
+  Topology const& top = *currentParm_;
+  double cut = nbcut_.Cut();
+  double cut2 = nbcut_.Cut2();
+  for (int idx1 = maskBeg_[ridx]; idx1 != maskBeg_[ridx+1]; idx1++)
+  {
+    int atom1 = mask_[idx1];
+    const double* crd1 = frameIn.XYZ( atom1 );
+    Atom::excluded_iterator excluded_atom = top[atom1].excludedbegin();
+    Atom::excluded_iterator excluded_end  = top[atom1].excludedend();
+    if (nbcut_.Active()) {
+      // Candidates after this atom, in order, so the exclusion list can be merged.
+      Iarray& nbrs = buf.nbrs_;
+      grid_.GetCandidates( crd1, cut, nbrs );
+      unsigned int nkeep = 0;
+      for (unsigned int n = 0; n != nbrs.size(); n++)
+        if (nbrs[n] > atom1)
+          nbrs[nkeep++] = nbrs[n];
+      nbrs.resize( nkeep );
+      std::sort( nbrs.begin(), nbrs.end() );
+      for (Iarray::const_iterator at2 = nbrs.begin(); at2 != nbrs.end(); ++at2)
+      {
+        while (excluded_atom != excluded_end && *excluded_atom < *at2) ++excluded_atom;
+        if (excluded_atom != excluded_end && *at2 == *excluded_atom)
+          ++excluded_atom;
+        else {
+          double rij2 = DIST2_NoImage( crd1, frameIn.XYZ( *at2 ) );
+          if (rij2 < cut2)
+            AddPair( atom1, *at2, rij2, buf );
+        }
+      }
+    } else {
+      for (int idx2 = idx1 + 1; idx2 < mask_.Nselected(); idx2++)
+      {
+        int atom2 = mask_[idx2];
+        while (excluded_atom != excluded_end && *excluded_atom < atom2) ++excluded_atom;
+        if (excluded_atom != excluded_end && atom2 == *excluded_atom)
+          ++excluded_atom;
+        else
+          AddPair( atom1, atom2, DIST2_NoImage( crd1, frameIn.XYZ( atom2 ) ), buf );
+      }
+    }
+  }
+  for (Barray::const_iterator term = bterms_[ridx].begin(); term != bterms_[ridx].end(); ++term)
+    AddBonded( *term, frameIn, buf );
+}
+
+/** Each residue is only handled by one thread per frame, so its row can
+  * be updated without locking.
+  */
+void Action_ResEnergy::FlushRow(int ridx, RowBuffer& buf) {
+  Parray& row = rows_[ridx];
+  for (Iarray::const_iterator r2 = buf.Touched().begin(); r2 != buf.Touched().end(); ++r2)
+  {
+    ResPair key( *r2 );
+    Parray::iterator pair = std::lower_bound( row.begin(), row.end(), key );
+    if (pair == row.end() || pair->Res2() != *r2)
+      pair = row.insert( pair, key );
+    pair->Accumulate( buf.Ene( *r2 ) );
+    buf.Reset( *r2 );
+  }
+  buf.ClearTouched();
+}
+
+// Action_ResEnergy::DoAction()
+Action::RetType Action_ResEnergy::DoAction(int frameNum, ActionFrame& frm) {
+  Frame const& frameIn = frm.Frm();
+  if (nbcut_.Active())
+    grid_.Setup( frameIn.xAddress(), mask_.Selected(), nbcut_.Cut() );
+  int nres = (int)rows_.size();
+  int ridx;
+# ifdef _OPENMP
+# pragma omp parallel private(ridx)
+  {
+  RowBuffer& buf = buffers_[omp_get_thread_num()];
+# pragma omp for schedule(dynamic)
+# else
+  RowBuffer& buf = buffers_[0];
+# endif
+  for (ridx = 0; ridx < nres; ridx++) {
+    CalcResidue( ridx, frameIn, buf );
+    FlushRow( ridx, buf );
+  }
+# ifdef _OPENMP
+  } // END omp parallel
+# endif
+  nframes_++;
+  return Action::OK;
+}
+
+/** Residue pairs that did not interact in a frame count as zero energy
+  * for that frame; fold those zeros into the statistics, then fill the
+  * output matrices.
+  */
+void Action_ResEnergy::Print() {
+  if (nframes_ < 1) return;
+  size_t npairs = 0;
+  double nf = (double)nframes_;
+  for (int r1 = 0; r1 != (int)rows_.size(); r1++)
+  {
+    npairs += rows_[r1].size();
+    for (Parray::const_iterator pair = rows_[r1].begin(); pair != rows_[r1].end(); ++pair)
+    {
+      for (int t = 0; t != (int)NTERMS; t++) {
+        Stats<double> stat = pair->Term(t);
+        if (stat.nData() < nf)
+          stat.Combine( Stats<double>(nf - stat.nData(), 0.0, 0.0) );
+        avg_[t]->SetElement( r1, pair->Res2(), stat.mean() );
+        sd_[t]->SetElement( r1, pair->Res2(), sqrt(stat.variance()) );
+      }
+    }
+  }
+  mprintf("    RESENERGY: %zu interacting residue pairs over %i frames.\n", npairs, nframes_);
+}
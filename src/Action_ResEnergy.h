@@ -0,0 +1,148 @@
+#ifndef INC_ACTION_RESENERGY_H
+#define INC_ACTION_RESENERGY_H
+#include "Action.h"
+#include "OnlineVarT.h"
+#include "NonbondCutoff.h"
+#include "NeighborGrid.h"
+#include "DataSet_MatrixDbl.h"
+/// Decompose energy into contributions between pairs of residues.
+/** For each frame the van der Waals, electrostatic, and bonded energy
+  * between every pair of selected residues (and within each residue) is
+  * calculated, and the mean and variance of each over all frames is
+  * accumulated. Only residue pairs that actually interact are stored.
+  * Bonded terms are assigned to the residues of their end atoms (bond
+  * A1-A2, angle A1-A3, dihedral A1-A4); 1-4 nonbonded energies are added
+  * to the van der Waals and electrostatic terms of the dihedral end atoms.
+  */
+class Action_ResEnergy : public Action {
+  public:
+    Action_ResEnergy();
+    DispatchObject* Alloc() const { return (DispatchObject*)new Action_ResEnergy(); }
+    void Help() const;
+  private:
+    Action::RetType Init(ArgList&, ActionInit&, int);
+    Action::RetType Setup(ActionSetup&);
+    Action::RetType DoAction(int, ActionFrame&);
+    void Print();
+
+    /// Energy terms; also index into output data sets.
+    enum TermType { VDW = 0, ELEC, BONDED, TOTAL, NTERMS };
+    /// Type of bonded term
+    enum BondedKind { B_BOND = 0, B_ANGLE, B_DIHEDRAL, B_DIHEDRAL14 };
+    typedef std::vector<int> Iarray;
+    typedef std::vector<double> Darray;
+    class Bterm;
+    typedef std::vector<Bterm> Barray;
+    class ResPair;
+    typedef std::vector<ResPair> Parray;
+    class RowBuffer;
+
+    /// Add bonded terms with all atoms selected to bterms_
+    void AddBonds(BondArray const&);
+    void AddAngles(AngleArray const&);
+    void AddDihedrals(DihedralArray const&);
+    /// Add given term to the bonded terms of the lower of the two given residues.
+    void AddBterm(Bterm const&, int, int);
+    /// Calculate LJ and Coulomb energy between two atoms, add to row buffer.
+    inline void AddPair(int, int, double, RowBuffer&) const;
+    /// Calculate energy of a bonded term, add to row buffer.
+    void AddBonded(Bterm const&, Frame const&, RowBuffer&) const;
+    /// Calculate all energies between given residue and residues after it.
+    void CalcResidue(int, Frame const&, RowBuffer&) const;
+    /// Accumulate energies in row buffer into residue pair statistics.
+    void FlushRow(int, RowBuffer&);
+
+    static const double QFAC;      ///< Convert charges to kcal/mol units
+    AtomMask mask_;                ///< Selected atoms
+    Topology const* currentParm_;  ///< Current topology
+    NonbondCutoff nbcut_;          ///< Nonbond cutoff
+    NeighborGrid grid_;            ///< Cell list for finding pairs within cutoff
+    Iarray maskBeg_;               ///< Index into mask_ of first atom of each selected residue (+ end)
+    Iarray atomRes_;               ///< Selected residue index of each atom, -1 if not selected
+    std::vector<Barray> bterms_;   ///< Bonded terms for each selected residue
+    std::vector<Parray> rows_;     ///< Residue pair statistics for each selected residue, sorted
+    std::vector<RowBuffer> buffers_; ///< Energy buffer for each thread
+    DataSet_MatrixDbl* avg_[NTERMS]; ///< Average energy matrices
+    DataSet_MatrixDbl* sd_[NTERMS];  ///< Energy standard deviation matrices
+    int nframes_;                  ///< Number of frames energies calculated for
+    int numthreads_;               ///< Number of OpenMP threads
+    bool doBonded_;                ///< If true calculate bonded terms
+};
+// ----- Bterm -----------------------------------------------------------------
+/// Hold bonded term atom indices, parameter index, and type.
+class Action_ResEnergy::Bterm {
+  public:
+    Bterm() : a1_(-1), a2_(-1), a3_(-1), a4_(-1), pidx_(-1), kind_(B_BOND) {}
+    Bterm(int a1, int a2, int a3, int a4, int p, BondedKind k) :
+      a1_(a1), a2_(a2), a3_(a3), a4_(a4), pidx_(p), kind_(k) {}
+    int A1()          const { return a1_;   }
+    int A2()          const { return a2_;   }
+    int A3()          const { return a3_;   }
+    int A4()          const { return a4_;   }
+    int Pidx()        const { return pidx_; }
+    BondedKind Kind() const { return kind_; }
+  private:
+    int a1_, a2_, a3_, a4_;
+    int pidx_;        ///< Parameter index
+    BondedKind kind_;
+};
+// ----- ResPair ---------------------------------------------------------------
+/// Hold energy statistics between a residue and a second residue.
+class Action_ResEnergy::ResPair {
+  public:
+    ResPair() : res2_(-1) {}
+    ResPair(int r2) : res2_(r2) {}
+    /// Accumulate energies for one frame (VDW, ELEC, BONDED).
+    void Accumulate(const double* ene) {
+      stats_[VDW].accumulate( ene[VDW] );
+      stats_[ELEC].accumulate( ene[ELEC] );
+      stats_[BONDED].accumulate( ene[BONDED] );
+      stats_[TOTAL].accumulate( ene[VDW] + ene[ELEC] + ene[BONDED] );
+    }
+    /// \return Second residue index
+    int Res2() const { return res2_; }
+    /// \return Statistics for given term
+    Stats<double> const& Term(int t) const { return stats_[t]; }
+    bool operator<(ResPair const& rhs) const { return res2_ < rhs.res2_; }
+  private:
+    Stats<double> stats_[NTERMS];
+    int res2_;
+};
+// ----- RowBuffer -------------------------------------------------------------
+/// Hold energies between one residue and all other residues for the current frame.
+class Action_ResEnergy::RowBuffer {
+  public:
+    RowBuffer() {}
+    /// Allocate for given number of residues.
+    void Setup(int nres) {
+      ene_.assign( nres * 3, 0.0 );
+      touched_.clear();
+      isTouched_.assign( nres, false );
+    }
+    /// Add energy for given residue and term.
+    void Add(int r2, int term, double e) {
+      if (!isTouched_[r2]) {
+        isTouched_[r2] = true;
+        touched_.push_back( r2 );
+      }
+      ene_[3*r2 + term] += e;
+    }
+    /// \return Residues that have energy
+    Iarray const& Touched() const { return touched_; }
+    /// \return Pointer to energies for given residue.
+    double* Ene(int r2) { return &ene_[3*r2]; }
+    /// Reset energies for given residue
+    void Reset(int r2) {
+      ene_[3*r2] = ene_[3*r2+1] = ene_[3*r2+2] = 0.0;
+      isTouched_[r2] = false;
+    }
+    /// Clear list of residues that have energy
+    void ClearTouched() { touched_.clear(); }
+
+    Iarray nbrs_; ///< Hold neighbor grid candidates
+  private:
+    Darray ene_;
+    Iarray touched_;
+    std::vector<bool> isTouched_;
+};
+#endif
@@ -15,6 +15,9 @@ class Action_Rmsd: public Action {
     Action::RetType Init(ArgList&, ActionInit&, int);
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
+#   ifdef _OPENMP
+    bool FrameThreadsOK() const { return (!perres_ && REF_.FixedReference()); }
+#   endif
     void Print();
     /// Describe if and how coordinates should be modified.
     enum ModeType { ROT_AND_TRANS = 0, TRANS_ONLY, NONE };
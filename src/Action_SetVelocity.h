@@ -14,6 +14,7 @@ class Action_SetVelocity : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY; }
 
     enum ModeType { SET = 0, ZERO, MODIFY, SCALE };
 
@@ -13,6 +13,7 @@ class Action_Temperature : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print() {}
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY | CoordinateInfo::TEMPERATURE; }
 
     DataSet* Tdata_;
     bool getTempFromFrame_;
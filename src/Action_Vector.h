@@ -21,6 +21,7 @@ class Action_Vector : public Action {
     Action::RetType Setup(ActionSetup&);
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY | CoordinateInfo::FORCE; }
 
     static double solve_cubic_eq(double,double,double,double);
     static Vec3 leastSquaresPlane(int,const double*);
@@ -18,6 +18,7 @@ class Action_VelocityAutoCorr : public Action {
     Parallel::Comm trajComm_;
 #   endif
     void Print();
+    int ComponentsNeeded() const { return CoordinateInfo::VELOCITY; }
 
     typedef DataSet_Vector Varray;
     typedef std::vector<Varray> VelArray;
@@ -1,13 +1,7 @@
-#include <cmath> // pow, exp, sqrt
 #include <algorithm> // std::min, std::max
 #include "Action_Volmap.h"
-#include "Constants.h" // PI
 #include "CpptrajStdio.h"
-#ifdef _OPENMP
-# include <omp.h>
-#endif
 
-const double Action_Volmap::sqrt_8_pi_cubed = sqrt(8.0*Constants::PI*Constants::PI*Constants::PI);
 // CONSTRUCTOR
 Action_Volmap::Action_Volmap() :
   radiiType_(UNSPECIFIED),
@@ -21,6 +15,7 @@ Action_Volmap::Action_Volmap() :
   setupGridOnMask_(false),
   spheremode_(false),
   grid_(0),
+  sparse_(false),
   peakfile_(0),
   peakcut_(0.05),
   buffer_(3.0),
@@ -36,7 +31,9 @@ void Action_Volmap::Help() const {
           "  or by a rectangular prism enclosing a mask with <buffer> clearance\n"
           "  in every dimension. The density is calculated from the atoms in the\n"
           "  required <mask>. If a <buffer> is given, the grid is centered on the\n"
-          "  centermask if provided, or the required mask if not.\n");
+          "  centermask if provided, or the required mask if not.\n"
+          "  If 'sparse' is specified, grid memory is only allocated for regions\n"
+          "  near atoms.\n");
 }
 
 void Action_Volmap::RawHelp() const {
@@ -47,7 +44,7 @@ void Action_Volmap::RawHelp() const {
           "\t      centermask <mask> [buffer <buffer>] |\n"
           "\t      boxref <reference> }\n"
           "\t}\n"
-          "\t[radii {vdw | element}] [peakcut <cutoff>] [peakfile <xyzfile>]\n");
+          "\t[radii {vdw | element}] [peakcut <cutoff>] [peakfile <xyzfile>] [sparse]\n");
 }
 
 // Action_Volmap::Init()
@@ -60,6 +57,7 @@ Action::RetType Action_Volmap::Init(ArgList& actionArgs, ActionInit& init, int d
   peakcut_ = actionArgs.getKeyDouble("peakcut", 0.05);
   peakfile_ = init.DFL().AddCpptrajFile(actionArgs.GetStringKey("peakfile"), "Volmap Peaks");
   spheremode_ = actionArgs.hasKey("sphere");
+  sparse_ = actionArgs.hasKey("sparse");
   radscale_ = 1.0;
   stepfac_ = 4.1;
   if (spheremode_) {
@@ -154,7 +152,10 @@ Action::RetType Action_Volmap::Init(ArgList& actionArgs, ActionInit& init, int d
       return Action::ERR;
     }
     // Allocate grid dataset
-    grid_ = (DataSet_GridFlt*)init.DSL().AddSet(DataSet::GRID_FLT, setname, "VOLMAP");
+    if (sparse_)
+      grid_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_SPARSE, setname, "VOLMAP");
+    else
+      grid_ = (DataSet_3D*)init.DSL().AddSet(DataSet::GRID_FLT, setname, "VOLMAP");
     if (grid_ == 0) {
       mprinterr("Error: Could not create grid dataset '%s'\n", setname.c_str());
       return Action::ERR;
@@ -174,7 +175,11 @@ Action::RetType Action_Volmap::Init(ArgList& actionArgs, ActionInit& init, int d
     }
   } else {
     // Get existing grid dataset
-    grid_ = (DataSet_GridFlt*)init.DSL().FindSetOfType( setup_arg, DataSet::GRID_FLT );
+    grid_ = (DataSet_3D*)init.DSL().FindSetOfType( setup_arg, DataSet::GRID_FLT );
+    if (grid_ == 0) {
+      grid_ = (DataSet_3D*)init.DSL().FindSetOfType( setup_arg, DataSet::GRID_SPARSE );
+      sparse_ = (grid_ != 0);
+    }
     if (grid_ == 0) {
       mprinterr("Error: Could not find grid data set with name '%s'\n",
                 setup_arg.c_str());
@@ -211,21 +216,6 @@ Action::RetType Action_Volmap::Init(ArgList& actionArgs, ActionInit& init, int d
   total_volume_ = init.DSL().AddSet(DataSet::DOUBLE, MetaData(grid_->Meta().Name(), "totalvol"));
   if (total_volume_ == 0) return Action::ERR;
 
-# ifdef _OPENMP
-  // Always need to allocate temp grid space for each thread.
-  int numthreads = 0;
-# pragma omp parallel
-  {
-    if (omp_get_thread_num() == 0)
-      numthreads = omp_get_num_threads();
-  }
-  GRID_THREAD_.resize( numthreads );
-  // If not setting up grid via mask later, allocate temp space now.
-  if (!setupGridOnMask_)
-    for (Garray::iterator gt = GRID_THREAD_.begin(); gt != GRID_THREAD_.end(); ++gt)
-      gt->resize( grid_->NX(), grid_->NY(), grid_->NZ() );
-# endif
-
   // Info
   mprintf("    VOLMAP: Grid spacing will be %.2fx%.2fx%.2f Angstroms\n", dx_, dy_, dz_);
   if (setupGridOnMask_)
@@ -247,13 +237,16 @@ Action::RetType Action_Volmap::Init(ArgList& actionArgs, ActionInit& init, int d
   if (outfile != 0)
     mprintf("\tDensity will wrtten to '%s'\n", outfile->DataFilename().full());
   mprintf("\tGrid dataset name is '%s'\n", grid_->legend());
+  if (sparse_)
+    mprintf("\tGrid memory will only be allocated near atoms.\n");
   mprintf("\tTotal grid volume dataset name is '%s'\n", total_volume_->legend());
   if (peakfile_ != 0)
     mprintf("\tDensity peaks above %.3f will be printed to %s in XYZ-format\n",
             peakcut_, peakfile_->Filename().full());
 # ifdef _OPENMP
-  if (GRID_THREAD_.size() > 1)
-    mprintf("\tParallelizing calculation with %zu threads.\n", GRID_THREAD_.size());
+  if (binner_.Nthreads() > 1)
+    mprintf("\tParallelizing calculation with %i threads; each thread owns a slab of the grid.\n",
+            binner_.Nthreads());
 # endif
 
   return Action::OK;
@@ -374,10 +367,6 @@ Action::RetType Action_Volmap::DoAction(int frameNum, ActionFrame& frm) {
       if (grid_->Allocate_N_O_D( (xmax-xmin)/dx_, (ymax-ymin)/dy_, (zmax-zmin)/dz_,
                                  Vec3(xmin, ymin, zmin), Vec3(dx_, dy_, dz_) ))
         return Action::ERR;
-#     ifdef _OPENMP
-      for (Garray::iterator gt = GRID_THREAD_.begin(); gt != GRID_THREAD_.end(); ++gt)
-        gt->resize( grid_->NX(), grid_->NY(), grid_->NZ() );
-#     endif
       xmin_ = xmin;
       ymin_ = ymin;
       zmin_ = zmin;
@@ -385,68 +374,15 @@ Action::RetType Action_Volmap::DoAction(int frameNum, ActionFrame& frm) {
     }
   }
   // Now calculate the density for every point
-  // TODO: Convert everything to size_t?
-  int nX = (int)grid_->NX();
-  int nY = (int)grid_->NY();
-  int nZ = (int)grid_->NZ();
-  int maxidx = (int)Atoms_.size();
-  int midx, atom;
-# ifdef _OPENMP
-  int mythread;
-# pragma omp parallel private(midx, atom, mythread)
-  {
-  mythread = omp_get_thread_num();
-# pragma omp for
-# endif
-  for (midx = 0; midx < maxidx; midx++) {
-    double rhalf = (double)halfradii_[midx];
-      double rcut2;
-      if (spheremode_)
-        rcut2 = rhalf*rhalf;
-      else
-        rcut2 = 99999999.0;
-      atom = Atoms_[midx];
-      Vec3 pt = Vec3(frm.Frm().XYZ(atom));
-      int ix = (int) ( floor( (pt[0]-xmin_) / dx_ + 0.5 ) );
-      int iy = (int) ( floor( (pt[1]-ymin_) / dy_ + 0.5 ) );
-      int iz = (int) ( floor( (pt[2]-zmin_) / dz_ + 0.5 ) );
-      /* See how many steps in each dimension we smear out our Gaussian. This
-       * formula is taken to be consistent with VMD's volmap tool
-       */
-      int nxstep = (int) ceil(stepfac_ * rhalf / dx_);
-      int nystep = (int) ceil(stepfac_ * rhalf / dy_);
-      int nzstep = (int) ceil(stepfac_ * rhalf / dz_);
-      if (ix < -nxstep || ix > nX + nxstep ||
-          iy < -nystep || iy > nY + nystep ||
-          iz < -nzstep || iz > nZ + nzstep)
-        continue;
-      // Calculate the gaussian normalization factor (in 3 dimensions with the
-      // given half-radius)
-      double norm = 1 / (sqrt_8_pi_cubed * rhalf*rhalf*rhalf);
-      double exfac = -1.0 / (2.0 * rhalf * rhalf);
-      //mprintf("DBG: Atom %i norm %g exfac %g\n", atom+1, norm, exfac);
+  if (sparse_)
+    binner_.SplatGaussians( static_cast<DataSet_GridSparse&>( *grid_ ),
+                            Vec3(xmin_, ymin_, zmin_), Vec3(dx_, dy_, dz_),
+                            frm.Frm(), Atoms_, halfradii_, stepfac_, spheremode_ );
+  else
+    binner_.SplatGaussians( static_cast<DataSet_GridFlt&>( *grid_ ),
+                            Vec3(xmin_, ymin_, zmin_), Vec3(dx_, dy_, dz_),
+                            frm.Frm(), Atoms_, halfradii_, stepfac_, spheremode_ );
 
-      int xend = std::min(ix+nxstep, nX);
-      int yend = std::min(iy+nystep, nY);
-      int zend = std::min(iz+nzstep, nZ);
-      for (int xval = std::max(ix-nxstep, 0); xval < xend; xval++)
-        for (int yval = std::max(iy-nystep, 0); yval < yend; yval++)
-          for (int zval = std::max(iz-nzstep, 0); zval < zend; zval++) {
-            Vec3 gridpt = Vec3(xmin_+xval*dx_, ymin_+yval*dy_, zmin_+zval*dz_) - pt;
-            double dist2 = gridpt.Magnitude2();
-            if (dist2 < rcut2) {
-#           ifdef _OPENMP
-            GRID_THREAD_[mythread].incrementBy(xval, yval, zval, norm * exp(exfac * dist2));
-#           else
-            grid_->Increment(xval, yval, zval, norm * exp(exfac * dist2));
-#           endif
-            }
-          }
-  } // END loop over atoms in densitymask_
-# ifdef _OPENMP
-  } // END pragma omp parallel
-# endif
-  
   // Increment frame counter
   Nframes_++;
   return Action::OK;
@@ -454,9 +390,6 @@ Action::RetType Action_Volmap::DoAction(int frameNum, ActionFrame& frm) {
 
 #ifdef MPI
 int Action_Volmap::SyncAction() {
-# ifdef _OPENMP
-  CombineGridThreads();
-# endif
   int total_frames = 0;
   trajComm_.ReduceMaster( &total_frames, &Nframes_, 1, MPI_INT, MPI_SUM );
   if (trajComm_.Master())
@@ -465,18 +398,6 @@ int Action_Volmap::SyncAction() {
 }
 #endif
 
-#ifdef _OPENMP
-/** Combine results from each GRID_THREAD into main grid */
-void Action_Volmap::CombineGridThreads() {
-  if (!GRID_THREAD_.empty()) {
-    for (Garray::const_iterator gt = GRID_THREAD_.begin(); gt != GRID_THREAD_.end(); ++gt)
-      for (unsigned int idx = 0; idx != gt->size(); idx++)
-        (*grid_)[idx] += (*gt)[idx];
-    GRID_THREAD_.clear();
-  }
-}
-#endif
-
 // Need this instead of MAX since size_t can never be negative
 inline size_t setStart(size_t xIn) {
   if (xIn == 0)
@@ -485,24 +406,31 @@ inline size_t setStart(size_t xIn) {
     return xIn - 1L;
 }
 
-// Action_Volmap::Print()
-void Action_Volmap::Print() {
-  if (Nframes_ < 1) return;
-# ifdef _OPENMP
-  CombineGridThreads();
-# endif
-  // Divide our grid by the number of frames
+/** Divide grid by number of frames. \return Number of occupied voxels. */
+template <class GRID> unsigned int Action_Volmap::NormalizeGrid(GRID& grid) const {
   float nf = (float)Nframes_;
-  for (DataSet_GridFlt::iterator gval = grid_->begin(); gval != grid_->end(); ++gval)
+  for (typename GRID::iterator gval = grid.begin(); gval != grid.end(); ++gval)
     *gval /= nf;
-  // Print volume estimate
   unsigned int nOccupiedVoxels = 0;
-  for (DataSet_GridFlt::iterator gval = grid_->begin(); gval != grid_->end(); ++gval) {
+  for (typename GRID::iterator gval = grid.begin(); gval != grid.end(); ++gval) {
     if (*gval > 0.0) {
       ++nOccupiedVoxels;
       //mprintf("DBG: %16.8e\n", *gval);
     }
   }
+  return nOccupiedVoxels;
+}
+
+// Action_Volmap::Print()
+void Action_Volmap::Print() {
+  if (Nframes_ < 1) return;
+  // Divide our grid by the number of frames
+  unsigned int nOccupiedVoxels;
+  if (sparse_)
+    nOccupiedVoxels = NormalizeGrid( static_cast<DataSet_GridSparse&>( *grid_ ) );
+  else
+    nOccupiedVoxels = NormalizeGrid( static_cast<DataSet_GridFlt&>( *grid_ ) );
+  // Print volume estimate
   double volume_estimate = (double)nOccupiedVoxels * grid_->Bin().VoxelVolume();
   total_volume_->Add(0, &volume_estimate);
   mprintf("\t%u occupied voxels, voxel volume= %f Ang^3, total volume %f Ang^3\n",
@@ -513,40 +441,33 @@ void Action_Volmap::Print() {
   
   // See if we need to write the peaks out somewhere
   if (peakfile_ != 0) {
-    // Extract peaks from the current grid, setup another Grid instance. This
-    // works by taking every grid point and analyzing all grid points adjacent
-    // to it (including diagonals). If any of those grid points have a higher 
-    // value (meaning there is a direction towards "increased" density) then 
-    // that value is _not_ a maximum. Any density peaks less than the minimum
-    // filter are discarded. The result is a Grid instance with all non-peak 
-    // grid points zeroed-out.
-    Grid<float> peakgrid = grid_->InternalGrid();
+    // Extract peaks from the current grid. This works by taking every grid
+    // point and analyzing all grid points adjacent to it (including
+    // diagonals). If any of those grid points have a higher value (meaning
+    // there is a direction towards "increased" density) then that value is
+    // _not_ a maximum. Any density peaks less than the minimum filter are
+    // discarded.
+    int npeaks = 0;
+    std::vector<double> peakdata;
     for (size_t i = 0; i < grid_->NX(); i++)
       for (size_t j = 0; j < grid_->NY(); j++)
         for (size_t k = 0; k < grid_->NZ(); k++) {
-          float val = grid_->GridVal(i, j, k);
-          if (val < peakcut_) {
-            peakgrid.setGrid(i, j, k, 0.0f);
-            continue;
-          }
+          double gval = grid_->GetElement(i, j, k);
+          if (gval < peakcut_ || !(gval > 0)) continue;
+          bool isPeak = true;
           size_t i_end = std::min(i+2, grid_->NX());
           size_t j_end = std::min(j+2, grid_->NY());
           size_t k_end = std::min(k+2, grid_->NZ()); 
-          for (size_t ii = setStart(i); ii < i_end; ii++)
-            for (size_t jj = setStart(j); jj < j_end; jj++)
+          for (size_t ii = setStart(i); ii < i_end && isPeak; ii++)
+            for (size_t jj = setStart(j); jj < j_end && isPeak; jj++)
               for (size_t kk = setStart(k); kk < k_end; kk++) {
                 if (ii==i && jj==j && kk==k) continue;
-                if (grid_->GridVal(ii, jj, kk) > val)
-                  peakgrid.setGrid(i,j,k,0.0f); // TODO: break after this?
+                if (grid_->GetElement(ii, jj, kk) > gval) {
+                  isPeak = false;
+                  break;
+                }
               }
-        }
-    int npeaks = 0;
-    std::vector<double> peakdata;
-    for (size_t i = 0; i < peakgrid.NX(); i++)
-      for (size_t j = 0; j < peakgrid.NY(); j++)
-        for (size_t k = 0; k < peakgrid.NZ(); k++) {
-          double gval = peakgrid.element(i, j, k);
-          if (gval > 0) {
+          if (isPeak) {
             npeaks++;
             peakdata.push_back(xmin_+dx_*i);
             peakdata.push_back(ymin_+dy_*j);
@@ -2,6 +2,8 @@
 #define INC_ACTION_VOLMAP_H
 #include "Action.h"
 #include "DataSet_GridFlt.h"
+#include "DataSet_GridSparse.h"
+#include "GridBinner.h"
 class Action_Volmap : public Action {
   public:
     Action_Volmap();
@@ -17,6 +19,8 @@ class Action_Volmap : public Action {
     Action::RetType DoAction(int, ActionFrame&);
     void Print();
     void RawHelp() const;
+    /// Divide grid by number of frames; \return number of occupied voxels.
+    template <class GRID> unsigned int NormalizeGrid(GRID&) const;
 
     /// Radii to use
     enum RadiiType { UNSPECIFIED = 0, VDW, ELEMENT };
@@ -30,7 +34,8 @@ class Action_Volmap : public Action {
     bool spheremode_;       ///< If true, grid points farther than rhalf^2 will be skipped
     AtomMask centermask_;   ///< Mask to center the grid on
     AtomMask densitymask_;  ///< Max of atoms to grid.
-    DataSet_GridFlt* grid_; ///< Hold the grid.
+    DataSet_3D* grid_;      ///< Hold the grid; DataSet_GridSparse if sparse_, DataSet_GridFlt otherwise.
+    bool sparse_;           ///< If true, grid memory only allocated near atoms.
     DataSet* total_volume_; ///< Hold total grid volume.
     CpptrajFile* peakfile_; ///< file name with the peak locations as Carbons in XYZ file format
     double peakcut_;        ///< The value below which to ignore all peaks
@@ -39,11 +44,6 @@ class Action_Volmap : public Action {
     double buffer_;         ///< Clearance between the edges of our grid and centermask_
     double radscale_;       ///< The scaling factor to divide all radii by
     double stepfac_;        ///< Factor for determining how many steps to smear Gaussian
-    static const double sqrt_8_pi_cubed;
-#   ifdef _OPENMP
-    typedef std::vector< Grid<float> > Garray;
-    Garray GRID_THREAD_;
-    void CombineGridThreads();
-#   endif
+    GridBinner binner_;     ///< Adds atomic Gaussians to grid_
 };
 #endif
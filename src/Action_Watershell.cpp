@@ -189,6 +189,12 @@ Action::RetType Action_Watershell::Setup(ActionSetup& setup) {
     mprintf("\tImaging is off.\n");
   // Allocate temp space for selected solute atom coords.
   soluteCoords_.resize( soluteMask_.Nselected() * 3 );
+# ifndef CUDA
+  // Index into soluteCoords_ for each atom.
+  soluteIdx_.assign( setup.Top().Natom(), -1 );
+  for (int idx = 0; idx != soluteMask_.Nselected(); idx++)
+    soluteIdx_[ soluteMask_[idx] ] = idx * 3;
+# endif
   // Store current topology
   CurrentParm_ = setup.TopAddress();
   return Action::OK;    
@@ -248,6 +254,14 @@ Action::RetType Action_Watershell::DoAction(int frameNum, ActionFrame& frm) {
 # endif
   int* status = 0;
 
+  // When it results in fewer distance calculations, only check solute atoms
+  // close to each solvent atom, found via the neighbor grid shared by all
+  // actions. Otherwise check all solute atoms.
+  double cut = sqrt(upperCutoff_);
+  NeighborGrid const& grid = frm.Neighbors( cut );
+  bool useGrid = ( grid.AvgCandidates( cut ) < (double)soluteMask_.Nselected() );
+  Iarray nbrs;
+
   if (image_.ImageType() == NONORTHO) {
     // ----- NON-ORTHORHOMBIC IMAGING ------------
     Matrix_3x3 ucell, recip;
@@ -256,7 +270,7 @@ Action::RetType Action_Watershell::DoAction(int frameNum, ActionFrame& frm) {
     Image::WrapToCell0( soluteCoords_, frm.Frm(), soluteMask_, ucell, recip );
     // Calculate every imaged distance of all solvent atoms to solute
 #   ifdef _OPENMP
-#   pragma omp parallel private(Vidx, mythread, status)
+#   pragma omp parallel private(Vidx, mythread, status, nbrs)
     {
     mythread = omp_get_thread_num();
     status = &(shellStatus_thread_[mythread][0]);
@@ -268,44 +282,50 @@ Action::RetType Action_Watershell::DoAction(int frameNum, ActionFrame& frm) {
     {
       int Vat = solventMask_[Vidx];
       int currentRes = (*CurrentParm_)[ Vat ].ResNum();
+      // Residue already in first shell. No need for more distance calcs
+      if (status[currentRes] > 1) continue;
       // Convert to frac coords
       Vec3 vFrac = recip * Vec3( frm.Frm().XYZ( Vat ) );
       // Wrap to primary unit cell
       vFrac[0] = vFrac[0] - floor(vFrac[0]);
       vFrac[1] = vFrac[1] - floor(vFrac[1]);
       vFrac[2] = vFrac[2] - floor(vFrac[2]);
-      // Loop over all images of this solvent atom
+      // Convert all images of this solvent atom back to Cartesian
+      Vec3 vCart[27];
+      int nimg = 0;
       for (int ix = -1; ix != 2; ix++)
         for (int iy = -1; iy != 2; iy++)
           for (int iz = -1; iz != 2; iz++)
+            vCart[nimg++] = ucell.TransposeMult( vFrac + Vec3(ix, iy, iz) );
+      // Loop over (nearby) solute atoms
+      if (useGrid)
+        grid.GetCandidates( frm.Frm().XYZ( Vat ), cut, nbrs );
+      Iarray const& Uatoms = (useGrid) ? nbrs : soluteMask_.Selected();
+      for (Iarray::const_iterator atm = Uatoms.begin(); atm != Uatoms.end(); ++atm)
+      {
+        int idx = soluteIdx_[*atm];
+        if (idx < 0) continue;
+        // Loop over all images of this solvent atom
+        for (int img = 0; img != 27; img++)
+        {
+          double x = vCart[img][0] - soluteCoords_[idx  ];
+          double y = vCart[img][1] - soluteCoords_[idx+1];
+          double z = vCart[img][2] - soluteCoords_[idx+2];
+          double dist2 = x*x + y*y + z*z;
+          // Less than upper, 2nd shell
+          if (dist2 < upperCutoff_)
           {
-            // Convert image back to Cartesian
-            Vec3 vCart = ucell.TransposeMult( vFrac + Vec3(ix, iy, iz) );
-            // Loop over all solute atoms
-            for (unsigned int idx = 0; idx < soluteCoords_.size(); idx += 3)
+            status[currentRes] = 1;
+            // Less than lower, 1st shell
+            if (dist2 < lowerCutoff_)
             {
-              if (status[currentRes] < 2)
-              {
-                // Residue is not yet marked as 1st shell, calc distance
-                double x = vCart[0] - soluteCoords_[idx  ];
-                double y = vCart[1] - soluteCoords_[idx+1];
-                double z = vCart[2] - soluteCoords_[idx+2];
-                double dist2 = x*x + y*y + z*z;
-                // Less than upper, 2nd shell
-                if (dist2 < upperCutoff_) 
-                {
-                  status[currentRes] = 1;
-                  // Less than lower, 1st shell
-                  if (dist2 < lowerCutoff_)
-                    status[currentRes] = 2;
-                }
-              } else {
-                // Residue already in first shell. No need for more distance calcs
-                ix = iy = iz = 1;
-                break;
-              }
-            } // END loop over solute atoms 
-          } // END loop over images (Z)
+              status[currentRes] = 2;
+              break;
+            }
+          }
+        } // END loop over images
+        if (status[currentRes] > 1) break;
+      } // END loop over solute atoms
     } // END loop over solvent atoms
 # ifdef _OPENMP
   } // END pragma omp parallel
@@ -324,7 +344,7 @@ Action::RetType Action_Watershell::DoAction(int frameNum, ActionFrame& frm) {
     }
     // Calculate distance of all solvent atoms to solute
 #   ifdef _OPENMP
-#   pragma omp parallel private(Vidx, mythread, status)
+#   pragma omp parallel private(Vidx, mythread, status, nbrs)
     {
     mythread = omp_get_thread_num();
     status = &(shellStatus_thread_[mythread][0]);
@@ -336,30 +356,33 @@ Action::RetType Action_Watershell::DoAction(int frameNum, ActionFrame& frm) {
     {
       int Vat = solventMask_[Vidx];
       int currentRes = (*CurrentParm_)[ Vat ].ResNum();
+      // Residue already in first shell. No need for more distance calcs.
+      if (status[currentRes] > 1) continue;
       Vec3 Vcoord( frm.Frm().XYZ( Vat ) );
-      // Loop over all solute atoms
-      for (unsigned int idx = 0; idx < soluteCoords_.size(); idx += 3)
+      // Loop over (nearby) solute atoms
+      if (useGrid)
+        grid.GetCandidates( Vcoord.Dptr(), cut, nbrs );
+      Iarray const& Uatoms = (useGrid) ? nbrs : soluteMask_.Selected();
+      for (Iarray::const_iterator atm = Uatoms.begin(); atm != Uatoms.end(); ++atm)
       {
-        if (status[currentRes] < 2)
+        int idx = soluteIdx_[*atm];
+        if (idx < 0) continue;
+        Vec3 Ucoord( soluteCoords_[idx], soluteCoords_[idx+1], soluteCoords_[idx+2] );
+        double dist2;
+        if (image_.ImageType() == ORTHO)
+          dist2 = DIST2_ImageOrtho( Vcoord, Ucoord, frm.Frm().BoxCrd() );
+        else
+          dist2 = DIST2_NoImage( Vcoord, Ucoord );
+        // Less than upper, 2nd shell
+        if (dist2 < upperCutoff_)
         {
-          // Residue is not yet marked as 1st shell, calc distance
-          Vec3 Ucoord( soluteCoords_[idx], soluteCoords_[idx+1], soluteCoords_[idx+2] );
-          double dist2;
-          if (image_.ImageType() == ORTHO)
-            dist2 = DIST2_ImageOrtho( Vcoord, Ucoord, frm.Frm().BoxCrd() );
-          else
-            dist2 = DIST2_NoImage( Vcoord, Ucoord );
-          // Less than upper, 2nd shell
-          if (dist2 < upperCutoff_)
+          status[currentRes] = 1;
+          // Less than lower, 1st shell
+          if (dist2 < lowerCutoff_)
           {
-            status[currentRes] = 1;
-            // Less than lower, 1st shell
-            if (dist2 < lowerCutoff_)
-              status[currentRes] = 2;
+            status[currentRes] = 2;
+            break;
           }
-        } else {
-          // Residue already in first shell. No need for more distance calcs.
-          break;
         }
       } // END loop over solute atoms
     } // END loop over solvent atoms
@@ -32,6 +32,7 @@ class Action_Watershell : public Action {
     int NsolventMolecules_; ///< Number of selected solvent mols
     int NAtoms_;            ///< Number of atoms in each solvent mol
 #else
+    Iarray soluteIdx_;      ///< Index into soluteCoords_ for each atom, -1 if not solute.
 #   ifdef _OPENMP
     /// Shell status for solvent for each OpenMP thread.
     std::vector<Iarray> shellStatus_thread_; ///< Shell status for solvent for each OpenMP thread.
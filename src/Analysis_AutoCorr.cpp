@@ -1,6 +1,10 @@
+#include <cmath> // fabs
 #include "Analysis_AutoCorr.h"
 #include "CpptrajStdio.h"
 #include "DataSet_Vector.h"
+#include "DataSet_double.h"
+#include "StringRoutines.h" // ByteString
+#include "Corr.h"
 
 // CONSTRUCTOR
 Analysis_AutoCorr::Analysis_AutoCorr() :
@@ -79,8 +83,74 @@ Analysis::RetType Analysis_AutoCorr::Setup(ArgList& analyzeArgs, AnalysisSetup&
   return Analysis::OK;
 }
 
+/** Calculate auto-correlations of all scalar sets together with the batch
+  * FFT engine: each set is transformed once and the inverse transforms are
+  * done in parallel. Gives the same result as DataSet_1D::CrossCorr().
+  * \param idxs Indices of sets in dsets_ to calculate.
+  */
+int Analysis_AutoCorr::BatchAutoCorr(std::vector<unsigned int> const& idxs) {
+  CorrF_Batch::ArrayType arrays( idxs.size() );
+  CorrF_Batch::PairArray pairs;
+  CorrF_Batch::Parray output;
+  int maxlag = 0;
+  for (unsigned int n = 0; n != idxs.size(); n++) {
+    DataSet_1D const& set = static_cast<DataSet_1D const&>( *dsets_[idxs[n]] );
+    int Nelements = (int)set.Size();
+    double avg = 0.0;
+    if (calc_covar_)
+      avg = set.Avg();
+    CorrF_Batch::Darray& arr = arrays[n];
+    arr.resize( Nelements );
+    if (set.Meta().IsTorsionArray()) {
+      for (int i = 0; i < Nelements; ++i)
+        arr[i] = DataSet_1D::PeriodicDiff(avg, set.Dval( i ));
+    } else {
+      for (int i = 0; i < Nelements; ++i)
+        arr[i] = set.Dval(i) - avg;
+    }
+    int lagmax;
+    if (lagmax_ == -1)
+      lagmax = Nelements;
+    else if (lagmax_ > Nelements) {
+      mprintf("Warning: CrossCorr [%s][%s]: max lag (%i) > Nelements (%i), setting to Nelements.\n",
+              set.legend(), set.legend(), lagmax_, Nelements);
+      lagmax = Nelements;
+    } else
+      lagmax = lagmax_;
+    if (lagmax > maxlag) maxlag = lagmax;
+    DataSet_double& Ct = static_cast<DataSet_double&>( *outputData_[idxs[n]] );
+    Ct.Resize( lagmax );
+    pairs.push_back( CorrF_Batch::PairType(n, n) );
+  }
+  CorrF_Batch batch;
+  if (batch.Transform( arrays )) return 1;
+  mprintf("\t\tCalculating %zu autocorrelations together, FFT size %i (%s for spectra)\n",
+          idxs.size(), batch.FFTsize(),
+          ByteString(batch.MemUsageInBytes(), BYTE_DECIMAL).c_str());
+  // Correlate into scratch space since output sets may have fewer lags.
+  CorrF_Batch::Darray scratch( idxs.size() * (size_t)maxlag );
+  for (unsigned int n = 0; n != idxs.size(); n++)
+    output.push_back( &scratch[0] + n * (size_t)maxlag );
+  if (batch.Correlate( pairs, maxlag, output )) return 1;
+  // Normalize by value at lag 0
+  for (unsigned int n = 0; n != idxs.size(); n++) {
+    DataSet_double& Ct = static_cast<DataSet_double&>( *outputData_[idxs[n]] );
+    const double* ct = output[n];
+    double norm = 1.0 / fabs( ct[0] );
+    for (unsigned int i = 0; i != Ct.Size(); i++)
+      Ct[i] = ct[i] * norm;
+  }
+  return 0;
+}
+
 Analysis::RetType Analysis_AutoCorr::Analyze() {
+  // Scalar sets with FFT are done together.
+  std::vector<unsigned int> batchIdxs;
   for (unsigned int ids = 0; ids != dsets_.size(); ids++) {
+    if (usefft_ && dsets_[ids]->Type() != DataSet::VECTOR && dsets_[ids]->Size() > 1) {
+      batchIdxs.push_back( ids );
+      continue;
+    }
     mprintf("\t\tCalculating AutoCorrelation for set %s\n", dsets_[ids]->legend());
     DataSet_1D& Ct = static_cast<DataSet_1D&>( *outputData_[ids] );
     if (dsets_[ids]->Type() == DataSet::VECTOR) {
@@ -91,6 +161,9 @@ Analysis::RetType Analysis_AutoCorr::Analyze() {
       set.CrossCorr( set, Ct, lagmax_, calc_covar_, usefft_ );
     }
   }
+  if (!batchIdxs.empty()) {
+    if (BatchAutoCorr( batchIdxs )) return Analysis::ERR;
+  }
 
   return Analysis::OK;
 }
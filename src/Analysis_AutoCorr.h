@@ -11,6 +11,8 @@ class Analysis_AutoCorr : public Analysis {
     Analysis::RetType Setup(ArgList&, AnalysisSetup&, int);
     Analysis::RetType Analyze();
   private:
+    int BatchAutoCorr(std::vector<unsigned int> const&);
+
     DataSetList::DataListType dsets_;
     DataSetList::DataListType outputData_;
     int lagmax_;
@@ -4,6 +4,7 @@
 #include "StringRoutines.h" // fileExists, integerToString
 #include "DataSet_integer.h" // For converting cnumvtime
 #include "DataSet_float.h"
+#include "DataSet_Cmatrix_TILE.h" // SetCacheSize
 #include "Trajout_Single.h"
 #include "Timer.h"
 // Clustering Algorithms
@@ -80,7 +81,8 @@ void Analysis_Clustering::Help() const {
           "\t{ [[rms | srmsd] [<mask>] [mass] [nofit]] | [dme [<mask>]] |\n"
           "\t   [data <dset0>[,<dset1>,...]] }\n"
           "\t[sieve <#> [random [sieveseed <#>]]] [loadpairdist] [savepairdist] [pairdist <name>]\n"
-          "\t[pairwisecache {mem | disk | none}] [includesieveincalc] [pwrecalc]\n"
+          "\t[pairwisecache {mem | disk | tile [tilecache <MB>] | none}]\n"
+          "\t[includesieveincalc] [pwrecalc]\n"
           "  Output options:\n"
           "\t[out <cnumvtime>] [gracecolor] [summary <summaryfile>] [info <infofile>]\n"
           "\t[summarysplit <splitfile>] [splitframe <comma-separated frame list>]\n"
@@ -205,11 +207,24 @@ Analysis::RetType Analysis_Clustering::Setup(ArgList& analyzeArgs, AnalysisSetup
       pw_type = DataSet::CMATRIX_DISK;
     else if (pw_typeString == "none")
       pw_type = DataSet::CMATRIX_NOMEM;
+    else if (pw_typeString == "tile") {
+#     ifdef _WIN32
+      mprinterr("Error: 'pairwisecache tile' not supported on Windows.\n");
+      return Analysis::ERR;
+#     else
+      pw_type = DataSet::CMATRIX_TILE;
+#     endif
+    }
     else {
       mprinterr("Error: Unrecognized option for 'pairwisecache' ('%s')\n", pw_typeString.c_str());
       return Analysis::ERR;
     }
   }
+  int tileCacheMB = analyzeArgs.getKeyInt("tilecache", 1024);
+  if (tileCacheMB < 1) {
+    mprinterr("Error: 'tilecache' must be > 0 MB\n");
+    return Analysis::ERR;
+  }
   std::string pairdistname = analyzeArgs.GetStringKey("pairdist");
   DataFile::DataFormatType pairdisttype = DataFile::UNKNOWN_DATA;
   bool load_pair = analyzeArgs.hasKey("loadpairdist");
@@ -388,6 +403,10 @@ Analysis::RetType Analysis_Clustering::Setup(ArgList& analyzeArgs, AnalysisSetup
       md.SetFileName("CpptrajPairwiseCache");
     pw_dist_ = setup.DSL().AddSet(pw_type, md);
     if (pw_dist_ == 0) return Analysis::ERR;
+#   ifndef _WIN32
+    if (pw_type == DataSet::CMATRIX_TILE)
+      ((DataSet_Cmatrix_TILE*)pw_dist_)->SetCacheSize( (size_t)tileCacheMB * 1000000UL );
+#   endif
   }
 
   // DataSet for # clusters seen v time
@@ -460,6 +479,9 @@ Analysis::RetType Analysis_Clustering::Setup(ArgList& analyzeArgs, AnalysisSetup
     mprintf("\tPairwise distances will not be cached (will slow clustering calcs)\n");
   else if (pw_dist_->Type() == DataSet::CMATRIX_DISK)
     mprintf("\tPairwise distances will be cached to disk (will slow clustering calcs)\n");
+  else if (pw_dist_->Type() == DataSet::CMATRIX_TILE)
+    mprintf("\tPairwise distances will be cached to disk in tiles, %i MB tile cache.\n",
+            tileCacheMB);
   if (pw_dist_->Size() > 0) {
     if (pw_mismatch_fatal_)
       mprintf("\tCalculation will be halted if # frames does not match '%s'\n",
@@ -653,7 +675,10 @@ Analysis::RetType Analysis_Clustering::Analyze() {
 
   // Cluster
   cluster_cluster.Start();
-  CList_->Cluster();
+  if (CList_->Cluster()) {
+    mprinterr("Error: Clustering failed.\n");
+    return Analysis::ERR;
+  }
   cluster_cluster.Stop();
   cluster_post.Start();
   Timer cluster_post_renumber;
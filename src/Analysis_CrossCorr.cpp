@@ -1,16 +1,24 @@
+#include <cmath> // sqrt
 #include "Analysis_CrossCorr.h"
 #include "DataSet_MatrixFlt.h"
+#include "DataSet_MatrixDbl.h"
 #include "CpptrajStdio.h"
-#include "StringRoutines.h" // integerToString
+#include "StringRoutines.h" // integerToString, ByteString
 #include "DataSet_1D.h"
+#include "Corr.h"
 
 // CONSTRUCTOR
-Analysis_CrossCorr::Analysis_CrossCorr() : outfile_(0), matrix_(0) {}
+Analysis_CrossCorr::Analysis_CrossCorr() : outfile_(0), matrix_(0), lagmatrix_(0), lagmax_(0) {}
 
 void Analysis_CrossCorr::Help() const {
   mprintf("\t[name <dsetname>] <dsetarg0> [<dsetarg1> ...] [out <filename>]\n"
+          "\t[lagmax <lag> [lagout <filename>]]\n"
           "  Calculate matrix of Pearson product-moment correlation\n"
-          "  coefficients between selected data sets.\n");
+          "  coefficients between selected data sets.\n"
+          "  If 'lagmax' is specified, also calculate (via FFT) the time cross-\n"
+          "  correlation up to <lag> for every pair of data sets, normalized so\n"
+          "  that lag 0 is the correlation coefficient. Each row of the resulting\n"
+          "  matrix is one pair (1-2, 1-3, ..., 2-3, ...); each column is one lag.\n");
 }
 
 // Analysis_CrossCorr::Setup()
@@ -18,6 +26,14 @@ Analysis::RetType Analysis_CrossCorr::Setup(ArgList& analyzeArgs, AnalysisSetup&
 {
   std::string setname = analyzeArgs.GetStringKey("name");
   outfile_ = setup.DFL().AddDataFile(analyzeArgs.GetStringKey("out"), analyzeArgs);
+  lagmax_ = analyzeArgs.getKeyInt("lagmax", 0);
+  if (lagmax_ < 0) {
+    mprinterr("Error: 'lagmax' must be > 0\n");
+    return Analysis::ERR;
+  }
+  DataFile* lagfile = 0;
+  if (lagmax_ > 0)
+    lagfile = setup.DFL().AddDataFile(analyzeArgs.GetStringKey("lagout"), analyzeArgs);
   // Select datasets from remaining args
   if (input_dsets_.AddSetsFromArgs( analyzeArgs.RemainingArgs(), setup.DSL() )) {
     mprinterr("Error: Could not add data sets.\n");
@@ -33,6 +49,14 @@ Analysis::RetType Analysis_CrossCorr::Setup(ArgList& analyzeArgs, AnalysisSetup&
     matrix_->SetDim(Dimension::X, Dimension(1.0, 1.0, "DataSets"));
     outfile_->AddDataSet( matrix_ );
   }
+  if (lagmax_ > 0) {
+    lagmatrix_ = setup.DSL().AddSet( DataSet::MATRIX_DBL,
+                                     MetaData(matrix_->Meta().Name(), "lag") );
+    if (lagmatrix_ == 0) return Analysis::ERR;
+    lagmatrix_->SetDim(Dimension::X, Dimension(0.0, 1.0, "Lag"));
+    lagmatrix_->SetDim(Dimension::Y, Dimension(1.0, 1.0, "Pair"));
+    if (lagfile != 0) lagfile->AddDataSet( lagmatrix_ );
+  }
   
   mprintf("    CROSSCORR: Calculating correlation between %zu data sets:\n", input_dsets_.size());
   for (Array1D::const_iterator ds = input_dsets_.begin(); ds != input_dsets_.end(); ++ds)
@@ -40,6 +64,12 @@ Analysis::RetType Analysis_CrossCorr::Setup(ArgList& analyzeArgs, AnalysisSetup&
   mprintf("\tOutput set name: %s\n", matrix_->Meta().Name().c_str() );
   if ( outfile_ != 0 )
     mprintf("\tOutfile name: %s\n", outfile_->DataFilename().full());
+  if (lagmatrix_ != 0) {
+    mprintf("\tTime cross-correlation up to lag %i will be calculated for each pair.\n"
+            "\tCross-correlation set name: %s\n", lagmax_, lagmatrix_->legend());
+    if (lagfile != 0)
+      mprintf("\tCross-correlation output to '%s'\n", lagfile->DataFilename().full());
+  }
 
   return Analysis::OK;
 }
@@ -58,17 +88,98 @@ Analysis::RetType Analysis_CrossCorr::Analyze() {
     Ylabels += (integerToString(idx) + ":" + (*ds)->Meta().Legend() + ",");
   }
   Ylabels += "\"";
-  for (Array1D::const_iterator ds0 = input_dsets_.begin(); ds0 != input_dsets_.end(); ++ds0) {
-    DataSet_1D const& set0 = static_cast<DataSet_1D const&>( *(*ds0) );
-    for (Array1D::const_iterator ds1 = ds0 + 1; ds1 != input_dsets_.end(); ++ds1) {
-      float corr = (float)set0.CorrCoeff( *(*ds1) );
-      //mprinterr("DBG:\tCross corr between %i (%s) and %i (%s)\n",
-      //          i, dsets_[i]->legend(), j, dsets_[j]->legend());
-      tmatrix.AddElement( corr );
+  // Deviations from average and their norms are calculated once for each
+  // set, then the correlation coefficients for each row of the matrix are
+  // calculated in parallel.
+  int Nelements = (int)input_dsets_[0]->Size();
+  for (Array1D::const_iterator ds = input_dsets_.begin(); ds != input_dsets_.end(); ++ds) {
+    if ((int)(*ds)->Size() != Nelements) {
+      mprinterr("Error: # elements in dataset %s (%zu) not equal to\n"
+                "Error: # elements in dataset %s (%i)\n", (*ds)->legend(), (*ds)->Size(),
+                input_dsets_[0]->legend(), Nelements);
+      return Analysis::ERR;
+    }
+  }
+  int nsets = (int)input_dsets_.size();
+  CorrF_Batch::ArrayType devs( nsets );
+  std::vector<double> norms( nsets );
+  for (int i = 0; i < nsets; i++) {
+    DataSet_1D const& set = *(input_dsets_[i]);
+    double avg = set.Avg();
+    double sumdiff2 = 0.0;
+    devs[i].resize( Nelements );
+    for (int n = 0; n < Nelements; n++) {
+      double diff = set.Dval(n) - avg;
+      devs[i][n] = diff;
+      sumdiff2 += (diff * diff);
+    }
+    norms[i] = sqrt( sumdiff2 );
+  }
+  for (int i = 0; i < nsets; i++)
+    for (int j = i + 1; j < nsets; j++)
+      if (norms[i] == 0.0 || norms[j] == 0.0)
+        mprintf("Warning: Corr: %s to %s, Normalization is 0\n",
+                input_dsets_[i]->legend(), input_dsets_[j]->legend());
+  // Index of first element of each row in the triangle matrix
+  std::vector<size_t> rowStart( nsets, 0 );
+  for (int i = 1; i < nsets; i++)
+    rowStart[i] = rowStart[i-1] + (size_t)(nsets - i);
+  int row;
+# ifdef _OPENMP
+# pragma omp parallel for schedule(dynamic)
+# endif
+  for (row = 0; row < nsets; row++) {
+    const double* dev0 = &(devs[row][0]);
+    size_t midx = rowStart[row];
+    for (int col = row + 1; col < nsets; col++, midx++) {
+      float corr = 0.0;
+      if (norms[row] != 0.0 && norms[col] != 0.0) {
+        const double* dev1 = &(devs[col][0]);
+        double corr_coeff = 0.0;
+        for (int n = 0; n < Nelements; n++)
+          corr_coeff += (dev0[n] * dev1[n]);
+        corr = (float)(corr_coeff / (norms[row] * norms[col]));
+      }
+      tmatrix[midx] = corr;
     }
   }
   if (outfile_ != 0)
     outfile_->ProcessArgs("ylabels " + Ylabels);
+  // Time cross-correlation for each pair.
+  if (lagmatrix_ != 0) {
+    int lagmax = lagmax_;
+    if (lagmax > Nelements) {
+      mprintf("Warning: max lag (%i) > Nelements (%i), setting to Nelements.\n",
+              lagmax, Nelements);
+      lagmax = Nelements;
+    }
+    DataSet_MatrixDbl& lmatrix = static_cast<DataSet_MatrixDbl&>( *lagmatrix_ );
+    size_t npairs = tmatrix.Size();
+    if (lmatrix.Allocate2D( lagmax, npairs )) return Analysis::ERR;
+    CorrF_Batch batch;
+    if (batch.Transform( devs )) return Analysis::ERR;
+    mprintf("\tCalculating time cross-correlation for %zu pairs, FFT size %i (%s for spectra)\n",
+            npairs, batch.FFTsize(), ByteString(batch.MemUsageInBytes(), BYTE_DECIMAL).c_str());
+    CorrF_Batch::PairArray pairs;
+    CorrF_Batch::Parray output;
+    pairs.reserve( npairs );
+    output.reserve( npairs );
+    for (int i = 0; i < nsets; i++)
+      for (int j = i + 1; j < nsets; j++) {
+        output.push_back( &lmatrix[0] + pairs.size() * (size_t)lagmax );
+        pairs.push_back( CorrF_Batch::PairType(i, j) );
+      }
+    if (batch.Correlate( pairs, lagmax, output )) return Analysis::ERR;
+    // Normalize so that lag 0 is the correlation coefficient.
+    for (size_t p = 0; p != npairs; p++) {
+      double denom = norms[pairs[p].first] * norms[pairs[p].second];
+      double norm = 0.0;
+      if (denom > 0.0) norm = 1.0 / denom;
+      double* ct = output[p];
+      for (int i = 0; i < lagmax; i++)
+        ct[i] *= norm;
+    }
+  }
 
   return Analysis::OK;
 }
@@ -16,5 +16,7 @@ class Analysis_CrossCorr : public Analysis {
     DataFile* outfile_;
     Array1D input_dsets_;
     DataSet* matrix_;
+    DataSet* lagmatrix_; ///< Time cross-correlation of each pair (rows) vs lag (cols).
+    int lagmax_;         ///< Max lag for time cross-correlation; 0 if not calculated.
 };
 #endif
@@ -5,10 +5,14 @@
 // CONSTRUCTOR
 Analysis_Matrix::Analysis_Matrix() :
   matrix_(0),
+  coords_(0),
   modes_(0),
   outthermo_(0),
   thermo_temp_(298.15),
   nevec_(0),
+  tol_(1.0E-8),
+  maxit_(300),
+  useBlock_(false),
   thermopt_(false),
   reduce_(false),
   nmwizopt_(false),
@@ -17,12 +21,18 @@ Analysis_Matrix::Analysis_Matrix() :
 {}
 
 void Analysis_Matrix::Help() const {
-  mprintf("\t<name> [out <filename>] [thermo [outthermo <filename>] [temp <T>]]\n"
+  mprintf("\t{<name> [block] | crdset <crd set> [crdmask <mask>]} [tol <tol>] [maxit <#>]\n"
+          "\t[out <filename>] [thermo [outthermo <filename>] [temp <T>]]\n"
           "\t[vecs <#>] [name <modesname>] [reduce]\n"
           "\t[ nmwiz [nmwizvecs <n>] [nmwizfile <file>] %s\n"
           "\t  nmwizmask <mask> ]\n"
           "  Diagonalize given symmetric matrix to obtain eigenvectors\n"
-          "  and eigenvalues.\n", DataSetList::TopArgs);
+          "  and eigenvalues.\n"
+          "    block: Calculate the <vecs> largest modes with a threaded block Lanczos solver.\n"
+          "    crdset: Calculate the <vecs> largest coordinate covariance modes directly\n"
+          "            from COORDS set with the block Lanczos solver, without forming\n"
+          "            the covariance matrix.\n"
+          "    tol, maxit: Block Lanczos tolerance and max # iterations.\n", DataSetList::TopArgs);
 }
 
 // Analysis_Matrix::Setup()
@@ -32,23 +42,43 @@ Analysis::RetType Analysis_Matrix::Setup(ArgList& analyzeArgs, AnalysisSetup& se
   mprinterr("Error: Compiled without LAPACK routines.\n");
   return Analysis::ERR;
 #else
-  // Get matrix name
-  std::string mname = analyzeArgs.GetStringNext();
-  if (mname.empty()) {
-    mprinterr("Error: Missing matrix name (first argument).\n");
-    return Analysis::ERR;
-  }
-  // Find matrix in DataSetList.
-  matrix_ = (DataSet_2D*)setup.DSL().FindSetOfType( mname, DataSet::MATRIX_DBL );
-  if (matrix_ == 0)
-    matrix_ = (DataSet_2D*)setup.DSL().FindSetOfType( mname, DataSet::MATRIX_FLT );
-  if (matrix_ == 0) {
-    mprinterr("Error: Could not find matrix named %s\n",mname.c_str());
-    return Analysis::ERR;
+  MetaData::scalarType mtype = MetaData::COVAR;
+  std::string crdname = analyzeArgs.GetStringKey("crdset");
+  if (!crdname.empty()) {
+    // Calculate modes directly from COORDS.
+    coords_ = (DataSet_Coords*)setup.DSL().FindCoordsSet( crdname );
+    if (coords_ == 0) {
+      mprinterr("Error: Could not find COORDS set '%s'\n", crdname.c_str());
+      return Analysis::ERR;
+    }
+    if (crdmask_.SetMaskString( analyzeArgs.GetStringKey("crdmask") )) return Analysis::ERR;
+  } else {
+    // Get matrix name
+    std::string mname = analyzeArgs.GetStringNext();
+    if (mname.empty()) {
+      mprinterr("Error: Missing matrix name (first argument).\n");
+      return Analysis::ERR;
+    }
+    // Find matrix in DataSetList.
+    matrix_ = (DataSet_2D*)setup.DSL().FindSetOfType( mname, DataSet::MATRIX_DBL );
+    if (matrix_ == 0)
+      matrix_ = (DataSet_2D*)setup.DSL().FindSetOfType( mname, DataSet::MATRIX_FLT );
+    if (matrix_ == 0) {
+      mprinterr("Error: Could not find matrix named %s\n",mname.c_str());
+      return Analysis::ERR;
+    }
+    // Check that matrix is symmetric (half-matrix incl. diagonal).
+    if (matrix_->MatrixKind() != DataSet_2D::HALF) {
+      mprinterr("Error: Only works for symmetric matrices (i.e. no mask2)\n");
+      return Analysis::ERR;
+    }
+    mtype = matrix_->Meta().ScalarType();
+    useBlock_ = analyzeArgs.hasKey("block");
   }
-  // Check that matrix is symmetric (half-matrix incl. diagonal).
-  if (matrix_->MatrixKind() != DataSet_2D::HALF) {
-    mprinterr("Error: Only works for symmetric matrices (i.e. no mask2)\n");
+  tol_ = analyzeArgs.getKeyDouble("tol", 1.0E-8);
+  maxit_ = analyzeArgs.getKeyInt("maxit", 300);
+  if (tol_ <= 0.0 || maxit_ < 1) {
+    mprinterr("Error: 'tol' must be > 0 and 'maxit' must be > 0\n");
     return Analysis::ERR;
   }
   
@@ -87,7 +117,7 @@ Analysis::RetType Analysis_Matrix::Setup(ArgList& analyzeArgs, AnalysisSetup& se
     if (outthermo_ == 0) return Analysis::ERR;
   }
   thermo_temp_ = analyzeArgs.getKeyDouble("temp", 298.15);
-  if (thermopt_ && matrix_->Meta().ScalarType() != MetaData::MWCOVAR) {
+  if (thermopt_ && mtype != MetaData::MWCOVAR) {
     mprinterr("Error: Parameter 'thermo' only works for mass-weighted covariance matrix ('mwcovar').\n");
     return Analysis::ERR;
   }
@@ -98,17 +128,26 @@ Analysis::RetType Analysis_Matrix::Setup(ArgList& analyzeArgs, AnalysisSetup& se
     mprintf("Warning: Specify # eigenvectors with 'vecs <#>'. Setting to All.\n");
     nevec_ = -1;
   }
+  if ((coords_ != 0 || useBlock_) && nevec_ < 1) {
+    mprinterr("Error: Number of eigenvectors must be specified with 'vecs <#>' for\n"
+              "Error:   'block' or 'crdset'.\n");
+    return Analysis::ERR;
+  }
   // Reduce flag
   reduce_ = analyzeArgs.hasKey("reduce");
   // Set up DataSet_Modes. Set Modes DataSet type to be same as input matrix. 
   MetaData md( analyzeArgs.GetStringKey("name") );
-  md.SetScalarType( matrix_->Meta().ScalarType() );
+  md.SetScalarType( mtype );
   modes_ = (DataSet_Modes*)setup.DSL().AddSet( DataSet::MODES, md, "Modes" );
   if (modes_==0) return Analysis::ERR;
   if (outfile != 0) outfile->AddDataSet( modes_ );
 
   // Print Status
-  mprintf("    DIAGMATRIX: Diagonalizing matrix %s",matrix_->legend());
+  if (coords_ != 0)
+    mprintf("    DIAGMATRIX: Covariance modes of COORDS set %s, mask '%s'",
+            coords_->legend(), crdmask_.MaskString());
+  else
+    mprintf("    DIAGMATRIX: Diagonalizing matrix %s",matrix_->legend());
   if (outfile != 0)
     mprintf(" and writing modes to %s", outfile->DataFilename().full());
   if (nevec_ > 0)
@@ -117,6 +156,8 @@ Analysis::RetType Analysis_Matrix::Setup(ArgList& analyzeArgs, AnalysisSetup& se
     mprintf("\n\tNot calculating eigenvectors.\n");
   else
     mprintf("\n\tCalculating all eigenvectors.\n");
+  if (coords_ != 0 || useBlock_)
+    mprintf("\tUsing block solver, tolerance %g, max iterations %i\n", tol_, maxit_);
   if (thermopt_)
     mprintf("\tCalculating thermodynamic data at %.2f K, output to %s\n",
             thermo_temp_, outthermo_->Filename().full());
@@ -131,6 +172,21 @@ Analysis::RetType Analysis_Matrix::Setup(ArgList& analyzeArgs, AnalysisSetup& se
 
 // Analysis_Matrix::Analyze()
 Analysis::RetType Analysis_Matrix::Analyze() {
+  if (coords_ != 0) {
+    if (coords_->Top().SetupIntegerMask( crdmask_ )) return Analysis::ERR;
+    crdmask_.MaskInfo();
+    if (crdmask_.None()) {
+      mprinterr("Error: No atoms selected.\n");
+      return Analysis::ERR;
+    }
+    if (modes_->CalcEigenFromCoords( *coords_, crdmask_, nevec_, tol_, maxit_ ))
+      return Analysis::ERR;
+    if (nmwizopt_) NMWizOutput();
+    if (reduce_) {
+      if (modes_->ReduceVectors()) return Analysis::ERR;
+    }
+    return Analysis::OK;
+  }
   // Set the averaged coordinates and masses from matrix.
   if (modes_->SetAvgCoords( *matrix_ )) return Analysis::ERR;
   mprintf("\tEigenmode calculation for '%s'\n", matrix_->legend());
@@ -143,7 +199,11 @@ Analysis::RetType Analysis_Matrix::Analyze() {
               Dmatrix.Nsnapshots(), Dmatrix.Ncols(), Dmatrix.Nsnapshots());
   }
   // Calculate eigenvalues / eigenvectors
-  if (modes_->CalcEigen( *matrix_, nevec_ )) return Analysis::ERR;
+  if (useBlock_) {
+    if (modes_->CalcEigenBlock( *matrix_, nevec_, tol_, maxit_ )) return Analysis::ERR;
+  } else {
+    if (modes_->CalcEigen( *matrix_, nevec_ )) return Analysis::ERR;
+  }
   // If mass-weighted covariance, mass-weight the resulting eigenvectors.
   if (matrix_->Meta().ScalarType() == MetaData::MWCOVAR) {
     mprintf("Info: Converting eigenvalues to cm^-1 and mass-weighting eigenvectors.\n");
@@ -3,6 +3,7 @@
 #include "Analysis.h"
 #include "DataSet_2D.h"
 #include "DataSet_Modes.h"
+#include "DataSet_Coords.h"
 class Analysis_Matrix : public Analysis {
   public:
     Analysis_Matrix();
@@ -16,10 +17,15 @@ class Analysis_Matrix : public Analysis {
     int NMWizOutput() const;
 
     DataSet_2D* matrix_;
+    DataSet_Coords* coords_; ///< If set, calculate covariance modes directly from COORDS.
+    AtomMask crdmask_;       ///< Atoms in coords_ to use.
     DataSet_Modes* modes_;
     CpptrajFile* outthermo_;
     double thermo_temp_;
     int nevec_;
+    double tol_;             ///< Block solver tolerance.
+    int maxit_;              ///< Block solver max iterations.
+    bool useBlock_;          ///< If true use block solver.
     bool thermopt_;
     bool reduce_;
     bool nmwizopt_;
@@ -1,8 +1,12 @@
 #include <cmath> // exp
+#include <algorithm> // std::min, std::copy
 #include "Analysis_Rms2d.h"
 #include "CpptrajStdio.h"
 #include "ProgressBar.h"
 #include "DataSet_Coords_TRJ.h"
+#include "RmsdRoutines.h"
+#include "StringRoutines.h" // ByteString
+#include "Constants.h" // SMALL
 #ifdef _OPENMP
 #  include <omp.h>
 #endif
@@ -16,17 +20,20 @@ Analysis_Rms2d::Analysis_Rms2d() :
   RefTraj_(0),
   RefParm_(0),
   rmsdataset_(0),
-  Ct_(0)
+  Ct_(0),
+  maxPackBytes_(512000000)
 { } 
 
 void Analysis_Rms2d::Help() const {
   mprintf("\t[crdset <crd set>] [<name>] [<mask>] [out <filename>]\n"
-          "\t[dme | nofit | srmsd] [mass]\n"
+          "\t[dme | nofit | srmsd] [mass] [maxmem <MB>]\n"
           "\t[reftraj <traj> [parm <parmname> | parmindex <#>] [<refmask>]]\n"
           "\t[corr <corrfilename>]\n"
           "  Calculate RMSD between all frames in <crd set>, or between frames in\n"
           "  <crd set> and frames in <traj>.\n"
-          "  <crd set> can be created with the 'createcrd' command.\n");
+          "  <crd set> can be created with the 'createcrd' command.\n"
+          "  For RMSD, at most <MB> megabytes (default 512) of selected coordinates\n"
+          "  are held in memory at once.\n");
 }
 
 const char* Analysis_Rms2d::ModeStrings_[] = {
@@ -55,6 +62,12 @@ Analysis::RetType Analysis_Rms2d::Setup(ArgList& analyzeArgs, AnalysisSetup& set
   else
     mode_ = RMS_FIT;
   useMass_ = analyzeArgs.hasKey("mass");
+  int maxmem = analyzeArgs.getKeyInt("maxmem", 512);
+  if (maxmem < 1) {
+    mprinterr("Error: 'maxmem' must be at least 1 MB.\n");
+    return Analysis::ERR;
+  }
+  maxPackBytes_ = (size_t)maxmem * 1000000;
   std::string outfilename = analyzeArgs.GetStringKey("out");
   if (outfilename.empty()) outfilename = analyzeArgs.GetStringKey("rmsout"); // DEPRECATED
   DataFile* rmsdFile = setup.DFL().AddDataFile(outfilename, "square2d", analyzeArgs);
@@ -222,6 +235,12 @@ int Analysis_Rms2d::Calculate_2D() {
               TgtTraj_->legend(), TgtMask_.MaskString(), RefMask_.MaskString());
   }
   mprintf(" (%zu total).\n", rmsdataset_->Size());
+  // RMSD with and without fitting use the tiled calculation.
+  if (mode_ == RMS_FIT || mode_ == RMS_NOFIT) {
+    if (Calculate_Tiled( calculateFullMatrix )) return 1;
+    if (Ct_ != 0) CalcAutoCorr( );
+    return 0;
+  }
   // Set up target and reference frames based on mask. Both have same topology.
   Frame SelectedRef, SelectedTgt;
   SelectedRef.SetupFrameFromMask( RefMask_, RefTraj_->Top().Atoms() );
@@ -287,6 +306,192 @@ int Analysis_Rms2d::Calculate_2D() {
   return 0;
 }
 
+/** Extract coordinates of selected atoms from frames beg to end of given
+  * COORDS set into a packed array, optionally centering each on the origin.
+  */
+static void PackSelectedFrames(std::vector<double>& crdOut, DataSet_Coords* crdIn,
+                               AtomMask const& maskIn, int beg, int end,
+                               bool center, bool useMass)
+{
+  Frame selected;
+  selected.SetupFrameFromMask( maskIn, crdIn->Top().Atoms() );
+  size_t ncrd = (size_t)selected.size();
+  crdOut.resize( (size_t)(end - beg) * ncrd );
+  std::vector<double>::iterator out = crdOut.begin();
+  for (int idx = beg; idx < end; idx++, out += ncrd) {
+    crdIn->GetFrame( idx, selected, maskIn );
+    if (center) selected.CenterOnOrigin( useMass );
+    std::copy( selected.xAddress(), selected.xAddress() + ncrd, out );
+  }
+}
+
+// Analysis_Rms2d::Calculate_Tiled()
+/** Calculate RMSD (with or without fitting) between frames. The selected
+  * coordinates of frames are extracted (and pre-centered if fitting) into
+  * packed arrays. If the packed coordinates for all frames would exceed
+  * maxPackBytes_, frames are packed in slabs small enough that a reference
+  * and a target slab fit, and each pair of slabs is processed in turn.
+  * Each slab pair is divided into square tiles of frames small enough that
+  * the coordinates for a tile stay in cache, and tiles are distributed
+  * among threads.
+  */
+int Analysis_Rms2d::Calculate_Tiled(bool calculateFullMatrix) {
+  int totalref = RefTraj_->Size();
+  int totaltgt = TgtTraj_->Size();
+  bool fit = (mode_ == RMS_FIT);
+  // Masses are taken from the target.
+  int ncrd = TgtMask_.Nselected() * 3;
+  std::vector<double> mass;
+  double total_mass = 0.0;
+  if (useMass_) {
+    for (AtomMask::const_iterator at = TgtMask_.begin(); at != TgtMask_.end(); ++at) {
+      mass.push_back( TgtTraj_->Top()[*at].Mass() );
+      total_mass += mass.back();
+    }
+  } else
+    total_mass = (double)TgtMask_.Nselected();
+  if (total_mass < Constants::SMALL) {
+    mprinterr("Error: Total mass of selected atoms is zero.\n");
+    return 1;
+  }
+  const double* massPtr = 0;
+  if (useMass_) massPtr = &mass[0];
+  // Tile size: ~256 KB of coordinates for each of the ref and tgt tiles.
+  int tileSize = (int)((256 * 1024) / (ncrd * sizeof(double)));
+  if (tileSize < 4) tileSize = 4;
+  if (tileSize > 256) tileSize = 256;
+# ifdef _OPENMP
+  // Ensure there are enough tiles to keep all threads busy.
+  int minTiles = 4 * omp_get_max_threads();
+  while (tileSize > 4 && ((totalref + tileSize - 1) / tileSize) *
+                         ((totaltgt + tileSize - 1) / tileSize) < 2 * minTiles)
+    tileSize /= 2;
+# endif
+  // Determine how many frames can be packed at once. When only the upper
+  // triangle is needed the reference and target frames are the same.
+  size_t frameBytes = (size_t)ncrd * sizeof(double);
+  size_t totalBytes = (size_t)totaltgt * frameBytes;
+  if (calculateFullMatrix)
+    totalBytes += (size_t)totalref * frameBytes;
+  int slabSize = std::max( totalref, totaltgt );
+  if (totalBytes > maxPackBytes_) {
+    slabSize = (int)(maxPackBytes_ / (2 * frameBytes));
+    if (slabSize > tileSize) slabSize -= (slabSize % tileSize);
+    if (slabSize < 1) slabSize = 1;
+    if (tileSize > slabSize) tileSize = slabSize;
+    mprintf("\tSelected coordinates (%s) exceed memory limit of %s;"
+            " packing %i frames at a time.\n",
+            ByteString(totalBytes, BYTE_DECIMAL).c_str(),
+            ByteString(maxPackBytes_, BYTE_DECIMAL).c_str(), slabSize);
+  } else
+    mprintf("\tSelected coordinates use %s\n", ByteString(totalBytes, BYTE_DECIMAL).c_str());
+  // Set up pairs of reference and target slabs, counting total tiles.
+  std::vector<int> slabRef, slabTgt;
+  int ntilesTotal = 0;
+  for (int rs = 0; rs < totalref; rs += slabSize) {
+    int nRefTiles = (std::min(rs + slabSize, totalref) - rs + tileSize - 1) / tileSize;
+    int ts0 = 0;
+    if (!calculateFullMatrix) ts0 = rs;
+    for (int ts = ts0; ts < totaltgt; ts += slabSize) {
+      int nTgtTiles = (std::min(ts + slabSize, totaltgt) - ts + tileSize - 1) / tileSize;
+      slabRef.push_back( rs );
+      slabTgt.push_back( ts );
+      if (!calculateFullMatrix && ts == rs)
+        ntilesTotal += (nRefTiles * (nRefTiles + 1)) / 2;
+      else
+        ntilesTotal += nRefTiles * nTgtTiles;
+    }
+  }
+  int nslabpairs = (int)slabRef.size();
+  mprintf("\tUsing %i tiles of up to %i x %i frames", ntilesTotal, tileSize, tileSize);
+  if (nslabpairs > 1)
+    mprintf(" in %i pairs of %i-frame slabs", nslabpairs, slabSize);
+  mprintf(".\n");
+  // Shared between threads; set up by a single thread for each slab pair.
+  std::vector<double> tgtCrd, refCrd;
+  const double* refPtr = 0;
+  const double* tgtPtr = 0;
+  int refSlabBeg = -1, refSlabEnd = 0, tgtSlabBeg = 0, tgtSlabEnd = 0;
+  std::vector<int> tileRef, tileTgt;
+  int ntiles = 0;
+  int tileOffset = 0;
+  ParallelProgress progress( ntilesTotal );
+  int tile;
+# ifdef _OPENMP
+# pragma omp parallel private(tile) firstprivate(progress)
+  {
+    if (omp_get_thread_num()==0)
+      mprintf("\tParallelizing calculation with %i OpenMP threads.\n", omp_get_num_threads());
+    progress.SetThread(omp_get_thread_num());
+# endif
+    for (int sp = 0; sp < nslabpairs; sp++) {
+#     ifdef _OPENMP
+#     pragma omp single
+#     endif
+      {
+        tileOffset += ntiles;
+        // Pack reference slab if it changed.
+        if (slabRef[sp] != refSlabBeg) {
+          refSlabBeg = slabRef[sp];
+          refSlabEnd = std::min(refSlabBeg + slabSize, totalref);
+          PackSelectedFrames( refCrd, RefTraj_, RefMask_, refSlabBeg, refSlabEnd, fit, useMass_ );
+          refPtr = &refCrd[0];
+        }
+        // Pack target slab unless it is the same as the reference slab.
+        tgtSlabBeg = slabTgt[sp];
+        tgtSlabEnd = std::min(tgtSlabBeg + slabSize, totaltgt);
+        if (!calculateFullMatrix && tgtSlabBeg == refSlabBeg)
+          tgtPtr = refPtr;
+        else {
+          PackSelectedFrames( tgtCrd, TgtTraj_, TgtMask_, tgtSlabBeg, tgtSlabEnd, fit, useMass_ );
+          tgtPtr = &tgtCrd[0];
+        }
+        // Set up tiles for this slab pair.
+        tileRef.clear();
+        tileTgt.clear();
+        for (int rt = refSlabBeg; rt < refSlabEnd; rt += tileSize) {
+          int tt0 = tgtSlabBeg;
+          if (!calculateFullMatrix && tgtSlabBeg == refSlabBeg) tt0 = rt;
+          for (int tt = tt0; tt < tgtSlabEnd; tt += tileSize) {
+            tileRef.push_back( rt );
+            tileTgt.push_back( tt );
+          }
+        }
+        ntiles = (int)tileRef.size();
+      } // END single
+#     ifdef _OPENMP
+#     pragma omp for schedule(dynamic)
+#     endif
+      for (tile = 0; tile < ntiles; tile++) {
+        progress.Update(tileOffset + tile);
+        int refBeg = tileRef[tile];
+        int refEnd = std::min(refBeg + tileSize, refSlabEnd);
+        int tgtBeg = tileTgt[tile];
+        int tgtEnd = std::min(tgtBeg + tileSize, tgtSlabEnd);
+        for (int nref = refBeg; nref < refEnd; nref++) {
+          const double* ref = refPtr + (size_t)(nref - refSlabBeg) * ncrd;
+          int tgtstart = tgtBeg;
+          if (!calculateFullMatrix && tgtstart <= nref)
+            tgtstart = nref + 1;
+          const double* tgt = tgtPtr + (size_t)(tgtstart - tgtSlabBeg) * ncrd;
+          for (int ntgt = tgtstart; ntgt < tgtEnd; ntgt++, tgt += ncrd) {
+            double R;
+            if (fit)
+              R = RMSD_PreCentered(tgt, ref, massPtr, ncrd, total_mass);
+            else
+              R = RMSD_NoFit(tgt, ref, massPtr, ncrd, total_mass);
+            rmsdataset_->SetElement(nref, ntgt, (float)R);
+          }
+        }
+      } // END loop over tiles
+    } // END loop over slab pairs
+# ifdef _OPENMP
+  }
+# endif
+  progress.Finish();
+  return 0;
+}
+
 /** Calculate the pseudo-autocorrelation of the RMSDs. For proper weighting
   * exp[ -RMSD(framei, framei+lag) ] is used. This takes advantage of
   * the fact that 0.0 RMSD essentially means perfect correlation (1.0).
@@ -19,6 +19,7 @@ class Analysis_Rms2d: public Analysis {
     Analysis::RetType Analyze();
   private:
     int Calculate_2D();
+    int Calculate_Tiled(bool);
     void CalcAutoCorr();
 
     static const char* ModeStrings_[];
@@ -34,5 +35,6 @@ class Analysis_Rms2d: public Analysis {
     SymmetricRmsdCalc SRMSD_;  ///< Hold symmetry-corrected RMSD calc.
     DataSet_MatrixFlt* rmsdataset_;
     DataSet* Ct_;
+    size_t maxPackBytes_;      ///< Max bytes of packed coordinates for tiled RMSD.
 };
 #endif
@@ -189,13 +189,31 @@ void AtomMask::PrintMaskAtoms(const char *header) const {
   */
 int AtomMask::SetupMask(AtomArrayT const& atoms, ResArrayT const& residues,
                         MolArrayT const& molecules, const double* XYZ)
+{
+  return setupMask(atoms, residues, molecules, XYZ, 0);
+}
+
+/** Set up integer mask; state from the previous selection in the given
+  * cache is used as a starting point for distance-based selection.
+  */
+int AtomMask::SetupMask(AtomArrayT const& atoms, ResArrayT const& residues,
+                        MolArrayT const& molecules, const double* XYZ,
+                        MaskSelectionCache& cache)
+{
+  return setupMask(atoms, residues, molecules, XYZ, &cache);
+}
+
+// AtomMask::setupMask()
+int AtomMask::setupMask(AtomArrayT const& atoms, ResArrayT const& residues,
+                        MolArrayT const& molecules, const double* XYZ,
+                        MaskSelectionCache* cache)
 {
   // Set up an integer list of the selected atoms. 
   // NOTE: For large selections this will use 4x the memory of the char atom
   //       mask. Could check to see which will be bigger.
   Natom_ = (int)atoms.size();
   Selected_.clear();
-  char* charmask = ParseMask(atoms, residues, molecules, XYZ);
+  char* charmask = ParseMask(atoms, residues, molecules, XYZ, cache);
   if (charmask == 0) return 1;
   for (int atom = 0; atom != Natom_; atom++) {
     if (charmask[atom] == maskChar_)
@@ -68,6 +68,9 @@ class AtomMask : public MaskTokenArray {
     void PrintMaskAtoms(const char*) const;
     /// Set up integer mask based on current mask expression. 
     int SetupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*);
+    /// Set up integer mask, reusing/updating given selection cache.
+    int SetupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*,
+                  MaskSelectionCache&);
     /// Reset atom mask
     void ResetMask();
     /// Clear any selected atoms in mask.
@@ -75,6 +78,9 @@ class AtomMask : public MaskTokenArray {
     /// \return number of selected atoms
     int Nselected() const { return (int)Selected_.size(); }
   private:
+    int setupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*,
+                  MaskSelectionCache*);
+
     std::vector<int> Selected_; ///< Int array of selected atom numbers
     int Natom_;     ///< Total # of atoms mask was set up with, used to convert to CharMask
     char maskChar_; ///< Current character used for selected atoms.
@@ -2,6 +2,7 @@
 #include <cstdlib> // atof
 #include "BufferedFrame.h"
 #include "CpptrajStdio.h"
+#include "FixedWidthRoutines.h"
 
 BufferedFrame::BufferedFrame() :
   buffer_(0),
@@ -135,6 +136,7 @@ int BufferedFrame::WriteFrame() {
 }
 
 void BufferedFrame::GetDoubleAtPosition(double& val, size_t start, size_t end) {
+  if (FixedWidthToDouble(buffer_ + start, end - start, val)) return;
   char savechar = buffer_[end];
   buffer_[end] = '\0';
   val = atof(buffer_ + start);
@@ -159,7 +161,8 @@ void BufferedFrame::AdvanceBuffer(size_t offset) {
   * element should be what SetupFrameBuffer was called with, and the 
   * number of elements to read should not be greater than Nelts.
   * Newlines are skipped. Output array should be as big as Nout. 
-  * Update bufferPosition after read.
+  * Update bufferPosition after read. Plain decimal fields are converted
+  * directly; anything else is passed to atof.
   */
 void BufferedFrame::BufferToDouble(double* Xout, int Nout) {
   for (int element = 0; element < Nout; ++element) {
@@ -175,23 +178,30 @@ void BufferedFrame::BufferToDouble(double* Xout, int Nout) {
       mprinterr("). This indicates coordinate overflow.\n");
     }
     char *ptrend = bufferPosition_ + eltWidth_;
-    char lastchar = *ptrend;
-    *ptrend = '\0';
-    Xout[element] = atof(bufferPosition_);
-    *ptrend = lastchar;
+    if (!FixedWidthToDouble(bufferPosition_, eltWidth_, Xout[element])) {
+      char lastchar = *ptrend;
+      *ptrend = '\0';
+      Xout[element] = atof(bufferPosition_);
+      *ptrend = lastchar;
+    }
     bufferPosition_ = ptrend;
   }
 }
 
 /** Convert given double array to ordered text in buffer. The number of
   * elements in the given array should be what SetupFrameBuffer was
-  * called with. Update bufferPosition after write. 
+  * called with. Update bufferPosition after write. If the format is a plain
+  * "%<width>.<precision>f" matching the element width, values are formatted
+  * directly; any value that cannot be is passed to sprintf.
   */
 void BufferedFrame::DoubleToBuffer(const double* Xin, int Nin, const char* format)
 {
+  int width, prec;
+  bool isFixed = (IsFixedWidthFormat(format, width, prec) && width == (int)eltWidth_);
   int col = 0;
   for (int element = 0; element < Nin; ++element) {
-    sprintf(bufferPosition_, format, Xin[element]);
+    if (!isFixed || !DoubleToFixedWidth(bufferPosition_, Xin[element], width, prec))
+      sprintf(bufferPosition_, format, Xin[element]);
     bufferPosition_ += eltWidth_;
     ++col;
     if ( col == Ncols_ ) {
@@ -6,11 +6,29 @@
   */
 int CharMask::SetupMask(AtomArrayT const& atoms, ResArrayT const& residues,
                         MolArrayT const& molecules, const double* XYZ)
+{
+  return setupMask(atoms, residues, molecules, XYZ, 0);
+}
+
+/** Set up character mask; state from the previous selection in the given
+  * cache is used as a starting point for distance-based selection.
+  */
+int CharMask::SetupMask(AtomArrayT const& atoms, ResArrayT const& residues,
+                        MolArrayT const& molecules, const double* XYZ,
+                        MaskSelectionCache& cache)
+{
+  return setupMask(atoms, residues, molecules, XYZ, &cache);
+}
+
+// CharMask::setupMask()
+int CharMask::setupMask(AtomArrayT const& atoms, ResArrayT const& residues,
+                        MolArrayT const& molecules, const double* XYZ,
+                        MaskSelectionCache* cache)
 {
   CharMask_.clear();
   nselected_ = 0;
   CharMask_.reserve( atoms.size() );
-  char* charmask = ParseMask(atoms, residues, molecules, XYZ);
+  char* charmask = ParseMask(atoms, residues, molecules, XYZ, cache);
   if (charmask == 0) return 1;
   for (unsigned int i = 0; i != atoms.size(); i++) {
     CharMask_.push_back( charmask[i] );
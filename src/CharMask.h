@@ -28,6 +28,9 @@ class CharMask : public MaskTokenArray {
     void PrintMaskAtoms(const char*) const;
     /// Set up character mask based on current mask expression. 
     int SetupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*);
+    /// Set up character mask, reusing/updating given selection cache.
+    int SetupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*,
+                  MaskSelectionCache&);
     /// Reset atom mask
     void ResetMask();
     /// Clear any selected atoms in mask.
@@ -37,6 +40,9 @@ class CharMask : public MaskTokenArray {
     /// \return number of selected atoms.
     int Nselected() const { return nselected_; }
   private:
+    int setupMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*,
+                  MaskSelectionCache*);
+
     std::vector<char> CharMask_; ///< Array of size Natoms, 'T' selected, 'F' otherwise.
     int nselected_; ///< Total # of selected atoms.
 };
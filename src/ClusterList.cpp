@@ -621,6 +621,10 @@ int ClusterList::CalcFrameDistances(DataSet* pwDistMatrixIn,
       ClusterSieve::SievedFrames const& frames = FrameDistances().FramesToCluster();
       int f2end = (int)frames.size();
       int f1end = f2end - 1;
+      // Some matrices (e.g. tiled) need rows to be set in blocks, in order.
+      int blockSize = (int)FrameDistances().RowsPerFlush();
+      if (blockSize < 1) blockSize = f1end;
+      int err = 0;
       ParallelProgress progress(f1end);
       int f1, f2;
       // For OMP, every other thread will need its own Cdist.
@@ -635,12 +639,24 @@ int ClusterList::CalcFrameDistances(DataSet* pwDistMatrixIn,
         MyCdist = Cdist_;
       } else
         MyCdist = Cdist_->Copy();
-#     pragma omp for schedule(dynamic)
 #     endif
-      for (f1 = 0; f1 < f1end; f1++) {
-        progress.Update(f1);
-        for (f2 = f1 + 1; f2 < f2end; f2++)
-          frameDistances_->SetElement( f1, f2, MyCdist->FrameDist(frames[f1], frames[f2]) );
+      for (int b0 = 0; b0 < f1end && err == 0; b0 += blockSize) {
+        int b1 = std::min( b0 + blockSize, f1end );
+#       ifdef _OPENMP
+#       pragma omp for schedule(dynamic)
+#       endif
+        for (f1 = b0; f1 < b1; f1++) {
+          progress.Update(f1);
+          for (f2 = f1 + 1; f2 < f2end; f2++)
+            frameDistances_->SetElement( f1, f2, MyCdist->FrameDist(frames[f1], frames[f2]) );
+        }
+#       ifdef _OPENMP
+#       pragma omp master
+#       endif
+        if (frameDistances_->FlushRows()) err = 1;
+#       ifdef _OPENMP
+#       pragma omp barrier
+#       endif
       }
 #     ifdef _OPENMP
       if (mythread > 0)
@@ -648,6 +664,10 @@ int ClusterList::CalcFrameDistances(DataSet* pwDistMatrixIn,
       } // END omp parallel
 #     endif
       progress.Finish();
+      if (err != 0) {
+        mprinterr("Error: Could not write pair-wise distances.\n");
+        return 1;
+      }
     }
     // Currently this is only for DataSet_Cmatrix_DISK
     frameDistances_->Complete();
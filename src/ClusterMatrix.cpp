@@ -64,6 +64,76 @@ double ClusterMatrix::FindMin(int& iOut, int& jOut) const {
 }
 #endif
 
+// -----------------------------------------------------------------------------
+/** Find smallest element in given row (cols > row) not being ignored. Ties
+  * go to the lowest column, same as FindMin().
+  */
+void ClusterMatrix::CalcRowMin(int row) {
+  float min = FLT_MAX;
+  int nbr = -1;
+  unsigned int col = row + 1;
+  unsigned int idx = Mat_.CalcIndex(col, row); // idx is start of this row
+  for (; col != Mat_.Ncols(); col++, idx++) {
+    if (!ignore_[col] && Mat_[idx] < min) {
+      min = Mat_[idx];
+      nbr = (int)col;
+    }
+  }
+  rowMin_[row] = min;
+  rowNbr_[row] = nbr;
+}
+
+/** Determine nearest neighbor of every row so that the global minimum can
+  * be found by scanning rows instead of the whole matrix.
+  */
+void ClusterMatrix::InitRowMin() {
+  int nrows = (int)Mat_.Nrows();
+  rowMin_.assign( nrows, FLT_MAX );
+  rowNbr_.assign( nrows, -1 );
+  int row;
+# ifdef _OPENMP
+# pragma omp parallel for schedule(dynamic)
+# endif
+  for (row = 0; row < nrows - 1; row++)
+    if (!ignore_[row]) CalcRowMin( row );
+}
+
+/** Find the minimum not being ignored from the tracked row minima. The
+  * first row with the smallest minimum is chosen, so the result is the same
+  * as the serial FindMin().
+  */
+double ClusterMatrix::FindRowMin(int& iOut, int& jOut) const {
+  float min = FLT_MAX;
+  for (unsigned int row = 0; row != rowMin_.size(); row++) {
+    if (!ignore_[row] && rowMin_[row] < min) {
+      min = rowMin_[row];
+      iOut = (int)row;
+      jOut = rowNbr_[row];
+    }
+  }
+  return (double)min;
+}
+
+/** Update row minima after row/col c2 has been ignored and all distances to
+  * row/col c1 have been changed. Only rows whose nearest neighbor was c1 or
+  * c2 need to be searched again.
+  */
+void ClusterMatrix::UpdateRowMin(int c1, int c2) {
+  CalcRowMin( c1 );
+  for (int row = 0; row < c2; row++) {
+    if (row == c1 || ignore_[row]) continue;
+    if (rowNbr_[row] == c1 || rowNbr_[row] == c2)
+      CalcRowMin( row );
+    else if (row < c1) {
+      float dist = Mat_.element(c1, row);
+      if (dist < rowMin_[row] || (dist == rowMin_[row] && c1 < rowNbr_[row])) {
+        rowMin_[row] = dist;
+        rowNbr_[row] = c1;
+      }
+    }
+  }
+}
+
 void ClusterMatrix::PrintElements() const {
   unsigned int iVal = 0;
   unsigned int jVal = 1;
@@ -18,6 +18,12 @@ class ClusterMatrix {
 #   else
     double FindMin(int&, int&) const;
 #   endif
+    /// Set up nearest neighbor of each row for use with FindRowMin().
+    void InitRowMin();
+    /// Set the row and column of the smallest element using tracked row minima.
+    double FindRowMin(int&, int&) const;
+    /// Update tracked row minima after row 2 was ignored and distances to row 1 changed.
+    void UpdateRowMin(int, int);
     /// \return an element.
     inline double GetCdist(int c, int r) const { return Mat_.element(c,r); }
     /// Print all matrix elements to STDOUT
@@ -29,8 +35,12 @@ class ClusterMatrix {
     /// Set up matrix for given number of rows
     int SetupMatrix(size_t);
   private:
+    void CalcRowMin(int);
+
     Matrix<float> Mat_;        ///< Upper-triangle matrix holding cluster distances.
     std::vector<bool> ignore_; ///< If true, ignore the row/col when printing/searching etc.
+    std::vector<float> rowMin_; ///< Smallest element in each row (cols > row) not ignored.
+    std::vector<int> rowNbr_;   ///< Column of smallest element in each row, -1 if none.
 #   ifdef _OPENMP
     std::vector<int> minRow_;
     std::vector<int> minCol_;
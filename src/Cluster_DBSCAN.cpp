@@ -77,10 +77,9 @@ int Cluster_DBSCAN::Cluster() {
   // Check if only need to calculate Kdist function(s)
   if (!kdist_.Empty()) {
     if (kdist_.Size() == 1)
-      ComputeKdist( kdist_.Front(), FrameDistances().FramesToCluster() );
+      return ComputeKdist( kdist_.Front(), FrameDistances().FramesToCluster() );
     else
-      ComputeKdistMap( kdist_, FrameDistances().FramesToCluster() );
-    return 0;
+      return ComputeKdistMap( kdist_, FrameDistances().FramesToCluster() );
   }
   // Actual clustering
   unsigned int nPtsToCluster = FrameDistances().FramesToCluster().size();
@@ -96,7 +95,9 @@ int Cluster_DBSCAN::Cluster() {
     if ( Status_[idx] == UNCLASSIFIED )
     {
       //IF ExpandCluster(SetOfPoints, Point, ClusterId, Eps, MinPts) THEN
-      if (ExpandCluster(idx, ClusterId))
+      int expanded = ExpandCluster(idx, ClusterId);
+      if (expanded < 0) return 1;
+      if (expanded > 0)
       //ClusterId := nextId(ClusterId)
         ClusterId++;
     }
@@ -120,10 +121,13 @@ int Cluster_DBSCAN::Cluster() {
 }
 
 // Cluster_DBSCAN::ExpandCluster()
-bool Cluster_DBSCAN::ExpandCluster(unsigned int point, int ClusterId)
+/** \return 1 if point is a core point of new cluster, 0 if point is noise,
+  *         -1 if pairwise distances could not be read.
+  */
+int Cluster_DBSCAN::ExpandCluster(unsigned int point, int ClusterId)
 {
   //seeds:=SetOfPoints.regionQuery(Point,Eps);
-  RegionQuery(seeds_, point);
+  if (RegionQuery(seeds_, point)) return -1;
 
   //IF seeds.size<MinPts THEN // no core point
   if ((int)seeds_.size() < minPoints_)
@@ -131,7 +135,7 @@ bool Cluster_DBSCAN::ExpandCluster(unsigned int point, int ClusterId)
     //SetOfPoint.changeClId(Point,NOISE);
     Status_[point] = NOISE;
     //RETURN False;
-    return false;
+    return 0;
   }
   else
   {
@@ -148,7 +152,7 @@ bool Cluster_DBSCAN::ExpandCluster(unsigned int point, int ClusterId)
       //currentP := seeds.first();
       int otherpoint = seeds_[idx];
       //result := SetOfPoints.regionQuery(currentP, Eps);
-      RegionQuery(result_, otherpoint);
+      if (RegionQuery(result_, otherpoint)) return -1;
       //IF result.size >= MinPts THEN
       if ( (int)result_.size() >= minPoints_ )
       {
@@ -178,24 +182,28 @@ bool Cluster_DBSCAN::ExpandCluster(unsigned int point, int ClusterId)
       //seeds.delete(currentP);
     }
     //END WHILE; // seeds <> Empty
-    return true;
+    return 1;
   }
 }
 
 // Cluster_DBSCAN::RegionQuery()
-void Cluster_DBSCAN::RegionQuery(Iarray& NeighborPts, int point) const
+int Cluster_DBSCAN::RegionQuery(Iarray& NeighborPts, int point)
 {
   NeighborPts.clear();
   // point and otherpoint are indices, not frame #s
-  int f1 = FrameDistances().FramesToCluster()[ point ];
+  frameRow_.resize( Status_.size() );
+  if (FrameDistances().GetRow( point, &frameRow_[0] )) {
+    mprinterr("Error: Could not get row %i of pairwise matrix.\n", point);
+    return 1;
+  }
   for (int otherpoint = 0; otherpoint < (int)Status_.size(); ++otherpoint)
   {
     if (point != otherpoint) {
-      int f2 = FrameDistances().FramesToCluster()[ otherpoint ];
-      if ( FrameDistances().GetFdist(f1, f2) < epsilon_ )
+      if ( frameRow_[otherpoint] < epsilon_ )
         NeighborPts.push_back( otherpoint );
     }
   }
+  return 0;
 }
 
 // Cluster_DBSCAN::ClusterResults()
@@ -301,23 +309,19 @@ void Cluster_DBSCAN::AddSievedFrames() {
 /** For each point p, calculate function Kdist(p) which is the distance of
   * the Kth nearest point to p.
   */
-void Cluster_DBSCAN::ComputeKdist( int Kval, std::vector<int> const& FramesToCluster ) const {
-  std::vector<double> dists;
+int Cluster_DBSCAN::ComputeKdist( int Kval, std::vector<int> const& FramesToCluster ) const {
+  std::vector<double> dists( FramesToCluster.size() );
   std::vector<double> Kdist;
-  dists.reserve( FramesToCluster.size() ); 
   Kdist.reserve( FramesToCluster.size() );
   std::string outfilename = k_prefix_ + "Kdist." + integerToString(Kval) + ".dat";
   mprintf("\tDBSCAN: Calculating Kdist(%i), output to %s\n", Kval, outfilename.c_str());
-  for (std::vector<int>::const_iterator point = FramesToCluster.begin();
-                                        point != FramesToCluster.end();
-                                        ++point)
+  for (unsigned int point = 0; point != FramesToCluster.size(); ++point)
   {
     // Store distances from this point
-    dists.clear();
-    for (std::vector<int>::const_iterator otherpoint = FramesToCluster.begin();
-                                          otherpoint != FramesToCluster.end();
-                                          ++otherpoint)
-      dists.push_back( FrameDistances().GetFdist(*point, *otherpoint) );
+    if (FrameDistances().GetRow( point, &dists[0] )) {
+      mprinterr("Error: Could not get row %u of pairwise matrix.\n", point);
+      return 1;
+    }
     // Sort distances - first dist should always be 0
     std::sort(dists.begin(), dists.end());
     Kdist.push_back( dists[Kval] );
@@ -332,13 +336,15 @@ void Cluster_DBSCAN::ComputeKdist( int Kval, std::vector<int> const& FramesToClu
                                              k != Kdist.rend(); ++k, ++ik)
     Outfile.Printf("%8u %12.4f\n", ik, *k);
   Outfile.CloseFile();
+  return 0;
 }
 
 // Cluster_DBSCAN::ComputeKdistMap()
-void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals, 
-                                      std::vector<int> const& FramesToCluster ) const
+int Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals, 
+                                     std::vector<int> const& FramesToCluster ) const
 {
-  int pt1_idx, pt2_idx, d_idx, point;
+  int pt1_idx, d_idx;
+  int nerr = 0;
   mprintf("\tCalculating Kdist map for %s\n", Kvals.RangeArg());
   double* kdist_array; // Store distance of pt1 to every other point.
   int nframes = (int)FramesToCluster.size();
@@ -348,7 +354,7 @@ void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals,
     if (*kval < 1 || *kval >= nframes) {
       mprinterr("Error: Kdist value %i is out of range (1 <= Kdist < %i)\n",
                  *kval, nframes);
-      return;
+      return 1;
     }
   int nvals = (int)Kvals.Size();
   double** KMAP; // KMAP[i] has the ith nearest point for each point.
@@ -357,7 +363,7 @@ void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals,
     KMAP[i] = new double[ nframes ];
   ParallelProgress progress( nframes );
 # ifdef _OPENMP
-# pragma omp parallel private(pt1_idx, pt2_idx, d_idx, kval, point, kdist_array) firstprivate(progress)
+# pragma omp parallel private(pt1_idx, d_idx, kval, kdist_array) firstprivate(progress) reduction(+ : nerr)
   {
   progress.SetThread( omp_get_thread_num() );
 #endif
@@ -368,11 +374,11 @@ void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals,
   for (pt1_idx = 0; pt1_idx < nframes; pt1_idx++) // X
   {
     progress.Update( pt1_idx );
-    point = FramesToCluster[pt1_idx];
-    d_idx = 0;
     // Store distances from pt1 to pt2
-    for (pt2_idx = 0; pt2_idx != nframes; pt2_idx++)
-      kdist_array[d_idx++] = FrameDistances().GetFdist(point, FramesToCluster[pt2_idx]);
+    if (FrameDistances().GetRow( pt1_idx, kdist_array )) {
+      nerr++;
+      continue;
+    }
     // Sort distances; will be smallest to largest
     std::sort( kdist_array, kdist_array + nframes );
     // Save the distance of specified nearest neighbors to this point.
@@ -385,6 +391,13 @@ void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals,
   } // END omp parallel
 # endif
   progress.Finish();
+  if (nerr > 0) {
+    mprinterr("Error: Could not get %i rows of pairwise matrix.\n", nerr);
+    for (int i = 0; i != nvals; i++)
+      delete[] KMAP[i];
+    delete[] KMAP;
+    return 1;
+  }
   // Sort all of the individual kdist plots, smallest to largest.
   for (int i = 0; i != nvals; i++)
     std::sort(KMAP[i], KMAP[i] + nframes);
@@ -407,11 +420,12 @@ void Cluster_DBSCAN::ComputeKdistMap( Range const& Kvals,
   // This means for each value of K the point with the furthest Kth-nearest
   // neighbor etc.
   CpptrajFile maxfile;
-  if (maxfile.OpenWrite(k_prefix_ + "Kmatrix.max.dat")) return;
+  if (maxfile.OpenWrite(k_prefix_ + "Kmatrix.max.dat")) return 1;
   maxfile.Printf("%-12s %12s %12s\n", "#Kval", "MaxD", "MinD");
   d_idx = 0;
   for (kval = Kvals.begin(); kval != Kvals.end(); ++kval, d_idx++)
     maxfile.Printf("%12i %12g %12g\n", *kval, kmatrix.GetElement(0, d_idx),
                    kmatrix.GetElement(nframes-1, d_idx));
   maxfile.CloseFile();
+  return 0;
 }
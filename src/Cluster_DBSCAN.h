@@ -19,14 +19,15 @@ class Cluster_DBSCAN : public ClusterList {
   private:
     typedef std::vector<int> Iarray;
 
-    bool ExpandCluster(unsigned int, int);
-    void RegionQuery(Iarray&, int) const;
-    void ComputeKdist( int, std::vector<int> const& ) const ;
-    void ComputeKdistMap( Range const&, std::vector<int> const& ) const ;
+    int ExpandCluster(unsigned int, int);
+    int RegionQuery(Iarray&, int);
+    int ComputeKdist( int, std::vector<int> const& ) const ;
+    int ComputeKdistMap( Range const&, std::vector<int> const& ) const ;
 
     Iarray Status_;        ///< Status of each point: unclassified, noise, or in cluster
     Iarray seeds_;         ///< Results from first RegionQuery
     Iarray result_;        ///< Results from seed RegionQueries
+    std::vector<double> frameRow_; ///< Distances from current point to every other point.
     int minPoints_;        ///< Min # of points needed to make a cluster.
     double epsilon_;       ///< Distance criterion for cluster formation.
     Range kdist_;
@@ -91,8 +91,18 @@ void Cluster_DPeaks::ClusteringInfo() const {
     mprintf("\t\tNo clustering, only writing density versus distance file.\n");
 }
 
+// Cluster_DPeaks::FetchRow()
+int Cluster_DPeaks::FetchRow(int f) {
+  if (FrameDistances().GetRow( FrameDistances().FrameToRow(f), &frameRow_[0] )) {
+    mprinterr("Error: Could not get pairwise matrix row for frame %i.\n", f + 1);
+    return 1;
+  }
+  return 0;
+}
+
 int Cluster_DPeaks::Cluster() {
   int err = 0;
+  frameRow_.resize( FrameDistances().Nrows() );
   // Calculate local densities
   if ( useGaussianKernel_ )
     err = Cluster_GaussianKernel();
@@ -158,6 +168,7 @@ int Cluster_DPeaks::Cluster() {
       for (unsigned int i0 = *idx0; i0 != *(idx0+1); ++i0)
       {
         Cpoint const& point = Points_[i0];
+        if (FetchRow( point.Fnum() )) return 1;
         // Look at each other cluster
         for (Parray::const_iterator idx1 = idx0 + 2;
                                     idx1 != C_start_stop.end(); idx1 += 2)
@@ -167,7 +178,7 @@ int Cluster_DPeaks::Cluster() {
           for (unsigned int i1 = *idx1; i1 != *(idx1+1); i1++)
           {
             Cpoint const& other_point = Points_[i1];
-            if (FrameDistances().GetFdist(point.Fnum(), other_point.Fnum()) < epsilon_) {
+            if (RowDist(other_point.Fnum()) < epsilon_) {
               //mprintf("\tBorder frame: %i (to cluster %i frame %i)\n",
               //        point.Fnum() + 1, c1, other_point.Fnum() + 1);
               borderIndices[c0].push_back( i0 );
@@ -249,8 +260,14 @@ int Cluster_DPeaks::Cluster_GaussianKernel() {
   // Sort distances
   std::vector<float> Distances;
   Distances.reserve( FrameDistances().Nelements() );
-  for (unsigned int idx = 0; idx != FrameDistances().Nelements(); idx++)
-    Distances.push_back( FrameDistances().GetElement(idx) );
+  for (unsigned int row = 0; row != FrameDistances().Nrows(); row++) {
+    if (FrameDistances().GetUpperRow( row, &frameRow_[0] )) {
+      mprinterr("Error: Could not get row %u of pairwise matrix.\n", row);
+      return 1;
+    }
+    for (unsigned int col = row + 1; col != FrameDistances().Nrows(); col++)
+      Distances.push_back( frameRow_[col] );
+  }
   std::sort( Distances.begin(), Distances.end() );
   unsigned int idx = (unsigned int)((double)Distances.size() * 0.02);
   double bandwidth = (double)Distances[idx];
@@ -259,8 +276,9 @@ int Cluster_DPeaks::Cluster_GaussianKernel() {
   // Density via Gaussian kernel
   double maxDist = -1.0;
   for (unsigned int i = 0; i != Points_.size(); i++) {
+    if (FetchRow( Points_[i].Fnum() )) return 1;
     for (unsigned int j = i+1; j != Points_.size(); j++) {
-      double dist = FrameDistances().GetFdist(Points_[i].Fnum(), Points_[j].Fnum());
+      double dist = RowDist( Points_[j].Fnum() );
       maxDist = std::max( maxDist, dist );
       dist /= bandwidth;
       double gk = exp(-(dist *dist));
@@ -291,9 +309,10 @@ int Cluster_DPeaks::Cluster_GaussianKernel() {
   for (unsigned int ii = 1; ii != Points_.size(); ii++) {
     int ord_i = Points_[ii].Oidx();
     Points_[ord_i].SetDist( maxDist );
+    if (FetchRow( Points_[ord_i].Fnum() )) return 1;
     for (unsigned int jj = 0; jj != ii; jj++) {
       int ord_j = Points_[jj].Oidx();
-      double dist = FrameDistances().GetFdist(Points_[ord_i].Fnum(), Points_[ord_j].Fnum());
+      double dist = RowDist( Points_[ord_j].Fnum() );
       if (dist < Points_[ord_i].Dist()) {
         Points_[ord_i].SetDist( dist );
         Points_[ord_j].SetNearestIdx( ord_j );
@@ -334,11 +353,12 @@ int Cluster_DPeaks::Cluster_DiscreteDensity() {
   {
     cluster_progress.Update(point0 - Points_.begin());
     int density = 0;
+    if (FetchRow( point0->Fnum() )) return 1;
     for (Carray::const_iterator point1 = Points_.begin();
                                 point1 != Points_.end(); ++point1)
     {
       if (point0 != point1) {
-        double dist = FrameDistances().GetFdist(point0->Fnum(), point1->Fnum());
+        double dist = RowDist( point1->Fnum() );
         maxDist = std::max(maxDist, dist);
         if ( dist < epsilon_ )
           density++;
@@ -372,10 +392,11 @@ int Cluster_DPeaks::Cluster_DiscreteDensity() {
     //mprintf("\nDBG:\tSearching for nearest neighbor to idx %u with higher density than %i.\n",
     //        idx0, point0.PointsWithinEps());
     // Since array is sorted by density we can start at the next point.
+    if (FetchRow( point0.Fnum() )) return 1;
     for (unsigned int idx1 = idx0+1; idx1 != Points_.size(); idx1++)
     {
       Cpoint const& point1 = Points_[idx1];
-      double dist1_2 = FrameDistances().GetFdist(point0.Fnum(), point1.Fnum());
+      double dist1_2 = RowDist( point1.Fnum() );
       if (point1.PointsWithinEps() > point0.PointsWithinEps())
       {
         if (dist1_2 < min_dist) {
@@ -19,6 +19,10 @@ class Cluster_DPeaks : public ClusterList {
     int Cluster_DiscreteDensity();
     int ChoosePointsAutomatically();
     int ChoosePointsManually();
+    /// Fetch pairwise distances from given frame to all frames.
+    int FetchRow(int);
+    /// \return Distance from frame last passed to FetchRow() to given frame.
+    double RowDist(int f) const { return frameRow_[ FrameDistances().FrameToRow(f) ]; }
 
     enum ChooseType {PLOT_ONLY = 0, MANUAL, AUTOMATIC};
     std::string dvdfile_;
@@ -108,5 +112,6 @@ class Cluster_DPeaks : public ClusterList {
     };
     typedef std::vector<Cpoint> Carray;
     Carray Points_; ///< Hold info for each point to be clustered.
+    std::vector<double> frameRow_; ///< Hold one row of the pairwise distance matrix.
 };
 #endif
@@ -8,12 +8,13 @@ Cluster_HierAgglo::Cluster_HierAgglo() :
   nclusters_(-1),
   epsilon_(-1.0),
   linkage_(AVERAGELINK),
+  engine_(SCAN),
   includeSievedFrames_(false)
 {}
 
 void Cluster_HierAgglo::Help() {
   mprintf("\t[hieragglo [epsilon <e>] [clusters <n>] [linkage|averagelinkage|complete]\n"
-          "\t  [epsilonplot <file>] [includesieved_cdist]]\n");
+          "\t  [epsilonplot <file>] [includesieved_cdist] [engine {scan|rowmin}]]\n");
 }
 
 static const char* LinkageString[] = {
@@ -28,6 +29,15 @@ int Cluster_HierAgglo::SetupCluster(ArgList& analyzeArgs) {
   else if (analyzeArgs.hasKey("complete"))       linkage_ = COMPLETELINK;
   else linkage_ = AVERAGELINK; // DEFAULT linkage
   includeSievedFrames_ = analyzeArgs.hasKey("includesieved_cdist");
+  std::string engine = analyzeArgs.GetStringKey("engine");
+  if (engine.empty() || engine == "scan")
+    engine_ = SCAN;
+  else if (engine == "rowmin")
+    engine_ = ROWMIN;
+  else {
+    mprinterr("Error: Unrecognized hieragglo engine '%s'\n", engine.c_str());
+    return 1;
+  }
   std::string epsilonPlot = analyzeArgs.GetStringKey("epsilonplot");
   if (!epsilonPlot.empty()) {
     if (eps_v_n_.OpenWrite( epsilonPlot )) return 1;
@@ -49,6 +59,13 @@ void Cluster_HierAgglo::ClusteringInfo() const {
   if (epsilon_ != -1.0)
     mprintf(" epsilon %.3f,",epsilon_);
   mprintf(" %s.\n", LinkageString[linkage_]);
+  if (engine_ == ROWMIN) {
+    mprintf("\tClosest clusters found from per-row minima");
+    if (linkage_ == AVERAGELINK)
+      mprintf(".\n");
+    else
+      mprintf(", distances updated with\n\t  Lance-Williams formula.\n");
+  }
   if (eps_v_n_.IsOpen())
     mprintf("\tWriting epsilon vs # clusters to '%s'\n", eps_v_n_.Filename().full());
   if (includeSievedFrames_)
@@ -60,24 +77,28 @@ void Cluster_HierAgglo::ClusteringInfo() const {
 
 /** Set up the initial distances between clusters. Should be called before 
   * any clustering is performed. 
+  * \return 0 if successful, 1 if the pairwise matrix could not be read.
   */
-void Cluster_HierAgglo::InitializeClusterDistances() {
+int Cluster_HierAgglo::InitializeClusterDistances() {
   // Sets up matrix and ignore array
   ClusterDistances_.SetupMatrix( clusters_.size() );
   // Build initial cluster distances. Take advantage of the fact that
   // the initial cluster layout is the same as the pairwise array.
   unsigned int total_frames = FrameDistances().FramesToCluster().size();
+  frameRow_.resize( total_frames );
   for (unsigned int idx1 = 0; idx1 != total_frames; idx1++) {
-    int f1 = FrameDistances().FramesToCluster()[ idx1 ];
-    for (unsigned int idx2 = idx1 + 1; idx2 != total_frames; idx2++) {
-      int f2 = FrameDistances().FramesToCluster()[ idx2 ];
-      ClusterDistances_.SetCdist( idx1, idx2, FrameDistances().GetFdist(f1, f2) );
+    if (FrameDistances().GetUpperRow( idx1, &frameRow_[0] )) {
+      mprinterr("Error: Could not get row %u of pairwise matrix.\n", idx1);
+      return 1;
     }
+    for (unsigned int idx2 = idx1 + 1; idx2 != total_frames; idx2++)
+      ClusterDistances_.SetCdist( idx1, idx2, frameRow_[idx2] );
   }
   if (debug_ > 1) {
     mprintf("CLUSTER: INITIAL CLUSTER DISTANCES:\n");
     ClusterDistances_.PrintElements();
   }
+  return 0;
 }
 
 /** Cluster using a hierarchical agglomerative (bottom-up) approach. All frames
@@ -102,7 +123,9 @@ int Cluster_HierAgglo::Cluster() {
   }
   mprintf("\t%i initial clusters.\n", Nclusters());
   // Build initial cluster distance matrix.
-  InitializeClusterDistances();
+  if (InitializeClusterDistances()) return 1;
+  if (engine_ == ROWMIN)
+    ClusterDistances_.InitRowMin();
   // DEBUG - print initial clusters
   if (debug_ > 1)
     PrintClusters();
@@ -110,7 +133,9 @@ int Cluster_HierAgglo::Cluster() {
   int iterations = 0;
   while (!clusteringComplete) {
     // Merge 2 closest clusters. Clustering complete if closest dist > epsilon.
-    if (MergeClosest()) break;
+    int err = MergeClosest();
+    if (err < 0) return 1;
+    if (err > 0) break;
     // If the target number of clusters is reached we are done
     if (Nclusters() <= nclusters_) {
       mprintf("\n\tTarget # of clusters (%i) met (%u), clustering complete.\n", nclusters_,
@@ -138,14 +163,21 @@ void Cluster_HierAgglo::Timing(double total) const {
 }
 #endif
 
-/** Find and merge the two closest clusters. */
+/** Find and merge the two closest clusters.
+  * \return 0 if clusters were merged, 1 if clustering is complete, -1 if
+  *         new distances could not be calculated.
+  */
 int Cluster_HierAgglo::MergeClosest() {
   int C1, C2;
   // Find the minimum distance between clusters. C1 will be lower than C2.
 # ifdef TIMER
   time_findMin_.Start();
 # endif
-  double min = ClusterDistances_.FindMin(C1, C2);
+  double min;
+  if (engine_ == ROWMIN)
+    min = ClusterDistances_.FindRowMin(C1, C2);
+  else
+    min = ClusterDistances_.FindMin(C1, C2);
 # ifdef TIMER
   time_findMin_.Stop();
 # endif
@@ -199,14 +231,28 @@ int Cluster_HierAgglo::MergeClosest() {
 # ifdef TIMER
   time_calcLinkage_.Start();
 # endif
-  switch (linkage_) {
-    case AVERAGELINK : calcAvgDist(C1_it); break;
-    case SINGLELINK  : calcMinDist(C1_it); break;
-    case COMPLETELINK: calcMaxDist(C1_it); break;
+  int err = 0;
+  if (engine_ == ROWMIN) {
+    // Average-linkage distances are recalculated from frame distances so
+    // they are identical to the scan engine; a Lance-Williams update of
+    // the stored averages could change merge order near ties.
+    if (linkage_ == AVERAGELINK)
+      err = calcAvgDist(C1_it);
+    else
+      calcLanceWilliams(C1_it, C2);
+    if (err == 0)
+      ClusterDistances_.UpdateRowMin(C1, C2);
+  } else {
+    switch (linkage_) {
+      case AVERAGELINK : err = calcAvgDist(C1_it); break;
+      case SINGLELINK  : err = calcMinDist(C1_it); break;
+      case COMPLETELINK: err = calcMaxDist(C1_it); break;
+    }
   }
 # ifdef TIMER
   time_calcLinkage_.Stop();
 # endif
+  if (err != 0) return -1;
   if (debug_>2) {
     mprintf("NEW CLUSTER DISTANCES:\n");
     ClusterDistances_.PrintElements();
@@ -273,95 +319,139 @@ double Cluster_HierAgglo::ClusterDistance(ClusterNode const& C1, ClusterNode con
 }
 
 /** Calculate the minimum distance between frames in cluster specified by
-  * iterator C1 and frames in all other clusters.
+  * iterator C1 and frames in all other clusters. The pairwise matrix row
+  * for each frame in C1 is fetched once and used for all other clusters.
   */
-void Cluster_HierAgglo::calcMinDist(cluster_it& C1_it)
+int Cluster_HierAgglo::calcMinDist(cluster_it& C1_it)
 {
   // All cluster distances to C1 must be recalcd.
-  for (cluster_it C2_it = clusters_.begin();
-                  C2_it != clusters_.end(); ++C2_it)
+  std::vector<double> min( clusters_.size(), DBL_MAX );
+  for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
+                                   c1frames != C1_it->endframe();
+                                   ++c1frames)
   {
-    if (C2_it == C1_it) continue;
-    //mprintf("\t\tRecalc distance between %i and %i:\n",C1,newc2);
-    // Pick the minimum distance between newc2 and C1
-    double min = DBL_MAX;
-    for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
-                                     c1frames != C1_it->endframe();
-                                     ++c1frames)
+    if (FrameDistances().GetRow( FrameDistances().FrameToRow(*c1frames), &frameRow_[0] )) {
+      mprinterr("Error: Could not get pairwise matrix row for frame %i.\n", *c1frames + 1);
+      return 1;
+    }
+    std::vector<double>::iterator cmin = min.begin();
+    for (cluster_it C2_it = clusters_.begin();
+                    C2_it != clusters_.end(); ++C2_it, ++cmin)
     {
+      if (C2_it == C1_it) continue;
+      // Pick the minimum distance between C2 and C1
       for (ClusterNode::frame_iterator c2frames = C2_it->beginframe();
                                        c2frames != C2_it->endframe();
                                        ++c2frames)
       {
-        double Dist = FrameDistances().GetFdist(*c1frames, *c2frames);
-        //mprintf("\t\t\tFrame %i to frame %i = %f\n",*c1frames,*c2frames,Dist);
-        if ( Dist < min ) min = Dist;
+        double Dist = frameRow_[ FrameDistances().FrameToRow(*c2frames) ];
+        if ( Dist < *cmin ) *cmin = Dist;
       }
     }
-    //mprintf("\t\tMin distance between %i and %i: %f\n",C1,newc2,min);
-    ClusterDistances_.SetCdist( C1_it->Num(), C2_it->Num(), min );
   }
+  std::vector<double>::const_iterator cmin = min.begin();
+  for (cluster_it C2_it = clusters_.begin();
+                  C2_it != clusters_.end(); ++C2_it, ++cmin)
+    if (C2_it != C1_it)
+      ClusterDistances_.SetCdist( C1_it->Num(), C2_it->Num(), *cmin );
+  return 0;
 }
 
 /** Calculate the maximum distance between frames in cluster specified by
   * iterator C1 and frames in all other clusters.
   */
-void Cluster_HierAgglo::calcMaxDist(cluster_it& C1_it)
+int Cluster_HierAgglo::calcMaxDist(cluster_it& C1_it)
 {
   // All cluster distances to C1 must be recalcd.
-  for (cluster_it C2_it = clusters_.begin();
-                  C2_it != clusters_.end(); ++C2_it)
+  std::vector<double> max( clusters_.size(), -1.0 );
+  for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
+                                   c1frames != C1_it->endframe();
+                                   ++c1frames)
   {
-    if (C2_it == C1_it) continue;
-    //mprintf("\t\tRecalc distance between %i and %i:\n",C1,newc2);
-    // Pick the maximum distance between newc2 and C1
-    double max = -1.0;
-    for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
-                                     c1frames != C1_it->endframe();
-                                     ++c1frames)
+    if (FrameDistances().GetRow( FrameDistances().FrameToRow(*c1frames), &frameRow_[0] )) {
+      mprinterr("Error: Could not get pairwise matrix row for frame %i.\n", *c1frames + 1);
+      return 1;
+    }
+    std::vector<double>::iterator cmax = max.begin();
+    for (cluster_it C2_it = clusters_.begin();
+                    C2_it != clusters_.end(); ++C2_it, ++cmax)
     {
+      if (C2_it == C1_it) continue;
+      // Pick the maximum distance between C2 and C1
       for (ClusterNode::frame_iterator c2frames = C2_it->beginframe();
                                        c2frames != C2_it->endframe();
                                        ++c2frames)
       {
-        double Dist = FrameDistances().GetFdist(*c1frames, *c2frames);
-        //mprintf("\t\t\tFrame %i to frame %i = %f\n",*c1frames,*c2frames,Dist);
-        if ( Dist > max ) max = Dist;
+        double Dist = frameRow_[ FrameDistances().FrameToRow(*c2frames) ];
+        if ( Dist > *cmax ) *cmax = Dist;
       }
     }
-    //mprintf("\t\tMax distance between %i and %i: %f\n",C1,newc2,max);
-    ClusterDistances_.SetCdist( C1_it->Num(), C2_it->Num(), max );
   }
+  std::vector<double>::const_iterator cmax = max.begin();
+  for (cluster_it C2_it = clusters_.begin();
+                  C2_it != clusters_.end(); ++C2_it, ++cmax)
+    if (C2_it != C1_it)
+      ClusterDistances_.SetCdist( C1_it->Num(), C2_it->Num(), *cmax );
+  return 0;
 }
 
 /** Calculate the average distance between frames in cluster specified by
   * iterator C1 and frames in all other clusters.
   */
-void Cluster_HierAgglo::calcAvgDist(cluster_it& C1_it)
+int Cluster_HierAgglo::calcAvgDist(cluster_it& C1_it)
 {
   // All cluster distances to C1 must be recalcd.
-  for (cluster_it C2_it = clusters_.begin();
-                  C2_it != clusters_.end(); ++C2_it)
+  std::vector<double> sumDist( clusters_.size(), 0.0 );
+  for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
+                                   c1frames != C1_it->endframe();
+                                   ++c1frames)
   {
-    if (C2_it == C1_it) continue;
-    //mprintf("\t\tRecalc distance between %i and %i:\n",(*C1_it).Num(),(*C2_it).Num());
-    // Pick the minimum distance between newc2 and C1
-    double sumDist = 0;
-    for (ClusterNode::frame_iterator c1frames = C1_it->beginframe();
-                                     c1frames != C1_it->endframe();
-                                     ++c1frames)
+    if (FrameDistances().GetRow( FrameDistances().FrameToRow(*c1frames), &frameRow_[0] )) {
+      mprinterr("Error: Could not get pairwise matrix row for frame %i.\n", *c1frames + 1);
+      return 1;
+    }
+    std::vector<double>::iterator csum = sumDist.begin();
+    for (cluster_it C2_it = clusters_.begin();
+                    C2_it != clusters_.end(); ++C2_it, ++csum)
     {
+      if (C2_it == C1_it) continue;
       for (ClusterNode::frame_iterator c2frames = C2_it->beginframe();
                                        c2frames != C2_it->endframe();
                                        ++c2frames)
-      {
-        double Dist = FrameDistances().GetFdist(*c1frames, *c2frames);
-        //mprintf("\t\t\tFrame %i to frame %i = %f\n",*c1frames,*c2frames,Dist);
-        sumDist += Dist;
-      }
+        *csum += frameRow_[ FrameDistances().FrameToRow(*c2frames) ];
     }
-    double Dist = sumDist / (double)(C1_it->Nframes() * C2_it->Nframes());
+  }
+  std::vector<double>::const_iterator csum = sumDist.begin();
+  for (cluster_it C2_it = clusters_.begin();
+                  C2_it != clusters_.end(); ++C2_it, ++csum)
+  {
+    if (C2_it == C1_it) continue;
+    double Dist = *csum / (double)(C1_it->Nframes() * C2_it->Nframes());
     //mprintf("\t\tAvg distance between %i and %i: %f\n",(*C1_it).Num(),(*C2_it).Num(),Dist);
     ClusterDistances_.SetCdist( C1_it->Num(), C2_it->Num(), Dist );
   }
+  return 0;
+}
+
+/** Calculate single- or complete-linkage distances between newly merged
+  * cluster C1 (formerly C1 and C2) and all other clusters from the previous
+  * distances to C1 and C2, without looking at frame distances. The results
+  * are exact since only a min or max of stored values is taken.
+  */
+void Cluster_HierAgglo::calcLanceWilliams(cluster_it& C1_it, int C2)
+{
+  int C1 = C1_it->Num();
+  for (cluster_it Ck_it = clusters_.begin(); Ck_it != clusters_.end(); ++Ck_it)
+  {
+    if (Ck_it == C1_it) continue;
+    int Ck = Ck_it->Num();
+    double d1 = ClusterDistances_.GetCdist( C1, Ck );
+    double d2 = ClusterDistances_.GetCdist( C2, Ck );
+    double Dist;
+    if (linkage_ == SINGLELINK)
+      Dist = std::min( d1, d2 );
+    else
+      Dist = std::max( d1, d2 );
+    ClusterDistances_.SetCdist( C1, Ck, Dist );
+  }
 }
@@ -20,20 +20,25 @@ class Cluster_HierAgglo : public ClusterList {
     void AddSievedFrames() { AddSievedFramesByCentroid(); }
     void ClusterResults(CpptrajFile&) const;
   private:
-    void InitializeClusterDistances();
+    int InitializeClusterDistances();
     int MergeClosest();
-    void calcMinDist(cluster_it&);
-    void calcMaxDist(cluster_it&);
-    void calcAvgDist(cluster_it&);
+    int calcMinDist(cluster_it&);
+    int calcMaxDist(cluster_it&);
+    int calcAvgDist(cluster_it&);
+    void calcLanceWilliams(cluster_it&, int);
 
     /// Type of distance calculation between clusters.
     enum LINKAGETYPE  { SINGLELINK = 0, AVERAGELINK, COMPLETELINK };
+    /// How closest clusters are found and new distances calculated.
+    enum ENGINETYPE   { SCAN = 0, ROWMIN };
     int nclusters_;       ///< Target # of clusters.
     double epsilon_;      ///< Once the min distance between clusters is > epsilon, stop.
     LINKAGETYPE linkage_; ///< Cluster Linkage type.
+    ENGINETYPE engine_;   ///< Clustering engine.
     bool includeSievedFrames_; ///< If true include sieved frames in ClusterDistance() calc.
     CpptrajFile eps_v_n_; ///< Write epsilon vs # clusters.
     ClusterMatrix ClusterDistances_;
+    std::vector<double> frameRow_; ///< Hold one row of the pairwise distance matrix.
 #   ifdef TIMER
     Timer time_findMin_;
     Timer time_mergeFrames_;
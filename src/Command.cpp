@@ -138,6 +138,7 @@
 #include "Action_LipidOrder.h"
 #include "Action_InfraredSpectrum.h"
 #include "Action_XtalSymm.h"
+#include "Action_ResEnergy.h"
 // ----- ANALYSIS --------------------------------------------------------------
 #include "Analysis_Hist.h"
 #include "Analysis_Corr.h"
@@ -205,6 +206,7 @@ void Command::Init() {
   Command::AddCmd( new Exec_DataFilter(),      Cmd::EXE, 1, "datafilter" );
   Command::AddCmd( new Exec_DataSetCmd(),      Cmd::EXE, 1, "dataset" );
   Command::AddCmd( new Exec_EnsFileExt(),      Cmd::EXE, 1, "ensextension" );
+  Command::AddCmd( new Exec_FrameThreads(),    Cmd::EXE, 1, "framethreads" );
   Command::AddCmd( new Exec_GenerateAmberRst(),Cmd::EXE, 1, "rst" );
   Command::AddCmd( new Exec_Help(),            Cmd::EXE, 1, "help" );
   Command::AddCmd( new Exec_ListAll(),         Cmd::EXE, 1, "list" );
@@ -220,6 +222,7 @@ void Command::Init() {
   Command::AddCmd( new Exec_ReadInput(),       Cmd::EXE, 1, "readinput" );
   Command::AddCmd( new Exec_RemoveData(),      Cmd::EXE, 1, "removedata" );
   Command::AddCmd( new Exec_Run(),             Cmd::EXE, 2, "go", "run" );
+  Command::AddCmd( new Exec_RunTiming(),       Cmd::EXE, 1, "runtiming" );
   Command::AddCmd( new Exec_RunAnalysis(),     Cmd::EXE, 1, "runanalysis" );
   Command::AddCmd( new Exec_SelectAtoms(),     Cmd::EXE, 1, "select" );
   Command::AddCmd( new Exec_SelectDS(),        Cmd::EXE, 1, "selectds" );
@@ -337,6 +340,7 @@ void Command::Init() {
   Command::AddCmd( new Action_RandomizeIons(), Cmd::ACT, 1, "randomizeions" );
   Command::AddCmd( new Action_Remap(),         Cmd::ACT, 1, "remap" );
   Command::AddCmd( new Action_ReplicateCell(), Cmd::ACT, 1, "replicatecell" );
+  Command::AddCmd( new Action_ResEnergy(),     Cmd::ACT, 1, "resenergy" );
   Command::AddCmd( new Action_Rmsd(),          Cmd::ACT, 2, "rms", "rmsd" );
   Command::AddCmd( new Action_Rotate(),        Cmd::ACT, 1, "rotate" );
   Command::AddCmd( new Action_RunningAvg(),    Cmd::ACT, 2, "runavg", "runningaverage" );
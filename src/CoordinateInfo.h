@@ -9,6 +9,10 @@
 /// All metadata associated with a Frame.
 class CoordinateInfo {
   public:
+    /// Optional Frame components (besides coordinates and box); combine as bit flags.
+    enum ComponentType { VELOCITY = 0x1, FORCE = 0x2, TEMPERATURE = 0x4, TIME = 0x8,
+                         REPLICA = 0x10, ///< Replica indices and REMD values.
+                         NO_COMPONENTS = 0x0, ALL_COMPONENTS = 0x1f };
     /// CONSTRUCTOR
     CoordinateInfo();
     /// CONSTRUCTOR - box, velocity, temperature, time
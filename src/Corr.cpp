@@ -1,4 +1,7 @@
 #include "Corr.h"
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 // CorrF_Direct::CorrSetup()
 int CorrF_Direct::CorrSetup(int stepsIn) {
   nsteps_ = stepsIn;
@@ -80,3 +83,142 @@ void CorrF_FFT::CrossCorr(ComplexArray& data1, ComplexArray& data2) {
   // Normalize with fft_size (since not done in inverse FFT routine)
   data1.Normalize( 1.0 / (double)pubfft_.size() );
 }
+
+// -----------------------------------------------------------------------------
+/** \return Number of OpenMP threads (1 if no OpenMP). */
+int CorrF_Batch::NumThreads() {
+  int numthreads = 1;
+# ifdef _OPENMP
+# pragma omp parallel
+  {
+  if (omp_get_thread_num() == 0)
+    numthreads = omp_get_num_threads();
+  }
+# endif
+  return numthreads;
+}
+
+// CorrF_Batch::Transform()
+int CorrF_Batch::Transform(ArrayType const& arrays) {
+  spectra_.clear();
+  if (arrays.empty()) return 0;
+  int maxlen = 2;
+  for (ArrayType::const_iterator arr = arrays.begin(); arr != arrays.end(); ++arr)
+    if ((int)arr->size() > maxlen) maxlen = (int)arr->size();
+  // Each thread needs its own FFT; memory must be allocated outside the
+  // OpenMP parallel block for FFTW to work properly.
+  int numthreads = NumThreads();
+  std::vector<PubFFT> thread_fft( numthreads );
+  for (int t = 0; t != numthreads; t++)
+    if (thread_fft[t].SetupFFT_NextPowerOf2( maxlen )) return 1;
+  fftsize_ = thread_fft[0].size();
+  nhalf_ = fftsize_ / 2 + 1;
+  spectra_.resize( arrays.size() );
+  std::vector<ComplexArray> thread_data( numthreads );
+  for (int t = 0; t != numthreads; t++)
+    thread_data[t].Allocate( fftsize_ );
+  int narrays = (int)arrays.size();
+  int idx;
+  int mythread = 0;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, mythread)
+  {
+  mythread = omp_get_thread_num();
+# pragma omp for schedule(dynamic)
+# endif
+  for (idx = 0; idx < narrays; idx++) {
+    ComplexArray& data = thread_data[mythread];
+    Darray const& arr = arrays[idx];
+    int len = (int)arr.size();
+    for (int i = 0; i < len; i++) {
+      data[2*i  ] = arr[i];
+      data[2*i+1] = 0.0;
+    }
+    data.PadWithZero( len );
+    thread_fft[mythread].Forward( data );
+    spectra_[idx].assign( data.CAptr(), data.CAptr() + 2 * nhalf_ );
+  }
+# ifdef _OPENMP
+  } // END omp parallel
+# endif
+  return 0;
+}
+
+/** Since the spectrum of each pair, F(a)* x F(b), is Hermitian only half of
+  * it is calculated. The spectra of two pairs are combined as A + iB so
+  * that after the inverse FFT the real part is the correlation of the first
+  * pair and the imaginary part is the correlation of the second.
+  * \param pairs Indices of arrays (in order given to Transform()) to correlate.
+  * \param lagmax Number of lags to calculate.
+  * \param output For each pair, array with room for lagmax values.
+  */
+int CorrF_Batch::Correlate(PairArray const& pairs, int lagmax, Parray const& output) {
+  if (pairs.size() != output.size()) return 1;
+  if (lagmax > fftsize_ / 2) return 1;
+  int numthreads = NumThreads();
+  std::vector<PubFFT> thread_fft( numthreads );
+  std::vector<ComplexArray> thread_data( numthreads );
+  for (int t = 0; t != numthreads; t++) {
+    if (thread_fft[t].SetupFFTforN( fftsize_ )) return 1;
+    thread_data[t].Allocate( fftsize_ );
+  }
+  // Not done in inverse FFT routine
+  double norm = 1.0 / (double)fftsize_;
+  int ncombined = ((int)pairs.size() + 1) / 2;
+  int idx;
+  int mythread = 0;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, mythread)
+  {
+  mythread = omp_get_thread_num();
+# pragma omp for schedule(dynamic)
+# endif
+  for (idx = 0; idx < ncombined; idx++) {
+    ComplexArray& data = thread_data[mythread];
+    unsigned int p0 = 2 * idx;
+    unsigned int p1 = p0 + 1;
+    bool hasSecond = (p1 < pairs.size());
+    const double* a0 = &(spectra_[pairs[p0].first][0]);
+    const double* b0 = &(spectra_[pairs[p0].second][0]);
+    const double* a1 = 0;
+    const double* b1 = 0;
+    if (hasSecond) {
+      a1 = &(spectra_[pairs[p1].first][0]);
+      b1 = &(spectra_[pairs[p1].second][0]);
+    }
+    for (int k = 0; k < nhalf_; k++) {
+      int k2 = 2 * k;
+      // A = F(a)* x F(b)
+      double Are = a0[k2] * b0[k2] + a0[k2+1] * b0[k2+1];
+      double Aim = a0[k2] * b0[k2+1] - a0[k2+1] * b0[k2];
+      double Bre = 0.0;
+      double Bim = 0.0;
+      if (hasSecond) {
+        Bre = a1[k2] * b1[k2] + a1[k2+1] * b1[k2+1];
+        Bim = a1[k2] * b1[k2+1] - a1[k2+1] * b1[k2];
+      }
+      // W(k) = A(k) + iB(k)
+      data[k2  ] = Are - Bim;
+      data[k2+1] = Aim + Bre;
+      // W(N-k) = A(k)* + iB(k)*
+      if (k > 0 && k < fftsize_ - k) {
+        int nk2 = 2 * (fftsize_ - k);
+        data[nk2  ] = Are + Bim;
+        data[nk2+1] = Bre - Aim;
+      }
+    }
+    thread_fft[mythread].Back( data );
+    double* out0 = output[p0];
+    for (int i = 0; i < lagmax; i++)
+      out0[i] = data[2*i] * norm;
+    if (hasSecond) {
+      double* out1 = output[p1];
+      for (int i = 0; i < lagmax; i++)
+        out1[i] = data[2*i+1] * norm;
+    }
+  }
+# ifdef _OPENMP
+  } // END omp parallel
+# endif
+  return 0;
+}
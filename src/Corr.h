@@ -1,6 +1,7 @@
 #ifndef INC_CORR_H
 #define INC_CORR_H
 #include <vector>
+#include <utility> // std::pair
 #include "PubFFT.h"
 /*! \file Corr.h
     \brief Classes that can be used to calculate time correlations from complex arrays.
@@ -32,4 +33,36 @@ class CorrF_FFT {
   private:
     PubFFT pubfft_;
 };
+
+/// Used to calculate auto/cross-correlations between many real arrays with FFTs.
+/** The FFT size is chosen once (from the longest array) and each array is
+  * transformed exactly once; only the non-redundant half of each spectrum
+  * is kept since the arrays are real. Correlations for any list of pairs
+  * are then formed in parallel, two pairs per inverse FFT (since both
+  * results are real they can be stored as the real and imaginary parts).
+  */
+class CorrF_Batch {
+  public:
+    typedef std::vector<double> Darray;
+    typedef std::vector<Darray> ArrayType;
+    typedef std::pair<int,int> PairType;
+    typedef std::vector<PairType> PairArray;
+    typedef std::vector<double*> Parray;
+
+    CorrF_Batch() : fftsize_(0), nhalf_(0) {}
+    /// Set up FFT size for given arrays and calculate their spectra.
+    int Transform(ArrayType const&);
+    /// Calculate sum_j (a[j] * b[j+lag]) for each pair (a,b) up to given lag.
+    int Correlate(PairArray const&, int, Parray const&);
+    /// \return Memory used by spectra in bytes.
+    size_t MemUsageInBytes() const { return spectra_.size() * (size_t)nhalf_ * 2 * sizeof(double); }
+    /// \return FFT size.
+    int FFTsize() const { return fftsize_; }
+  private:
+    static int NumThreads();
+
+    int fftsize_;        ///< FFT size (complex numbers), at least 2x longest array.
+    int nhalf_;          ///< Number of complex numbers stored per spectrum (fftsize_/2 + 1).
+    ArrayType spectra_;  ///< Half spectrum (real/imag pairs) of each array.
+};
 #endif
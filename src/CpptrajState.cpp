@@ -4,9 +4,17 @@
 #include "DataSet_Coords_REF.h" // AddReference
 #include "DataSet_Topology.h" // AddTopology
 #include "ProgressBar.h"
+#include "Version.h" // WriteRunTiming
+#ifdef _OPENMP
+# include <omp.h>
+# include <algorithm> // std::min
+# include "TrajectoryFile.h" // RunFrameThreads
+#endif
+#if defined(MPI) || defined(_OPENMP)
+# include "DataSet_Coords_TRJ.h"
+#endif
 #ifdef MPI
 # include "Parallel.h"
-# include "DataSet_Coords_TRJ.h"
 # include "EnsembleNavigator.h"
 # ifdef TIMER
 #   include "EnsembleIn.h"
@@ -23,7 +31,9 @@ CpptrajState::CpptrajState() :
   exitOnError_(true),
   recordAllInput_(true),
   noEmptyRun_(false),
-  mode_(UNDEFINED)
+  mode_(UNDEFINED),
+  frameThreads_(0),
+  runTiming_(false)
 # ifdef MPI
   , forceParallelEnsemble_(false)
 # endif
@@ -407,10 +417,152 @@ void CpptrajState::Time_Summary() const {
           other_time, other_time/run_time_.Total());
   run_time_.WriteTiming(1, "Run Total");
 }
+/** \return Frames per second for given number of frames and time. */
+static inline double FramesPerSec(int nframes, double seconds) {
+  if (seconds > 0.0) return (double)nframes / seconds;
+  return 0.0;
+}
+
+/** Print tables of time spent in each Action and reading each input
+  * trajectory during the last Run.
+  */
+void CpptrajState::RunTiming_Summary() const {
+  double runTotal = run_time_.Total();
+  if (!(runTotal > 0.0)) runTotal = 1.0;
+  mprintf("\nACTION TIMING:\n");
+  if (actionTimes_.empty())
+    mprintf("\tNo Actions.\n");
+  else {
+    mprintf("  %3s %-24s %10s %10s %10s", "#", "Action", "Setup(s)", "Frames(s)", "Print(s)");
+#   ifdef MPI
+    mprintf(" %10s", "Sync(s)");
+#   endif
+    mprintf(" %8s %12s %7s\n", "Nframes", "Frames/s", "%Run");
+    for (ActionList::TimeArray::const_iterator act = actionTimes_.begin();
+                                               act != actionTimes_.end(); ++act)
+    {
+      double actTotal = act->setup_.Total() + act->frames_.Total() +
+                        act->print_.Total() + act->sync_.Total();
+      mprintf("  %3li %-24s %10.4f %10.4f %10.4f", act - actionTimes_.begin(),
+              act->name_.substr(0, 24).c_str(),
+              act->setup_.Total(), act->frames_.Total(), act->print_.Total());
+#     ifdef MPI
+      mprintf(" %10.4f", act->sync_.Total());
+#     endif
+      mprintf(" %8i %12.2f %6.2f%%\n", act->nframes_,
+              FramesPerSec(act->nframes_, act->frames_.Total()),
+              (actTotal / runTotal) * 100.0);
+    }
+  }
+  mprintf("TRAJECTORY READ TIMING:\n");
+  if (trajinTimes_.empty())
+    mprintf("\tNot available (trajectories read in parallel or ahead of processing).\n");
+  else {
+    mprintf("  %3s %-24s %10s %8s %12s %10s %10s\n", "#", "Trajectory", "Read(s)",
+            "Nframes", "Frames/s", "MB", "MB/s");
+    for (TrajinTimeArray::const_iterator trj = trajinTimes_.begin();
+                                         trj != trajinTimes_.end(); ++trj)
+    {
+      double mbytes = trj->bytes_ / (1024.0 * 1024.0);
+      mprintf("  %3li %-24s %10.4f %8i %12.2f %10.2f %10.2f\n", trj - trajinTimes_.begin(),
+              trj->name_.substr(0, 24).c_str(), trj->read_.Total(), trj->nframes_,
+              FramesPerSec(trj->nframes_, trj->read_.Total()), mbytes,
+              (trj->read_.Total() > 0.0) ? mbytes / trj->read_.Total() : 0.0);
+    }
+  }
+}
+
+/** \return Given string with characters that are special in JSON escaped. */
+static std::string JsonString(std::string const& strIn) {
+  std::string out("\"");
+  for (std::string::const_iterator c = strIn.begin(); c != strIn.end(); ++c) {
+    if (*c == '"' || *c == '\\') {
+      out += '\\';
+      out += *c;
+    } else if ((unsigned char)*c < 0x20)
+      out += ' ';
+    else
+      out += *c;
+  }
+  out += '"';
+  return out;
+}
+
+/** Write overall, per-Action, and per-trajectory timing of the last Run
+  * to timingFile_ in JSON format so it can be compared between runs/builds.
+  * All times are in seconds.
+  */
+int CpptrajState::WriteRunTiming() const {
+# ifdef MPI
+  if (!Parallel::World().Master()) return 0;
+# endif
+  CpptrajFile outfile;
+  if (outfile.OpenWrite( timingFile_ )) return 1;
+  outfile.Printf("{\n  \"version\": %s,\n", JsonString(CPPTRAJ_VERSION_STRING).c_str());
+  outfile.Printf("  \"run\": { \"total\": %.6f, \"init\": %.6f, \"frames\": %.6f,"
+                 " \"post\": %.6f, \"analysis\": %.6f, \"write\": %.6f },\n",
+                 run_time_.Total(), init_time_.Total(), frames_time_.Total(),
+                 post_time_.Total(), analysis_time_.Total(), write_time_.Total());
+  outfile.Printf("  \"actions\": [");
+  for (ActionList::TimeArray::const_iterator act = actionTimes_.begin();
+                                             act != actionTimes_.end(); ++act)
+  {
+    if (act != actionTimes_.begin()) outfile.Printf(",");
+    outfile.Printf("\n    { \"name\": %s, \"setup\": %.6f, \"frames\": %.6f,"
+                   " \"print\": %.6f, \"sync\": %.6f, \"nframes\": %i,"
+                   " \"fps\": %.4f }", JsonString(act->name_).c_str(),
+                   act->setup_.Total(), act->frames_.Total(), act->print_.Total(),
+                   act->sync_.Total(), act->nframes_,
+                   FramesPerSec(act->nframes_, act->frames_.Total()));
+  }
+  outfile.Printf(" ],\n  \"trajectories\": [");
+  for (TrajinTimeArray::const_iterator trj = trajinTimes_.begin();
+                                       trj != trajinTimes_.end(); ++trj)
+  {
+    if (trj != trajinTimes_.begin()) outfile.Printf(",");
+    outfile.Printf("\n    { \"name\": %s, \"read\": %.6f, \"nframes\": %i,"
+                   " \"fps\": %.4f, \"bytes\": %.0f }", JsonString(trj->name_).c_str(),
+                   trj->read_.Total(), trj->nframes_,
+                   FramesPerSec(trj->nframes_, trj->read_.Total()), trj->bytes_);
+  }
+  outfile.Printf(" ]\n}\n");
+  outfile.CloseFile();
+  mprintf("\tRun timing written to '%s'\n", timingFile_.c_str());
+  return 0;
+}
+
+/** Read the next frame from given trajectory, recording the time taken if
+  * readTime is not null.
+  */
+int CpptrajState::ReadNextFrame(Trajin* trajin, Frame& frameIn, TrajinTime* readTime) {
+  if (readTime == 0) return trajin->GetNextFrame( frameIn );
+  readTime->read_.Start();
+  int more = trajin->GetNextFrame( frameIn );
+  readTime->read_.Stop();
+  return more;
+}
+
+/** Record number of frames read from given trajectory. Since trajectory
+  * formats do not report how much they actually read, the number of bytes
+  * is estimated as the fraction of the (uncompressed) file corresponding
+  * to the frames read.
+  */
+void CpptrajState::FinishTrajinTime(Trajin* trajin, TrajinTime& readTime) {
+  readTime.nframes_ = trajin->Traj().Counter().NumFramesProcessed();
+  CpptrajFile trajFile;
+  int totalFrames = trajin->Traj().Counter().TotalFrames();
+  if (totalFrames > 0 && trajFile.SetupRead( trajin->Traj().Filename(), 0 ) == 0)
+    readTime.bytes_ = (double)trajFile.UncompressedSize() *
+                      ((double)readTime.nframes_ / (double)totalFrames);
+}
+
 // -----------------------------------------------------------------------------
 // CpptrajState::Run()
 int CpptrajState::Run() {
   Init_Timers();
+  actionList_.SetTiming( runTiming_ );
+  actionTimes_.clear();
+  trajinTimes_.clear();
   run_time_.Start();
   int err = 0;
   // Special case: check if _DEFAULTCRD_ COORDS DataSet is defined. If so,
@@ -459,12 +611,22 @@ int CpptrajState::Run() {
         else
           err = RunEnsemble();
         break;
+#     else
+#     ifdef _OPENMP
+      case NORMAL   :
+        if (frameThreads_ > 1)
+          err = RunFrameThreads();
+        else
+          err = RunNormal();
+        break;
 #     else
       case NORMAL   : err = RunNormal(); break;
+#     endif
       case ENSEMBLE : err = RunEnsemble(); break;
 #     endif
       case UNDEFINED: break;
     }
+    actionTimes_ = actionList_.TimingData();
     // Clean up Actions if run completed successfully.
     if (err == 0) {
       actionList_.Clear();
@@ -486,6 +648,11 @@ int CpptrajState::Run() {
   write_time_.Stop();
   run_time_.Stop();
   Time_Summary();
+  if (runTiming_) {
+    RunTiming_Summary();
+    if (!timingFile_.empty() && WriteRunTiming())
+      mprinterr("Error: Could not write run timing to '%s'\n", timingFile_.c_str());
+  }
   mprintf("---------- RUN END ---------------------------------------------------\n");
   return err;
 }
@@ -1277,15 +1444,35 @@ int CpptrajState::RunNormal() {
 #   ifdef TIMER
     setup_time.Stop();
 #   endif
+    // Only read optional Frame components (e.g. velocities) that will be used.
+    if (trajoutList_.Empty())
+      (*traj)->SetComponentsNeeded( actionList_.ComponentsNeeded() );
     // Loop over every Frame in trajectory
     (*traj)->Traj().PrintInfoLine();
+#   ifdef _OPENMP
+    if ((*traj)->PrefetchDepth() > 0) {
+      // Frames are read ahead on a separate thread.
+      if (ProcessPrefetch( *traj, TrajFrame, actionSet, progress ))
+        return 1;
+      (*traj)->EndTraj();
+      readSets += (*traj)->Traj().Counter().NumFramesProcessed();
+      mprintf("\n");
+      continue;
+    }
+#   endif
+    TrajinTime* readTime = 0;
+    if (runTiming_) {
+      trajinTimes_.push_back( TrajinTime() );
+      readTime = &(trajinTimes_.back());
+      readTime->name_ = (*traj)->Traj().Filename().Base();
+    }
 #   ifdef TIMER
     trajin_time.Start();
-    bool readMoreFrames = (*traj)->GetNextFrame(TrajFrame);
+    bool readMoreFrames = ReadNextFrame(*traj, TrajFrame, readTime);
     trajin_time.Stop();
     while ( readMoreFrames )
 #   else
-    while ( (*traj)->GetNextFrame(TrajFrame) )
+    while ( ReadNextFrame(*traj, TrajFrame, readTime) )
 #   endif
     {
       // Since Frame can be modified by actions, save original and use currentFrame
@@ -1319,13 +1506,14 @@ int CpptrajState::RunNormal() {
       ++actionSet;
 #     ifdef TIMER
       trajin_time.Start();
-      readMoreFrames = (*traj)->GetNextFrame(TrajFrame);
+      readMoreFrames = ReadNextFrame(*traj, TrajFrame, readTime);
       trajin_time.Stop();
 #     endif 
     }
 
     // Close the trajectory file
     (*traj)->EndTraj();
+    if (readTime != 0) FinishTrajinTime(*traj, *readTime);
     // Update how many frames have been processed.
     readSets += (*traj)->Traj().Counter().NumFramesProcessed();
     mprintf("\n");
@@ -1352,6 +1540,332 @@ int CpptrajState::RunNormal() {
   return 0;
 }
 
+#ifdef _OPENMP
+// -----------------------------------------------------------------------------
+/** Read up to buffer size frames from trajectory into buffer, recording the
+  * trajectory frame number of each.
+  * \return Number of frames read.
+  */
+static int PrefetchRead(Trajin* trajin, FrameArray& buffer, std::vector<int>& frameNum)
+{
+  int nread = 0;
+  while (nread < (int)buffer.Size()) {
+    frameNum[nread] = trajin->Traj().Counter().Current();
+    if (!trajin->GetNextFrame( buffer[nread] )) break;
+    ++nread;
+  }
+  return nread;
+}
+
+// CpptrajState::ProcessPrefetch()
+/** Process all frames from given input trajectory, reading ahead on a
+  * separate thread. Frames are read into two buffers of 'prefetch' frames
+  * each; while the master thread performs Actions and trajectory output on
+  * one buffer, a second thread reads (and decompresses) the next frames
+  * into the other. Nested parallelism is enabled so Actions can still use
+  * OpenMP; while the reader thread is active, nested parallel regions in
+  * Actions use one less than the max # of threads so the total is not
+  * oversubscribed. Messages from the reader thread are saved and printed by
+  * the master thread after each buffer is processed.
+  * \param trajin Input trajectory, already opened.
+  * \param frameIn Frame set up for input trajectory; used as template for buffers.
+  * \param actionSet Frame counter, updated with # frames processed.
+  * \param progress Progress bar.
+  * \return 1 if an error occurred and exitOnError_ is set, 0 otherwise.
+  */
+int CpptrajState::ProcessPrefetch(Trajin* trajin, Frame const& frameIn,
+                                  int& actionSet, ProgressBar& progress)
+{
+  int depth = trajin->PrefetchDepth();
+  FrameArray buffer[2];
+  std::vector<int> frameNum[2];
+  int nread[2];
+  for (int ib = 0; ib != 2; ib++) {
+    buffer[ib].resize( depth );
+    for (FrameArray::iterator frm = buffer[ib].begin(); frm != buffer[ib].end(); ++frm)
+      *frm = frameIn;
+    frameNum[ib].resize( depth );
+  }
+  nread[0] = PrefetchRead(trajin, buffer[0], frameNum[0]);
+  int maxActiveLevels = omp_get_max_active_levels();
+  if (maxActiveLevels < 2) omp_set_max_active_levels( 2 );
+  int maxThreads = omp_get_max_threads();
+  int actionThreads = std::max( 1, maxThreads - 1 );
+  BufferThreadMessages( true );
+  int err = 0;
+  int current = 0;
+  while (nread[current] > 0 && err == 0) {
+    int next = 1 - current;
+    nread[next] = 0;
+    // Only read more frames if the current buffer was filled.
+    bool readNext = (nread[current] == depth);
+#   pragma omp parallel num_threads(2)
+    {
+      int mythread = omp_get_thread_num();
+      int nthreads = omp_get_num_threads();
+      if (readNext && mythread == 1)
+        nread[next] = PrefetchRead(trajin, buffer[next], frameNum[next]);
+      if (mythread == 0) {
+        // Only applies to nested parallel regions started by this thread.
+        if (readNext && nthreads == 2)
+          omp_set_num_threads( actionThreads );
+        else
+          omp_set_num_threads( maxThreads );
+        for (int idx = 0; idx != nread[current]; idx++) {
+          // Since Frame can be modified by actions, save original and use currentFrame
+          ActionFrame currentFrame( &(buffer[current][idx]), actionSet );
+          // Check that coords are valid.
+          if ( currentFrame.Frm().CheckCoordsInvalid() )
+            mprintf("Warning: Frame %i coords 1 & 2 overlap at origin; may be corrupt.\n",
+                    frameNum[current][idx]+1);
+          // Perform Actions on Frame
+          bool suppress_output = actionList_.DoActions(actionSet, currentFrame);
+          // Do Output
+          if (!suppress_output) {
+            if (trajoutList_.WriteTrajout(actionSet, currentFrame.Frm())) {
+              if (exitOnError_) {
+                err = 1;
+                break;
+              }
+            }
+          }
+          if (showProgress_) progress.Update( actionSet );
+          // Increment frame counter
+          ++actionSet;
+        }
+        // No second thread available; read next frames here.
+        if (readNext && nthreads < 2 && err == 0)
+          nread[next] = PrefetchRead(trajin, buffer[next], frameNum[next]);
+      }
+    } // END pragma omp parallel
+    // Print any messages from the reader thread.
+    FlushThreadMessages();
+    current = next;
+  }
+  BufferThreadMessages( false );
+  omp_set_max_active_levels( maxActiveLevels );
+  return err;
+}
+
+// CpptrajState::RunFrameThreads()
+/** Process input frames in parallel with OpenMP threads. Input frames are
+  * divided into one contiguous block per thread. Each block is read with its
+  * own copies of the input trajectories and processed with its own copies of
+  * the Actions (the first block uses the original Actions); DataSets created
+  * by the copies are given the block number as ensemble number so they do
+  * not clash with the originals. After processing, data from each block is
+  * merged into the original Actions in frame order via
+  * ActionList::SyncThreadActions(), similar to how RunParallel() syncs ranks.
+  * Falls back to RunNormal() if any Action does not support this, if there
+  * are output trajectories, or if input trajectories use different topologies.
+  */
+int CpptrajState::RunFrameThreads() {
+  // Check that frame-parallel processing is possible.
+  bool canRun = actionList_.FrameThreadsOK();
+  if (!trajoutList_.Empty()) {
+    mprintf("Warning: 'framethreads' does not support output trajectories.\n");
+    canRun = false;
+  }
+  // All trajectories must share same topology. NetCDF reads are not
+  // thread-safe and must be serialized.
+  Topology* top = 0;
+  bool serialRead = false;
+  for ( TrajinList::trajin_it traj = trajinList_.trajin_begin();
+                              traj != trajinList_.trajin_end(); ++traj)
+  {
+    if (top == 0)
+      top = (*traj)->Traj().Parm();
+    else if (top != (*traj)->Traj().Parm()) {
+      mprintf("Warning: 'framethreads' requires all trajectories use the same topology.\n");
+      canRun = false;
+    }
+    TrajectoryFile::TrajFormatType fmt =
+      TrajectoryFile::DetectFormat( (*traj)->Traj().Filename() );
+    if (fmt == TrajectoryFile::AMBERNETCDF || fmt == TrajectoryFile::AMBERRESTARTNC)
+      serialRead = true;
+  }
+  if (!canRun) {
+    mprintf("Warning: Processing frames with a single thread.\n");
+    return RunNormal();
+  }
+  init_time_.Start();
+  // List state
+  ListState();
+  // Set up random access to input frames for the first block.
+  DataSet_Coords_TRJ input_traj;
+  for ( TrajinList::trajin_it traj = trajinList_.trajin_begin();
+                              traj != trajinList_.trajin_end(); ++traj)
+    if (input_traj.AddInputTraj( *traj )) return 1;
+  int nframes = (int)input_traj.Size();
+  if (nframes < 1) {
+    mprinterr("Error: No input frames.\n");
+    return 1;
+  }
+  int nblocks = std::min( frameThreads_, nframes );
+  // Divide frames into blocks.
+  std::vector<int> blockStart( nblocks + 1 );
+  for (int block = 0; block <= nblocks; block++)
+    blockStart[block] = (int)(((long int)nframes * block) / nblocks);
+  mprintf("\nFRAME-PARALLEL INFO:\n");
+  for (int block = 0; block != nblocks; block++)
+    mprintf("  Thread block %i will handle %i frames.\n", block,
+            blockStart[block+1] - blockStart[block]);
+
+  // Allocate DataSets for all frames, since data from other blocks will be appended.
+  DSL_.AllocateSets( nframes );
+
+  // ----- SETUP PHASE ---------------------------
+  CoordinateInfo const& currentCoordInfo = input_traj.CoordsInfo();
+  top->SetBoxFromTraj( currentCoordInfo.TrajBox() ); // FIXME necessary?
+  int topFrames = trajinList_.TopFrames( top->Pindex() );
+  std::vector<ActionSetup> blockSetup( nblocks );
+  blockSetup[0].Set( top, currentCoordInfo, topFrames );
+  if (actionList_.SetupActions( blockSetup[0], exitOnError_ )) {
+    mprinterr("Error: Could not set up actions for '%s'\n", top->c_str());
+    return 1;
+  }
+  int err = 0;
+  // Set up readers and Actions for each block > 0. Copies of Actions do not
+  // write to DataFiles.
+  std::vector<DataSet_Coords_TRJ*> blockTraj( nblocks, (DataSet_Coords_TRJ*)0 );
+  std::vector<ActionList*> blockActions( nblocks, (ActionList*)0 );
+  std::vector<Trajin*> trajCopies;
+  blockTraj[0] = &input_traj;
+  blockActions[0] = &actionList_;
+  DataFileList copyDFL;
+  unsigned int firstCopySet = DSL_.size();
+  if (debug_ == 0) SetWorldSilent( true );
+  for (int block = 1; block < nblocks && err == 0; block++) {
+    blockTraj[block] = new DataSet_Coords_TRJ();
+    for (unsigned int idx = 0; idx != trajinList_.Size() && err == 0; idx++) {
+      Trajin* trajCopy = trajinList_.CopyOfTrajin( idx );
+      if (trajCopy == 0)
+        err = 1;
+      else {
+        trajCopies.push_back( trajCopy );
+        if (blockTraj[block]->AddInputTraj( trajCopy )) err = 1;
+      }
+    }
+    if (err != 0) break;
+    DSL_.SetEnsembleNum( block );
+    ActionInit init( DSL_, copyDFL );
+    blockActions[block] = new ActionList();
+    blockActions[block]->SetDebug( debug_ );
+    blockActions[block]->SetTiming( runTiming_ );
+    for (int iaction = 0; iaction < actionList_.Naction(); iaction++) {
+      ArgList actionArgs = actionList_.ActionArgs(iaction);
+      if (blockActions[block]->AddAction(actionList_.ActionAlloc(iaction), actionArgs, init)) {
+        err = 1;
+        break;
+      }
+    }
+    if (err != 0) break;
+    blockSetup[block].Set( top, currentCoordInfo, topFrames );
+    if (blockActions[block]->SetupActions( blockSetup[block], exitOnError_ ))
+      err = 1;
+  }
+  DSL_.SetEnsembleNum( -1 );
+  SetWorldSilent( false );
+  // Sets created by Action copies only need to hold data for their block.
+  DataSetList::DataListType copySets;
+  for (unsigned int idx = firstCopySet; idx < DSL_.size(); idx++) {
+    copySets.push_back( DSL_[idx] );
+    int block = DSL_[idx]->Meta().EnsembleNum();
+    if (DSL_[idx]->Meta().TimeSeries() == MetaData::IS_TS && block > 0 && block < nblocks)
+      DSL_[idx]->Allocate( DataSet::SizeArray(1, blockStart[block+1] - blockStart[block]) );
+  }
+  // Only read optional Frame components (e.g. velocities) that will be used.
+  int componentsNeeded = actionList_.ComponentsNeeded();
+  for ( TrajinList::trajin_it traj = trajinList_.trajin_begin();
+                              traj != trajinList_.trajin_end(); ++traj)
+    (*traj)->SetComponentsNeeded( componentsNeeded );
+  for (std::vector<Trajin*>::const_iterator trj = trajCopies.begin();
+                                            trj != trajCopies.end(); ++trj)
+    (*trj)->SetComponentsNeeded( componentsNeeded );
+  init_time_.Stop();
+  if (err != 0)
+    mprinterr("Error: Could not set up frame-parallel processing.\n");
+  else {
+    // ----- ACTION PHASE --------------------------
+    mprintf("\nBEGIN FRAME-PARALLEL TRAJECTORY PROCESSING:\n");
+    frames_time_.Start();
+    ProgressBar progress;
+    if (showProgress_)
+      progress.SetupProgress( blockStart[1] );
+    std::vector<int> nInvalid( nblocks, 0 );
+    std::vector<int> nProcessed( nblocks, 0 );
+    // Any OpenMP regions in Actions run on a single thread.
+    int maxActiveLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels( 1 );
+    int block;
+#   pragma omp parallel private(block) num_threads(nblocks) reduction(+: err)
+    {
+#   pragma omp for schedule(static, 1)
+    for (block = 0; block < nblocks; block++)
+    {
+      Frame TrajFrame = blockTraj[block]->AllocateFrame();
+      int actionSet = 0; // Internal data frame for this block
+      for (int set = blockStart[block]; set != blockStart[block+1]; set++, actionSet++)
+      {
+        int readErr;
+        if (serialRead) {
+#         pragma omp critical(FrameThreadsRead)
+          readErr = blockTraj[block]->GetFrameNoLock( set, TrajFrame );
+        } else
+          readErr = blockTraj[block]->GetFrameNoLock( set, TrajFrame );
+        if (readErr != 0) {
+          err++;
+          break;
+        }
+        if (TrajFrame.CheckCoordsInvalid())
+          nInvalid[block]++;
+        ActionFrame currentFrame( &TrajFrame, set );
+        blockActions[block]->DoActions(actionSet, currentFrame);
+        if (block == 0 && showProgress_) progress.Update( actionSet );
+      }
+      nProcessed[block] = actionSet;
+    }
+    } // END pragma omp parallel
+    omp_set_max_active_levels( maxActiveLevels );
+    int totalProcessed = 0;
+    for (block = 0; block != nblocks; block++) {
+      if (nInvalid[block] > 0)
+        mprintf("Warning: %i frames in block %i have coords 1 & 2 overlapping at origin;"
+                " may be corrupt.\n", nInvalid[block], block);
+      totalProcessed += nProcessed[block];
+    }
+    mprintf("\nRead and processed %i frames with %i threads.\n", totalProcessed, nblocks);
+    // Merge data from each block in frame order.
+    for (block = 1; block < nblocks; block++)
+      if (actionList_.SyncThreadActions( *(blockActions[block]) )) err++;
+    frames_time_.Stop();
+    mprintf("TIME: Avg. throughput= %.4f frames / second.\n",
+            (double)totalProcessed / frames_time_.Total());
+  }
+  // Clean up copies of Actions, trajectories, and their DataSets.
+  for (int block = 1; block < nblocks; block++) {
+    delete blockActions[block];
+    delete blockTraj[block];
+  }
+  for (std::vector<Trajin*>::const_iterator trj = trajCopies.begin();
+                                            trj != trajCopies.end(); ++trj)
+    delete *trj;
+  copyDFL.Clear();
+  for (DataSetList::DataListType::const_iterator ds = copySets.begin();
+                                                 ds != copySets.end(); ++ds)
+    DSL_.RemoveSet( *ds );
+  if (err != 0) return 1;
+
+  // ========== A C T I O N  O U T P U T  P H A S E ==========
+  mprintf("\nACTION OUTPUT:\n");
+  post_time_.Start();
+  actionList_.PrintActions();
+  post_time_.Stop();
+  return 0;
+}
+
+#endif /* _OPENMP */
+
 // -----------------------------------------------------------------------------
 // CpptrajState::MasterDataFileWrite()
 /** Trigger write of all pending DataFiles. When in parallel ensemble mode,
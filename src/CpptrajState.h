@@ -8,6 +8,7 @@
 #include "ActionList.h"
 #include "AnalysisList.h"
 #include "Timer.h"
+class ProgressBar;
 /// Hold all cpptraj state data
 class CpptrajState {
   public:
@@ -24,6 +25,10 @@ class CpptrajState {
 #   ifdef MPI
     void SetForceParaEnsemble(bool b) { forceParallelEnsemble_ = b; }
 #   endif
+    /// Set # threads for frame-parallel processing (0 = off).
+    void SetFrameThreads(int n) { frameThreads_ = n; }
+    /// Set whether to report per-Action/trajectory timing after Run, and optional JSON file.
+    void SetRunTiming(bool b, std::string const& f) { runTiming_ = b; timingFile_ = f; }
     DataSetList const& DSL()  const { return DSL_;         }
     DataSetList&       DSL()        { return DSL_;         }
     DataFileList const& DFL() const { return DFL_;         }
@@ -84,6 +89,10 @@ class CpptrajState {
     void ListState() const;
     int RunNormal();
     int RunEnsemble();
+#   ifdef _OPENMP
+    int RunFrameThreads();
+    int ProcessPrefetch(Trajin*, Frame const&, int&, ProgressBar&);
+#   endif
 #   ifdef MPI
     void DivideFramesAmongProcesses(int&, int&, int&, int, Parallel::Comm const&) const;
     int PreloadCheck(int, int, int&, int&) const;
@@ -93,6 +102,20 @@ class CpptrajState {
 #   endif
     void Init_Timers();
     void Time_Summary() const;
+    void RunTiming_Summary() const;
+    int WriteRunTiming() const;
+    /// Time spent reading a single input trajectory.
+    class TrajinTime {
+      public:
+        TrajinTime() : nframes_(0), bytes_(0.0) {}
+        std::string name_; ///< Trajectory file name.
+        Timer read_;       ///< Time spent reading frames.
+        int nframes_;      ///< Number of frames read.
+        double bytes_;     ///< Estimated number of bytes read.
+    };
+    typedef std::vector<TrajinTime> TrajinTimeArray;
+    static inline int ReadNextFrame(Trajin*, Frame&, TrajinTime*);
+    static void FinishTrajinTime(Trajin*, TrajinTime&);
     // -------------------------------------------
     DataSetList DSL_;             ///< List of DataSets
     DataFileList DFL_;            ///< List of DataFiles that DataSets will be written to.
@@ -112,6 +135,11 @@ class CpptrajState {
     /// If true do not process input trajectories when no actions/output trajectories.
     bool noEmptyRun_; // DEBUG: false is used for benchmarking trajectory read speed.
     TrajModeType mode_; ///< Current trajectory mode (NORMAL/ENSEMBLE)
+    int frameThreads_;  ///< # threads for frame-parallel processing; 0 is off.
+    bool runTiming_;          ///< If true report per-Action/trajectory timing after Run.
+    std::string timingFile_;  ///< If not empty, file to write run timing to as JSON.
+    ActionList::TimeArray actionTimes_; ///< Per-Action timing from last Run.
+    TrajinTimeArray trajinTimes_;       ///< Per-trajectory read timing from last Run.
     Timer init_time_;     ///< Run initialization time.
     Timer frames_time_;   ///< Run frame processing time.
     Timer post_time_;     ///< Run post-frame processing (e.g. Action::Print()) time.
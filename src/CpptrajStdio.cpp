@@ -3,6 +3,11 @@
 #ifdef MPI
 #  include "Parallel.h"
 #endif
+#ifdef _OPENMP
+#  include <omp.h>
+#  include <string>
+#  include <vector>
+#endif
 
 enum IO_LEVEL_TYPE {
   IO_ALL = 0,    // Normal output
@@ -15,6 +20,27 @@ static IO_LEVEL_TYPE world_io_level_ = IO_ALL;
 static bool suppressErrorMsg_ = false;
 /// Where normal output should be written.
 static FILE* STDOUT_ = stdout;
+#ifdef _OPENMP
+/// If true, mprintf/mprinterr messages from threads other than thread 0 are saved.
+static bool bufferThreadMsg_ = false;
+/// Saved messages; true if message goes to STDERR.
+static std::vector< std::pair<bool, std::string> > threadMsg_;
+
+/** \return true if message should be saved, i.e. buffering is on and this
+  * is not thread 0 (or a thread spawned by thread 0) of the outermost team.
+  */
+static inline bool IsBufferedThread() {
+  return (bufferThreadMsg_ && omp_get_level() > 0 && omp_get_ancestor_thread_num(1) != 0);
+}
+
+/** Save message for printing by FlushThreadMessages(). */
+static void SaveThreadMsg(bool isErr, const char* format, va_list args) {
+  char buffer[1024];
+  vsnprintf(buffer, 1024, format, args);
+# pragma omp critical(cpptrajstdio_threadmsg)
+  threadMsg_.push_back( std::pair<bool, std::string>(isErr, std::string(buffer)) );
+}
+#endif
 
 // mflush()
 /** Call flush on STDOUT only if this is the master thread */
@@ -81,7 +107,12 @@ void mprintf(const char *format, ...) {
 #   endif
     va_list args;
     va_start(args,format);
-    vfprintf(STDOUT_,format,args);
+#   ifdef _OPENMP
+    if (IsBufferedThread())
+      SaveThreadMsg(false, format, args);
+    else
+#   endif
+      vfprintf(STDOUT_,format,args);
     va_end(args);
   }
 }
@@ -94,7 +125,12 @@ void mprinterr(const char *format, ...) {
 # endif
   va_list args;
   va_start(args,format);
-  vfprintf(stderr,format,args);
+# ifdef _OPENMP
+  if (IsBufferedThread())
+    SaveThreadMsg(true, format, args);
+  else
+# endif
+    vfprintf(stderr,format,args);
   va_end(args);
 }
 #endif
@@ -151,6 +187,32 @@ void SuppressAllOutput() { world_io_level_ = IO_STAY_SILENT; }
 
 void SuppressErrorMsg(bool suppressIn) { suppressErrorMsg_ = suppressIn; }
 
+#ifdef _OPENMP
+/** Print messages saved from other threads. Should only be called by thread
+  * 0 outside of parallel regions.
+  */
+void FlushThreadMessages() {
+  for (std::vector< std::pair<bool, std::string> >::const_iterator msg = threadMsg_.begin();
+                                                                  msg != threadMsg_.end(); ++msg)
+  {
+    if (msg->first)
+      fputs(msg->second.c_str(), stderr);
+    else
+      fputs(msg->second.c_str(), STDOUT_);
+  }
+  threadMsg_.clear();
+}
+
+/** When set, messages from mprintf/mprinterr called by OpenMP threads other
+  * than thread 0 are saved instead of printed; they are printed in order by
+  * FlushThreadMessages(). Turning buffering off flushes any saved messages.
+  */
+void BufferThreadMessages(bool bufferIn) {
+  bufferThreadMsg_ = bufferIn;
+  if (!bufferThreadMsg_) FlushThreadMessages();
+}
+#endif
+
 void FinalizeIO() {
   if (STDOUT_ != stdout) {
     fclose(STDOUT_);
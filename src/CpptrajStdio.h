@@ -19,6 +19,10 @@ void rprinterr(const char *, ...);
 void SetWorldSilent(bool);
 void SuppressAllOutput();
 void SuppressErrorMsg(bool);
+#ifdef _OPENMP
+void BufferThreadMessages(bool);
+void FlushThreadMessages();
+#endif
 void FinalizeIO();
 int OutputToFile(const char*);
 #endif
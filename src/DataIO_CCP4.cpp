@@ -313,18 +313,20 @@ int DataIO_CCP4::WriteSet3D( DataSetList::const_iterator const& setIn, CpptrajFi
 
   // No symmetry bytes
 
-  // Store data in buffer, then write. X changes fastest.
+  // Store data in buffer one Z plane at a time, then write. X changes
+  // fastest. Buffering by plane avoids a dense copy of sparse grids.
   // SANITY CHECK; This will result in invalid files if size of float is not 4.
   if (sizeof(float) != wSize)
     mprintf("Warning: Size of float on this system is %zu, not 4.\n"
             "Warning:  Resulting CCP4 file data will not conform to standard.\n", sizeof(float));
-  std::vector<float> mapbuffer( grid.Size() );
-  std::vector<float>::iterator it = mapbuffer.begin();
-  for (unsigned int iz = 0; iz != grid.NZ(); iz++)
+  std::vector<float> mapbuffer( grid.NX() * grid.NY() );
+  for (unsigned int iz = 0; iz != grid.NZ(); iz++) {
+    std::vector<float>::iterator it = mapbuffer.begin();
     for (unsigned int iy = 0; iy != grid.NY(); iy++)
       for (unsigned int ix = 0; ix != grid.NX(); ix++)
         *(it++) = grid.GetElement( ix, iy, iz );
-  outfile.Write( &mapbuffer[0], mapbuffer.size() * sizeof(float) );
+    outfile.Write( &mapbuffer[0], mapbuffer.size() * sizeof(float) );
+  }
 
   outfile.CloseFile();
   return 0;
@@ -25,10 +25,12 @@ const char* DataSet::Descriptions_[] = {
   "cluster matrix", // CMATRIX
   "cluster matrix (no memory)", // CMATRIX_NOMEM
   "cluster matrix (disk)",      // CMATRIX_DISK
+  "cluster matrix (tiled disk)", // CMATRIX_TILE
   "pH",                         // PH
   "pH REMD (explicit)",         // PH_EXPL
   "pH REMD (implicit)",         // PH_IMPL
-  "parameters"                  // PARAMETERS
+  "parameters",                 // PARAMETERS
+  "sparse float grid"           // GRID_SPARSE
 };
 
 // CONSTRUCTOR
@@ -13,9 +13,11 @@
 #include "DataSet_MatrixDbl.h"
 #include "DataSet_MatrixFlt.h"
 #include "DataSet_Coords_CRD.h"
+#include "DataSet_Coords_MMAP.h"
 #include "DataSet_Vector.h"
 #include "DataSet_Modes.h"
 #include "DataSet_GridFlt.h"
+#include "DataSet_GridSparse.h"
 #include "DataSet_RemLog.h"
 #include "DataSet_Mesh.h"
 #include "DataSet_Coords_TRJ.h"
@@ -26,6 +28,7 @@
 #include "DataSet_Cmatrix_MEM.h"
 #include "DataSet_Cmatrix_NOMEM.h"
 #include "DataSet_Cmatrix_DISK.h"
+#include "DataSet_Cmatrix_TILE.h"
 #include "DataSet_pH.h"
 #include "DataSet_PHREMD_Explicit.h"
 #include "DataSet_PHREMD_Implicit.h"
@@ -51,14 +54,22 @@ DataSet* DataSetList::NewSet(DataSet::DataType typeIn) {
         ds = DataSet_integer_mem::Alloc();
 #     else
       if (useDiskCache_)
-        mprintf("Warning: Integer data set disk cache requires NetCDF. Using memory.\n"
+        mprintf("Warning: Integer data set disk cache requires NetCDF. Using memory.\n");
       ds = DataSet_integer_mem::Alloc();
 #     endif
       break;
     case DataSet::STRING  : ds = DataSet_string::Alloc(); break;
     case DataSet::MATRIX_DBL : ds = DataSet_MatrixDbl::Alloc(); break;
     case DataSet::MATRIX_FLT : ds = DataSet_MatrixFlt::Alloc(); break;
-    case DataSet::COORDS     : ds = DataSet_Coords_CRD::Alloc(); break;
+    case DataSet::COORDS     :
+#     ifndef _WIN32
+      if (useDiskCache_) {
+        ds = DataSet_Coords_MMAP::Alloc();
+        cannotUseDiskCache = false;
+      } else
+#     endif
+        ds = DataSet_Coords_CRD::Alloc();
+      break;
     case DataSet::VECTOR     : ds = DataSet_Vector::Alloc() ; break;
     case DataSet::MODES      : ds = DataSet_Modes::Alloc(); break;
     case DataSet::GRID_FLT   : ds = DataSet_GridFlt::Alloc(); break;
@@ -72,10 +83,14 @@ DataSet* DataSetList::NewSet(DataSet::DataType typeIn) {
     case DataSet::CMATRIX    : ds = DataSet_Cmatrix_MEM::Alloc(); break;
     case DataSet::CMATRIX_NOMEM : ds = DataSet_Cmatrix_NOMEM::Alloc(); break;
     case DataSet::CMATRIX_DISK  : ds = DataSet_Cmatrix_DISK::Alloc(); break;
+#     ifndef _WIN32
+    case DataSet::CMATRIX_TILE  : ds = DataSet_Cmatrix_TILE::Alloc(); break;
+#     endif
     case DataSet::PH            : ds = DataSet_pH::Alloc(); break;
     case DataSet::PH_EXPL       : ds = DataSet_PHREMD_Explicit::Alloc(); break;
     case DataSet::PH_IMPL       : ds = DataSet_PHREMD_Implicit::Alloc(); break;
     case DataSet::PARAMETERS    : ds = DataSet_Parameters::Alloc(); break;
+    case DataSet::GRID_SPARSE   : ds = DataSet_GridSparse::Alloc(); break;
     // Sanity check
     default:
       mprinterr("Internal Error: No allocator for DataSet type '%s'\n",
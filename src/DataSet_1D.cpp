@@ -84,15 +84,6 @@ double DataSet_1D::Max() const {
   return max;
 }
 
-static inline double PeriodicDiff(double v1, double v2) {
-  double diff = v1 - v2;
-  if (diff > 180.0)
-    diff = 360.0 - diff;
-  else if (diff < -180.0)
-    diff = 360.0 + diff;
-  return diff;
-}
-
 /** Calculate time correlation between two DataSets.
   * \D2 DataSet to calculate correlation to.
   * \Ct DataSet to store time correlation fn, must be DOUBLE.
@@ -24,7 +24,18 @@ class DataSet_1D : public DataSet {
     double CorrCoeff(DataSet_1D const&) const;
     /// Calculate linear regression; report slope, intercept, and correlation.
     int LinearRegression(double&, double&, double&, CpptrajFile*) const;
+    /// \return Difference between two angles in degrees, wrapped to [-180, 180].
+    static inline double PeriodicDiff(double, double);
   private:
     double Avg(double*) const;
 };
+// ----- INLINE FUNCTIONS ------------------------------------------------------
+double DataSet_1D::PeriodicDiff(double v1, double v2) {
+  double diff = v1 - v2;
+  if (diff > 180.0)
+    diff -= 360.0;
+  else if (diff < -180.0)
+    diff += 360.0;
+  return diff;
+}
 #endif
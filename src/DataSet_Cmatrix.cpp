@@ -8,6 +8,26 @@ void DataSet_Cmatrix::PrintElements() const {
       mprintf("\t%u %u %f\n", row+1, col+1, GetFdist(col, row));
 }
 
+/** Generic row fetch; matrices with a more efficient layout for
+  * retrieving whole rows should override this.
+  */
+int DataSet_Cmatrix::GetRow(unsigned int row, double* rowOut) const {
+  ClusterSieve::SievedFrames const& frames = FramesToCluster();
+  int f1 = frames[row];
+  for (unsigned int col = 0; col != frames.size(); col++)
+    rowOut[col] = (col == row) ? 0.0 : GetFdist(f1, frames[col]);
+  return 0;
+}
+
+/** Generic upper row fetch; only elements after the diagonal are set. */
+int DataSet_Cmatrix::GetUpperRow(unsigned int row, double* rowOut) const {
+  ClusterSieve::SievedFrames const& frames = FramesToCluster();
+  int f1 = frames[row];
+  for (unsigned int col = row + 1; col < frames.size(); col++)
+    rowOut[col] = GetFdist(f1, frames[col]);
+  return 0;
+}
+
 /** Set up sieving info as necessary and set up cluster based on actual
   * number of frames to be clustered.
   */
@@ -43,6 +43,16 @@ class DataSet_Cmatrix : public DataSet {
     virtual bool NeedsCalc() const = 0;
     /// Indicate that no more distances will be added to matrix.
     virtual void Complete() = 0;
+    /// Fill given array with distances from given row to every row (diagonal is 0).
+    /** \return 0 on success, 1 if the row could not be read. */
+    virtual int GetRow(unsigned int, double*) const;
+    /// Fill given array with distances from given row to every later row (columns > row only).
+    /** \return 0 on success, 1 if the row could not be read. */
+    virtual int GetUpperRow(unsigned int, double*) const;
+    /// \return Rows that must be set (in order) before FlushRows() is called; 0 if any order.
+    virtual unsigned int RowsPerFlush() const { return 0; }
+    /// Called after each block of RowsPerFlush() rows has been set.
+    virtual int FlushRows() { return 0; }
     // ----- Sieved frames functions -------------
     /// \return An array containing frame numbers that have not been sieved out.
     ClusterSieve::SievedFrames const& FramesToCluster() const { return sievedFrames_.Frames(); }
@@ -54,6 +64,8 @@ class DataSet_Cmatrix : public DataSet {
     int OriginalNframes()               const { return sievedFrames_.MaxFrames(); }
     /// \return true if frame was sieved out.
     bool FrameWasSieved(int f)          const { return (sievedFrames_.FrameToIdx(f) == -1); }
+    /// \return Matrix row corresponding to given frame, -1 if frame was sieved out.
+    int FrameToRow(int f)               const { return sievedFrames_.FrameToIdx(f); }
     // -------------------------------------------
     /// Allocate matrix and sieve info for given size and sieve
     int SetupWithSieve(ClusterDist*, size_t, int, int);
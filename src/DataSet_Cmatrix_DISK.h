@@ -33,6 +33,10 @@ class DataSet_Cmatrix_DISK : public DataSet_Cmatrix {
     bool NeedsCalc()                     const { return true;                          }
     /// No more distances will be added; flush to disk
     void Complete()                            { file_.Sync();                         }
+    /// Fill given array with distances from given row to every row.
+    int GetRow(unsigned int row, double* rowOut) const { return file_.GetCmatrixRow(row, rowOut); }
+    /// Fill given array with distances from given row to every later row.
+    int GetUpperRow(unsigned int row, double* rowOut) const { return file_.GetCmatrixUpperRow(row, rowOut); }
   protected:
     int AllocateCmatrix(size_t);
     int SetCdist(ClusterDist*) { return 0; }
@@ -1,3 +1,4 @@
+#include <algorithm> // std::copy
 #include "DataSet_Cmatrix_MEM.h"
 #include "CpptrajStdio.h"
 #include "StringRoutines.h" // ByteString
@@ -45,3 +46,29 @@ int DataSet_Cmatrix_MEM::AllocateCmatrix(size_t sizeIn)
 size_t DataSet_Cmatrix_MEM::DataSize() const {
   return ( Mat_.DataSize() + sievedFrames_.DataSize() );
 }
+
+/** Row elements before the diagonal are stored in column order (one per
+  * previous row), elements after the diagonal are contiguous.
+  */
+int DataSet_Cmatrix_MEM::GetRow(unsigned int row, double* rowOut) const {
+  size_t nrows = Mat_.Nrows();
+  const float* elts = Mat_.Ptr();
+  // Index of element (col, row) for col < row; starts at (0, row).
+  size_t idx = (size_t)row - 1;
+  for (size_t col = 0; col < (size_t)row; col++) {
+    rowOut[col] = elts[idx];
+    idx += nrows - col - 2;
+  }
+  rowOut[row] = 0.0;
+  return GetUpperRow( row, rowOut );
+}
+
+/** Row elements after the diagonal are contiguous. */
+int DataSet_Cmatrix_MEM::GetUpperRow(unsigned int row, double* rowOut) const {
+  size_t nrows = Mat_.Nrows();
+  if ((size_t)row + 1 < nrows) {
+    const float* ptr = Mat_.Ptr() + Mat_.CalcIndex(row, row + 1);
+    std::copy( ptr, ptr + (nrows - row - 1), rowOut + row + 1 );
+  }
+  return 0;
+}
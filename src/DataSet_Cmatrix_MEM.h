@@ -36,6 +36,10 @@ class DataSet_Cmatrix_MEM : public DataSet_Cmatrix {
     bool NeedsCalc()                        const { return true;                    }
     /// Indicate that no more distances will be added to matrix.
     void Complete() {}
+    /// Fill given array with distances from given row to every row.
+    int GetRow(unsigned int, double*) const;
+    /// Fill given array with distances from given row to every later row.
+    int GetUpperRow(unsigned int, double*) const;
   protected:
     int AllocateCmatrix(size_t);
     int SetCdist(ClusterDist*) { return 0; }
@@ -0,0 +1,362 @@
+#ifndef _WIN32
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cmath> // sqrt
+#include <algorithm> // std::min, std::copy
+#include "DataSet_Cmatrix_TILE.h"
+#include "CpptrajStdio.h"
+#include "StringRoutines.h" // ByteString
+#include "File_TempName.h"
+
+/// CONSTRUCTOR
+DataSet_Cmatrix_TILE::DataSet_Cmatrix_TILE() :
+  DataSet_Cmatrix(CMATRIX_TILE),
+  fd_(-1),
+  nrows_(0),
+  tdim_(0),
+  ntiles_(0),
+  tileSize_(0),
+  maxCacheBytes_(1024000000UL),
+  bandRow_(0),
+  useCount_(0)
+{}
+
+/// DESTRUCTOR
+DataSet_Cmatrix_TILE::~DataSet_Cmatrix_TILE() {
+  FreeFile();
+}
+
+/** Close and remove the temporary file if present. */
+void DataSet_Cmatrix_TILE::FreeFile() {
+  if (fd_ != -1) {
+    close( fd_ );
+    fd_ = -1;
+  }
+  if (!tfname_.empty()) {
+    File::FreeTempName( tfname_ );
+    tfname_.clear();
+  }
+}
+
+// DataSet_Cmatrix_TILE::Info()
+void DataSet_Cmatrix_TILE::Info() const {
+  if (tdim_ > 0)
+    mprintf(" (on disk, %u x %u tiles)", tdim_, tdim_);
+}
+
+// DataSet_Cmatrix_TILE::MemUsageInBytes()
+size_t DataSet_Cmatrix_TILE::MemUsageInBytes() const {
+  return (band_.size() + cache_.size()) * sizeof(float) +
+         tileSlot_.size() * sizeof(int) +
+         slotTile_.size() * (sizeof(int) + sizeof(unsigned long));
+}
+
+/** Read/write exactly the given number of bytes at the given offset.
+  * \return 0 on success, 1 on error.
+  */
+static int readFully(int fd, void* buf, size_t nbytes, off_t offset) {
+  char* ptr = (char*)buf;
+  while (nbytes > 0) {
+    ssize_t n = pread( fd, ptr, nbytes, offset );
+    if (n <= 0) return 1;
+    ptr += n;
+    nbytes -= (size_t)n;
+    offset += (off_t)n;
+  }
+  return 0;
+}
+
+static int writeFully(int fd, const void* buf, size_t nbytes, off_t offset) {
+  const char* ptr = (const char*)buf;
+  while (nbytes > 0) {
+    ssize_t n = pwrite( fd, ptr, nbytes, offset );
+    if (n <= 0) return 1;
+    ptr += n;
+    nbytes -= (size_t)n;
+    offset += (off_t)n;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+/** Set up tiling for given number of rows and create the temporary file.
+  * Tiles are 256 x 256 elements (256 KB), which is large enough that each
+  * disk read is efficient and small enough that a block of tile rows fits
+  * in memory during the pairwise calculation for several hundred thousand
+  * frames.
+  */
+int DataSet_Cmatrix_TILE::AllocateCmatrix(size_t sizeIn) {
+  FreeFile();
+  if (sizeIn < 1) {
+    mprinterr("Error: No rows specified for tiled pair-wise matrix.\n");
+    return 1;
+  }
+  nrows_ = (unsigned int)sizeIn;
+  tdim_ = std::min( 256U, nrows_ );
+  ntiles_ = (nrows_ + tdim_ - 1) / tdim_;
+  tileSize_ = (size_t)tdim_ * tdim_;
+  size_t totalTiles = TileRowStart( ntiles_ );
+  size_t nbytes = totalTiles * tileSize_ * sizeof(float);
+  mprintf("\tEstimated pair-wise matrix disk usage: > %s (%zu tiles of %u x %u)\n",
+          ByteString( nbytes, BYTE_DECIMAL ).c_str(), totalTiles, tdim_, tdim_);
+  mprintf("\tPair-wise matrix tile cache size: %s\n",
+          ByteString( maxCacheBytes_, BYTE_DECIMAL ).c_str());
+  tfname_ = File::GenTempName();
+  if (tfname_.empty()) {
+    mprinterr("Internal Error: Could not get temporary file name for tiled pair-wise matrix.\n");
+    return 1;
+  }
+  fd_ = open( tfname_.full(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+  if (fd_ == -1) {
+    mprinterr("Error: Could not create pair-wise matrix file '%s'\n", tfname_.full());
+    return 1;
+  }
+  if (ftruncate( fd_, (off_t)nbytes ) != 0) {
+    mprinterr("Error: Could not resize pair-wise matrix file '%s' to %s\n",
+              tfname_.full(), ByteString( nbytes, BYTE_DECIMAL ).c_str());
+    return 1;
+  }
+  // First tile row will be written first.
+  bandRow_ = 0;
+  try { band_.assign( (size_t)ntiles_ * tileSize_, 0.0f ); }
+  catch (const std::bad_alloc&) {
+    mprinterr("Error: Not enough memory to allocate pair-wise matrix tile buffer.\n");
+    return 1;
+  }
+  // Nothing cached yet.
+  tileSlot_.assign( totalTiles, -1 );
+  cache_.clear();
+  slotTile_.clear();
+  slotUsed_.clear();
+  useCount_ = 0;
+  return 0;
+}
+
+/** Set element in the tile row currently being written. All elements of a
+  * tile row must be set before FlushRows() is called, after which elements
+  * for the next tile row can be set. Different elements may be set from
+  * different threads at the same time.
+  */
+void DataSet_Cmatrix_TILE::SetElement(int x, int y, double val) {
+  unsigned int i, j;
+  if (x < y) {
+    i = (unsigned int)x;
+    j = (unsigned int)y;
+  } else if (y < x) {
+    i = (unsigned int)y;
+    j = (unsigned int)x;
+  } else
+    return;
+  unsigned int I = i / tdim_;
+  if (I != bandRow_) {
+    mprinterr("Internal Error: Pair-wise matrix element (%u, %u) is not in tile row %u\n",
+              i, j, bandRow_);
+    return;
+  }
+  unsigned int J = j / tdim_;
+  band_[ (J - I) * tileSize_ + (i % tdim_) * tdim_ + (j % tdim_) ] = (float)val;
+}
+
+/** Write the current tile row to disk and start the next one. */
+int DataSet_Cmatrix_TILE::FlushRows() {
+  if (bandRow_ >= ntiles_) return 0;
+  size_t nelts = (size_t)(ntiles_ - bandRow_) * tileSize_;
+  off_t offset = (off_t)(TileRowStart( bandRow_ ) * tileSize_ * sizeof(float));
+  if (writeFully( fd_, &band_[0], nelts * sizeof(float), offset )) {
+    mprinterr("Error: Could not write tile row %u to pair-wise matrix file '%s'\n",
+              bandRow_, tfname_.full());
+    return 1;
+  }
+  ++bandRow_;
+  if (bandRow_ < ntiles_)
+    band_.assign( (size_t)(ntiles_ - bandRow_) * tileSize_, 0.0f );
+  return 0;
+}
+
+/** Write any tile rows not yet written, then free the write buffer. */
+void DataSet_Cmatrix_TILE::Complete() {
+  while (bandRow_ < ntiles_)
+    if (FlushRows()) break;
+  Farray().swap( band_ );
+  // Any previously cached tiles may be out of date.
+  tileSlot_.assign( tileSlot_.size(), -1 );
+  slotTile_.assign( slotTile_.size(), -1 );
+  slotUsed_.assign( slotUsed_.size(), 0 );
+}
+
+// -----------------------------------------------------------------------------
+/** Tiles not in the cache are read into the least-recently used slot. The
+  * cache is allocated on first use. Must not be called by multiple threads
+  * at once.
+  */
+const float* DataSet_Cmatrix_TILE::Tile(unsigned int I, unsigned int J) const {
+  size_t tidx = TileRowStart( I ) + (J - I);
+  int slot = tileSlot_[tidx];
+  if (slot < 0) {
+    if (cache_.empty()) {
+      size_t nslots = maxCacheBytes_ / (tileSize_ * sizeof(float));
+      if (nslots < 1) nslots = 1;
+      if (nslots > tileSlot_.size()) nslots = tileSlot_.size();
+      cache_.resize( nslots * tileSize_ );
+      slotTile_.assign( nslots, -1 );
+      slotUsed_.assign( nslots, 0 );
+    }
+    // Find least recently used slot; empty slots are never used.
+    slot = 0;
+    for (int s = 1; s != (int)slotUsed_.size() && slotUsed_[slot] > 0; s++)
+      if (slotUsed_[s] < slotUsed_[slot])
+        slot = s;
+    if (slotTile_[slot] != -1)
+      tileSlot_[ slotTile_[slot] ] = -1;
+    float* tptr = &cache_[0] + (size_t)slot * tileSize_;
+    if (readFully( fd_, tptr, tileSize_ * sizeof(float),
+                   (off_t)(tidx * tileSize_ * sizeof(float)) ))
+    {
+      mprinterr("Error: Could not read tile %zu from pair-wise matrix file '%s'\n",
+                tidx, tfname_.full());
+      slotTile_[slot] = -1;
+      slotUsed_[slot] = 0;
+      return 0;
+    }
+    slotTile_[slot] = (int)tidx;
+    tileSlot_[tidx] = slot;
+  }
+  slotUsed_[slot] = ++useCount_;
+  return &cache_[0] + (size_t)slot * tileSize_;
+}
+
+/** \return Element at row i and column j, i < j. */
+float DataSet_Cmatrix_TILE::Element(unsigned int i, unsigned int j) const {
+  const float* tptr = Tile(i / tdim_, j / tdim_);
+  if (tptr == 0) return 0.0f;
+  return tptr[ (i % tdim_) * tdim_ + (j % tdim_) ];
+}
+
+// DataSet_Cmatrix_TILE::GetFdist()
+double DataSet_Cmatrix_TILE::GetFdist(int x, int y) const {
+  int i = sievedFrames_.FrameToIdx( x );
+  int j = sievedFrames_.FrameToIdx( y );
+  if (i == j) return 0.0;
+  if (j < i) std::swap( i, j );
+  float val;
+# ifdef _OPENMP
+# pragma omp critical(cmatrix_tile)
+# endif
+  val = Element( i, j );
+  return (double)val;
+}
+
+/** Convert an index into the upper triangle into row and column. */
+double DataSet_Cmatrix_TILE::GetElement(unsigned int idxIn) const {
+  size_t idx = idxIn;
+  size_t N = nrows_;
+  // Row i starts at index i*N - (i*(i+1))/2.
+  double b = (double)N - 0.5;
+  double disc = b * b - 2.0 * (double)idx;
+  size_t i = (disc > 0.0) ? (size_t)(b - sqrt(disc)) : 0;
+  while (i > 0 && i * N - (i * (i + 1)) / 2 > idx) --i;
+  while ((i + 1) * N - ((i + 1) * (i + 2)) / 2 <= idx) ++i;
+  size_t j = idx - (i * N - (i * (i + 1)) / 2) + i + 1;
+  float val;
+# ifdef _OPENMP
+# pragma omp critical(cmatrix_tile)
+# endif
+  val = Element( i, j );
+  return (double)val;
+}
+
+// DataSet_Cmatrix_TILE::WriteBuffer()
+void DataSet_Cmatrix_TILE::WriteBuffer(CpptrajFile& outfile, SizeArray const& pIn) const {
+  size_t x = (size_t)pIn[0];
+  size_t y = (size_t)pIn[1];
+  float val = 0.0f;
+  if ( x < nrows_ && y < nrows_ && x != y ) {
+    if (y < x) std::swap( x, y );
+#   ifdef _OPENMP
+#   pragma omp critical(cmatrix_tile)
+#   endif
+    val = Element( x, y );
+  }
+  outfile.Printf(format_.fmt(), val);
+}
+
+/** Row elements before the diagonal tile are columns of tiles above it, row
+  * elements after it are rows of tiles to the right of it. Each tile is
+  * fetched once.
+  */
+int DataSet_Cmatrix_TILE::GetRow(unsigned int row, double* rowOut) const {
+  unsigned int I = row / tdim_;
+  unsigned int r = row % tdim_;
+  int err = 0;
+# ifdef _OPENMP
+# pragma omp critical(cmatrix_tile)
+# endif
+  {
+  for (unsigned int J = 0; J != ntiles_ && err == 0; J++) {
+    unsigned int c0 = J * tdim_;
+    unsigned int ncols = std::min( tdim_, nrows_ - c0 );
+    double* out = rowOut + c0;
+    if (J < I) {
+      const float* tptr = Tile(J, I);
+      if (tptr == 0)
+        err = 1;
+      else {
+        tptr += r;
+        for (unsigned int c = 0; c != ncols; c++)
+          out[c] = tptr[c * tdim_];
+      }
+    } else if (J > I) {
+      const float* tptr = Tile(I, J);
+      if (tptr == 0)
+        err = 1;
+      else {
+        tptr += r * tdim_;
+        std::copy( tptr, tptr + ncols, out );
+      }
+    } else {
+      const float* tptr = Tile(I, I);
+      if (tptr == 0)
+        err = 1;
+      else {
+        for (unsigned int c = 0; c != r; c++)
+          out[c] = tptr[c * tdim_ + r];
+        out[r] = 0.0;
+        for (unsigned int c = r + 1; c < ncols; c++)
+          out[c] = tptr[r * tdim_ + c];
+      }
+    }
+  }
+  }
+  return err;
+}
+
+/** Only the diagonal tile and tiles to the right of it are fetched. */
+int DataSet_Cmatrix_TILE::GetUpperRow(unsigned int row, double* rowOut) const {
+  unsigned int I = row / tdim_;
+  unsigned int r = row % tdim_;
+  int err = 0;
+# ifdef _OPENMP
+# pragma omp critical(cmatrix_tile)
+# endif
+  {
+  for (unsigned int J = I; J < ntiles_ && err == 0; J++) {
+    unsigned int c0 = J * tdim_;
+    unsigned int ncols = std::min( tdim_, nrows_ - c0 );
+    double* out = rowOut + c0;
+    const float* tptr = Tile(I, J);
+    if (tptr == 0)
+      err = 1;
+    else {
+      tptr += r * tdim_;
+      if (J > I)
+        std::copy( tptr, tptr + ncols, out );
+      else
+        for (unsigned int c = r + 1; c < ncols; c++)
+          out[c] = tptr[c];
+    }
+  }
+  }
+  return err;
+}
+#endif /* _WIN32 */
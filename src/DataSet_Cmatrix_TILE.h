@@ -0,0 +1,98 @@
+#ifndef INC_DATASET_CMATRIX_TILE_H
+#define INC_DATASET_CMATRIX_TILE_H
+#ifndef _WIN32
+#include "DataSet_Cmatrix.h"
+#include "FileName.h"
+/// Pairwise distance matrix for clustering stored on disk in square tiles.
+/** The upper triangle of the matrix is divided into square tiles of
+  * TileDim() x TileDim() elements. Tiles are stored contiguously in a
+  * temporary file, one tile row after another, so that a block of
+  * TileDim() rows can be written with a single call during the pairwise
+  * calculation. Once the matrix is complete, tiles are read on demand into
+  * a least-recently-used cache of fixed size, so that scanning whole rows
+  * (via GetRow()) only touches disk once per tile instead of once per
+  * element. Cache access is serialized, so rows/elements may be requested
+  * from multiple threads.
+  */
+class DataSet_Cmatrix_TILE : public DataSet_Cmatrix {
+  public:
+    DataSet_Cmatrix_TILE();
+    ~DataSet_Cmatrix_TILE();
+    static DataSet* Alloc() { return (DataSet*)new DataSet_Cmatrix_TILE(); }
+    // ----- DataSet functions -------------------
+    size_t Size()                        const { return Nelements(); }
+    void Info() const;
+    void WriteBuffer(CpptrajFile&, SizeArray const&) const;
+    int Allocate(SizeArray const&) { return 0; }
+    /// \return Size in bytes of set
+    size_t MemUsageInBytes() const;
+    // ----- Cmatrix functions -------------------
+    /// \return an element indexed by sievedFrames.
+    double GetFdist(int, int) const;
+    /// Set element at column/row to given value
+    void SetElement(int, int, double);
+    /// \return Actual number of elements in matrix
+    size_t Nelements() const { return ((size_t)nrows_ * (nrows_ - 1)) / 2; }
+    /// \return size used by matrix in bytes
+    size_t DataSize() const { return MemUsageInBytes() + sievedFrames_.DataSize(); }
+    /// \return Actual number of rows in the matrix
+    size_t Nrows()                       const { return nrows_;           }
+    /// \return Element at given index.
+    double GetElement(unsigned int) const;
+    /// \return true if matrix needs setup
+    bool NeedsSetup()                    const { return (nrows_ < 1);     }
+    /// \return true if matrix needs calculation
+    bool NeedsCalc()                     const { return true;             }
+    /// No more distances will be added; write any remaining tiles to disk.
+    void Complete();
+    /// Fill given array with distances from given row to every row.
+    int GetRow(unsigned int, double*) const;
+    /// Fill given array with distances from given row to every later row.
+    int GetUpperRow(unsigned int, double*) const;
+    /// \return Number of rows in each block of tiles written to disk.
+    unsigned int RowsPerFlush()          const { return tdim_;            }
+    /// Write current block of tiles to disk.
+    int FlushRows();
+    // -------------------------------------------
+    /// Set max memory to be used for the tile cache in bytes.
+    void SetCacheSize(size_t bytesIn) { maxCacheBytes_ = bytesIn; }
+    /// \return Number of rows/columns in each tile.
+    unsigned int TileDim()               const { return tdim_;            }
+  protected:
+    int AllocateCmatrix(size_t);
+    int SetCdist(ClusterDist*) { return 0; }
+  private:
+    typedef std::vector<float> Farray;
+    // Disable copy and assignment; the set owns the file.
+    DataSet_Cmatrix_TILE(DataSet_Cmatrix_TILE const&);
+    DataSet_Cmatrix_TILE& operator=(DataSet_Cmatrix_TILE const&);
+
+    /// \return Index in file of first tile in given tile row.
+    size_t TileRowStart(unsigned int I) const {
+      return (size_t)I * ntiles_ - ((size_t)I * (I - 1)) / 2;
+    }
+    /// \return Element at given row and column (row < col).
+    float Element(unsigned int, unsigned int) const;
+    /// \return Pointer to tile (I, J), reading it into the cache if needed; 0 on read error.
+    const float* Tile(unsigned int, unsigned int) const;
+    void FreeFile();
+
+    FileName tfname_;        ///< Temporary file name.
+    int fd_;                 ///< Temporary file descriptor.
+    unsigned int nrows_;     ///< Number of rows (and columns) in matrix.
+    unsigned int tdim_;      ///< Number of rows (and columns) in each tile.
+    unsigned int ntiles_;    ///< Number of tiles in each row/column of the full matrix.
+    size_t tileSize_;        ///< Number of elements in each tile.
+    size_t maxCacheBytes_;   ///< Max memory to be used for cached tiles.
+    // Tile row currently being written
+    Farray band_;            ///< Tiles (I, I) to (I, ntiles_-1) for tile row I being written.
+    unsigned int bandRow_;   ///< Current tile row being written.
+    // LRU cache of tiles
+    mutable Farray cache_;                    ///< Cached tiles, tileSize_ elements per slot.
+    mutable std::vector<int> slotTile_;       ///< Index of tile in each slot, -1 if empty.
+    mutable std::vector<unsigned long> slotUsed_; ///< When each slot was last used.
+    mutable std::vector<int> tileSlot_;       ///< Slot for each tile, -1 if not cached.
+    mutable unsigned long useCount_;          ///< Incremented every time a tile is used.
+};
+#endif /* _WIN32 */
+#endif
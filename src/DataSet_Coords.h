@@ -23,6 +23,10 @@ class DataSet_Coords : public DataSet {
     virtual void GetFrame(int, Frame&, AtomMask const&) = 0;
     /// Set topology and coordinate information associated with this COORDS set.
     virtual int CoordsSetup(Topology const&, CoordinateInfo const&) = 0;
+    /// \return Estimated memory usage in bytes for given # of frames; 0 if not held in memory.
+    virtual size_t EstSizeInBytes(size_t) const { return 0; }
+    /// \return true if a frame could not be stored by AddFrame().
+    virtual bool AddFrameFailed() const { return false; }
     // -------------------------------------------
     /// Allocate a Frame that can be used to store COORDS 
     Frame AllocateFrame() const;
@@ -1,10 +1,17 @@
 #include "DataSet_Coords_CRD.h"
 #include "CpptrajStdio.h"
 #include "StringRoutines.h" // ByteString
+#include <algorithm> // std::fill, std::min
 
+/** Reserve space for the given number of frames. Since all frames are stored
+  * in one array, this avoids repeated reallocation as frames are added. If
+  * the frame size is not yet known space will be reserved in CoordsSetup().
+  */
 int DataSet_Coords_CRD::Allocate(SizeArray const& sizeIn) {
-  if (!sizeIn.empty())
-    coords_.reserve( sizeIn[0] );
+  if (!sizeIn.empty()) {
+    nreserve_ = sizeIn[0];
+    coords_.reserve( nreserve_ * frameSize_ );
+  }
   return 0;
 }
 
@@ -16,6 +23,17 @@ int DataSet_Coords_CRD::CoordsSetup(Topology const& topIn, CoordinateInfo const&
     numBoxCrd_ = 6;
   else
     numBoxCrd_ = 0;
+  size_t newFrameSize = (size_t)numCrd_ + (size_t)numBoxCrd_;
+  if (cInfo_.HasVel())
+    newFrameSize += (size_t)numCrd_;
+  if (nframes_ > 0 && newFrameSize != frameSize_) {
+    mprinterr("Error: Cannot change size of frames in COORDS set '%s' (%zu) once\n"
+              "Error:  frames have been added (%zu).\n", legend(), frameSize_, newFrameSize);
+    return 1;
+  }
+  frameSize_ = newFrameSize;
+  if (nreserve_ > 0)
+    coords_.reserve( nreserve_ * frameSize_ );
   // FIXME: The COORDS DataSet cannot store things like rep dims, times, or
   //        temperatures. Remove these from the CoordinateInfo and warn.
   if (cInfo_.ReplicaDimensions().Ndims() > 0) {
@@ -33,9 +51,29 @@ int DataSet_Coords_CRD::CoordsSetup(Topology const& topIn, CoordinateInfo const&
   return 0;
 }
 
-size_t DataSet_Coords_CRD::sizeInBytes(size_t nframes, size_t natom, size_t nbox) {
-  size_t frame_size_bytes = ((natom * 3UL) + nbox) * sizeof(float);
-  return ((nframes * frame_size_bytes) + sizeof(CRDarray));
+/** Store a frame whose # of atoms does not match the set; extra atoms are
+  * discarded and missing atoms are zeroed.
+  */
+void DataSet_Coords_CRD::setMismatchedCRD(size_t idx, Frame const& fIn) {
+  float* crd = &coords_[0] + (idx * frameSize_);
+  std::fill( crd, crd + frameSize_, 0.0f );
+  int ncrd = std::min( fIn.size(), numCrd_ );
+  for (int ix = 0; ix != ncrd; ix++)
+    crd[ix] = (float)fIn[ix];
+  crd += numCrd_;
+  if (cInfo_.HasVel()) {
+    if (fIn.HasVelocity()) {
+      for (int iv = 0; iv != ncrd; iv++)
+        crd[iv] = (float)fIn.vAddress()[iv];
+    }
+    crd += numCrd_;
+  }
+  for (int ib = 0; ib < numBoxCrd_; ib++)
+    crd[ib] = (float)fIn.bAddress()[ib];
+}
+
+size_t DataSet_Coords_CRD::sizeInBytes(size_t nframes, size_t frameSize) {
+  return ((nframes * frameSize * sizeof(float)) + sizeof(CRDarray));
 }
 
 #ifdef MPI
@@ -45,16 +83,16 @@ int DataSet_Coords_CRD::Sync(size_t total, std::vector<int> const& rank_frames,
   if (commIn.Size()==1) return 0;
   if (commIn.Master()) {
     // Resize for total number of frames.
-    coords_.resize( total, std::vector<float>( numCrd_+numBoxCrd_ ) );
-    int cidx = rank_frames[0]; // Index on master
+    coords_.resize( total * frameSize_ );
+    float* endptr = &coords_[0] + (rank_frames[0] * frameSize_);
     // Receive data from each rank
     for (int rank = 1; rank < commIn.Size(); rank++) {
-      for (int ridx = 0; ridx != rank_frames[rank]; ridx++, cidx++)
-        commIn.SendMaster( &(coords_[cidx][0]), numCrd_+numBoxCrd_, rank, MPI_FLOAT );
+      commIn.SendMaster( endptr, rank_frames[rank] * frameSize_, rank, MPI_FLOAT );
+      endptr += (rank_frames[rank] * frameSize_);
     }
+    nframes_ = total;
   } else // Send data to master
-    for (unsigned int ridx = 0; ridx != coords_.size(); ++ridx)
-      commIn.SendMaster( &(coords_[ridx][0]), numCrd_+numBoxCrd_, commIn.Rank(), MPI_FLOAT );
+    commIn.SendMaster( &coords_[0], coords_.size(), commIn.Rank(), MPI_FLOAT );
   return 0;
 }
 #endif
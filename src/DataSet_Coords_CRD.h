@@ -1,12 +1,18 @@
 #ifndef INC_DATASET_COORDS_CRD_H
 #define INC_DATASET_COORDS_CRD_H
 #include "DataSet_Coords.h"
+/// Hold coordinate frames in memory.
+/** All frames are stored in a single contiguous float array; each frame
+  * occupies a fixed number of elements (frameSize_): coordinates, then
+  * velocities (if present), then box (if present).
+  */
 class DataSet_Coords_CRD : public DataSet_Coords {
   public:
-    DataSet_Coords_CRD() : DataSet_Coords(COORDS), numCrd_(0), numBoxCrd_(0) {}
+    DataSet_Coords_CRD() : DataSet_Coords(COORDS), nframes_(0), nreserve_(0),
+                           frameSize_(0), numCrd_(0), numBoxCrd_(0) {}
     static DataSet* Alloc() { return (DataSet*)new DataSet_Coords_CRD(); }
     // ----- DataSet functions -------------------
-    size_t Size() const                       { return coords_.size(); }
+    size_t Size() const                       { return nframes_; }
 #   ifdef MPI
     int Sync(size_t, std::vector<int> const&, Parallel::Comm const&);
 #   endif
@@ -17,32 +23,48 @@ class DataSet_Coords_CRD : public DataSet_Coords {
     size_t MemUsageInBytes() const { return EstSizeInBytes(Size()); }
     // ----- DataSet_Coords functions ------------
     /// Add a frame.
-    inline void AddFrame(Frame const& fIn) { 
-      coords_.push_back( fIn.ConvertToCRD(numBoxCrd_, cInfo_.HasVel()) );
+    inline void AddFrame(Frame const& fIn) {
+      coords_.resize( coords_.size() + frameSize_ );
+      setCRD( nframes_++, fIn );
     }
     /// Get a frame at position.
     inline void GetFrame(int idx, Frame& fIn) { 
-      fIn.SetFromCRD( coords_[idx], numCrd_, numBoxCrd_, cInfo_.HasVel() );
+      fIn.SetFromCRD( CRD(idx), numCrd_, numBoxCrd_, cInfo_.HasVel() );
     }
     /// Get a frame at position corresponding to mask.
     inline void GetFrame(int idx, Frame& fIn, AtomMask const& mIn) {
-      fIn.SetFromCRD( coords_[idx], mIn, numCrd_, numBoxCrd_, cInfo_.HasVel() );
+      fIn.SetFromCRD( CRD(idx), mIn, numCrd_, numBoxCrd_, cInfo_.HasVel() );
     }
     /// Set CRD at position with frame.
-    inline void SetCRD(int idx, Frame const& fIn) {
-      coords_[idx] = fIn.ConvertToCRD(numBoxCrd_, cInfo_.HasVel());
-    }
+    inline void SetCRD(int idx, Frame const& fIn) { setCRD( idx, fIn ); }
     /// Set topology and coordinate information
     int CoordsSetup(Topology const&, CoordinateInfo const&);
     // -------------------------------------------
+    /// \return Pointer to start of frame at position (coords, [velocities], [box]).
+    inline const float* CRD(int idx) const { return &coords_[0] + ((size_t)idx * frameSize_); }
+    /// \return Number of floats each frame occupies.
+    size_t FrameSize() const { return frameSize_; }
+    /// \return Number of coordinates in each frame.
+    int NumCrd()       const { return numCrd_; }
     /// \return estimated size in bytes for given # of frames.
-    size_t EstSizeInBytes(size_t nframes) const { return sizeInBytes(nframes, Top().Natom(), numBoxCrd_); }
+    size_t EstSizeInBytes(size_t nframes) const { return sizeInBytes(nframes, frameSize_); }
   private:
-    static size_t sizeInBytes(size_t, size_t, size_t);
+    static size_t sizeInBytes(size_t, size_t);
+    /// Convert frame directly into storage at given position.
+    inline void setCRD(size_t idx, Frame const& fIn) {
+      if (fIn.size() == numCrd_)
+        fIn.ConvertToCRD( &coords_[0] + (idx * frameSize_), numBoxCrd_, cInfo_.HasVel() );
+      else
+        setMismatchedCRD( idx, fIn );
+    }
+    void setMismatchedCRD(size_t, Frame const&);
 
-    typedef std::vector<Frame::CRDtype> CRDarray;
-    CRDarray coords_; ///< Array of coordinate frames.
-    int numCrd_;      ///< Number of coordinates
-    int numBoxCrd_;   ///< Number of box coords (0 or 6).
+    typedef std::vector<float> CRDarray;
+    CRDarray coords_;  ///< Contiguous array of coordinate frames.
+    size_t nframes_;   ///< Number of frames currently stored.
+    size_t nreserve_;  ///< Number of frames to reserve space for.
+    size_t frameSize_; ///< Number of floats in each frame.
+    int numCrd_;       ///< Number of coordinates
+    int numBoxCrd_;    ///< Number of box coords (0 or 6).
 };
 #endif
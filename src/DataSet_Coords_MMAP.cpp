@@ -0,0 +1,221 @@
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm> // std::fill, std::min
+#include "DataSet_Coords_MMAP.h"
+#include "CpptrajStdio.h"
+#include "File_TempName.h"
+
+/// CONSTRUCTOR
+DataSet_Coords_MMAP::DataSet_Coords_MMAP() :
+  DataSet_Coords(COORDS),
+  fd_(-1),
+  map_(0),
+  nframes_(0),
+  nreserve_(0),
+  maxFrames_(0),
+  frameSize_(0),
+  numCrd_(0),
+  numBoxCrd_(0),
+  failed_(false)
+{}
+
+/// DESTRUCTOR
+DataSet_Coords_MMAP::~DataSet_Coords_MMAP() {
+  Unmap();
+  if (fd_ != -1) close( fd_ );
+  if (!tfname_.empty()) File::FreeTempName( tfname_ );
+}
+
+/** Remove current mapping if present. */
+void DataSet_Coords_MMAP::Unmap() {
+  if (map_ != 0) {
+    munmap( (void*)map_, maxFrames_ * frameSize_ * sizeof(float) );
+    map_ = 0;
+  }
+}
+
+#ifdef MPI
+// DataSet_Coords_MMAP::Sync()
+/** Receive frames from each rank into the master cache, growing the cache
+  * as needed. Each rank sends its frames in rank order.
+  */
+int DataSet_Coords_MMAP::Sync(size_t total, std::vector<int> const& rank_frames,
+                              Parallel::Comm const& commIn)
+{
+  if (commIn.Size()==1) return 0;
+  // Ensure master has room for all frames and no rank has failed.
+  int err = 0;
+  if (failed_)
+    err = 1;
+  else if (commIn.Master())
+    err = Reserve( total );
+  if (commIn.CheckError( err )) {
+    mprinterr("Error: Could not sync disk-cached COORDS set '%s'.\n", legend());
+    return 1;
+  }
+  if (commIn.Master()) {
+    float* endptr = map_ + ((size_t)rank_frames[0] * frameSize_);
+    // Receive data from each rank
+    for (int rank = 1; rank < commIn.Size(); rank++) {
+      commIn.SendMaster( endptr, rank_frames[rank] * frameSize_, rank, MPI_FLOAT );
+      endptr += ((size_t)rank_frames[rank] * frameSize_);
+    }
+    nframes_ = total;
+  } else // Send data to master
+    commIn.SendMaster( map_, nframes_ * frameSize_, commIn.Rank(), MPI_FLOAT );
+  return 0;
+}
+#endif
+
+// DataSet_Coords_MMAP::Info()
+void DataSet_Coords_MMAP::Info() const {
+  mprintf(" (cached)");
+  CommonInfo();
+}
+
+/** Ensure the file and mapping have room for at least the given number of
+  * frames. The file is grown with ftruncate() and remapped. Any existing
+  * mapping is only replaced once the new mapping succeeds, so frames already
+  * cached remain accessible on error. If the frame size is not yet known
+  * nothing is done; space will be reserved in CoordsSetup().
+  * \return 0 on success, 1 on error.
+  */
+int DataSet_Coords_MMAP::Reserve(size_t nframesIn) {
+  if (nframesIn <= maxFrames_ || frameSize_ == 0) return 0;
+  if (fd_ == -1) {
+    tfname_ = File::GenTempName();
+    if (tfname_.empty()) {
+      mprinterr("Internal Error: Could not get temporary file name for disk-cached COORDS set.\n");
+      return 1;
+    }
+    fd_ = open( tfname_.full(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+    if (fd_ == -1) {
+      mprinterr("Error: Could not create disk cache file '%s' for COORDS set.\n", tfname_.full());
+      return 1;
+    }
+  }
+  // Growing the file does not affect the current mapping.
+  size_t nbytes = nframesIn * frameSize_ * sizeof(float);
+  if (ftruncate( fd_, (off_t)nbytes ) != 0) {
+    mprinterr("Error: Could not resize disk cache file '%s' to %zu bytes.\n",
+              tfname_.full(), nbytes);
+    return 1;
+  }
+  void* ptr = mmap( 0, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0 );
+  if (ptr == MAP_FAILED) {
+    mprinterr("Error: Could not memory-map disk cache file '%s'.\n", tfname_.full());
+    return 1;
+  }
+  Unmap();
+  map_ = (float*)ptr;
+  maxFrames_ = nframesIn;
+  return 0;
+}
+
+// DataSet_Coords_MMAP::Allocate()
+/** Reserve space in the cache file for the given number of frames. If the
+  * frame size is not yet known space will be reserved in CoordsSetup().
+  */
+int DataSet_Coords_MMAP::Allocate(SizeArray const& sizeIn) {
+  if (!sizeIn.empty()) {
+    nreserve_ = sizeIn[0];
+    return Reserve( nreserve_ );
+  }
+  return 0;
+}
+
+// DataSet_Coords_MMAP::CoordsSetup()
+int DataSet_Coords_MMAP::CoordsSetup(Topology const& topIn, CoordinateInfo const& cInfoIn) {
+  top_ = topIn;
+  cInfo_ = cInfoIn;
+  numCrd_ = top_.Natom() * 3;
+  if (cInfo_.TrajBox().HasBox())
+    numBoxCrd_ = 6;
+  else
+    numBoxCrd_ = 0;
+  size_t newFrameSize = (size_t)numCrd_ + (size_t)numBoxCrd_;
+  if (cInfo_.HasVel())
+    newFrameSize += (size_t)numCrd_;
+  if (nframes_ > 0 && newFrameSize != frameSize_) {
+    mprinterr("Error: Cannot change size of frames in COORDS set '%s' (%zu) once\n"
+              "Error:  frames have been added (%zu).\n", legend(), frameSize_, newFrameSize);
+    return 1;
+  }
+  if (newFrameSize != frameSize_) {
+    Unmap();
+    frameSize_ = newFrameSize;
+    maxFrames_ = 0;
+    if (Reserve( nreserve_ )) return 1;
+  }
+  // COORDS data sets cannot store things like rep dims, times, or temperatures.
+  if (cInfo_.ReplicaDimensions().Ndims() > 0) {
+    mprintf("Warning: COORDS data sets do not store replica dimensions.\n");
+    cInfo_.SetReplicaDims( ReplicaDimArray() );
+  }
+  if (cInfo_.HasTemp()) {
+    mprintf("Warning: COORDS data sets do not store temperatures.\n");
+    cInfo_.SetTemperature( false );
+  }
+  if (cInfo_.HasTime()) {
+    mprintf("Warning: COORDS data sets do not store times.\n");
+    cInfo_.SetTime( false );
+  }
+  return 0;
+}
+
+// DataSet_Coords_MMAP::SetCRD()
+void DataSet_Coords_MMAP::SetCRD(int idx, Frame const& fIn) {
+  if (idx < 0 || (size_t)idx >= maxFrames_) {
+    mprinterr("Internal Error: Frame %i is outside disk-cached COORDS set '%s' (%zu frames).\n",
+              idx + 1, legend(), maxFrames_);
+    return;
+  }
+  float* crd = map_ + ((size_t)idx * frameSize_);
+  if (fIn.size() == numCrd_) {
+    fIn.ConvertToCRD( crd, numBoxCrd_, cInfo_.HasVel() );
+    return;
+  }
+  // # atoms does not match the set; discard extra atoms and zero missing ones.
+  std::fill( crd, crd + frameSize_, 0.0f );
+  int ncrd = std::min( fIn.size(), numCrd_ );
+  for (int ix = 0; ix != ncrd; ix++)
+    crd[ix] = (float)fIn[ix];
+  crd += numCrd_;
+  if (cInfo_.HasVel()) {
+    if (fIn.HasVelocity()) {
+      for (int iv = 0; iv != ncrd; iv++)
+        crd[iv] = (float)fIn.vAddress()[iv];
+    }
+    crd += numCrd_;
+  }
+  for (int ib = 0; ib < numBoxCrd_; ib++)
+    crd[ib] = (float)fIn.bAddress()[ib];
+}
+
+// DataSet_Coords_MMAP::AddFrame()
+/** Add frame to the end of the cache, doubling the cache size if needed.
+  * If the cache cannot be grown the set is marked as failed and no further
+  * frames are added; callers should check AddFrameFailed().
+  */
+void DataSet_Coords_MMAP::AddFrame(Frame const& fIn) {
+  if (failed_) return;
+  if (frameSize_ == 0) {
+    mprinterr("Error: Disk-cached COORDS set '%s' has not been set up; cannot add frames.\n",
+              legend());
+    failed_ = true;
+    return;
+  }
+  if (nframes_ == maxFrames_) {
+    if (Reserve( std::max( (size_t)1, maxFrames_ * 2 ) )) {
+      mprinterr("Error: Could not add frame %zu to disk-cached COORDS set '%s'.\n",
+                nframes_ + 1, legend());
+      failed_ = true;
+      return;
+    }
+  }
+  SetCRD( nframes_++, fIn );
+}
+#endif /* _WIN32 */
@@ -0,0 +1,68 @@
+#ifndef INC_DATASET_COORDS_MMAP_H
+#define INC_DATASET_COORDS_MMAP_H
+#ifndef _WIN32
+#include "DataSet_Coords.h"
+#include "FileName.h"
+/// COORDS data set cached to a temporary file and accessed via mmap.
+/** Frames are stored as fixed-size float records (coordinates, then
+  * velocities if present, then box if present) in a temporary binary file
+  * that is memory-mapped, so random access is served from the OS page cache
+  * instead of re-reading the original trajectories. Useful when coordinates
+  * do not fit in memory. Since the mapping is read-only during GetFrame(),
+  * frames may be read by multiple threads at once.
+  */
+class DataSet_Coords_MMAP : public DataSet_Coords {
+  public:
+    DataSet_Coords_MMAP();
+    ~DataSet_Coords_MMAP();
+    static DataSet* Alloc() { return (DataSet*)new DataSet_Coords_MMAP(); }
+    // ----- DataSet functions -------------------
+    size_t Size() const { return nframes_; }
+#   ifdef MPI
+    int Sync(size_t, std::vector<int> const&, Parallel::Comm const&);
+#   endif
+    void Info() const;
+    void Add(size_t, const void*) {}
+    int Allocate(SizeArray const&);
+    size_t MemUsageInBytes() const { return 0; }
+    // ----- DataSet_Coords functions ------------
+    /// Add a frame.
+    void AddFrame(Frame const&);
+    /// Get a frame at position.
+    void GetFrame(int idx, Frame& fIn) {
+      fIn.SetFromCRD( CRD(idx), numCrd_, numBoxCrd_, cInfo_.HasVel() );
+    }
+    /// Get a frame at position corresponding to mask.
+    void GetFrame(int idx, Frame& fIn, AtomMask const& mIn) {
+      fIn.SetFromCRD( CRD(idx), mIn, numCrd_, numBoxCrd_, cInfo_.HasVel() );
+    }
+    /// Set CRD at position with frame.
+    void SetCRD(int, Frame const&);
+    /// \return true if cache could not be grown to store a frame.
+    bool AddFrameFailed() const { return failed_; }
+    /// Set topology and coordinate information
+    int CoordsSetup(Topology const&, CoordinateInfo const&);
+    // -------------------------------------------
+    /// \return Pointer to start of frame at position (coords, [velocities], [box]).
+    const float* CRD(int idx) const { return map_ + ((size_t)idx * frameSize_); }
+  private:
+    // Disable copy and assignment; the set owns the mapping.
+    DataSet_Coords_MMAP(DataSet_Coords_MMAP const&);
+    DataSet_Coords_MMAP& operator=(DataSet_Coords_MMAP const&);
+
+    int Reserve(size_t);
+    void Unmap();
+
+    FileName tfname_;  ///< Temporary file name.
+    int fd_;           ///< Temporary file descriptor.
+    float* map_;       ///< Start of mapped file.
+    size_t nframes_;   ///< Number of frames currently stored.
+    size_t nreserve_;  ///< Number of frames requested via Allocate().
+    size_t maxFrames_; ///< Number of frames file/mapping currently has room for.
+    size_t frameSize_; ///< Number of floats in each frame.
+    int numCrd_;       ///< Number of coordinates.
+    int numBoxCrd_;    ///< Number of box coords (0 or 6).
+    bool failed_;      ///< True if a frame could not be added; no more frames are added.
+};
+#endif /* _WIN32 */
+#endif
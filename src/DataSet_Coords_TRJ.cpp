@@ -85,43 +85,49 @@ int DataSet_Coords_TRJ::AddInputTraj(Trajin* tIn) {
   return 0;
 }
 
-void DataSet_Coords_TRJ::GetFrame(int idx, Frame& fIn) {
-# ifdef _OPENMP
-# pragma omp critical
-  {
-# endif
-  int err = 0; // NOTE: Needed because exiting from OMP critical block is illegal.
+/** Read frame at global index idx into fIn. Since this may change the current
+  * trajectory it should only be called by one thread at a time.
+  * \return 0 if frame was read, 1 on error.
+  */
+int DataSet_Coords_TRJ::GetFrameNoLock(int idx, Frame& fIn) {
   // Determine which trajectory has the desired index
   int internalIdx = IDX_.FindIndex( idx );
   if (internalIdx < 0) {
     mprinterr("Internal Error: Global index %i is out of range.\n", idx);
-    err = 1;
-  } else {
-    // If desired traj is different than current, open desired traj
-    if (IDX_.TrajHasChanged()) {
-      if (Traj_ != 0) Traj_->EndTraj();
-      Trajin* previousTraj = Traj_;
-      Traj_ = trajinList_[ IDX_.CurrentTrajNum() ];
-      // NOTE: Currently enforcing all traj have same # atoms, no need to check topology.
-      // See if frame needs (re-)allocation.
-      if (previousTraj == 0 || previousTraj->TrajCoordInfo() != Traj_->TrajCoordInfo())
-        readFrame_.SetupFrameV( Traj_->Traj().Parm()->Atoms(), Traj_->TrajCoordInfo() );
-      // Open traj.
-      if (Traj_->BeginTraj()) {
-        mprinterr("Error: Could not open trajectory %i '%s'\n", IDX_.CurrentTrajNum(),
-                  Traj_->Traj().Filename().full());
-        err = 1;
-      }
-    }
-    // Read the frame
-    // TODO: May need to use readFrame here as well...
-    if (err == 0) { 
-      if (Traj_->ReadTrajFrame( internalIdx, fIn )) {
-        mprinterr("Error: Could not read '%s' frame %i\n",
-                    Traj_->Traj().Filename().full(), internalIdx + 1);
-      }
+    return 1;
+  }
+  // If desired traj is different than current, open desired traj
+  if (IDX_.TrajHasChanged()) {
+    if (Traj_ != 0) Traj_->EndTraj();
+    Trajin* previousTraj = Traj_;
+    Traj_ = trajinList_[ IDX_.CurrentTrajNum() ];
+    // NOTE: Currently enforcing all traj have same # atoms, no need to check topology.
+    // See if frame needs (re-)allocation.
+    if (previousTraj == 0 || previousTraj->TrajCoordInfo() != Traj_->TrajCoordInfo())
+      readFrame_.SetupFrameV( Traj_->Traj().Parm()->Atoms(), Traj_->TrajCoordInfo() );
+    // Open traj.
+    if (Traj_->BeginTraj()) {
+      mprinterr("Error: Could not open trajectory %i '%s'\n", IDX_.CurrentTrajNum(),
+                Traj_->Traj().Filename().full());
+      return 1;
     }
   }
+  // Read the frame
+  // TODO: May need to use readFrame here as well...
+  if (Traj_->ReadTrajFrame( internalIdx, fIn )) {
+    mprinterr("Error: Could not read '%s' frame %i\n",
+                Traj_->Traj().Filename().full(), internalIdx + 1);
+    return 1;
+  }
+  return 0;
+}
+
+void DataSet_Coords_TRJ::GetFrame(int idx, Frame& fIn) {
+# ifdef _OPENMP
+# pragma omp critical
+  {
+# endif
+  GetFrameNoLock( idx, fIn );
 # ifdef _OPENMP
   }
 # endif
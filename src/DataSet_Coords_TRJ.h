@@ -32,6 +32,8 @@ class DataSet_Coords_TRJ : public DataSet_Coords {
     void GetFrame(int idx, Frame& fIn);
     /// Get a frame at position corresponding to mask.
     void GetFrame(int idx, Frame& fIn, AtomMask const& mIn);
+    /// Get a frame at position without locking; set must not be shared between threads.
+    int GetFrameNoLock(int, Frame&);
     /// Set topology and coordinate information.
     int CoordsSetup(Topology const&, CoordinateInfo const&);
    private:
@@ -0,0 +1,62 @@
+#include "DataSet_GridSparse.h"
+#include "CpptrajStdio.h"
+
+DataSet_GridSparse::DataSet_GridSparse(DataSet_GridSparse const& rhs) :
+  DataSet_3D(rhs), grid_(rhs.grid_) {}
+
+DataSet_GridSparse& DataSet_GridSparse::operator=(DataSet_GridSparse const& rhs) {
+  if (this == &rhs) return *this;
+  DataSet_3D::operator=(rhs);
+  grid_ = rhs.grid_;
+  return *this;
+}
+
+void DataSet_GridSparse::Info() const {
+  mprintf(" (%zu of %zu bricks allocated)", grid_.NbricksAllocated(), grid_.Nbricks());
+}
+
+void DataSet_GridSparse::WriteBuffer(CpptrajFile& outfile, SizeArray const& pIn) const {
+  size_t x = pIn[0];
+  size_t y = pIn[1];
+  size_t z = pIn[2];
+  if ( x >= grid_.NX() || y >= grid_.NY() || z >= grid_.NZ() )
+    outfile.Printf(format_.fmt(), 0.0);
+  else
+    outfile.Printf(format_.fmt(), grid_.element(x,y,z));
+}
+
+#ifdef MPI
+/** Bricks allocated on any rank are allocated on all ranks, then the
+  * allocated bricks are summed to the master.
+  */
+int DataSet_GridSparse::Sync(size_t total, std::vector<int> const& rank_frames,
+                             Parallel::Comm const& commIn)
+{
+  size_t nbricks = grid_.Nbricks();
+  std::vector<int> isAllocated( nbricks, 0 );
+  for (size_t b = 0; b != nbricks; b++)
+    if (grid_.Brick(b) != 0) isAllocated[b] = 1;
+  commIn.AllReduce( &(isAllocated[0]), nbricks, MPI_INT, MPI_MAX );
+  std::vector<float> buf;
+  for (size_t b = 0; b != nbricks; b++) {
+    if (isAllocated[b]) {
+      grid_.AllocateBrick( b );
+      buf.insert( buf.end(), grid_.Brick(b), grid_.Brick(b) + SparseGrid<float>::BVOXELS );
+    }
+  }
+  if (buf.empty()) return 0;
+  if (commIn.Master()) {
+    std::vector<float> sum( buf.size() );
+    commIn.ReduceMaster( &(sum[0]), &(buf[0]), buf.size(), MPI_FLOAT, MPI_SUM );
+    std::vector<float>::const_iterator it = sum.begin();
+    for (size_t b = 0; b != nbricks; b++) {
+      if (isAllocated[b]) {
+        std::copy( it, it + SparseGrid<float>::BVOXELS, grid_.Brick(b) );
+        it += SparseGrid<float>::BVOXELS;
+      }
+    }
+  } else
+    commIn.ReduceMaster( 0,          &(buf[0]), buf.size(), MPI_FLOAT, MPI_SUM );
+  return 0;
+}
+#endif
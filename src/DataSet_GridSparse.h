@@ -0,0 +1,72 @@
+#ifndef INC_DATASET_GRIDSPARSE_H
+#define INC_DATASET_GRIDSPARSE_H
+#include "DataSet_3D.h"
+#include "SparseGrid.h"
+/// Single-precision three-dimensional grid; memory is only allocated for 8x8x8 bricks that are written to.
+class DataSet_GridSparse : public DataSet_3D {
+  public:
+    DataSet_GridSparse() : DataSet_3D(GRID_SPARSE, TextFormat(TextFormat::DOUBLE, 12, 4)) {}
+    DataSet_GridSparse(DataSet_GridSparse const&);
+    DataSet_GridSparse& operator=(DataSet_GridSparse const&);
+    static DataSet* Alloc()       { return (DataSet*)new DataSet_GridSparse();  }
+    SparseGrid<float> const& InternalGrid() const { return grid_; }
+    // ----- DataSet functions -------------------
+    size_t Size()                        const { return grid_.size();        }
+#   ifdef MPI
+    int Sync(size_t, std::vector<int> const&, Parallel::Comm const&);
+#   endif
+    void Info() const;
+    void WriteBuffer(CpptrajFile&,SizeArray const&) const;
+    size_t MemUsageInBytes() const { return grid_.DataSize(); }
+    // ----- DataSet_3D functions ----------------
+    int Allocate3D(size_t x, size_t y, size_t z)          { return grid_.resize(x,y,z); }
+    double GetElement(size_t x, size_t y, size_t z) const { return (double)grid_.element(x,y,z); }
+    double operator[](size_t idx)                   const { return (double)grid_[idx];  }
+    size_t NX() const { return grid_.NX(); }
+    size_t NY() const { return grid_.NY(); }
+    size_t NZ() const { return grid_.NZ(); }
+    /// \return grid index
+    long int CalcIndex(size_t i, size_t j, size_t k) const { return grid_.CalcIndex(i,j,k); }
+    void ReverseIndex(long int n, size_t& i, size_t& j, size_t& k) const
+      { return grid_.ReverseIndex(n,i,j,k); }
+    inline void UpdateVoxel(long int, double);
+    // -------------------------------------------
+    void SetElement(size_t x,size_t y,size_t z,float v) { grid_.setGrid(x,y,z,v);     }
+    /// Type definition of iterator over voxels in allocated bricks.
+    typedef SparseGrid<float>::iterator iterator;
+    iterator begin() { return grid_.begin(); }
+    iterator end()   { return grid_.end();   }
+    /// Increment grid bin corresponding to point by given value.
+    inline long int Increment(Vec3 const&, float);
+    inline long int Increment(const double*, float);
+    /// Increment grid bin by given value.
+    long int Increment(size_t i,size_t j,size_t k,float f) { return grid_.incrementBy(i,j,k,f); }
+    /// \return grid value at specified bin.
+    float GridVal(size_t x,size_t y,size_t z)        const { return grid_.element(x,y,z);   }
+    /// \return Number of X planes spanned by each brick.
+    static size_t PlanesPerBrick() { return SparseGrid<float>::BSIZE; }
+  private:
+    SparseGrid<float> grid_;
+};
+// ----- INLINE FUNCTIONS ------------------------------------------------------
+// DataSet_GridSparse::UpdateVoxel()
+void DataSet_GridSparse::UpdateVoxel(long int idx, double val) {
+  size_t i,j,k;
+  grid_.ReverseIndex(idx,i,j,k);
+  grid_.incrementBy(i,j,k,(float)val);
+}
+// DataSet_GridSparse::Increment()
+long int DataSet_GridSparse::Increment(Vec3 const& xyz, float f) {
+  size_t i,j,k;
+  if (Bin().Calc(xyz[0],xyz[1],xyz[2],i,j,k))
+    return grid_.incrementBy(i,j,k,f);
+  return -1L;
+}
+// DataSet_GridSparse::Increment()
+long int DataSet_GridSparse::Increment(const double* xyz, float f) {
+  size_t i,j,k;
+  if (Bin().Calc(xyz[0],xyz[1],xyz[2],i,j,k))
+    return grid_.incrementBy(i,j,k,f);
+  return -1L;
+}
+#endif
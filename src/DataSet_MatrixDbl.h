@@ -30,6 +30,8 @@ class DataSet_MatrixDbl : public DataSet_2D {
     size_t Nrows()                       const { return mat_.Nrows();       }
     size_t Ncols()                       const { return mat_.Ncols();       }
     double* MatrixArray()                const;
+    /// \return Pointer to internal matrix elements (no copy).
+    const double* MatrixPtr()            const { return mat_.Ptr();         }
     MatrixKindType MatrixKind()          const { return kind_;              }
     // -------------------------------------------
     unsigned int Nsnapshots()            const { return snap_;              }
@@ -1,9 +1,15 @@
 #include <cmath> // sqrt
+#include <algorithm> // std::max, std::min
 #include "DataSet_Modes.h"
 #include "CpptrajStdio.h"
 #include "ArgList.h"
 #include "Constants.h" // PI, TWOPI
 #include "Frame.h"
+#include "DataSet_Coords.h"
+#include "Random.h"
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 #ifndef NO_MATHLIB
 // Definition of Fortran subroutines called from this class
@@ -21,6 +27,343 @@ extern "C" {
 }
 #endif
 
+#ifndef NO_MATHLIB
+// ----- Routines used by the block and randomized eigensolvers ----------------
+/// \return Dot product of two vectors of size n.
+static inline double VecDot(const double* v1, const double* v2, int n) {
+  double sum = 0.0;
+  for (int k = 0; k < n; k++)
+    sum += v1[k] * v2[k];
+  return sum;
+}
+
+/** Y = A * X for nvec vectors of size n stored one after another, where A is
+  * a symmetric matrix stored as an upper triangle (each row starting at the
+  * diagonal). For multiple vectors, X and Y are interleaved in the given work
+  * arrays so all values for one matrix row/column are contiguous. The rows of
+  * Y are divided into one block per thread; elements of A in the rows above
+  * a block are read as columns, so each thread only writes its own rows of Y.
+  */
+static void PackedMatVec(const double* mat, int n, const double* X, double* Y, int nvec,
+                         std::vector<double>& Xt, std::vector<double>& Yt)
+{
+  const double* xt = X;
+  double* yt = Y;
+  if (nvec > 1) {
+    Xt.resize( (size_t)n * nvec );
+    Yt.resize( (size_t)n * nvec );
+    for (int v = 0; v < nvec; v++)
+      for (int i = 0; i < n; i++)
+        Xt[(size_t)i * nvec + v] = X[(size_t)v * n + i];
+    xt = &Xt[0];
+    yt = &Yt[0];
+  }
+# ifdef _OPENMP
+# pragma omp parallel
+# endif
+  {
+  int block = 0;
+  int nblocks = 1;
+# ifdef _OPENMP
+  block = omp_get_thread_num();
+  nblocks = omp_get_num_threads();
+# endif
+  int beg = (int)(((long int)n * block) / nblocks);
+  int end = (int)(((long int)n * (block + 1)) / nblocks);
+  std::fill( yt + (size_t)beg * nvec, yt + (size_t)end * nvec, 0.0 );
+  // Elements A(k,i) with k above this block, stored in earlier rows.
+  for (int k = 0; k < beg; k++) {
+    // row[j] is A(k,j) for j >= k
+    const double* row = mat + (size_t)k * n - ((size_t)k * (k + 1)) / 2;
+    const double* xk = xt + (size_t)k * nvec;
+    for (int i = beg; i < end; i++) {
+      double aki = row[i];
+      double* yi = yt + (size_t)i * nvec;
+      for (int v = 0; v < nvec; v++)
+        yi[v] += aki * xk[v];
+    }
+  }
+  // Rows of this block from the diagonal on.
+  for (int i = beg; i < end; i++) {
+    const double* row = mat + (size_t)i * n - ((size_t)i * (i + 1)) / 2;
+    const double* xi = xt + (size_t)i * nvec;
+    double* yi = yt + (size_t)i * nvec;
+    for (int v = 0; v < nvec; v++)
+      yi[v] += row[i] * xi[v];
+    int j = i + 1;
+    for (; j < end; j++) {
+      double aij = row[j];
+      const double* xj = xt + (size_t)j * nvec;
+      double* yj = yt + (size_t)j * nvec;
+      for (int v = 0; v < nvec; v++) {
+        yi[v] += aij * xj[v];
+        yj[v] += aij * xi[v];
+      }
+    }
+    for (; j < n; j++) {
+      double aij = row[j];
+      const double* xj = xt + (size_t)j * nvec;
+      for (int v = 0; v < nvec; v++)
+        yi[v] += aij * xj[v];
+    }
+  }
+  } // END pragma omp parallel
+  if (nvec > 1) {
+    for (int v = 0; v < nvec; v++)
+      for (int i = 0; i < n; i++)
+        Y[(size_t)v * n + i] = Yt[(size_t)i * nvec + v];
+  }
+}
+
+/** Make vectors first to first+nvec-1 of V (each of size n) orthonormal to
+  * vectors 0 to first-1, which must already be orthonormal, and to each
+  * other. Everything is done twice, which is enough to keep orthogonality
+  * to machine precision. Vectors that turn out to be (nearly) linearly
+  * dependent on the others are replaced with random vectors.
+  */
+static void Orthonormalize(double* V, int n, int first, int nvec, Random_Number& rng) {
+  int last = first + nvec;
+  std::vector<double> norm0( nvec );
+  for (int v = first; v < last; v++)
+    norm0[v - first] = sqrt( VecDot(V + (size_t)v * n, V + (size_t)v * n, n) );
+  for (int pass = 0; pass < 2; pass++) {
+    int v, w;
+    // Remove components along previous vectors
+#   ifdef _OPENMP
+#   pragma omp parallel for private(v) schedule(dynamic)
+#   endif
+    for (v = first; v < last; v++) {
+      double* vv = V + (size_t)v * n;
+      for (int q = 0; q < first; q++) {
+        const double* qq = V + (size_t)q * n;
+        double d = VecDot(qq, vv, n);
+        for (int k = 0; k < n; k++)
+          vv[k] -= d * qq[k];
+      }
+    }
+    // Modified Gram-Schmidt within the block
+    for (v = first; v < last; v++) {
+      double* vv = V + (size_t)v * n;
+      double vnorm = sqrt( VecDot(vv, vv, n) );
+      if (pass == 0 && !(vnorm > 1.0E-10 * norm0[v - first])) {
+        for (int k = 0; k < n; k++)
+          vv[k] = rng.rn_gauss(0.0, 1.0);
+        for (int rpass = 0; rpass < 2; rpass++)
+          for (int q = 0; q < v; q++) {
+            const double* qq = V + (size_t)q * n;
+            double d = VecDot(qq, vv, n);
+            for (int k = 0; k < n; k++)
+              vv[k] -= d * qq[k];
+          }
+        vnorm = sqrt( VecDot(vv, vv, n) );
+      }
+      double scale = 1.0 / vnorm;
+      for (int k = 0; k < n; k++)
+        vv[k] *= scale;
+#     ifdef _OPENMP
+#     pragma omp parallel for private(w)
+#     endif
+      for (w = v + 1; w < last; w++) {
+        double* ww = V + (size_t)w * n;
+        double d = VecDot(vv, ww, n);
+        for (int k = 0; k < n; k++)
+          ww[k] -= d * vv[k];
+      }
+    }
+  }
+}
+
+/** Rayleigh-Ritz procedure. Given s orthonormal vectors V (each of size n)
+  * and W = A*V, diagonalize the projected matrix V^T*A*V and calculate the
+  * nritz Ritz vectors X with the largest Ritz values, along with A*X. Ritz
+  * values and vectors are stored in descending order.
+  */
+static int RayleighRitz(const double* V, const double* W, int n, int s, int nritz,
+                        double* vals, double* X, double* AX)
+{
+  // Projected matrix, upper triangle.
+  std::vector<double> T( (size_t)s * (s + 1) / 2 );
+  int i;
+# ifdef _OPENMP
+# pragma omp parallel for private(i) schedule(dynamic)
+# endif
+  for (i = 0; i < s; i++) {
+    size_t idx = (size_t)i * s - ((size_t)i * (i - 1)) / 2;
+    for (int j = i; j < s; j++)
+      T[idx++] = VecDot(V + (size_t)i * n, W + (size_t)j * n, n);
+  }
+  // As in CalcEigen, C upper triangle is Fortran lower triangle and
+  // eigenvectors end up in rows, in ascending order.
+  char jobz = 'V';
+  char uplo = 'L';
+  int info = 0;
+  std::vector<double> evals( s );
+  std::vector<double> evecs( (size_t)s * s );
+  std::vector<double> work( 3 * s );
+  dspev_(jobz, uplo, s, &T[0], &evals[0], &evecs[0], s, &work[0], info);
+  if (info != 0) {
+    mprinterr("Internal Error: from dspev: info= %i\n", info);
+    return 1;
+  }
+  int r;
+# ifdef _OPENMP
+# pragma omp parallel for private(r)
+# endif
+  for (r = 0; r < nritz; r++) {
+    const double* y = &evecs[0] + (size_t)(s - 1 - r) * s;
+    double* xr  = X  + (size_t)r * n;
+    double* axr = AX + (size_t)r * n;
+    std::fill( xr,  xr + n,  0.0 );
+    std::fill( axr, axr + n, 0.0 );
+    for (int j = 0; j < s; j++) {
+      const double* vj = V + (size_t)j * n;
+      const double* wj = W + (size_t)j * n;
+      for (int k = 0; k < n; k++) {
+        xr[k]  += y[j] * vj[k];
+        axr[k] += y[j] * wj[k];
+      }
+    }
+  }
+  for (r = 0; r < nritz; r++)
+    vals[r] = evals[s - 1 - r];
+  return 0;
+}
+
+/// Multiplies a symmetric matrix with a block of vectors; used by BlockLanczos().
+class ModesOperator {
+  public:
+    virtual ~ModesOperator() {}
+    /// Y = A * X for given # of vectors stored one after another.
+    virtual void Apply(const double*, double*, int) = 0;
+};
+
+/// Symmetric matrix stored as an upper triangle.
+class PackedMatrixOperator : public ModesOperator {
+  public:
+    PackedMatrixOperator(const double* m, int n) : mat_(m), n_(n) {}
+    void Apply(const double* X, double* Y, int nvec) { PackedMatVec(mat_, n_, X, Y, nvec, Xt_, Yt_); }
+  private:
+    const double* mat_;
+    int n_;
+    std::vector<double> Xt_; ///< Work array for interleaved input vectors.
+    std::vector<double> Yt_; ///< Work array for interleaved output vectors.
+};
+
+/** Coordinate covariance matrix C that is never formed; multiplying it with
+  * a block of vectors Z takes one pass over the coordinates:
+  * C*Z = (1/N) sum_frames (x - <x>) ((x - <x>) . Z).
+  */
+class CoordsCovarOperator : public ModesOperator {
+  public:
+    CoordsCovarOperator(DataSet_Coords& c, AtomMask const& m, std::vector<double> const& a) :
+      crd_(c), mask_(m), avg_(a), dx_(a.size())
+    {
+      frm_.SetupFrameFromMask( mask_, crd_.Top().Atoms() );
+    }
+    void Apply(const double*, double*, int);
+  private:
+    DataSet_Coords& crd_;
+    AtomMask const& mask_;
+    std::vector<double> const& avg_;
+    std::vector<double> dx_;
+    Frame frm_;
+};
+
+void CoordsCovarOperator::Apply(const double* Z, double* W, int nvec) {
+  int n = (int)avg_.size();
+  int nframes = (int)crd_.Size();
+  std::fill( W, W + (size_t)nvec * n, 0.0 );
+  for (int frame = 0; frame < nframes; frame++) {
+    crd_.GetFrame( frame, frm_, mask_ );
+    const double* XYZ = frm_.xAddress();
+    for (int k = 0; k < n; k++)
+      dx_[k] = XYZ[k] - avg_[k];
+    int vec;
+#   ifdef _OPENMP
+#   pragma omp parallel for private(vec)
+#   endif
+    for (vec = 0; vec < nvec; vec++) {
+      double* wv = W + (size_t)vec * n;
+      double proj = VecDot(&dx_[0], Z + (size_t)vec * n, n);
+      for (int k = 0; k < n; k++)
+        wv[k] += proj * dx_[k];
+    }
+  }
+  double norm = 1.0 / (double)nframes;
+  for (size_t k = 0; k != (size_t)nvec * n; k++)
+    W[k] *= norm;
+}
+
+/** Block Lanczos method for the nmodes largest eigenpairs of the operator.
+  * Starting from a block of random vectors, a Krylov basis of NBLOCKS blocks
+  * is built, the best approximations to the eigenvectors within that basis
+  * are found (Rayleigh-Ritz), and the procedure is restarted from those
+  * until the residuals ||A*x - lambda*x|| of all wanted modes are below tol
+  * relative to the largest eigenvalue. Eigenpairs are returned in
+  * descending order.
+  * \return 0 on success, 1 on error.
+  */
+static int BlockLanczos(ModesOperator& op, int n, int nmodes, int bsize, double tol,
+                        int maxit, std::vector<double>& vals, std::vector<double>& X)
+{
+  static const int NBLOCKS = 3; // Number of Krylov blocks per restart
+  int s = NBLOCKS * bsize;
+  size_t bvecs = (size_t)bsize * n;
+  std::vector<double> V( s * (size_t)n );
+  std::vector<double> W( s * (size_t)n );
+  std::vector<double> AX( bvecs );
+  X.resize( bvecs );
+  vals.resize( bsize );
+  Random_Number rng;
+  rng.rn_set();
+  for (size_t k = 0; k != bvecs; k++)
+    V[k] = rng.rn_gauss(0.0, 1.0);
+  Orthonormalize(&V[0], n, 0, bsize, rng);
+  op.Apply(&V[0], &W[0], bsize);
+  int nmatvec = 1;
+  double maxres = 0.0;
+  bool converged = false;
+  int iter = 0;
+  while (iter < maxit && !converged) {
+    ++iter;
+    for (int blk = 1; blk < NBLOCKS; blk++) {
+      double* Vb = &V[0] + blk * bvecs;
+      std::copy( W.begin() + (blk - 1) * bvecs, W.begin() + blk * bvecs, Vb );
+      Orthonormalize(&V[0], n, blk * bsize, bsize, rng);
+      op.Apply(Vb, &W[0] + blk * bvecs, bsize);
+      ++nmatvec;
+    }
+    if (RayleighRitz(&V[0], &W[0], n, s, bsize, &vals[0], &X[0], &AX[0])) return 1;
+    double scale = std::max(fabs(vals[0]), 1.0E-300);
+    maxres = 0.0;
+    for (int mode = 0; mode < nmodes; mode++) {
+      const double* xm  = &X[0]  + (size_t)mode * n;
+      const double* axm = &AX[0] + (size_t)mode * n;
+      double res = 0.0;
+      for (int k = 0; k < n; k++) {
+        double d = axm[k] - vals[mode] * xm[k];
+        res += d * d;
+      }
+      maxres = std::max(maxres, sqrt(res) / scale);
+    }
+    converged = (maxres <= tol);
+    // Restart from Ritz vectors; A*X is already known.
+    std::copy( X.begin(),  X.end(),  V.begin() );
+    std::copy( AX.begin(), AX.end(), W.begin() );
+  }
+  mprintf("\t%i iterations, %i block matrix-vector products, max relative residual %g\n",
+          iter, nmatvec, maxres);
+  if (!converged)
+    mprintf("Warning: Block solver did not converge to %g within %i iterations.\n", tol, maxit);
+  return 0;
+}
+
+/// \return Block size for BlockLanczos(); extra vectors speed up convergence of the last wanted modes.
+static int LanczosBlockSize(int nmodes, int n) {
+  return std::min( nmodes + std::max(8, nmodes / 4), n / 3 );
+}
+#endif /* NO_MATHLIB */
+
 const char* DataSet_Modes::DeprecateFileMsg = "Modes should be read in prior to this command with 'readdata'\n";
 
 // CONSTRUCTOR
@@ -262,22 +605,15 @@ int DataSet_Modes::CalcEigen(DataSet_2D const& mIn, int n_to_calc) {
     std::fill( ipntr, ipntr + 11, 0 );
     // Create copy of matrix since it will be modified 
     double* mat = mIn.MatrixArray();
+    std::vector<double> Xt, Yt; // Unused for a single vector
     // LOOP
     bool loop = false;
     do {
       if (loop) {
-        // Dot products
+        // Matrix-vector product
         double* target = workd + (ipntr[1] - 1); // -1 since fortran indexing starts at 1
         double* vec    = workd + (ipntr[0] - 1);
-        std::fill( target, target + nelem, 0 );
-        for(int i = 0; i < nelem; i++) {
-          for(int j = i; j < nelem; j++) {
-            int ind = nelem * i + j - (i * (i + 1)) / 2;
-            target[i] += mat[ind] * vec[j];
-            if(i != j)
-              target[j] += mat[ind] * vec[i];
-          }
-        }
+        PackedMatVec(mat, nelem, vec, target, 1, Xt, Yt);
       }
 
       dsaupd_(ido, bmat, nelem, which, nmodes_, tol, resid,
@@ -338,6 +674,123 @@ int DataSet_Modes::CalcEigen(DataSet_2D const& mIn, int n_to_calc) {
 # endif /* NO_MATHLIB */
 }
 
+/** Get the n_to_calc largest eigenvalues and eigenvectors of given matrix
+  * with a block Lanczos method. The matrix is used directly in its packed
+  * form and multiplied with a whole block of vectors at once in parallel,
+  * so it is read once per block instead of once per vector. Modes are
+  * stored in descending order.
+  */
+int DataSet_Modes::CalcEigenBlock(DataSet_2D const& mIn, int n_to_calc, double tol, int maxit)
+{
+# ifdef NO_MATHLIB
+  mprinterr("Error: Compiled without LAPACK/BLAS routines.\n");
+  return 1;
+# else
+  if (mIn.MatrixKind() != DataSet_2D::HALF) {
+    mprinterr("Error: Eigenvector/value calc only for symmetric matrices.\n");
+    return 1;
+  }
+  if (n_to_calc < 1) {
+    mprinterr("Error: Number of eigenvectors to calculate must be specified for block solver.\n");
+    return 1;
+  }
+  int n = (int)mIn.Ncols();
+  int bsize = LanczosBlockSize(n_to_calc, n);
+  if (bsize < n_to_calc) {
+    mprintf("\tMatrix too small for block solver (%i), using standard solver.\n", n);
+    return CalcEigen(mIn, n_to_calc);
+  }
+  nmodes_ = n_to_calc;
+  mprintf("\tCalculating first %i eigenmodes with block Lanczos, block size %i.\n",
+          nmodes_, bsize);
+  double* matCopy = 0;
+  const double* mat = 0;
+  if (mIn.Type() == DataSet::MATRIX_DBL)
+    mat = static_cast<DataSet_MatrixDbl const&>( mIn ).MatrixPtr();
+  else {
+    matCopy = mIn.MatrixArray();
+    mat = matCopy;
+  }
+  PackedMatrixOperator op(mat, n);
+  Darray vals, X;
+  int err = BlockLanczos(op, n, nmodes_, bsize, tol, maxit, vals, X);
+  if (matCopy != 0) delete[] matCopy;
+  if (err != 0) return 1;
+  // Store modes
+  vecsize_ = n;
+  if (evalues_ != 0) delete[] evalues_;
+  evalues_ = new double[ nmodes_ ];
+  std::copy( vals.begin(), vals.begin() + nmodes_, evalues_ );
+  if (evectors_ != 0) delete[] evectors_;
+  evectors_ = new double[ (size_t)nmodes_ * vecsize_ ];
+  std::copy( X.begin(), X.begin() + (size_t)nmodes_ * vecsize_, evectors_ );
+  return 0;
+# endif /* NO_MATHLIB */
+}
+
+/** Calculate the n_to_calc largest modes of the coordinate covariance
+  * matrix of the atoms in mask straight from the coordinates, without
+  * forming the covariance matrix. The block Lanczos method starting from
+  * random vectors is used (i.e. a randomized block Krylov method, see
+  * Musco & Musco, NIPS 2015), where each multiplication of the covariance
+  * matrix with a block of vectors is one pass over the coordinates. Average
+  * coordinates are also set. Modes are stored in descending order.
+  */
+int DataSet_Modes::CalcEigenFromCoords(DataSet_Coords& crd, AtomMask const& mask,
+                                       int n_to_calc, double tol, int maxit)
+{
+# ifdef NO_MATHLIB
+  mprinterr("Error: Compiled without LAPACK/BLAS routines.\n");
+  return 1;
+# else
+  int nframes = (int)crd.Size();
+  if (nframes < 1) {
+    mprinterr("Error: COORDS set '%s' is empty.\n", crd.legend());
+    return 1;
+  }
+  if (n_to_calc < 1) {
+    mprinterr("Error: Number of eigenvectors to calculate must be specified.\n");
+    return 1;
+  }
+  int n = mask.Nselected() * 3;
+  int bsize = LanczosBlockSize(n_to_calc, n);
+  if (bsize < n_to_calc) {
+    mprinterr("Error: Too few coordinates (%i) to calculate %i modes without a matrix.\n",
+              n, n_to_calc);
+    return 1;
+  }
+  nmodes_ = n_to_calc;
+  mprintf("\tCalculating first %i covariance eigenmodes from %i frames of '%s',\n"
+          "\t  block size %i.\n", nmodes_, nframes, crd.legend(), bsize);
+  // Average coordinates.
+  Frame frm;
+  frm.SetupFrameFromMask( mask, crd.Top().Atoms() );
+  avgcrd_.assign( n, 0.0 );
+  mass_.clear();
+  for (int frame = 0; frame < nframes; frame++) {
+    crd.GetFrame( frame, frm, mask );
+    const double* XYZ = frm.xAddress();
+    for (int k = 0; k < n; k++)
+      avgcrd_[k] += XYZ[k];
+  }
+  double norm = 1.0 / (double)nframes;
+  for (int k = 0; k < n; k++)
+    avgcrd_[k] *= norm;
+  CoordsCovarOperator op(crd, mask, avgcrd_);
+  Darray vals, X;
+  if (BlockLanczos(op, n, nmodes_, bsize, tol, maxit, vals, X)) return 1;
+  // Store modes
+  vecsize_ = n;
+  if (evalues_ != 0) delete[] evalues_;
+  evalues_ = new double[ nmodes_ ];
+  std::copy( vals.begin(), vals.begin() + nmodes_, evalues_ );
+  if (evectors_ != 0) delete[] evectors_;
+  evectors_ = new double[ (size_t)nmodes_ * vecsize_ ];
+  std::copy( X.begin(), X.begin() + (size_t)nmodes_ * vecsize_, evectors_ );
+  return 0;
+# endif /* NO_MATHLIB */
+}
+
 // DataSet_Modes::PrintModes()
 void DataSet_Modes::PrintModes() {
   mprintf("%s: %i modes.\n",legend(),nmodes_);
@@ -1,6 +1,9 @@
 #ifndef INC_DATASET_MODES_H
 #define INC_DATASET_MODES_H
 #include "DataSet_MatrixDbl.h"
+// Forward declares
+class DataSet_Coords;
+class AtomMask;
 /// Hold eigenvalues/eigenvectors and optionally averaged coords.
 class DataSet_Modes : public DataSet {
   public:
@@ -34,6 +37,10 @@ class DataSet_Modes : public DataSet {
     int SetAvgCoords(DataSet_2D const&);
     int SetModes(bool, int, int, const double*, const double*);
     int CalcEigen(DataSet_2D const&,int);
+    /// Calculate given # of largest modes with block Lanczos; tolerance, max iterations.
+    int CalcEigenBlock(DataSet_2D const&, int, double, int);
+    /// Calculate given # of largest covariance modes directly from coordinates; tolerance, max iterations.
+    int CalcEigenFromCoords(DataSet_Coords&, AtomMask const&, int, double, int);
     void PrintModes();
     int EigvalToFreq(double);
     int MassWtEigvect();
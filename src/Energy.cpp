@@ -1,4 +1,5 @@
 #include <cmath>
+#include <algorithm> // sort
 #include "Energy.h"
 #include "CpptrajStdio.h"
 #include "DistRoutines.h"
@@ -200,6 +201,8 @@ double Energy_Amber::Calc_14_Energy(Frame const& fIn, DihedralArray const& Dihed
 double Energy_Amber::E_Nonbond(Frame const& fIn, Topology const& tIn, AtomMask const& mask,
                                double& EelecOut)
 {
+  if (cutoff_.Active())
+    return NonbondCut(fIn, tIn, mask, true, true, EelecOut);
   double Evdw = 0.0;
   double Eelec = 0.0;
   int idx1;
@@ -259,6 +262,10 @@ double Energy_Amber::E_Nonbond(Frame const& fIn, Topology const& tIn, AtomMask c
 // -----------------------------------------------------------------------------
 double Energy_Amber::E_VDW(Frame const& fIn, Topology const& tIn, AtomMask const& mask)
 {
+  if (cutoff_.Active()) {
+    double Eelec;
+    return NonbondCut(fIn, tIn, mask, true, false, Eelec);
+  }
   double Evdw = 0.0;
   int idx1;
 # ifdef _OPENMP
@@ -308,6 +315,11 @@ double Energy_Amber::E_VDW(Frame const& fIn, Topology const& tIn, AtomMask const
 // -----------------------------------------------------------------------------
 double Energy_Amber::E_Elec(Frame const& fIn, Topology const& tIn, AtomMask const& mask)
 {
+  if (cutoff_.Active()) {
+    double Eelec;
+    NonbondCut(fIn, tIn, mask, false, true, Eelec);
+    return Eelec;
+  }
   double Eelec = 0.0;
   int idx1;
 # ifdef _OPENMP
@@ -350,6 +362,73 @@ double Energy_Amber::E_Elec(Frame const& fIn, Topology const& tIn, AtomMask cons
 # endif
   return Eelec;
 }
+// -----------------------------------------------------------------------------
+/** Only pairs within the cutoff are visited; candidates come from a
+  * non-periodic cell list of the selected atoms built for this frame.
+  * Candidates are sorted so that the exclusion list can be merged in the
+  * same way as the all-pairs loops.
+  * \param doVdw If true calculate LJ energy (returned).
+  * \param doElec If true calculate Coulomb energy (set in EelecOut).
+  */
+double Energy_Amber::NonbondCut(Frame const& fIn, Topology const& tIn, AtomMask const& mask,
+                                bool doVdw, bool doElec, double& EelecOut)
+{
+  double Evdw = 0.0;
+  double Eelec = 0.0;
+  double cut = cutoff_.Cut();
+  double cut2 = cutoff_.Cut2();
+  grid_.Setup( fIn.xAddress(), mask.Selected(), cut );
+  NeighborGrid::Iarray nbrs;
+  int idx1;
+# ifdef _OPENMP
+# pragma omp parallel private(idx1, nbrs) reduction(+ : Eelec, Evdw)
+  {
+# pragma omp for schedule(dynamic, 64)
+# endif
+  for (idx1 = 0; idx1 < mask.Nselected(); idx1++)
+  {
+    int atom1 = mask[idx1];
+    const double* crd1 = fIn.XYZ( atom1 );
+    // Get candidates, keeping only atoms after this one so each pair is done once.
+    grid_.GetCandidates( crd1, cut, nbrs );
+    unsigned int nkeep = 0;
+    for (unsigned int n = 0; n != nbrs.size(); n++)
+      if (nbrs[n] > atom1)
+        nbrs[nkeep++] = nbrs[n];
+    nbrs.resize( nkeep );
+    std::sort( nbrs.begin(), nbrs.end() );
+    // Set up exclusion list for this atom
+    Atom::excluded_iterator excluded_atom = tIn[atom1].excludedbegin();
+    for (NeighborGrid::Iarray::const_iterator at2 = nbrs.begin(); at2 != nbrs.end(); ++at2)
+    {
+      int atom2 = *at2;
+      // Advance excluded list up to current selected atom
+      while (excluded_atom != tIn[atom1].excludedend() && *excluded_atom < atom2) ++excluded_atom;
+      // If atom is excluded, just increment to next excluded atom.
+      if (excluded_atom != tIn[atom1].excludedend() && atom2 == *excluded_atom)
+        ++excluded_atom;
+      else {
+        double rij2 = DIST2_NoImage( crd1, fIn.XYZ( atom2 ) );
+        if (rij2 < cut2) {
+          if (doVdw) {
+            NonbondType const& LJ = tIn.GetLJparam(atom1, atom2);
+            Evdw += cutoff_.Evdw( LJ.A(), LJ.B(), rij2 );
+          }
+          if (doElec) {
+            double qiqj = QFAC * tIn[atom1].Charge() * tIn[atom2].Charge();
+            Eelec += cutoff_.Eelec( qiqj, sqrt(rij2), rij2 );
+          }
+        }
+      }
+    }
+  }
+# ifdef _OPENMP
+  } // END omp parallel
+# endif
+  EelecOut = Eelec;
+  return Evdw;
+}
+
 // -----------------------------------------------------------------------------
 double Energy_Amber::E_DirectSum(Frame const& fIn, Topology const& tIn, AtomMask const& mask,
                                  int n_points)
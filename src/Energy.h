@@ -1,6 +1,8 @@
 #ifndef INC_ENERGY_H
 #define INC_ENERGY_H
 #include "Topology.h"
+#include "NonbondCutoff.h"
+#include "NeighborGrid.h"
 /// Calculate energy/force from coordinates.
 class Energy_Amber {
   public:
@@ -22,6 +24,10 @@ class Energy_Amber {
     double E_Kinetic_VV(Frame const&, AtomMask const&, double);
 
     void SetDebug(int d) { debug_ = d; }
+    /// Set cutoff used by E_Nonbond(), E_VDW(), and E_Elec(); inactive means all pairs.
+    void SetCutoff(NonbondCutoff const& c) { cutoff_ = c; }
+    /// \return Current nonbond cutoff.
+    NonbondCutoff const& Cutoff() const { return cutoff_; }
   private:
     double CalcBondEnergy(Frame const&, BondArray const&, BondParmArray const&,
                           CharMask const&);
@@ -31,8 +37,12 @@ class Energy_Amber {
                              CharMask const&);
     double Calc_14_Energy(Frame const&, DihedralArray const&, DihedralParmArray const&,
                           Topology const&, CharMask const&, double&);
+    /// Nonbond energy of pairs within cutoff, found with a cell list.
+    double NonbondCut(Frame const&, Topology const&, AtomMask const&, bool, bool, double&);
 
     static const double QFAC;
+    NonbondCutoff cutoff_; ///< Nonbond cutoff.
+    NeighborGrid grid_;    ///< Cell list for finding pairs within cutoff.
     int debug_;
 };
 #endif 
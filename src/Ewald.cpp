@@ -390,7 +390,7 @@ double Ewald::Direct_VDW_LongRangeCorrection(PairList const& PL, double& evdw_ou
 # ifdef _OPENMP
 # pragma omp parallel private(cidx) reduction(+: Eelec, Evdw, e_adjust)
   {
-# pragma omp for
+# pragma omp for schedule(dynamic)
 # endif
 # include "PairListLoop.h"
 # ifdef _OPENMP
@@ -422,7 +422,7 @@ double Ewald::Direct_VDW_LJPME(PairList const& PL, double& evdw_out)
 # ifdef _OPENMP
 # pragma omp parallel private(cidx) reduction(+: Eelec, Evdw, e_adjust, Eljpme_correction,Eljpme_correction_excl)
   {
-# pragma omp for
+# pragma omp for schedule(dynamic)
 # endif
 # include "PairListLoop.h"
 # ifdef _OPENMP
@@ -445,7 +445,9 @@ double Ewald::Direct_VDW_LJPME(PairList const& PL, double& evdw_out)
 //  Ewald::Direct()
 /** Calculate direct space energy. This is the faster version that uses
   * a pair list. Also calculate the energy adjustment for excluded
-  * atoms.
+  * atoms. With OpenMP, cells are handed out to threads dynamically since
+  * the number of atoms (and so work) per cell varies, and each thread
+  * accumulates energies in its own reduction variables.
   * \param PL The pairlist used to calculate energy.
   * \param e_adjust_out The electrostatic adjust energy for excluded atoms.
   * \param evdw_out The direct space van der Waals term (corrected for exclusion if LJ PME).
@@ -3,15 +3,23 @@
 //#incl ude <memory> // unique_ptr
 #include "Ewald_ParticleMesh.h"
 #include "CpptrajStdio.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 typedef helpme::Matrix<double> Mat;
 
 /// CONSTRUCTOR
-Ewald_ParticleMesh::Ewald_ParticleMesh() : order_(6)
+Ewald_ParticleMesh::Ewald_ParticleMesh() :
+  order_(6),
+  nthreads_(1),
+  boxTol_(0.0),
+  nGridReused_(0)
 {
   nfft_[0] = -1;
   nfft_[1] = -1;
   nfft_[2] = -1;
+  std::fill(recipNfft_, recipNfft_+3, -1);
 }
 
 /** \return true if given number is a product of powers of 2, 3, or 5. */
@@ -89,7 +97,7 @@ int Ewald_ParticleMesh::DetermineNfft(int& nfft1, int& nfft2, int& nfft3, Box co
 int Ewald_ParticleMesh::Init(Box const& boxIn, double cutoffIn, double dsumTolIn,
                     double ew_coeffIn, double lw_coeffIn, double switch_widthIn,
                     double skinnbIn, double erfcTableDxIn, 
-                    int orderIn, int debugIn, const int* nfftIn)
+                    int orderIn, int debugIn, const int* nfftIn, double boxTolIn)
 {
   if (CheckInput(boxIn, debugIn, cutoffIn, dsumTolIn, ew_coeffIn, lw_coeffIn, switch_widthIn,
                  erfcTableDxIn, skinnbIn))
@@ -102,6 +110,17 @@ int Ewald_ParticleMesh::Init(Box const& boxIn, double cutoffIn, double dsumTolIn
 
   // Set defaults if necessary
   if (order_ < 1) order_ = 6;
+  boxTol_ = boxTolIn;
+  if (boxTol_ < 0.0) boxTol_ = 0.0;
+  nfftBox_ = Box();
+  nGridReused_ = 0;
+  // Pass the actual thread count to helpme; passing 0 ("all available")
+  // makes helpme see a changed setup, and rebuild its FFT plans, every frame.
+# ifdef _OPENMP
+  nthreads_ = omp_get_max_threads();
+# else
+  nthreads_ = 1;
+# endif
 
   mprintf("\tParticle Mesh Ewald params:\n");
   mprintf("\t  Cutoff= %g   Direct Sum Tol= %g   Ewald coeff.= %g  NB skin= %g\n",
@@ -110,7 +129,9 @@ int Ewald_ParticleMesh::Init(Box const& boxIn, double cutoffIn, double dsumTolIn
     mprintf("\t  LJ Ewald coeff.= %g\n", lw_coeff_);
   if (switch_width_ > 0.0)
     mprintf("\t  LJ switch width= %g\n", switch_width_);
-  mprintf("\t  Bspline order= %i\n", order_);
+  mprintf("\t  Bspline order= %i   Recip threads= %i\n", order_, nthreads_);
+  if (boxTol_ > 0.0)
+    mprintf("\t  FFT grid size reused while box changes < %g (relative)\n", boxTol_);
   mprintf("\t  Erfc table dx= %g, size= %zu\n", erfcTableDx_, erfc_table_.size()/4);
   mprintf("\t ");
   for (int i = 0; i != 3; i++)
@@ -150,6 +171,36 @@ static inline void PrintM(const char* Title, Mat<double> const& M_)
   mprintf("     %16.10f %16.10f %16.10f\n", M_(2,0), M_(2,1), M_(2,2));
 }*/
 
+/** Determine the FFT grid size for the given box. If a box tolerance is
+  * set and no box length or angle has changed by more than that (relative)
+  * amount since the grid size was last determined, keep the previous grid
+  * size so that helpme does not have to redo its setup. The current box
+  * is always used for the lattice vectors.
+  */
+int Ewald_ParticleMesh::SetRecipNfft(Box const& boxIn) {
+  if (boxTol_ > 0.0 && nfftBox_.HasBox()) {
+    bool withinTol = true;
+    for (int i = 0; i != 6; i++) {
+      if (DABS(boxIn[i] - nfftBox_[i]) > boxTol_ * DABS(nfftBox_[i])) {
+        withinTol = false;
+        break;
+      }
+    }
+    if (withinTol) {
+      nGridReused_++;
+      return 0;
+    }
+  }
+  std::copy(nfft_, nfft_+3, recipNfft_);
+  if ( DetermineNfft(recipNfft_[0], recipNfft_[1], recipNfft_[2], boxIn) ) {
+    mprinterr("Error: Could not determine grid spacing.\n");
+    nfftBox_ = Box();
+    return 1;
+  }
+  nfftBox_ = boxIn;
+  return 0;
+}
+
 // Ewald::Recip_ParticleMesh()
 double Ewald_ParticleMesh::Recip_ParticleMesh(Box const& boxIn)
 {
@@ -157,13 +208,9 @@ double Ewald_ParticleMesh::Recip_ParticleMesh(Box const& boxIn)
   // This essentially makes coordsD and chargesD point to arrays.
   Mat coordsD(&coordsD_[0], Charge_.size(), 3);
   Mat chargesD(&Charge_[0], Charge_.size(), 1);
-  int nfft1 = nfft_[0];
-  int nfft2 = nfft_[1];
-  int nfft3 = nfft_[2];
-  if ( DetermineNfft(nfft1, nfft2, nfft3, boxIn) ) {
-    mprinterr("Error: Could not determine grid spacing.\n");
-    return 0.0;
-  }
+  int nfft1 = recipNfft_[0];
+  int nfft2 = recipNfft_[1];
+  int nfft3 = recipNfft_[2];
   // Instantiate double precision PME object
   // Args: 1 = Exponent of the distance kernel: 1 for Coulomb
   //       2 = Kappa
@@ -173,10 +220,11 @@ double Ewald_ParticleMesh::Recip_ParticleMesh(Box const& boxIn)
   //       6 = nfft3
   //       7 = scale factor to be applied to all computed energies and derivatives thereof
   //       8 = max # threads to use for each MPI instance; 0 = all available threads used.
+  //           Always set explicitly so setup does not rebuild plans every frame.
   // NOTE: Scale factor for Charmm is 332.0716
   // NOTE: The electrostatic constant has been baked into the Charge_ array already.
   //auto pme_object = std::unique_ptr<PMEInstanceD>(new PMEInstanceD());
-  pme_object_.setup(1, ew_coeff_, order_, nfft1, nfft2, nfft3, 1.0, 0);
+  pme_object_.setup(1, ew_coeff_, order_, nfft1, nfft2, nfft3, 1.0, nthreads_);
   // Sets the unit cell lattice vectors, with units consistent with those used to specify coordinates.
   // Args: 1 = the A lattice parameter in units consistent with the coordinates.
   //       2 = the B lattice parameter in units consistent with the coordinates.
@@ -198,19 +246,15 @@ double Ewald_ParticleMesh::Recip_ParticleMesh(Box const& boxIn)
 double Ewald_ParticleMesh::LJ_Recip_ParticleMesh(Box const& boxIn)
 {
   t_recip_.Start();
-  int nfft1 = nfft_[0];
-  int nfft2 = nfft_[1];
-  int nfft3 = nfft_[2];
-  if ( DetermineNfft(nfft1, nfft2, nfft3, boxIn) ) {
-    mprinterr("Error: Could not determine grid spacing.\n");
-    return 0.0;
-  }
+  int nfft1 = recipNfft_[0];
+  int nfft2 = recipNfft_[1];
+  int nfft3 = recipNfft_[2];
 
   Mat coordsD(&coordsD_[0], Charge_.size(), 3);
   Mat cparamD(&Cparam_[0], Cparam_.size(), 1);
 
   //auto pme_vdw = std::unique_ptr<PMEInstanceD>(new PMEInstanceD());
-  pme_vdw_.setup(6, lw_coeff_, order_, nfft1, nfft2, nfft3, -1.0, 0);
+  pme_vdw_.setup(6, lw_coeff_, order_, nfft1, nfft2, nfft3, -1.0, nthreads_);
   pme_vdw_.setLatticeVectors(boxIn.BoxX(), boxIn.BoxY(), boxIn.BoxZ(),
                              boxIn.Alpha(), boxIn.Beta(), boxIn.Gamma(),
                              PMEInstanceD::LatticeType::XAligned);
@@ -241,6 +285,10 @@ double Ewald_ParticleMesh::CalcEnergy(Frame const& frameIn, AtomMask const& mask
   }
 
 //  MapCoords(frameIn, ucell, recip, maskIn);
+  if (SetRecipNfft( frameIn.BoxCrd() )) {
+    t_total_.Stop();
+    return 0.0;
+  }
   double e_recip = Recip_ParticleMesh( frameIn.BoxCrd() );
 
   // TODO branch
@@ -7,18 +7,23 @@
 class Ewald_ParticleMesh : public Ewald {
   public:
     Ewald_ParticleMesh();
-    /// Box, cut, dsum tol, ew coeff, lj ew coeff, switch width, NB skin, erfc dx, order, dbg, nfft
+    /// Box, cut, dsum tol, ew coeff, lj ew coeff, switch width, NB skin, erfc dx, order, dbg, nfft, box tol
     int Init(Box const&, double, double, double, double, double, double, double,
-             int, int, const int*);
+             int, int, const int*, double);
     // ----- Inherited ---------------------------
     int Setup(Topology const&, AtomMask const&);
     double CalcEnergy(Frame const&, AtomMask const&, double&); // TODO const?
+    // -------------------------------------------
+    /// \return Number of frames for which previous FFT grid size was reused.
+    int NgridReused() const { return nGridReused_; }
   private:
     typedef Ewald::Darray Darray;
     /// Based on given length return number of grid points that is power of 2, 3, or 5
     static int ComputeNFFT(double);
     /// Determine grid points for FFT in each dimension
     int DetermineNfft(int&, int&, int&, Box const&) const;
+    /// Set FFT grid size for box; previous size is kept if box change is within tolerance.
+    int SetRecipNfft(Box const&);
     /// Particle mesh Ewald reciprocal energy
     double Recip_ParticleMesh(Box const&);
     /// Particle mesh Ewald LJ recip energy
@@ -28,6 +33,11 @@ class Ewald_ParticleMesh : public Ewald {
 
     int nfft_[3]; ///< Number of FFT grid points in each direction
     int order_;   ///< PME B spline order
+    int nthreads_; ///< Number of threads helpme should use
+    int recipNfft_[3]; ///< FFT grid points in each direction for current frame.
+    double boxTol_; ///< Max relative box change for which previous FFT grid size is reused.
+    Box nfftBox_;   ///< Box FFT grid size was last determined from.
+    int nGridReused_; ///< Number of times the FFT grid size was reused.
 
     PMEInstanceD pme_object_;
     PMEInstanceD pme_vdw_;
@@ -33,6 +33,64 @@ Exec::RetType Exec_ForceParaEnsemble::Execute(CpptrajState& State, ArgList&) {
 }
 #endif
 // -----------------------------------------------------------------------------
+void Exec_FrameThreads::Help() const {
+  mprintf("\t{<#threads> | off}\n"
+          "  During Run, divide input frames into <#threads> contiguous blocks, each\n"
+          "  processed by an OpenMP thread with its own copies of the input trajectories\n"
+          "  and Actions. Data from each block is merged in frame order afterwards.\n"
+          "  Requires all input trajectories use the same topology, no output\n"
+          "  trajectories, and Actions that support it (e.g. distance, angle,\n"
+          "  dihedral, radgyr, rms, average); otherwise frames are processed normally.\n"
+          "  Only available in OpenMP builds.\n");
+}
+
+Exec::RetType Exec_FrameThreads::Execute(CpptrajState& State, ArgList& argIn)
+{
+# ifdef _OPENMP
+  if (argIn.hasKey("off")) {
+    State.SetFrameThreads( 0 );
+    mprintf("\tFrame-parallel trajectory processing disabled.\n");
+    return CpptrajState::OK;
+  }
+  int nthreads = argIn.getNextInteger(-1);
+  if (nthreads < 1) {
+    mprinterr("Error: Expected number of threads > 0 or 'off'.\n");
+    return CpptrajState::ERR;
+  }
+  State.SetFrameThreads( nthreads );
+  mprintf("\tDuring Run, frames will be processed in %i blocks by separate threads.\n",
+          nthreads);
+  return CpptrajState::OK;
+# else
+  mprinterr("Error: 'framethreads' is only available in OpenMP builds.\n");
+  return CpptrajState::ERR;
+# endif
+}
+// -----------------------------------------------------------------------------
+void Exec_RunTiming::Help() const {
+  mprintf("\t[off] [out <file>]\n"
+          "  After each Run, print a table of the time spent in each Action (Setup,\n"
+          "  frame processing, Print, and in parallel Sync) and reading each input\n"
+          "  trajectory, with frames/second. If 'out' is specified the timing is\n"
+          "  also written to <file> in JSON format. Trajectory bytes read are\n"
+          "  estimated from file size.\n");
+}
+
+Exec::RetType Exec_RunTiming::Execute(CpptrajState& State, ArgList& argIn)
+{
+  if (argIn.hasKey("off")) {
+    State.SetRunTiming( false, std::string() );
+    mprintf("\tRun timing disabled.\n");
+    return CpptrajState::OK;
+  }
+  std::string outname = argIn.GetStringKey("out");
+  State.SetRunTiming( true, outname );
+  mprintf("\tTime spent in each Action and input trajectory will be reported after Run.\n");
+  if (!outname.empty())
+    mprintf("\tTiming will be written to '%s' in JSON format.\n", outname.c_str());
+  return CpptrajState::OK;
+}
+// -----------------------------------------------------------------------------
 void Exec_NoProgress::Help() const {
   mprintf("  Do not print progress while reading in trajectories.\n");
 }
@@ -156,7 +214,9 @@ Exec::RetType Exec_EnsFileExt::Execute(CpptrajState& State, ArgList& argIn) {
 // -----------------------------------------------------------------------------
 void Exec_UseDiskCache::Help() const {
   mprintf("\t{on|off}\n"
-          "  If on, CPPTRAJ will attempt to cache data sets to disk if possible.\n");
+          "  If on, CPPTRAJ will attempt to cache data sets to disk if possible.\n"
+          "  Currently integer (requires NetCDF) and COORDS data sets can be cached.\n"
+          "  COORDS data sets are cached to a temporary file that is memory-mapped.\n");
 }
 
 Exec::RetType Exec_UseDiskCache::Execute(CpptrajState& State, ArgList& argIn) {
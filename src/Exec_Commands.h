@@ -40,6 +40,24 @@ class Exec_QuietBlocks : public Exec {
     RetType Execute(CpptrajState&, ArgList&);
 };
 
+/// Tell CpptrajState to report time spent in each Action/trajectory after Run.
+class Exec_RunTiming : public Exec {
+  public:
+    Exec_RunTiming() : Exec(GENERAL) {}
+    void Help() const;
+    DispatchObject* Alloc() const { return (DispatchObject*)new Exec_RunTiming(); }
+    RetType Execute(CpptrajState&, ArgList&);
+};
+
+/// Tell CpptrajState to process blocks of frames in separate threads during Run.
+class Exec_FrameThreads : public Exec {
+  public:
+    Exec_FrameThreads() : Exec(GENERAL) {}
+    void Help() const;
+    DispatchObject* Alloc() const { return (DispatchObject*)new Exec_FrameThreads(); }
+    RetType Execute(CpptrajState&, ArgList&);
+};
+
 #ifdef MPI
 /// Tell CpptrajState to run parallel ensemble even with 1 thread/member
 class Exec_ForceParaEnsemble : public Exec {
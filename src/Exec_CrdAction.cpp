@@ -60,11 +60,13 @@ Exec::RetType Exec_CrdAction::DoCrdAction(CpptrajState& State, ArgList& actionar
   if (State.ShowProgress())
     progress = new ProgressBar( frameCount.TotalReadFrames() );
   int set = 0;
+  NeighborGrid grid;
   for (int frame = frameCount.Start(); frame < frameCount.Stop();
            frame += frameCount.Offset(), ++set)
   {
     // Since Frame can be modified by actions, save original and use currentFrame
     ActionFrame frm( &originalFrame, set );
+    frm.SetNeighborGrid( &grid );
     if (progress != 0) progress->Update( set );
     CRD->GetFrame( frame, originalFrame );
     Action::RetType ret = act->DoAction( set, frm );
@@ -62,8 +62,11 @@ Exec::RetType Exec_LoadCrd::Execute(CpptrajState& State, ArgList& argIn) {
   // Read trajectory TODO progress bar
   trajin.BeginTraj();
   trajin.Traj().PrintInfoLine();
-  while (trajin.GetNextFrame( frameIn ))
+  while (trajin.GetNextFrame( frameIn )) {
     coords->AddFrame( frameIn );
+    if (coords->AddFrameFailed()) break;
+  }
   trajin.EndTraj();
+  if (coords->AddFrameFailed()) return CpptrajState::ERR;
   return CpptrajState::OK;
 }
@@ -103,7 +103,7 @@ Exec::RetType Exec_PermuteDihedrals::Execute(CpptrajState& State, ArgList& argIn
   outfilename = argIn.GetStringKey("crdout");
   if (!outfilename.empty()) {
     mprintf("\tCoordinates saved to set '%s'\n", outfilename.c_str());
-    crdout_ = (DataSet_Coords_CRD*)State.DSL().AddSet(DataSet::COORDS, outfilename);
+    crdout_ = (DataSet_Coords*)State.DSL().AddSet(DataSet::COORDS, outfilename);
     if (crdout_ == 0) return CpptrajState::ERR;
     crdout_->CoordsSetup( CRD->Top(), CRD->CoordsInfo() );
   }
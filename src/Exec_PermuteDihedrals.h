@@ -47,7 +47,7 @@ class Exec_PermuteDihedrals : public Exec {
     int debug_;
     Trajout_Single outtraj_;     ///< Output trajectory
     int outframe_;               ///< Output trajectory frame count
-    DataSet_Coords_CRD* crdout_; ///< Output COORDS set
+    DataSet_Coords* crdout_; ///< Output COORDS set
     // 'random' options
     bool check_for_clashes_;
     bool checkAllResidues_;
@@ -32,7 +32,7 @@ Exec::RetType Exec_SplitCoords::Execute(CpptrajState& State, ArgList& argIn)
     mprinterr("Error: Must specify output COORDS name.\n");
     return CpptrajState::ERR;
   }
-  DataSet_Coords_CRD* OUT = (DataSet_Coords_CRD*)
+  DataSet_Coords* OUT = (DataSet_Coords*)
                             State.DSL().AddSet(DataSet::COORDS, MetaData(dsname));
   if (OUT == 0) return CpptrajState::ERR;
   mprintf("\tOutput to COORDS set '%s'\n", OUT->legend());
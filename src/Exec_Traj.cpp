@@ -5,6 +5,7 @@ void Exec_Trajin::Help() const {
   mprintf("\t<filename> {[<start>] [<stop> | last] [<offset>]} | lastframe\n"
           "\t           [%s]\n", DataSetList::TopArgs);
   mprintf("\t           [mdvel <velocities>] [mdfrc <forces>]\n"
+          "\t           [readblock <#>] [prefetch <depth>]\n"
           "\t           [as <format keyword>] [ <Format Options> ]\n"
           "\t           [ remdtraj {remdtrajtemp <T> |\n"
           "\t                       remdtrajidx <indices list> |\n"
@@ -17,6 +18,10 @@ void Exec_Trajin::Help() const {
           "  before <stop>.\n"
           "  If desired, additional velocity or force information can be read from\n"
           "  files specified by 'mdvel' and/or 'mdfrc'.\n"
+          "  For formats that support it (NetCDF, DCD, XTC), up to 'readblock' frames\n"
+          "  (default 16) are read at once; 'readblock 1' reads one frame at a time.\n"
+          "  If 'prefetch' is specified (OpenMP only), the next <depth> frames are read\n"
+          "  on a separate thread while Actions process the current frames.\n"
           "  The 'remdtraj' keyword can be used to extract frames for a specific replica\n"
           "  from an ensemble of replica trajectories. In this case, if only <filename> is\n"
           "  specified it is assumed <filename> has format <name>.<ext> where <ext> is\n"
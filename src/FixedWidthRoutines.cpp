@@ -0,0 +1,132 @@
+#include <cmath> // floor
+#include "FixedWidthRoutines.h"
+
+/** Powers of 10 that are exactly representable as doubles. */
+static const double PowersOf10[] = {
+  1.0E0,  1.0E1,  1.0E2,  1.0E3,  1.0E4,  1.0E5,  1.0E6,  1.0E7,
+  1.0E8,  1.0E9,  1.0E10, 1.0E11, 1.0E12, 1.0E13, 1.0E14, 1.0E15,
+  1.0E16, 1.0E17, 1.0E18, 1.0E19, 1.0E20, 1.0E21, 1.0E22
+};
+
+// FixedWidthToDouble()
+/** Field may have leading blanks, an optional sign, digits with an optional
+  * decimal point, then trailing blanks. All digits are accumulated into an
+  * integer mantissa, which is exact for up to 15 digits, and divided by a
+  * power of 10 that is also exact. Since IEEE division is correctly rounded
+  * the result is the same as that of a correctly rounded atof.
+  * \param ptr Start of field.
+  * \param width Width of field.
+  * \param val Set to value of field on success.
+  * \return true if field was converted, false if atof must be used.
+  */
+bool FixedWidthToDouble(const char* ptr, unsigned int width, double& val) {
+  const char* end = ptr + width;
+  while (ptr != end && *ptr == ' ') ++ptr;
+  if (ptr == end) return false;
+  bool negative = false;
+  if (*ptr == '-') {
+    negative = true;
+    ++ptr;
+  } else if (*ptr == '+')
+    ++ptr;
+  unsigned long long mantissa = 0;
+  int ndigits = 0;
+  int nfrac = 0;
+  int hasPoint = 0;
+  for (; ptr != end; ++ptr) {
+    unsigned int digit = (unsigned int)(*ptr - '0');
+    if (digit < 10) {
+      mantissa = mantissa * 10 + digit;
+      ++ndigits;
+      nfrac += hasPoint;
+    } else if (*ptr == '.' && !hasPoint)
+      hasPoint = 1;
+    else
+      break;
+  }
+  if (ndigits < 1 || ndigits > 15) return false;
+  // Only trailing blanks are allowed.
+  for (; ptr != end; ++ptr)
+    if (*ptr != ' ') return false;
+  double dval = (double)mantissa;
+  if (nfrac > 0) dval /= PowersOf10[nfrac];
+  if (negative)
+    val = -dval;
+  else
+    val = dval;
+  return true;
+}
+
+// DoubleToFixedWidth()
+/** Value times 10^precision is rounded to the nearest integer, whose digits
+  * are then written right-justified with a decimal point. The product is
+  * only off from the exact value by at most half an ulp, so unless it is
+  * within that distance of a rounding tie (in which case false is returned)
+  * the digits are the same as those printed by sprintf.
+  * \param buf Output buffer, must have room for width chars.
+  * \param dval Value to write.
+  * \param width Total width of output; output is right-justified.
+  * \param prec Number of digits after the decimal point.
+  * \return true if value was written, false if sprintf must be used.
+  */
+bool DoubleToFixedWidth(char* buf, double dval, int width, int prec) {
+  if (prec < 0 || prec > 15 || width > 40) return false;
+  if (dval != dval) return false; // NaN
+  // sprintf prints the sign of negative zero and of negative values that round to zero.
+  bool negative = (dval < 0.0 || (dval == 0.0 && 1.0 / dval < 0.0));
+  double scaled = (negative ? -dval : dval) * PowersOf10[prec];
+  if (!(scaled < 4.0E15)) return false; // Also catches Inf
+  double whole = floor(scaled);
+  double frac = scaled - whole;
+  double diff = frac - 0.5;
+  if (diff < 0.0) diff = -diff;
+  if (diff <= scaled * 4.0E-16) return false;
+  unsigned long long ival = (unsigned long long)whole;
+  if (frac > 0.5) ++ival;
+  // Digits, least significant first. Need at least one before the decimal point.
+  char digits[24];
+  int ndigits = 0;
+  do {
+    digits[ndigits++] = (char)('0' + (ival % 10));
+    ival /= 10;
+  } while (ival > 0);
+  while (ndigits < prec + 1)
+    digits[ndigits++] = '0';
+  int len = ndigits + (prec > 0 ? 1 : 0) + (negative ? 1 : 0);
+  if (len > width) return false;
+  char* ptr = buf;
+  for (int i = len; i < width; i++)
+    *(ptr++) = ' ';
+  if (negative) *(ptr++) = '-';
+  int d = ndigits - 1;
+  for (; d >= prec; d--)
+    *(ptr++) = digits[d];
+  if (prec > 0) {
+    *(ptr++) = '.';
+    for (; d >= 0; d--)
+      *(ptr++) = digits[d];
+  }
+  return true;
+}
+
+// IsFixedWidthFormat()
+bool IsFixedWidthFormat(const char* fmt, int& width, int& prec) {
+  if (fmt == 0 || *fmt != '%') return false;
+  ++fmt;
+  // Leading zero is the zero-padding flag.
+  if (*fmt == '0') return false;
+  width = 0;
+  while (*fmt >= '0' && *fmt <= '9')
+    width = width * 10 + (*(fmt++) - '0');
+  if (width < 1 || *fmt != '.') return false;
+  ++fmt;
+  prec = 0;
+  int nprec = 0;
+  while (*fmt >= '0' && *fmt <= '9') {
+    prec = prec * 10 + (*(fmt++) - '0');
+    ++nprec;
+  }
+  if (nprec < 1 || *fmt != 'f') return false;
+  ++fmt;
+  return (*fmt == '\0');
+}
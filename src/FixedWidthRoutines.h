@@ -0,0 +1,19 @@
+#ifndef INC_FIXEDWIDTHROUTINES_H
+#define INC_FIXEDWIDTHROUTINES_H
+/*! \file FixedWidthRoutines.h
+    \brief Fast conversion of fixed-width (Fortran Fw.d style) floating point text.
+
+    These handle the common case of plain decimal numbers (e.g. Amber
+    trajectory/restart F8.3 and F12.7 fields) without going through
+    atof/sprintf. Results are identical to atof and sprintf("%w.df");
+    anything that cannot be guaranteed to match (exponents, very long
+    numbers, values close to a rounding boundary, overflow) is rejected so
+    the caller can fall back to the C library.
+ */
+/// Convert field of given width to double. \return false if field needs atof.
+bool FixedWidthToDouble(const char*, unsigned int, double&);
+/// Write double to given width and precision, no terminating null. \return false if sprintf needed.
+bool DoubleToFixedWidth(char*, double, int, int);
+/// \return true if given format is "%<width>.<precision>f"; set width and precision.
+bool IsFixedWidthFormat(const char*, int&, int&);
+#endif
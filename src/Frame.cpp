@@ -3,6 +3,7 @@
 #include "Frame.h"
 #include "Constants.h" // SMALL
 #include "CpptrajStdio.h"
+#include "RmsdRoutines.h" // QCP_RMSD
 
 const size_t Frame::COORDSIZE_ = 3 * sizeof(double);
 
@@ -255,6 +256,36 @@ Frame &Frame::operator=(Frame rhs) {
 // ---------- CONVERT TO/FROM CRDtype ------------------------------------------
 // Frame::SetFromCRD()
 void Frame::SetFromCRD(CRDtype const& farray, int numCrd, int numBoxCrd, bool hasVel) {
+  SetFromCRD( &farray[0], numCrd, numBoxCrd, hasVel );
+}
+
+// Frame::SetFromCRD()
+void Frame::SetFromCRD(CRDtype const& crdIn, AtomMask const& mask, int numCrd,
+                       int numBoxCrd, bool hasVel)
+{
+  SetFromCRD( &crdIn[0], mask, numCrd, numBoxCrd, hasVel );
+}
+
+// Frame::ConvertToCRD()
+Frame::CRDtype Frame::ConvertToCRD(int numBoxCrd, bool hasVel) const {
+  int nvel;
+  if (hasVel)
+    nvel = ncoord_;
+  else
+    nvel = 0;
+  CRDtype farray( ncoord_ + nvel + numBoxCrd );
+  ConvertToCRD( &farray[0], numBoxCrd, hasVel );
+  return farray;
+}
+
+// Frame::SetFromCRD()
+/** \param farray Float array containing coordinates, velocities (if hasVel),
+  *        then box (if numBoxCrd > 0).
+  * \param numCrd Number of coordinates in farray.
+  * \param numBoxCrd Number of box coordinates in farray.
+  * \param hasVel If true farray contains velocities.
+  */
+void Frame::SetFromCRD(const float* farray, int numCrd, int numBoxCrd, bool hasVel) {
   int f_ncoord = numCrd;
   if (f_ncoord > maxnatom_*3) {
     mprinterr("Error: Float array size (%i) > max #coords in frame (%i)\n",
@@ -265,16 +296,19 @@ void Frame::SetFromCRD(CRDtype const& farray, int numCrd, int numBoxCrd, bool ha
   natom_ = ncoord_ / 3;
   for (int ix = 0; ix < ncoord_; ++ix)
     X_[ix] = (double)farray[ix];
-  if (hasVel && V_ != 0) {
-    for (int iv = 0; iv < ncoord_; ++iv)
-      V_[iv] = (double)farray[f_ncoord++];
+  if (hasVel) {
+    if (V_ != 0) {
+      for (int iv = 0; iv < ncoord_; ++iv)
+        V_[iv] = (double)farray[f_ncoord + iv];
+    }
+    f_ncoord += numCrd;
   }
   for (int ib = 0; ib < numBoxCrd; ++ib)
     box_[ib] = (double)farray[f_ncoord++];
 }
 
 // Frame::SetFromCRD()
-void Frame::SetFromCRD(CRDtype const& crdIn, AtomMask const& mask, int numCrd,
+void Frame::SetFromCRD(const float* crdIn, AtomMask const& mask, int numCrd,
                        int numBoxCrd, bool hasVel)
 {
   if (mask.Nselected() > maxnatom_) {
@@ -298,27 +332,27 @@ void Frame::SetFromCRD(CRDtype const& crdIn, AtomMask const& mask, int numCrd,
       V_[iv++] = (double)crdIn[voffset+2]; 
     }
   }
-  int f_ncoord = (int)crdIn.size() - numBoxCrd;
+  int f_ncoord = numCrd;
+  if (hasVel) f_ncoord += numCrd;
   for (int ib = 0; ib < numBoxCrd; ++ib)
     box_[ib] = (double)crdIn[f_ncoord++];
 }
 
 // Frame::ConvertToCRD()
-Frame::CRDtype Frame::ConvertToCRD(int numBoxCrd, bool hasVel) const {
-  int nvel;
-  if (hasVel)
-    nvel = ncoord_;
-  else
-    nvel = 0;
-  CRDtype farray;
-  farray.reserve( ncoord_ + nvel + numBoxCrd );
+void Frame::ConvertToCRD(float* farray, int numBoxCrd, bool hasVel) const {
   for (int ix = 0; ix < ncoord_; ++ix)
-    farray.push_back( (float)X_[ix]   );
-  for (int iv = 0; iv < nvel; ++iv )
-    farray.push_back( (float)V_[iv]   );
+    *(farray++) = (float)X_[ix];
+  if (hasVel) {
+    if (V_ != 0) {
+      for (int iv = 0; iv < ncoord_; ++iv)
+        *(farray++) = (float)V_[iv];
+    } else {
+      for (int iv = 0; iv < ncoord_; ++iv)
+        *(farray++) = 0.0f;
+    }
+  }
   for (int ib = 0; ib < numBoxCrd; ++ib)
-    farray.push_back( (float)box_[ib] );
-  return farray;
+    *(farray++) = (float)box_[ib];
 }
 
 // ---------- ACCESS INTERNAL DATA ---------------------------------------------
@@ -601,6 +635,34 @@ void Frame::SetCoordAndBox(Frame const& frameIn) {
   box_ = frameIn.box_;
 }
 
+// Frame::CopyFrame()
+/** Copy coordinates, velocities, forces, box, and replica/time info from
+  * input frame into existing memory. Both frames must have the same number
+  * of atoms and the same velocity/force layout.
+  * \return 1 if frames are not compatible, 0 otherwise.
+  */
+int Frame::CopyFrame(Frame const& frameIn) {
+  if (frameIn.natom_ != natom_ ||
+      (frameIn.V_ == 0) != (V_ == 0) ||
+      (frameIn.F_ == 0) != (F_ == 0) ||
+      frameIn.remd_indices_.size() != remd_indices_.size())
+    return 1;
+  memcpy(X_, frameIn.X_, natom_ * COORDSIZE_);
+  if (V_ != 0)
+    memcpy(V_, frameIn.V_, natom_ * COORDSIZE_);
+  if (F_ != 0)
+    memcpy(F_, frameIn.F_, natom_ * COORDSIZE_);
+  box_ = frameIn.box_;
+  T_ = frameIn.T_;
+  repidx_ = frameIn.repidx_;
+  crdidx_ = frameIn.crdidx_;
+  pH_ = frameIn.pH_;
+  redox_ = frameIn.redox_;
+  time_ = frameIn.time_;
+  remd_indices_ = frameIn.remd_indices_;
+  return 0;
+}
+
 int Frame::SetCoordinates(int natom, double* Xptr) {
   if (!memIsExternal_)
     mprinterr("Internal Error: Frame memory is internal, not setting from external pointer.\n");
@@ -971,10 +1033,13 @@ void Frame::Align(Frame const& REF, AtomMask const& mask) {
 
 // ---------- COORDINATE CALCULATION ------------------------------------------- 
 // Frame::RMSD()
+/** Get the best-fit RMSD of this Frame to Ref Frame. Both frames are
+  * translated to the origin. Since the rotation matrix is not needed the
+  * RMSD is obtained via the QCP method.
+  */
 double Frame::RMSD( Frame& Ref, bool useMassIn ) {
-  Matrix_3x3 U;
-  Vec3 Trans, refTrans;
-  return RMSD( Ref, U, Trans, refTrans, useMassIn );
+  Ref.CenterOnOrigin(useMassIn);
+  return RMSD_CenteredRef( Ref, useMassIn );
 }
 
 // Frame::RMSD()
@@ -998,13 +1063,113 @@ double Frame::RMSD( Frame& Ref, Matrix_3x3& U, Vec3& Trans, Vec3& refTrans, bool
   return RMSD_CenteredRef( Ref, U, Trans, useMassIn );
 }
 
+// Frame::CenteredCovariance()
+/** Translate this Frame to the origin and calculate the covariance (Kabsch)
+  * matrix with Ref Frame, which should already be at the origin. Both loops
+  * use scalar accumulators and hoist the mass weighting out of the loop so
+  * that the compiler can keep everything in registers/vectorize.
+  * \param Ref Previously-centered frame.
+  * \param rot Will be set to covariance matrix R = Xt * Ref.
+  * \param Trans Will be set to translation of this frame to the origin.
+  * \param mwss Will be set to 0.5 * weighted sum of squares of both frames.
+  * \param useMassIn If true, mass-weight everything.
+  * \return Total mass (# atoms if not mass-weighted), 0 on error.
+  */
+double Frame::CenteredCovariance(Frame const& Ref, Matrix_3x3& rot, Vec3& Trans,
+                                 double& mwss, bool useMassIn)
+{
+  double total_mass = 0.0;
+  double tx = 0.0, ty = 0.0, tz = 0.0;
+  // Rotation will occur around geometric center/center of mass
+  if (useMassIn) {
+    Darray::const_iterator mass = Mass_.begin();
+    for (int ix = 0; ix < ncoord_; ix += 3, ++mass) {
+      total_mass += *mass;
+      tx += (X_[ix  ] * (*mass));
+      ty += (X_[ix+1] * (*mass));
+      tz += (X_[ix+2] * (*mass));
+    }
+  } else {
+    total_mass = (double)natom_;
+    for (int ix = 0; ix < ncoord_; ix += 3) {
+      tx += X_[ix  ];
+      ty += X_[ix+1];
+      tz += X_[ix+2];
+    }
+  }
+  if (total_mass<Constants::SMALL) {
+    mprinterr("Error: Frame::RMSD: Divide by zero.\n");
+    return 0.0;
+  }
+  // Shift to common COM
+  tx = -tx / total_mass;
+  ty = -ty / total_mass;
+  tz = -tz / total_mass;
+  Trans[0] = tx;
+  Trans[1] = ty;
+  Trans[2] = tz;
+  // Translate this frame and calculate the covariance matrix of Coords
+  // and Reference (R = Xt * Ref) in the same pass.
+  double r0 = 0.0, r1 = 0.0, r2 = 0.0, r3 = 0.0, r4 = 0.0;
+  double r5 = 0.0, r6 = 0.0, r7 = 0.0, r8 = 0.0, ss = 0.0;
+  const double* XR = Ref.X_;
+  if (useMassIn) {
+    Darray::const_iterator mass = Mass_.begin();
+    for (int i = 0; i < ncoord_; i += 3, ++mass) {
+      double xt = X_[i  ] + tx;
+      double yt = X_[i+1] + ty;
+      double zt = X_[i+2] + tz;
+      X_[i  ] = xt;
+      X_[i+1] = yt;
+      X_[i+2] = zt;
+      double xr = XR[i  ];
+      double yr = XR[i+1];
+      double zr = XR[i+2];
+      double w = *mass;
+      ss += w * ( (xt*xt)+(yt*yt)+(zt*zt)+(xr*xr)+(yr*yr)+(zr*zr) );
+      xt *= w;
+      yt *= w;
+      zt *= w;
+      r0 += xt*xr; r1 += xt*yr; r2 += xt*zr;
+      r3 += yt*xr; r4 += yt*yr; r5 += yt*zr;
+      r6 += zt*xr; r7 += zt*yr; r8 += zt*zr;
+    }
+  } else {
+    for (int i = 0; i < ncoord_; i += 3) {
+      double xt = X_[i  ] + tx;
+      double yt = X_[i+1] + ty;
+      double zt = X_[i+2] + tz;
+      X_[i  ] = xt;
+      X_[i+1] = yt;
+      X_[i+2] = zt;
+      double xr = XR[i  ];
+      double yr = XR[i+1];
+      double zr = XR[i+2];
+      ss += (xt*xt)+(yt*yt)+(zt*zt)+(xr*xr)+(yr*yr)+(zr*zr);
+      r0 += xt*xr; r1 += xt*yr; r2 += xt*zr;
+      r3 += yt*xr; r4 += yt*yr; r5 += yt*zr;
+      r6 += zt*xr; r7 += zt*yr; r8 += zt*zr;
+    }
+  }
+  rot[0] = r0; rot[1] = r1; rot[2] = r2;
+  rot[3] = r3; rot[4] = r4; rot[5] = r5;
+  rot[6] = r6; rot[7] = r7; rot[8] = r8;
+  mwss = 0.5 * ss; // E0 = 0.5*Sum(xn^2+yn^2)
+  return total_mass;
+}
+
 // Frame::RMSD_CenteredRef()
 /** Calculate RMSD of this Frame to Ref Frame previously centered at origin.
+  * This frame will be translated to the origin. Since no rotation matrix
+  * is needed the RMSD is obtained via the QCP method.
   */
 double Frame::RMSD_CenteredRef( Frame const& Ref, bool useMassIn ) {
-  Matrix_3x3 U;
+  Matrix_3x3 rot;
   Vec3 Trans;
-  return RMSD_CenteredRef( Ref, U, Trans, useMassIn );
+  double mwss;
+  double total_mass = CenteredCovariance( Ref, rot, Trans, mwss, useMassIn );
+  if (total_mass < Constants::SMALL) return -1;
+  return QCP_RMSD( rot.Dptr(), mwss, total_mass );
 }
 
 static inline void normalize(double* vIn) {
@@ -1026,77 +1191,13 @@ static inline void normalize(double* vIn) {
   */ 
 double Frame::RMSD_CenteredRef( Frame const& Ref, Matrix_3x3& U, Vec3& Trans, bool useMassIn)
 {
-  double total_mass, cp[3], sig3, b[9];
-  // Rotation will occur around geometric center/center of mass
-  Trans.Zero();
-  if (useMassIn) {
-    Darray::iterator mass = Mass_.begin();
-    total_mass = 0.0;
-    for (int ix = 0; ix < ncoord_; ix += 3) {
-      total_mass += *mass;
-      Trans[0] += (X_[ix  ] * (*mass));
-      Trans[1] += (X_[ix+1] * (*mass));
-      Trans[2] += (X_[ix+2] * (*mass));
-      ++mass;
-    }
-  } else {
-    total_mass = (double)natom_;
-    for (int ix = 0; ix < ncoord_; ix += 3) {
-      Trans[0] += X_[ix  ];
-      Trans[1] += X_[ix+1];
-      Trans[2] += X_[ix+2];
-    }
-  }
-  if (total_mass<Constants::SMALL) {
-    mprinterr("Error: Frame::RMSD: Divide by zero.\n");
-    return -1;
-  }
-  Trans[0] /= total_mass;
-  Trans[1] /= total_mass;
-  Trans[2] /= total_mass;
-  //mprintf("  FRAME COM: %f %f %f\n",Trans[0],Trans[1],Trans[2]); //DEBUG
-
-  // Shift to common COM
-  Trans.Neg();
-  Translate(Trans);
-  //for (int i = 0; i < natom_; i++) {
-  //  mprinterr("\tSHIFTED FRAME %i: %f %f %f\n",i,X_[i*3],X_[i*3+1],X_[i*3+2]); //DEBUG
-  //  mprinterr("\tSHIFTED REF %i  : %f %f %f\n",i,Ref.X_[i*3],Ref.X_[i*3+1],Ref.X_[i*3+2]); //DEBUG
-  //}
-
+  double cp[3], sig3, b[9];
   // Use Kabsch algorithm to calculate optimum rotation matrix.
   // U = [(RtR)^.5][R^-1]
-  double mwss = 0.0;
-  Matrix_3x3 rot(0.0);
-  // Calculate covariance matrix of Coords and Reference (R = Xt * Ref)
-  Darray::iterator mass = Mass_.begin();
-  double atom_mass = 1.0;
-  for (int i = 0; i < ncoord_; i += 3, ++mass)
-  {
-    double xt = X_[i  ];
-    double yt = X_[i+1];
-    double zt = X_[i+2];
-    double xr = Ref.X_[i  ];
-    double yr = Ref.X_[i+1];
-    double zr = Ref.X_[i+2];
-    // Use atom_mass to hold mass for this atom if specified
-    if (useMassIn)
-      atom_mass = *mass;
-    mwss += atom_mass * ( (xt*xt)+(yt*yt)+(zt*zt)+(xr*xr)+(yr*yr)+(zr*zr) );
-    // Calculate the Kabsch matrix: R = (rij) = Sum(yni*xnj)
-    rot[0] += atom_mass*xt*xr;
-    rot[1] += atom_mass*xt*yr;
-    rot[2] += atom_mass*xt*zr;
-
-    rot[3] += atom_mass*yt*xr;
-    rot[4] += atom_mass*yt*yr;
-    rot[5] += atom_mass*yt*zr;
-
-    rot[6] += atom_mass*zt*xr;
-    rot[7] += atom_mass*zt*yr;
-    rot[8] += atom_mass*zt*zr;
-  }
-  mwss *= 0.5;    // E0 = 0.5*Sum(xn^2+yn^2) 
+  double mwss;
+  Matrix_3x3 rot;
+  double total_mass = CenteredCovariance( Ref, rot, Trans, mwss, useMassIn );
+  if (total_mass < Constants::SMALL) return -1;
   //DEBUG
   //mprinterr("ROT:\n%lf %lf %lf\n%lf %lf %lf\n%lf %lf %lf\n",
   //          rot[0],rot[1],rot[2],rot[3],rot[4],rot[5],rot[6],rot[7],rot[8]);
@@ -1170,17 +1271,25 @@ double Frame::RMSD_NoFit( Frame const& Ref, bool useMass) const {
   double rms_return = 0.0;
   double total_mass = 0.0;
   
-  Darray::const_iterator mass = Mass_.begin();
-  double atom_mass = 1.0;
-  for (int i = 0; i < ncoord_; i += 3, ++mass)
-  {
-    double xx = Ref.X_[i  ] - X_[i  ];
-    double yy = Ref.X_[i+1] - X_[i+1];
-    double zz = Ref.X_[i+2] - X_[i+2];
-    if (useMass) 
-      atom_mass = *mass;
-    total_mass += atom_mass;
-    rms_return += (atom_mass * (xx*xx + yy*yy + zz*zz));
+  if (useMass) {
+    Darray::const_iterator mass = Mass_.begin();
+    for (int i = 0; i < ncoord_; i += 3, ++mass)
+    {
+      double xx = Ref.X_[i  ] - X_[i  ];
+      double yy = Ref.X_[i+1] - X_[i+1];
+      double zz = Ref.X_[i+2] - X_[i+2];
+      total_mass += *mass;
+      rms_return += ((*mass) * (xx*xx + yy*yy + zz*zz));
+    }
+  } else {
+    for (int i = 0; i < ncoord_; i += 3)
+    {
+      double xx = Ref.X_[i  ] - X_[i  ];
+      double yy = Ref.X_[i+1] - X_[i+1];
+      double zz = Ref.X_[i+2] - X_[i+2];
+      rms_return += (xx*xx + yy*yy + zz*zz);
+    }
+    total_mass = (double)natom_;
   }
 
   if (total_mass<Constants::SMALL) {
@@ -54,6 +54,12 @@ class Frame {
     void SetFromCRD(CRDtype const&, AtomMask const&, int, int, bool);
     /// Convert this frame to CRDtype.
     CRDtype ConvertToCRD(int, bool) const;
+    /// Assign given float array (coords, [velocities], box) to this frame.
+    void SetFromCRD(const float*, int, int, bool);
+    /// Assign selected atoms from given float array to this frame.
+    void SetFromCRD(const float*, AtomMask const&, int, int, bool);
+    /// Convert this frame in place to given float array with room for coords, [velocities], box.
+    void ConvertToCRD(float*, int, bool) const;
     // -------------------------------------------
     /// \return Size of Frame in memory
     size_t DataSize() const;
@@ -162,6 +168,8 @@ class Frame {
     int SetCoordinates(int, double*);
     /// Copy entire input frame according to mask.
     void SetFrame(Frame const&, AtomMask const&);
+    /// Copy entire input frame with same # atoms without reallocating.
+    int CopyFrame(Frame const&);
     // ----- Frame coordinate remapping ----------
     /// Copy entire input frame, reorder according to input map. 
     void SetCoordinatesByMap(Frame const&, std::vector<int>const&);
@@ -272,6 +280,7 @@ class Frame {
     bool memIsExternal_; ///< True if Frame is not responsible for freeing memory.
 
     void swap(Frame&, Frame&);
+    double CenteredCovariance(Frame const&, Matrix_3x3&, Vec3&, double&, bool);
     void IncreaseX();
     inline bool ReallocateX(int);
 };
@@ -17,13 +17,22 @@ static inline void CheckEven(int& N, char dir) {
 // GridAction::GridInit()
 DataSet_GridFlt* GridAction::GridInit(const char* callingRoutine, ArgList& argIn, DataSetList& DSL) 
 {
-  DataSet_GridFlt* Grid = 0; 
+  return (DataSet_GridFlt*)GridInit( callingRoutine, argIn, DSL, DataSet::GRID_FLT );
+}
+
+/** Find existing or create new grid data set of given type (GRID_FLT
+  * or GRID_SPARSE) and set up the gridding mode.
+  */
+DataSet_3D* GridAction::GridInit(const char* callingRoutine, ArgList& argIn, DataSetList& DSL,
+                                 DataSet::DataType typeIn)
+{
+  DataSet_3D* Grid = 0;
   bool specifiedCenter = false;
   std::string dsname = argIn.GetStringKey("data");
   std::string refname = argIn.GetStringKey("boxref");
   if (!dsname.empty()) { 
     // Get existing grid dataset
-    Grid = (DataSet_GridFlt*)DSL.FindSetOfType( dsname, DataSet::GRID_FLT );
+    Grid = (DataSet_3D*)DSL.FindSetOfType( dsname, typeIn );
     if (Grid == 0) {
       mprinterr("Error: %s: Could not find grid data set with name %s\n",
                 callingRoutine, dsname.c_str());
@@ -51,7 +60,7 @@ DataSet_GridFlt* GridAction::GridInit(const char* callingRoutine, ArgList& argIn
       mprinterr("Error:  %s: Invalid grid sizes\n", callingRoutine);
       return 0;
     }
-    Grid = (DataSet_GridFlt*)DSL.AddSet( DataSet::GRID_FLT, argIn.GetStringKey("name"), "GRID" );
+    Grid = (DataSet_3D*)DSL.AddSet( typeIn, argIn.GetStringKey("name"), "GRID" );
     if (Grid == 0) return 0;
     if (Grid->Allocate_N_O_Box(nx,ny,nz,Vec3(0.0),REF->RefFrame().BoxCrd())) return 0;
   } else {
@@ -81,7 +90,7 @@ DataSet_GridFlt* GridAction::GridInit(const char* callingRoutine, ArgList& argIn
       gridctr.SetVec(cx, cy, cz);
       specifiedCenter = true;
     }
-    Grid = (DataSet_GridFlt*)DSL.AddSet( DataSet::GRID_FLT, argIn.GetStringKey("name"), "GRID" );
+    Grid = (DataSet_3D*)DSL.AddSet( typeIn, argIn.GetStringKey("name"), "GRID" );
     if (Grid == 0) return 0;
     // Set up grid from dims, center, and spacing
     // NOTE: # of grid points in each direction with be forced to be even.
@@ -118,19 +127,8 @@ DataSet_GridFlt* GridAction::GridInit(const char* callingRoutine, ArgList& argIn
   return Grid;
 }
 
-#ifdef MPI
-int GridAction::ParallelGridInit(Parallel::Comm const& commIn, DataSet_GridFlt* Grid) {
-  if (commIn.Rank() > 0) {
-    // Since this set may have been read in (and therefore is synced),
-    // zero it out on all non-master threads to avoid overcounting.
-    std::fill( Grid->begin(), Grid->end(), 0.0 );
-  }
-  return 0;
-}
-#endif
-
 // GridAction::GridInfo() 
-void GridAction::GridInfo(DataSet_GridFlt const& grid) {
+void GridAction::GridInfo(DataSet_3D const& grid) {
   if (mode_ == BOX)
     mprintf("\tOffset for points is box center.\n");
   else if (mode_ == MASKCENTER)
@@ -3,6 +3,7 @@
 #include "DataSetList.h"
 #include "DataSet_GridFlt.h"
 #include "Topology.h"
+#include "GridBinner.h"
 /// Class for setting up a grid within an action.
 class GridAction {
   public:
@@ -11,12 +12,14 @@ class GridAction {
     GridAction() : increment_(1.0) {}
     static const char* HelpText;
     DataSet_GridFlt* GridInit(const char*, ArgList&, DataSetList&);
+    /// Set up grid of given type (GRID_FLT or GRID_SPARSE).
+    DataSet_3D* GridInit(const char*, ArgList&, DataSetList&, DataSet::DataType);
 #   ifdef MPI
-    int ParallelGridInit(Parallel::Comm const&, DataSet_GridFlt*);
+    template <class GRID> int ParallelGridInit(Parallel::Comm const&, GRID*);
 #   endif
-    void GridInfo(DataSet_GridFlt const&);
+    void GridInfo(DataSet_3D const&);
     int GridSetup(Topology const&, CoordinateInfo const&);
-    inline void GridFrame(Frame const&, AtomMask const&, DataSet_GridFlt&);
+    template <class GRID> void GridFrame(Frame const&, AtomMask const&, GRID&);
     GridModeType GridMode()      const { return mode_;       }
     AtomMask const& CenterMask() const { return centerMask_; }
     float Increment()            const { return increment_;  }
@@ -24,22 +27,29 @@ class GridAction {
     GridModeType mode_;
     AtomMask centerMask_;
     float increment_;     ///< Set to -1 if negative, 1 if not.
+    GridBinner binner_;   ///< Bins atoms on the grid.
 };
-// ----- INLINE FUNCTIONS ------------------------------------------------------
-void GridAction::GridFrame(Frame const& currentFrame, AtomMask const& mask, 
-                           DataSet_GridFlt& grid) 
-{
-  if (mode_==BOX) {
-    Vec3 offset = currentFrame.BoxCrd().Center();
-    for (AtomMask::const_iterator atom = mask.begin(); atom != mask.end(); ++atom)
-      grid.Increment( Vec3(currentFrame.XYZ(*atom)) - offset, increment_ );
-  } else if (mode_==MASKCENTER) {
-    Vec3 offset = currentFrame.VGeometricCenter( centerMask_ );
-    for (AtomMask::const_iterator atom = mask.begin(); atom != mask.end(); ++atom)
-      grid.Increment( Vec3(currentFrame.XYZ(*atom)) - offset, increment_ );
-  } else {// mode_==ORIGIN/SPECIFIEDCENTER, no offset
-    for (AtomMask::const_iterator atom = mask.begin(); atom != mask.end(); ++atom)
-      grid.Increment( currentFrame.XYZ(*atom), increment_ );
+// ----- TEMPLATE FUNCTIONS ----------------------------------------------------
+#ifdef MPI
+template <class GRID> int GridAction::ParallelGridInit(Parallel::Comm const& commIn, GRID* Grid) {
+  if (commIn.Rank() > 0) {
+    // Since this set may have been read in (and therefore is synced),
+    // zero it out on all non-master threads to avoid overcounting.
+    for (typename GRID::iterator gval = Grid->begin(); gval != Grid->end(); ++gval)
+      *gval = 0.0;
   }
+  return 0;
+}
+#endif
+template <class GRID> void GridAction::GridFrame(Frame const& currentFrame, AtomMask const& mask,
+                                                 GRID& grid)
+{
+  if (mode_==BOX)
+    binner_.BinPoints( grid, currentFrame, mask, currentFrame.BoxCrd().Center(), increment_ );
+  else if (mode_==MASKCENTER)
+    binner_.BinPoints( grid, currentFrame, mask, currentFrame.VGeometricCenter( centerMask_ ),
+                       increment_ );
+  else // mode_==ORIGIN/SPECIFIEDCENTER, no offset
+    binner_.BinPoints( grid, currentFrame, mask, Vec3(0.0), increment_ );
 }
 #endif
@@ -0,0 +1,114 @@
+#include <cmath> // floor, ceil, exp, sqrt
+#include "GridBinner.h"
+#include "Constants.h" // PI
+#include "DataSet_GridSparse.h" // PlanesPerBrick
+
+const double GridBinner::sqrt_8_pi_cubed = sqrt(8.0*Constants::PI*Constants::PI*Constants::PI);
+
+/** Binning a point is cheap; only worth starting threads if there are
+  * at least this many points per thread.
+  */
+const int GridBinner::MIN_ATOMS_PER_THREAD = 1000;
+
+const int GridBinner::PLANES_PER_BRICK = (int)DataSet_GridSparse::PlanesPerBrick();
+
+// CONSTRUCTOR
+GridBinner::GridBinner() : nthreads_(1) {
+# ifdef _OPENMP
+  nthreads_ = omp_get_max_threads();
+# endif
+}
+
+/** \return First X plane of slab, rounded down to a brick boundary. */
+int GridBinner::SlabBegin(int nx, int slab, int nslab) {
+  if (slab >= nslab) return nx;
+  int xbeg = (int)(((long int)nx * (long int)slab) / (long int)nslab);
+  return xbeg - (xbeg % PLANES_PER_BRICK);
+}
+
+/** Determine voxel range and Gaussian parameters of atoms overlapping
+  * the grid, divide the X planes into slabs, and assign each splat to
+  * every slab it overlaps, in atom order.
+  * \return Number of slabs.
+  */
+int GridBinner::SetupSplats(int nX, int nY, int nZ, Vec3 const& oxyz, Vec3 const& dxyz,
+                            Frame const& frm, Iarray const& atoms,
+                            std::vector<float> const& halfradii, double stepfac, bool sphere)
+{
+  int ngrid[3];
+  ngrid[0] = nX;
+  ngrid[1] = nY;
+  ngrid[2] = nZ;
+  splats_.clear();
+  for (unsigned int midx = 0; midx != atoms.size(); midx++)
+  {
+    double rhalf = (double)halfradii[midx];
+    const double* xyz = frm.XYZ( atoms[midx] );
+    Splat s;
+    bool onGrid = true;
+    for (int d = 0; d != 3 && onGrid; d++) {
+      int id = (int) ( floor( (xyz[d]-oxyz[d]) / dxyz[d] + 0.5 ) );
+      int nstep = (int) ceil(stepfac * rhalf / dxyz[d]);
+      s.beg_[d] = std::max(id - nstep, 0);
+      s.end_[d] = std::min(id + nstep, ngrid[d]);
+      s.xyz_[d] = xyz[d];
+      onGrid = (s.beg_[d] < s.end_[d]);
+    }
+    if (!onGrid) continue;
+    s.norm_ = 1 / (sqrt_8_pi_cubed * rhalf*rhalf*rhalf);
+    s.exfac_ = -1.0 / (2.0 * rhalf * rhalf);
+    if (sphere)
+      s.rcut2_ = rhalf*rhalf;
+    else
+      s.rcut2_ = 99999999.0;
+    splats_.push_back( s );
+  }
+  // Use more slabs than threads for load balance.
+  int nchunks = 1;
+  if (nthreads_ > 1)
+    nchunks = std::min((nX + PLANES_PER_BRICK - 1) / PLANES_PER_BRICK, 4 * nthreads_);
+  if ((int)chunkBeg_.size() != nchunks + 1 || chunkBeg_.back() != nX) {
+    chunkBeg_.resize( nchunks + 1 );
+    for (int c = 0; c <= nchunks; c++)
+      chunkBeg_[c] = SlabBegin( nX, c, nchunks );
+  }
+  chunkSplats_.resize( nchunks );
+  for (std::vector<Iarray>::iterator it = chunkSplats_.begin(); it != chunkSplats_.end(); ++it)
+    it->clear();
+  for (unsigned int sidx = 0; sidx != splats_.size(); sidx++) {
+    Splat const& s = splats_[sidx];
+    int c = (int)(std::upper_bound(chunkBeg_.begin(), chunkBeg_.end(), s.beg_[0]) -
+                  chunkBeg_.begin()) - 1;
+    for (; c < nchunks && chunkBeg_[c] < s.end_[0]; c++)
+      chunkSplats_[c].push_back( sidx );
+  }
+  return nchunks;
+}
+
+/** Tables are stored X, then Y, then Z. */
+void GridBinner::FillTables(Splat const& s, int xbeg, int xend,
+                            Vec3 const& oxyz, Vec3 const& dxyz,
+                            Darray& etab, Darray& d2tab)
+{
+  int nx = xend - xbeg;
+  int ny = s.end_[1] - s.beg_[1];
+  int nz = s.end_[2] - s.beg_[2];
+  etab.resize( nx + ny + nz );
+  d2tab.resize( nx + ny + nz );
+  int tidx = 0;
+  for (int i = xbeg; i < xend; i++, tidx++) {
+    double d = oxyz[0] + i * dxyz[0] - s.xyz_[0];
+    d2tab[tidx] = d * d;
+    etab[tidx] = exp(s.exfac_ * d2tab[tidx]);
+  }
+  for (int j = s.beg_[1]; j < s.end_[1]; j++, tidx++) {
+    double d = oxyz[1] + j * dxyz[1] - s.xyz_[1];
+    d2tab[tidx] = d * d;
+    etab[tidx] = exp(s.exfac_ * d2tab[tidx]);
+  }
+  for (int k = s.beg_[2]; k < s.end_[2]; k++, tidx++) {
+    double d = oxyz[2] + k * dxyz[2] - s.xyz_[2];
+    d2tab[tidx] = d * d;
+    etab[tidx] = exp(s.exfac_ * d2tab[tidx]);
+  }
+}
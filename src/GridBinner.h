@@ -0,0 +1,190 @@
+#ifndef INC_GRIDBINNER_H
+#define INC_GRIDBINNER_H
+#include <vector>
+#include <algorithm> // std::min, std::max
+#include "Frame.h"
+#include "AtomMask.h"
+#include "GridBin.h"
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+/// Add atomic contributions to a 3D grid, in parallel if OpenMP is enabled.
+/** Instead of giving each thread its own copy of the grid, the grid is
+  * split into slabs of X planes and each slab is only written by the
+  * thread that owns it. Atoms are added in the same order as in serial,
+  * so results do not depend on the number of threads. Slabs always start
+  * on a sparse grid brick boundary so that bricks allocated on first
+  * write are never shared between threads.
+  * Grid functions are templated so that both dense (DataSet_GridFlt) and
+  * sparse (DataSet_GridSparse) grids can be used.
+  */
+class GridBinner {
+  public:
+    GridBinner();
+    /// \return Number of threads that will be used.
+    int Nthreads() const { return nthreads_; }
+    /// Add value to grid bin containing each selected atom minus given offset.
+    template <class GRID> void BinPoints(GRID&, Frame const&, AtomMask const&, Vec3 const&, float);
+    /// Add a normalized 3D Gaussian centered on each atom to an orthogonal grid.
+    template <class GRID> void SplatGaussians(GRID&, Vec3 const&, Vec3 const&, Frame const&,
+                                              std::vector<int> const&, std::vector<float> const&,
+                                              double, bool);
+  private:
+    typedef std::vector<int> Iarray;
+    typedef std::vector<double> Darray;
+    /// Hold voxel range and Gaussian parameters for one atom.
+    class Splat {
+      public:
+        Splat() {}
+        double xyz_[3]; ///< Atom coordinates
+        double norm_;   ///< Gaussian normalization factor
+        double exfac_;  ///< Gaussian exponent factor, -1 / (2 * sigma^2)
+        double rcut2_;  ///< Voxels farther than this (squared) are skipped
+        int beg_[3];    ///< First voxel in each dimension
+        int end_[3];    ///< One past last voxel in each dimension
+    };
+    /// \return First X plane of given slab when grid is divided into given # slabs.
+    static int SlabBegin(int, int, int);
+    /// Set up splats_ and slabs for Gaussians on grid of given size; \return # slabs.
+    int SetupSplats(int, int, int, Vec3 const&, Vec3 const&, Frame const&,
+                    Iarray const&, std::vector<float> const&, double, bool);
+    /// Fill 1D Gaussian and distance^2 tables for splat over given X range.
+    static void FillTables(Splat const&, int, int, Vec3 const&, Vec3 const&, Darray&, Darray&);
+    /// Add Gaussian for given splat to voxels with X index in given range.
+    template <class GRID> static void AddSplat(GRID&, Splat const&, Vec3 const&, Vec3 const&,
+                                               int, int, Darray&, Darray&);
+
+    static const double sqrt_8_pi_cubed;
+    static const int MIN_ATOMS_PER_THREAD; ///< Below this bin points serially
+    static const int PLANES_PER_BRICK;     ///< Slabs start on multiples of this
+    std::vector<long int> bins_;  ///< X, Y, Z bin for each point, X is -1 if off grid
+    std::vector<Splat> splats_;   ///< Gaussian for each atom that overlaps the grid
+    std::vector<Iarray> chunkSplats_; ///< Indices into splats_ overlapping each slab
+    Iarray chunkBeg_;             ///< First X plane of each slab (+ end)
+    int nthreads_;                ///< Number of threads
+};
+// ----- TEMPLATE FUNCTIONS ----------------------------------------------------
+/** Grid bins are calculated in parallel. Each thread then adds the
+  * points that fall in its own slab of X planes.
+  */
+template <class GRID>
+void GridBinner::BinPoints(GRID& grid, Frame const& frm, AtomMask const& mask,
+                           Vec3 const& offset, float inc)
+{
+  int npts = mask.Nselected();
+  GridBin const& bin = grid.Bin();
+  bins_.resize( 3 * npts );
+  int idx;
+# ifdef _OPENMP
+  bool inParallel = (nthreads_ > 1 && npts >= MIN_ATOMS_PER_THREAD * nthreads_);
+# pragma omp parallel private(idx) if (inParallel)
+  {
+  int nslab = omp_get_num_threads();
+  int mythread = omp_get_thread_num();
+  long int xbeg = SlabBegin( (int)grid.NX(), mythread, nslab );
+  long int xend = SlabBegin( (int)grid.NX(), mythread + 1, nslab );
+# pragma omp for
+# endif
+  for (idx = 0; idx < npts; idx++) {
+    Vec3 xyz = Vec3(frm.XYZ( mask[idx] )) - offset;
+    long int* ijk = &bins_[3*idx];
+    size_t i, j, k;
+    if (bin.Calc(xyz[0], xyz[1], xyz[2], i, j, k)) {
+      ijk[0] = (long int)i;
+      ijk[1] = (long int)j;
+      ijk[2] = (long int)k;
+    } else
+      ijk[0] = -1;
+  }
+# ifdef _OPENMP
+  // Implicit barrier after omp for; all bins are set.
+  for (idx = 0; idx < npts; idx++) {
+    const long int* ijk = &bins_[3*idx];
+    if (ijk[0] >= xbeg && ijk[0] < xend)
+      grid.Increment( ijk[0], ijk[1], ijk[2], inc );
+  }
+  } // END omp parallel
+# else
+  for (idx = 0; idx < npts; idx++) {
+    const long int* ijk = &bins_[3*idx];
+    if (ijk[0] > -1)
+      grid.Increment( ijk[0], ijk[1], ijk[2], inc );
+  }
+# endif
+}
+
+/** The Gaussian is separable, exp(a*(dx^2+dy^2+dz^2)) = exp(a*dx^2) *
+  * exp(a*dy^2) * exp(a*dz^2), so only 1D tables of exponentials along
+  * each axis are needed instead of one exp per voxel.
+  */
+template <class GRID>
+void GridBinner::AddSplat(GRID& grid, Splat const& s, Vec3 const& oxyz, Vec3 const& dxyz,
+                          int xlo, int xhi, Darray& etab, Darray& d2tab)
+{
+  int xbeg = std::max(s.beg_[0], xlo);
+  int xend = std::min(s.end_[0], xhi);
+  if (xbeg >= xend) return;
+  FillTables( s, xbeg, xend, oxyz, dxyz, etab, d2tab );
+  int nx = xend - xbeg;
+  int ny = s.end_[1] - s.beg_[1];
+  int nz = s.end_[2] - s.beg_[2];
+  const double* ex = &etab[0];
+  const double* ey = ex + nx;
+  const double* ez = ey + ny;
+  const double* dx2 = &d2tab[0];
+  const double* dy2 = dx2 + nx;
+  const double* dz2 = dy2 + ny;
+  for (int i = 0; i < nx; i++) {
+    for (int j = 0; j < ny; j++) {
+      double dxy2 = dx2[i] + dy2[j];
+      if (dxy2 >= s.rcut2_) continue;
+      double exy = s.norm_ * ex[i] * ey[j];
+      for (int k = 0; k < nz; k++)
+        if (dxy2 + dz2[k] < s.rcut2_)
+          grid.Increment( xbeg + i, s.beg_[1] + j, s.beg_[2] + k, (float)(exy * ez[k]) );
+    }
+  }
+}
+
+/** Add a normalized Gaussian with sigma equal to the given half radius
+  * for each atom. In each dimension the Gaussian is smeared over
+  * ceil(stepfac * sigma / spacing) voxels; this is consistent with the
+  * VMD volmap tool. If sphere is true, voxels farther than sigma from
+  * the atom are skipped.
+  * \param grid Grid to add to.
+  * \param oxyz Grid origin.
+  * \param dxyz Grid spacing.
+  * \param frm Current coordinates.
+  * \param atoms Atoms to add.
+  * \param halfradii Half radius (sigma) of each atom in atoms.
+  * \param stepfac Factor for determining how many voxels to smear over.
+  * \param sphere If true skip voxels farther than sigma.
+  */
+template <class GRID>
+void GridBinner::SplatGaussians(GRID& grid, Vec3 const& oxyz, Vec3 const& dxyz,
+                                Frame const& frm, Iarray const& atoms,
+                                std::vector<float> const& halfradii,
+                                double stepfac, bool sphere)
+{
+  int nchunks = SetupSplats( (int)grid.NX(), (int)grid.NY(), (int)grid.NZ(), oxyz, dxyz,
+                             frm, atoms, halfradii, stepfac, sphere );
+  // Each slab is only written by the thread that processes it.
+  int chunk;
+# ifdef _OPENMP
+# pragma omp parallel private(chunk) if (nchunks > 1)
+  {
+# endif
+  Darray etab, d2tab;
+# ifdef _OPENMP
+# pragma omp for schedule(dynamic)
+# endif
+  for (chunk = 0; chunk < nchunks; chunk++)
+    for (Iarray::const_iterator sidx = chunkSplats_[chunk].begin();
+                                sidx != chunkSplats_[chunk].end(); ++sidx)
+      AddSplat( grid, splats_[*sidx], oxyz, dxyz, chunkBeg_[chunk], chunkBeg_[chunk+1],
+                etab, d2tab );
+# ifdef _OPENMP
+  } // END omp parallel
+# endif
+}
+#endif
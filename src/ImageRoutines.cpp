@@ -88,6 +88,42 @@ Vec3 Image::SetupTruncoct( Frame const& frameIn, AtomMask* ComMask, bool useMass
   return Vec3(0.0, 0.0, 0.0); // Default is origin {0,0,0}
 }
 
+/** \return Translation that images Coord into non-orthogonal cell (see
+  *         Image::Nonortho() for a single coordinate), with fractional
+  *         coordinates of the trunc. oct. center (f2) already calculated.
+  */
+static inline Vec3 NonorthoTrans(Vec3 const& Coord, bool truncoct, bool origin,
+                                 Matrix_3x3 const& ucell, Matrix_3x3 const& recip,
+                                 Vec3 const& f2, double min)
+{
+  int ixyz[3];
+
+  Vec3 fc = recip * Coord;
+
+  if ( origin )
+    fc += 0.5; 
+
+  Vec3 boxTransOut = ucell.TransposeMult( Vec3(floor(fc[0]), floor(fc[1]), floor(fc[2])) );
+  boxTransOut.Neg();
+
+  // Put into familiar trunc. oct. shape
+  if (truncoct) {
+    Vec3 TransCoord = recip * (Coord + boxTransOut);
+
+    if (origin)
+      TransCoord += 0.5;
+
+    DIST2_ImageNonOrthoRecip(TransCoord, f2, min, ixyz, ucell);
+    if (ixyz[0] != 0 || ixyz[1] != 0 || ixyz[2] != 0) {
+      boxTransOut += ucell.TransposeMult( ixyz );
+      //if (debug > 2)
+      //  mprintf( "  IMAGING, FAMILIAR OFFSETS ARE %i %i %i\n", 
+      //          ixyz[0], ixyz[1], ixyz[2]);
+    }
+  }
+  return boxTransOut;
+}
+
 // Image::Nonortho()
 /** \param frameIn Frame to image.
   * \param origin If true image w.r.t. coordinate origin.
@@ -112,14 +148,24 @@ void Image::Nonortho(Frame& frameIn, bool origin, Vec3 const& fcom, Vec3 const&
     min = 100.0 * (frameIn.BoxCrd().BoxX()*frameIn.BoxCrd().BoxX()+
                    frameIn.BoxCrd().BoxY()*frameIn.BoxCrd().BoxY()+
                    frameIn.BoxCrd().BoxZ()*frameIn.BoxCrd().BoxZ());
+  // Fractional coords of the trunc. oct. center are the same for every entity.
+  Vec3 f2 = recip * fcom;
+  if (origin)
+    f2 += 0.5;
 
-  // Loop over atom pairs
-  for (PairType::const_iterator atom = AtomPairs.begin();
-                                atom != AtomPairs.end(); ++atom)
+  // Loop over atom pairs. Entities do not overlap so each can be imaged
+  // independently.
+  int npairs = (int)AtomPairs.size() / 2;
+  int idx, firstAtom, lastAtom;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, firstAtom, lastAtom, Coord)
   {
-    int firstAtom = *atom;
-    ++atom;
-    int lastAtom = *atom;
+# pragma omp for schedule(dynamic, 256)
+# endif
+  for (idx = 0; idx < npairs; idx++)
+  {
+    firstAtom = AtomPairs[2*idx  ];
+    lastAtom  = AtomPairs[2*idx+1];
     //if (debug>2)
     //  mprintf( "  IMAGE processing atoms %i to %i\n", firstAtom+1, lastAtom);
     // Set up Coord with position to check for imaging based on first atom or 
@@ -133,11 +179,14 @@ void Image::Nonortho(Frame& frameIn, bool origin, Vec3 const& fcom, Vec3 const&
       Coord = frameIn.XYZ( firstAtom );
 
     // boxTrans will hold calculated translation needed to move atoms back into box
-    Vec3 boxTrans = Nonortho(Coord, truncoct, origin, ucell, recip, fcom, min) + offset;
+    Vec3 boxTrans = NonorthoTrans(Coord, truncoct, origin, ucell, recip, f2, min) + offset;
 
     frameIn.Translate(boxTrans, firstAtom, lastAtom);
 
   } // END loop over atom pairs
+# ifdef _OPENMP
+  } // END pragma omp parallel
+# endif
 }
 
 // Image::Nonortho()
@@ -153,35 +202,10 @@ Vec3 Image::Nonortho(Vec3 const& Coord, bool truncoct,
                      bool origin, Matrix_3x3 const& ucell, Matrix_3x3 const& recip, 
                      Vec3 const& fcom, double min)
 {
-  int ixyz[3];
-
-  Vec3 fc = recip * Coord;
-
-  if ( origin )
-    fc += 0.5; 
-
-  Vec3 boxTransOut = ucell.TransposeMult( Vec3(floor(fc[0]), floor(fc[1]), floor(fc[2])) );
-  boxTransOut.Neg();
-
-  // Put into familiar trunc. oct. shape
-  if (truncoct) {
-    Vec3 TransCoord = recip * (Coord + boxTransOut);
-    Vec3 f2 = recip * fcom;
-
-    if (origin) {
-      TransCoord += 0.5;
-      f2 += 0.5;
-    }
-
-    DIST2_ImageNonOrthoRecip(TransCoord, f2, min, ixyz, ucell);
-    if (ixyz[0] != 0 || ixyz[1] != 0 || ixyz[2] != 0) {
-      boxTransOut += ucell.TransposeMult( ixyz );
-      //if (debug > 2)
-      //  mprintf( "  IMAGING, FAMILIAR OFFSETS ARE %i %i %i\n", 
-      //          ixyz[0], ixyz[1], ixyz[2]);
-    }
-  }
-  return boxTransOut;
+  Vec3 f2 = recip * fcom;
+  if (origin)
+    f2 += 0.5;
+  return NonorthoTrans(Coord, truncoct, origin, ucell, recip, f2, min);
 }
 
 // -----------------------------------------------------------------------------
@@ -219,13 +243,19 @@ void Image::Ortho(Frame& frameIn, Vec3 const& bp, Vec3 const& bm, Vec3 const& of
   Vec3 offset(offIn[0] * frameIn.BoxCrd()[0],
               offIn[1] * frameIn.BoxCrd()[1],
               offIn[2] * frameIn.BoxCrd()[2]);
-  // Loop over atom pairs
-  for (PairType::const_iterator atom = AtomPairs.begin();
-                                atom != AtomPairs.end(); atom++)
+  // Loop over atom pairs. Entities do not overlap so each can be imaged
+  // independently.
+  int npairs = (int)AtomPairs.size() / 2;
+  int idx, firstAtom, lastAtom;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, firstAtom, lastAtom, Coord)
   {
-    int firstAtom = *atom;
-    ++atom;
-    int lastAtom = *atom;
+# pragma omp for schedule(dynamic, 256)
+# endif
+  for (idx = 0; idx < npairs; idx++)
+  {
+    firstAtom = AtomPairs[2*idx  ];
+    lastAtom  = AtomPairs[2*idx+1];
     //if (debug>2)
     //  mprintf( "  IMAGE processing atoms %i to %i\n", firstAtom+1, lastAtom);
     // Set up Coord with position to check for imaging based on first atom or 
@@ -244,6 +274,9 @@ void Image::Ortho(Frame& frameIn, Vec3 const& bp, Vec3 const& bm, Vec3 const& of
     // Translate atoms according to Coord
     frameIn.Translate(boxTrans, firstAtom, lastAtom);
   } // END loop over atom pairs
+# ifdef _OPENMP
+  } // END pragma omp parallel
+# endif
 }
 
 // Image::Ortho()
@@ -279,13 +312,19 @@ void Image::UnwrapNonortho( Frame& tgtIn, Frame& refIn, PairType const& AtomPair
                             bool center, bool useMass ) 
 {
   Vec3 vtgt, vref, boxTrans;
-  // Loop over atom pairs
-  for (PairType::const_iterator atom = AtomPairs.begin();
-                                atom != AtomPairs.end(); ++atom)
+  // Loop over atom pairs. Entities do not overlap so each can be unwrapped
+  // independently.
+  int npairs = (int)AtomPairs.size() / 2;
+  int idx, firstAtom, lastAtom;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, firstAtom, lastAtom, vtgt, vref, boxTrans)
+  {
+# pragma omp for schedule(dynamic, 256)
+# endif
+  for (idx = 0; idx < npairs; idx++)
   {
-    int firstAtom = *atom;
-    ++atom;
-    int lastAtom = *atom;
+    firstAtom = AtomPairs[2*idx  ];
+    lastAtom  = AtomPairs[2*idx+1];
     if (center) {
       // Use center of coordinates between first and last atoms.
       if (useMass) {
@@ -337,6 +376,9 @@ void Image::UnwrapNonortho( Frame& tgtIn, Frame& refIn, PairType const& AtomPair
     int i3 = firstAtom * 3;
     std::copy( tgtIn.xAddress()+i3, tgtIn.xAddress()+(lastAtom*3), refIn.xAddress()+i3 );
   } // END loop over atom pairs 
+# ifdef _OPENMP
+  } // END pragma omp parallel
+# endif
 }
 
 // Image::UnwrapOrtho()
@@ -345,13 +387,19 @@ void Image::UnwrapOrtho( Frame& tgtIn, Frame& refIn, PairType const& AtomPairs,
 {
   Vec3 vtgt, vref, boxTrans;
   Vec3 boxVec = tgtIn.BoxCrd().Lengths();
-  // Loop over atom pairs
-  for (PairType::const_iterator atom = AtomPairs.begin();
-                                atom != AtomPairs.end(); ++atom)
+  // Loop over atom pairs. Entities do not overlap so each can be unwrapped
+  // independently.
+  int npairs = (int)AtomPairs.size() / 2;
+  int idx, firstAtom, lastAtom;
+# ifdef _OPENMP
+# pragma omp parallel private(idx, firstAtom, lastAtom, vtgt, vref, boxTrans)
   {
-    int firstAtom = *atom;
-    ++atom;
-    int lastAtom = *atom;
+# pragma omp for schedule(dynamic, 256)
+# endif
+  for (idx = 0; idx < npairs; idx++)
+  {
+    firstAtom = AtomPairs[2*idx  ];
+    lastAtom  = AtomPairs[2*idx+1];
     if (center) {
       // Use center of coordinates between first and last atoms.
       if (useMass) {
@@ -376,6 +424,9 @@ void Image::UnwrapOrtho( Frame& tgtIn, Frame& refIn, PairType const& AtomPairs,
     int i3 = firstAtom * 3;
     std::copy( tgtIn.xAddress()+i3, tgtIn.xAddress()+(lastAtom*3), refIn.xAddress()+i3 );
   } // END loop over atom pairs
+# ifdef _OPENMP
+  } // END pragma omp parallel
+# endif
 }
 
 // -----------------------------------------------------------------------------
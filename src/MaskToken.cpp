@@ -1,5 +1,7 @@
 #include <locale>
 #include <stack> // Tokenize()
+#include <cmath> // sqrt
+#include <algorithm> // std::min, std::max
 #include "MaskToken.h"
 #include "ArgList.h" // Tokenize()
 #include "CpptrajStdio.h"
@@ -627,12 +629,15 @@ char MaskTokenArray::UnselectedChar_ = 'F';
 char* MaskTokenArray::ParseMask(AtomArrayT const& atoms,
                                 ResArrayT const& residues,
                                 MolArrayT const& molecules,
-                                const double* XYZ) const
+                                const double* XYZ,
+                                MaskSelectionCache* cache) const
 {
   std::stack<char*> Stack;
   char *pMask = 0; 
   char *pMask2 = 0;
   int err = 0;
+  unsigned int ndist = 0; // Index of distance token, for cache
+  NeighborGrid distGrid; // Used if no cache
 
   for (token_iterator token = maskTokens_.begin(); token != maskTokens_.end(); ++token)
   {
@@ -688,7 +693,12 @@ char* MaskTokenArray::ParseMask(AtomArrayT const& atoms,
         Mask_NEG( Stack.top(), atoms.size() );
         break;
       case MaskToken::OP_DIST :
-        err = SelectDistance( XYZ, Stack.top(), *token, atoms, residues, molecules);
+        if (cache != 0)
+          err = SelectDistance( XYZ, Stack.top(), *token, atoms, residues, molecules,
+                                cache->Grid(), &(cache->Witness(ndist++)) );
+        else
+          err = SelectDistance( XYZ, Stack.top(), *token, atoms, residues, molecules,
+                                distGrid, 0 );
         break;
       default:
         mprinterr("Error: Invalid mask token (Mask [%s], type [%s]).\n",
@@ -728,18 +738,98 @@ char* MaskTokenArray::ParseMask(AtomArrayT const& atoms,
   return pMask;
 }
 
-/** \param REF reference coordinates.
+// -----------------------------------------------------------------------------
+/// Used to determine if atoms are within a distance cutoff of any reference atom.
+/** Atoms outside the bounding box of the reference atoms (plus cutoff) are
+  * rejected immediately. Otherwise the reference atom that was within the
+  * cutoff the last time this atom was checked (e.g. the previous frame) is
+  * tried first if a witness array is given, since it usually still is; only
+  * if that fails are nearby reference atoms found with the grid. The result
+  * is the same as checking every reference atom.
+  */
+class DistanceSearch {
+  public:
+    typedef NeighborGrid::Iarray Iarray;
+    DistanceSearch(const double* REF, double dcut2, std::vector<char> const& isRef,
+                   char selChar, Iarray const& refIdx, NeighborGrid const& grid,
+                   Iarray* witness) :
+      REF_(REF), dcut2_(dcut2), dcut_(sqrt(dcut2)), isRef_(isRef), selChar_(selChar),
+      grid_(grid), witness_(witness)
+    {
+      for (int i = 0; i != 3; i++) {
+        bmin_[i] = REF[refIdx.front()*3 + i];
+        bmax_[i] = bmin_[i];
+      }
+      for (Iarray::const_iterator at = refIdx.begin(); at != refIdx.end(); ++at) {
+        const double* XYZ = REF + (*at * 3);
+        for (int i = 0; i != 3; i++) {
+          bmin_[i] = std::min(bmin_[i], XYZ[i]);
+          bmax_[i] = std::max(bmax_[i], XYZ[i]);
+        }
+      }
+      // Small margin guards against round-off at the box edge.
+      double reach = dcut_ * (1.0 + 1.0E-8);
+      for (int i = 0; i != 3; i++) {
+        bmin_[i] -= reach;
+        bmax_[i] += reach;
+      }
+    }
+    /// \return true if atom is within cutoff of any reference atom; nbrs is scratch space.
+    bool Near(int atomi, Iarray& nbrs) const {
+      const double* i_crd = REF_ + (atomi * 3);
+      if (i_crd[0] < bmin_[0] || i_crd[0] > bmax_[0] ||
+          i_crd[1] < bmin_[1] || i_crd[1] > bmax_[1] ||
+          i_crd[2] < bmin_[2] || i_crd[2] > bmax_[2])
+      {
+        if (witness_ != 0) (*witness_)[atomi] = -1;
+        return false;
+      }
+      if (witness_ != 0) {
+        int w = (*witness_)[atomi];
+        if (w > -1 && isRef_[w] == selChar_ && DIST2_NoImage(i_crd, REF_ + (w * 3)) < dcut2_)
+          return true;
+      }
+      grid_.GetCandidates(i_crd, dcut_, nbrs);
+      for (Iarray::const_iterator at = nbrs.begin(); at != nbrs.end(); ++at) {
+        if (DIST2_NoImage(i_crd, REF_ + (*at * 3)) < dcut2_) {
+          if (witness_ != 0) (*witness_)[atomi] = *at;
+          return true;
+        }
+      }
+      if (witness_ != 0) (*witness_)[atomi] = -1;
+      return false;
+    }
+  private:
+    const double* REF_;
+    double dcut2_;
+    double dcut_;
+    std::vector<char> const& isRef_;
+    char selChar_;
+    NeighborGrid const& grid_;
+    Iarray* witness_; ///< Reference atom last within cutoff of each atom; may be 0.
+    double bmin_[3];
+    double bmax_[3];
+};
+
+/** Reference atoms are placed on a grid so the cost depends on the number of
+  * atoms near the reference atoms rather than (# atoms) x (# reference atoms).
+  * Distances are not imaged.
+  * \param REF reference coordinates.
   * \param mask Initial atom selection; will be set with final output mask.
   * \param token Describe how atoms are to be selected.
   * \param atoms Atom array.
   * \param residues Residue array.
+  * \param distGrid Grid to place reference atoms on.
+  * \param witness If not 0, results of the previous selection with this token, used as a starting point.
   * \return 0 if successful, 1 if an error occurs.
   */
 int MaskTokenArray::SelectDistance(const double* REF, char *mask,
                                    MaskToken const& token,
                                    AtomArrayT const& atoms,
                                    ResArrayT const& residues,
-                                   MolArrayT const& molecules) const
+                                   MolArrayT const& molecules,
+                                   NeighborGrid& distGrid,
+                                   Iarray* witness) const
 {
   if (REF == 0) {
     mprinterr("Error: No reference set, cannot select by distance.\n");
@@ -749,24 +839,25 @@ int MaskTokenArray::SelectDistance(const double* REF, char *mask,
   double dcut2 = token.Distance2();
   // Create temporary array of atom #s currently selected in mask.
   // These are the atoms the search is based on.
-  typedef std::vector<unsigned int> Uarray;
-  Uarray Idx;
+  Iarray Idx;
   for (unsigned int i = 0; i < atoms.size(); i++) {
     if (mask[i] == SelectedChar_)
-      Idx.push_back( i*3 );
+      Idx.push_back( i );
   }
   if (Idx.empty()) {
     mprinterr("Error: Mask_SelectDistance: No atoms in prior selection.\n");
     return 1;
   }
-  //if (debug_ > 1) {
-  //  mprintf("\t\tDistance Op: Within=%i  DistOp=%i  distance^2=%f\n",
-  //          (int)token.Within(), (int)token.DistOp(), token.Distance2());
-  //  mprintf("\t\tSearch Mask=[");
-  //  for (Uarray::const_iterator at = Idx.begin(); at != Idx.end(); ++at)
-  //    mprintf(" %u",*at/3 + 1);
-  //  mprintf(" ]\n");
-  //}
+  if (token.DistOp() == MaskToken::BY_MOL && molecules.empty()) {
+    mprinterr("Error: No molecule info. Cannot select molecules by distance.\n");
+    return 1;
+  }
+  // Save initial selection since mask will be overwritten.
+  std::vector<char> isRef( mask, mask + atoms.size() );
+  if (witness != 0 && witness->size() != atoms.size())
+    witness->assign( atoms.size(), -1 );
+  distGrid.Setup( REF, Idx, sqrt(dcut2) );
+  DistanceSearch search( REF, dcut2, isRef, SelectedChar_, Idx, distGrid, witness );
 
   char char0, char1;
   if (token.Within()) {
@@ -781,28 +872,21 @@ int MaskTokenArray::SelectDistance(const double* REF, char *mask,
     char1 = UnselectedChar_;
   }
 
+  Iarray nbrs;
   if (token.DistOp() == MaskToken::BY_ATOM) {
     // Select by atom
     int n_of_atoms = (int)atoms.size();
     int atomi;
 #   ifdef _OPENMP
-#   pragma omp parallel private(atomi)
+#   pragma omp parallel private(atomi, nbrs)
     {
 #   pragma omp for
 #   endif
     for (atomi = 0; atomi < n_of_atoms; atomi++) {
-      // Initial state
-      mask[atomi] = char0;
-      const double* i_crd = REF + (atomi * 3);
-      // Loop over initially selected atoms
-      for (Uarray::const_iterator idx = Idx.begin(); idx != Idx.end(); ++idx) {
-        double d2 = DIST2_NoImage(i_crd, REF + *idx);
-        if (d2 < dcut2) {
-          // State changes
-          mask[atomi] = char1;
-          break;
-        }
-      } // END loop over initially selected atoms
+      if (search.Near(atomi, nbrs))
+        mask[atomi] = char1;
+      else
+        mask[atomi] = char0;
     } // END loop over all atoms
 #   ifdef _OPENMP
     } // END pragma omp parallel
@@ -813,30 +897,24 @@ int MaskTokenArray::SelectDistance(const double* REF, char *mask,
     int resi;
     // Loop over all residues
 #   ifdef _OPENMP
-#   pragma omp parallel private(resi)
+#   pragma omp parallel private(resi, nbrs)
     {
 #   pragma omp for
 #   endif
     for (resi = 0; resi < n_of_res; resi++) {
       // Initial state
       char schar = char0;
-      int atomi = residues[resi].FirstAtom();
-      const double* i_crd = REF + (atomi * 3);
       // Loop over residue atoms
-      for (; atomi != residues[resi].LastAtom(); atomi++, i_crd += 3) {
-        // Loop over initially selected atoms
-        for (Uarray::const_iterator idx = Idx.begin(); idx != Idx.end(); ++idx) {
-          double d2 = DIST2_NoImage(i_crd, REF + *idx);
-          if (d2 < dcut2) {
-            // State changes
-            schar = char1;
-            break;
-          }
-        } // END loop over initially selected atoms
-        if (schar == char1) break;
+      for (int atomi = residues[resi].FirstAtom(); atomi != residues[resi].LastAtom(); atomi++)
+      {
+        if (search.Near(atomi, nbrs)) {
+          // State changes
+          schar = char1;
+          break;
+        }
       } // END loop over residue atoms
       // Set residue selection status
-      for (atomi = residues[resi].FirstAtom();
+      for (int atomi = residues[resi].FirstAtom();
            atomi != residues[resi].LastAtom(); atomi++)
         mask[atomi] = schar;
     } // END loop over all residues
@@ -845,38 +923,28 @@ int MaskTokenArray::SelectDistance(const double* REF, char *mask,
 #   endif
   } else {
     // Select by molecule
-    if (molecules.empty()) {
-      mprinterr("Error: No molecule info. Cannot select molecules by distance.\n");
-      return 1;
-    }
     int n_of_mol = (int)molecules.size();
     int moli;
     // Loop over all molecules
 #   ifdef _OPENMP
-#   pragma omp parallel private(moli)
+#   pragma omp parallel private(moli, nbrs)
     {
 #   pragma omp for
 #   endif
     for (moli = 0; moli < n_of_mol; moli++) {
       // Initial state
       char schar = char0;
-      int atomi = molecules[moli].BeginAtom();
-      const double* i_crd = REF + (atomi * 3);
       // Loop over molecule atoms
-      for (; atomi != molecules[moli].EndAtom(); atomi++, i_crd += 3) {
-        // Loop over initially selected atoms
-        for (Uarray::const_iterator idx = Idx.begin(); idx != Idx.end(); ++idx) {
-          double d2 = DIST2_NoImage(i_crd, REF + *idx);
-          if (d2 < dcut2) {
-            // State changes
-            schar = char1;
-            break;
-          }
-        } // END loop over initially selected atoms
-        if (schar == char1) break;
+      for (int atomi = molecules[moli].BeginAtom(); atomi != molecules[moli].EndAtom(); atomi++)
+      {
+        if (search.Near(atomi, nbrs)) {
+          // State changes
+          schar = char1;
+          break;
+        }
       } // END loop over molecule atoms
       // Set molecule selection status
-      for (atomi = molecules[moli].BeginAtom();
+      for (int atomi = molecules[moli].BeginAtom();
            atomi != molecules[moli].EndAtom(); atomi++)
         mask[atomi] = schar;
     } // END loop over all molecules
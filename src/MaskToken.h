@@ -3,6 +3,7 @@
 #include "Atom.h"
 #include "Residue.h"
 #include "Molecule.h"
+#include "NeighborGrid.h"
 #include "SymbolExporting.h"
 
 /// Hold information used in mask selection. 
@@ -47,6 +48,32 @@ class MaskToken {
     bool d_within_;      ///< True if distance selection is within
 };
 // =============================================================================
+/// Hold selection state that can be reused when a mask is selected repeatedly.
+/** For distance-based masks this is, for each distance token, the reference
+  * atom last found within the cutoff of each atom (tried first on the next
+  * selection, e.g. the next frame) and the reference atom grid, kept to
+  * reuse its memory. Owned by the caller and passed to mask setup; masks
+  * themselves hold no selection state. A cache should only be used by one
+  * thread at a time.
+  */
+class MaskSelectionCache {
+  public:
+    typedef NeighborGrid::Iarray Iarray;
+    MaskSelectionCache() {}
+    /// \return Reference atom array for given distance token, resizing if needed.
+    Iarray& Witness(unsigned int idx) {
+      if (idx >= distWitness_.size()) distWitness_.resize( idx + 1 );
+      return distWitness_[idx];
+    }
+    /// \return Grid for reference atoms.
+    NeighborGrid& Grid() { return distGrid_; }
+    /// Clear saved selection state.
+    void Clear() { distWitness_.clear(); }
+  private:
+    std::vector<Iarray> distWitness_; ///< Reference atom last within cutoff of each atom (or -1).
+    NeighborGrid distGrid_;           ///< Grid of reference atoms.
+};
+// =============================================================================
 /// Hold an array of MaskTokens. Basis of all Mask classes.
 class MaskTokenArray {
   public:
@@ -90,12 +117,14 @@ class MaskTokenArray {
   protected:
     void ClearTokens() { maskTokens_.clear(); maskExpression_.clear(); }
     /// \return array of characters with selected atoms marked with SelectedChar_
-    char* ParseMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*) const;
+    char* ParseMask(AtomArrayT const&, ResArrayT const&, MolArrayT const&, const double*,
+                    MaskSelectionCache*) const;
     static CPPTRAJ_EXPORT char SelectedChar_;
     static CPPTRAJ_EXPORT char UnselectedChar_;
   private:
     typedef std::vector<MaskToken> MTarray;
     typedef MTarray::const_iterator token_iterator;
+    typedef NeighborGrid::Iarray Iarray;
 
     static bool IsOperator(char);
     static bool IsOperand(char);
@@ -105,7 +134,8 @@ class MaskTokenArray {
 
     // Mask selection routines.
     int SelectDistance(const double*, char *, MaskToken const&,
-                       AtomArrayT const&, ResArrayT const&, MolArrayT const&) const;
+                       AtomArrayT const&, ResArrayT const&, MolArrayT const&,
+                       NeighborGrid&, Iarray*) const;
     void Mask_AND(char*, char*, unsigned int) const;
     void Mask_OR(char*, char*, unsigned int) const;
     void Mask_NEG(char *, unsigned int) const;
@@ -152,6 +152,33 @@ double NC_Cmatrix::GetCmatrixElement(unsigned int idxIn) const {
   return (double)fval;
 }
 
+/** Get all distances for given row. Elements after the diagonal are
+  * contiguous in the file and read at once; elements before the diagonal
+  * are one per previous row and must be read individually.
+  */
+int NC_Cmatrix::GetCmatrixRow(unsigned int row, double* rowOut) const {
+  size_t index[1];
+  index[0] = (size_t)row - 1;
+  for (unsigned int col = 0; col < row; col++) {
+    if (NC::CheckErr( nc_get_var1_double(ncid_, cmatrix_VID_, index, rowOut + col) ))
+      return 1;
+    index[0] += nRows_ - col - 2;
+  }
+  rowOut[row] = 0.0;
+  return GetCmatrixUpperRow(row, rowOut);
+}
+
+/** Elements after the diagonal are contiguous in the file. */
+int NC_Cmatrix::GetCmatrixUpperRow(unsigned int row, double* rowOut) const {
+  if (row + 1 < nRows_) {
+    size_t start[1] = { (size_t)CalcIndex(row, row + 1) };
+    size_t count[1] = { nRows_ - row - 1 };
+    if (NC::CheckErr( nc_get_vara_double(ncid_, cmatrix_VID_, start, count, rowOut + row + 1) ))
+      return 1;
+  }
+  return 0;
+}
+
 // NC_Cmatrix::GetSieveStatus()
 std::vector<char> NC_Cmatrix::GetSieveStatus() const {
   if (nFrames_ < 1) return std::vector<char>();
@@ -342,6 +369,8 @@ NC_Cmatrix::~NC_Cmatrix() {}
 int NC_Cmatrix::OpenCmatrixRead(FileName const&, int&) { return 1; }
 double NC_Cmatrix::GetCmatrixElement(unsigned int, unsigned int) const { return 0.0; }
 double NC_Cmatrix::GetCmatrixElement(unsigned int) const { return 0.0; }
+int NC_Cmatrix::GetCmatrixRow(unsigned int, double*) const { return 1; }
+int NC_Cmatrix::GetCmatrixUpperRow(unsigned int, double*) const { return 1; }
 std::vector<char> NC_Cmatrix::GetSieveStatus() const { return std::vector<char>(); }
 int NC_Cmatrix::GetCmatrix(float*) const { return 1; }
 int NC_Cmatrix::CreateCmatrix(FileName const&, unsigned int, unsigned int, int, std::string const&)
@@ -15,6 +15,10 @@ class NC_Cmatrix {
     double GetCmatrixElement(unsigned int, unsigned int) const;
     /// Get cluster matrix element (raw index)
     double GetCmatrixElement(unsigned int) const;
+    /// Get all elements of given row (diagonal set to 0).
+    int GetCmatrixRow(unsigned int, double*) const;
+    /// Get elements of given row after the diagonal (one contiguous read).
+    int GetCmatrixUpperRow(unsigned int, double*) const;
     /// \return Array containing sieve status for each frame: 'T' sieved out, 'F' present
     std::vector<char> GetSieveStatus() const;
     /// Read cmatrix into given pointer
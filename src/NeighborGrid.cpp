@@ -0,0 +1,233 @@
+#include <cmath> // floor, ceil, pow
+#include <algorithm> // std::max, std::min
+#include "NeighborGrid.h"
+#include "Frame.h"
+
+NeighborGrid::NeighborGrid() :
+  frame_(0),
+  nx_(0),
+  ny_(0),
+  nz_(0),
+  periodic_(false)
+{
+  for (int i = 0; i != 3; i++) {
+    recipL_[i] = 0.0;
+    origin_[i] = 0.0;
+    width_[i] = 0.0;
+  }
+}
+
+// NeighborGrid::Update()
+void NeighborGrid::Update(Frame const& frmIn, double cutIn) {
+  if (frame_ != &frmIn) {
+    Box const& box = frmIn.BoxCrd();
+    bool periodic = (box.HasBox() && box.BoxX() > 0.0 && box.BoxY() > 0.0 && box.BoxZ() > 0.0);
+    Build(frmIn.xAddress(), 0, frmIn.Natom(), (periodic ? &box : 0), cutIn);
+    frame_ = &frmIn;
+  }
+}
+
+/** Used when coordinates do not come from a Frame, e.g. during mask
+  * selection. Only the given atoms are placed on the grid, so queries only
+  * return those atoms.
+  */
+void NeighborGrid::Setup(const double* XYZ, Iarray const& atomsIn, double cutIn) {
+  frame_ = 0;
+  if (atomsIn.empty())
+    Build(XYZ, 0, 0, 0, cutIn);
+  else
+    Build(XYZ, &atomsIn[0], (int)atomsIn.size(), 0, cutIn);
+}
+
+/** \return Cell index for given coordinate in non-periodic dimension dim,
+  *         clamped to the grid.
+  */
+int NeighborGrid::CellIdx(double xyz, int dim) const {
+  double c = floor((xyz - origin_[dim]) / width_[dim]);
+  if (c < 0.0) return 0;
+  int n = (dim == 0) ? nx_ : ((dim == 1) ? ny_ : nz_);
+  if (c >= (double)n) return n - 1;
+  return (int)c;
+}
+
+/** Determine grid dimensions and sort atoms into cells.
+  * \param xyzIn Coordinate array.
+  * \param sel If not null, indices of the natom atoms to grid; otherwise the first natom atoms.
+  * \param natom Number of atoms to grid.
+  * \param box If not null, grid is periodic in this box.
+  * \param cutIn Minimum cell width.
+  */
+void NeighborGrid::Build(const double* xyzIn, const int* sel, int natom, Box const* box,
+                         double cutIn)
+{
+  double cut = std::max(cutIn, 0.1);
+  periodic_ = (box != 0);
+  double extent[3];
+  if (periodic_) {
+    Matrix_3x3 ucell;
+    box->ToRecip(ucell, recip_);
+    Vec3 rl = Box::RecipLengths(recip_);
+    for (int i = 0; i != 3; i++) {
+      recipL_[i] = rl[i];
+      extent[i] = rl[i];
+    }
+  } else {
+    // Bounding box of all atoms
+    if (natom > 0) {
+      const double* XYZ = xyzIn + 3 * (sel ? sel[0] : 0);
+      for (int i = 0; i != 3; i++)
+        origin_[i] = extent[i] = XYZ[i];
+    } else {
+      for (int i = 0; i != 3; i++)
+        origin_[i] = extent[i] = 0.0;
+    }
+    for (int at = 1; at < natom; at++) {
+      const double* XYZ = xyzIn + 3 * (sel ? sel[at] : at);
+      for (int i = 0; i != 3; i++) {
+        origin_[i] = std::min(origin_[i], XYZ[i]);
+        extent[i]  = std::max(extent[i],  XYZ[i]);
+      }
+    }
+    for (int i = 0; i != 3; i++)
+      extent[i] -= origin_[i];
+  }
+  // Cells must be at least the cutoff wide. Do not use (many) more cells
+  // than atoms, which can happen for small systems or stray atoms.
+  int ndim[3];
+  for (int i = 0; i != 3; i++)
+    ndim[i] = std::max(1, (int)(extent[i] / cut));
+  double ncells = (double)ndim[0] * (double)ndim[1] * (double)ndim[2];
+  double maxcells = (double)std::max(natom, 1) * 2.0;
+  if (ncells > maxcells) {
+    double scale = pow(ncells / maxcells, 1.0 / 3.0);
+    for (int i = 0; i != 3; i++)
+      ndim[i] = std::max(1, (int)((double)ndim[i] / scale));
+  }
+  nx_ = ndim[0];
+  ny_ = ndim[1];
+  nz_ = ndim[2];
+  if (!periodic_) {
+    for (int i = 0; i != 3; i++) {
+      if (extent[i] > 0.0)
+        width_[i] = extent[i] / (double)ndim[i];
+      else
+        width_[i] = cut;
+    }
+  }
+  // Assign each atom to a cell
+  int ncell = Ncells();
+  cellStart_.assign( ncell + 1, 0 );
+  atomCell_.resize( natom );
+  for (int at = 0; at < natom; at++) {
+    const double* XYZ = xyzIn + 3 * (sel ? sel[at] : at);
+    int cx, cy, cz;
+    if (periodic_) {
+      Vec3 frac = recip_ * Vec3(XYZ);
+      cx = std::min(nx_ - 1, (int)((frac[0] - floor(frac[0])) * (double)nx_));
+      cy = std::min(ny_ - 1, (int)((frac[1] - floor(frac[1])) * (double)ny_));
+      cz = std::min(nz_ - 1, (int)((frac[2] - floor(frac[2])) * (double)nz_));
+    } else {
+      cx = CellIdx(XYZ[0], 0);
+      cy = CellIdx(XYZ[1], 1);
+      cz = CellIdx(XYZ[2], 2);
+    }
+    int cidx = (cz * ny_ + cy) * nx_ + cx;
+    atomCell_[at] = cidx;
+    ++cellStart_[cidx + 1];
+  }
+  // Counting sort of atoms by cell
+  for (int c = 0; c != ncell; c++)
+    cellStart_[c + 1] += cellStart_[c];
+  atoms_.resize( natom );
+  Iarray fill( cellStart_.begin(), cellStart_.end() - 1 );
+  for (int at = 0; at < natom; at++)
+    atoms_[ fill[atomCell_[at]]++ ] = (sel ? sel[at] : at);
+}
+
+/** Range of cells in one dimension that need to be searched. */
+static inline void CellRange(int c, int r, int n, bool wrap, int& lo, int& hi) {
+  if (wrap) {
+    if (2 * r + 1 >= n) {
+      // Search covers the whole dimension; visit every cell only once.
+      lo = 0;
+      hi = n - 1;
+    } else {
+      lo = c - r;
+      hi = c + r;
+    }
+  } else {
+    // If the search range is entirely off the grid, hi < lo and nothing is
+    // searched; any gridded atom is further away than the cutoff.
+    lo = std::max(0, c - r);
+    hi = std::min(n - 1, c + r);
+  }
+}
+
+/** Cell indices in dimension i can differ by at most ceil(cut * n / L),
+  * where L is the distance between parallel cell faces (periodic) or the
+  * grid extent (non-periodic). The small factor guards against round-off
+  * when the cutoff is an exact multiple of the cell width.
+  */
+int NeighborGrid::CellReach(double cut, int dim) const {
+  if (periodic_) {
+    int n = (dim == 0) ? nx_ : ((dim == 1) ? ny_ : nz_);
+    return (int)ceil( cut * (double)n / recipL_[dim] * (1.0 + 1.0E-8) );
+  }
+  return (int)ceil( cut / width_[dim] * (1.0 + 1.0E-8) );
+}
+
+/** Assumes atoms are evenly distributed over the grid. Can be used by
+  * callers to decide whether a grid search is worth it compared to
+  * looping over a small set of atoms directly.
+  */
+double NeighborGrid::AvgCandidates(double cut) const {
+  int ncell = Ncells();
+  if (ncell < 1) return 0.0;
+  int ndim[3] = { nx_, ny_, nz_ };
+  double nscan = 1.0;
+  for (int i = 0; i != 3; i++)
+    nscan *= (double)std::min(ndim[i], 2 * CellReach(cut, i) + 1);
+  return nscan * (double)atoms_.size() / (double)ncell;
+}
+
+/** The result is a superset of the atoms within the cutoff; the point itself
+  * (if it is an atom) is included.
+  */
+void NeighborGrid::GetCandidates(const double* XYZ, double cut, Iarray& nbrs) const {
+  nbrs.clear();
+  int c[3], r[3];
+  if (periodic_) {
+    Vec3 frac = recip_ * Vec3(XYZ);
+    int ndim[3] = { nx_, ny_, nz_ };
+    for (int i = 0; i != 3; i++) {
+      c[i] = std::min(ndim[i] - 1, (int)((frac[i] - floor(frac[i])) * (double)ndim[i]));
+      r[i] = CellReach(cut, i);
+    }
+  } else {
+    for (int i = 0; i != 3; i++) {
+      // Unclamped so that points outside the grid are handled.
+      c[i] = (int)std::max(-1.0E8, std::min(1.0E8, floor((XYZ[i] - origin_[i]) / width_[i])));
+      r[i] = CellReach(cut, i);
+    }
+  }
+  int xlo, xhi, ylo, yhi, zlo, zhi;
+  CellRange(c[0], r[0], nx_, periodic_, xlo, xhi);
+  CellRange(c[1], r[1], ny_, periodic_, ylo, yhi);
+  CellRange(c[2], r[2], nz_, periodic_, zlo, zhi);
+  for (int iz = zlo; iz <= zhi; iz++) {
+    int wz = iz;
+    if (wz < 0) wz += nz_; else if (wz >= nz_) wz -= nz_;
+    for (int iy = ylo; iy <= yhi; iy++) {
+      int wy = iy;
+      if (wy < 0) wy += ny_; else if (wy >= ny_) wy -= ny_;
+      int row = (wz * ny_ + wy) * nx_;
+      for (int ix = xlo; ix <= xhi; ix++) {
+        int wx = ix;
+        if (wx < 0) wx += nx_; else if (wx >= nx_) wx -= nx_;
+        int cidx = row + wx;
+        for (int a = cellStart_[cidx]; a != cellStart_[cidx + 1]; a++)
+          nbrs.push_back( atoms_[a] );
+      }
+    }
+  }
+}
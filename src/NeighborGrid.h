@@ -0,0 +1,59 @@
+#ifndef INC_NEIGHBORGRID_H
+#define INC_NEIGHBORGRID_H
+#include <vector>
+#include "Matrix_3x3.h"
+// Forward declares
+class Frame;
+class Box;
+/// Cell list spatial index of all atoms in a Frame, for finding neighbors within a cutoff.
+/** Atoms are binned into a regular grid of cells whose width is at least
+  * the cutoff the grid was built with. For periodic systems the grid is
+  * laid out in fractional coordinates of the unit cell and wraps around
+  * (so it works for any box shape), otherwise it covers the bounding box
+  * of all atoms. Neighbor queries return every atom that could be within
+  * the given cutoff of a point, including via periodic images; callers
+  * then calculate the actual (imaged or non-imaged) distance themselves.
+  * Queries may use a different cutoff than the one used to build the
+  * grid, and are thread-safe once the grid is built.
+  *
+  * A single grid is shared by all Actions for the current Frame via
+  * ActionFrame::Neighbors(); it is rebuilt only when the Frame changes.
+  */
+class NeighborGrid {
+  public:
+    typedef std::vector<int> Iarray;
+    NeighborGrid();
+    /// Mark grid as out of date; next Update() will rebuild it.
+    void Invalidate() { frame_ = 0; }
+    /// Build grid from given Frame and cutoff if grid is not current for that Frame.
+    void Update(Frame const&, double);
+    /// Build non-periodic grid from only the given atoms of a coordinate array.
+    void Setup(const double*, Iarray const&, double);
+    /// Set given array to indices of all atoms that may be within cutoff of given point.
+    void GetCandidates(const double*, double, Iarray&) const;
+    /// \return Estimated number of candidates returned by GetCandidates() for given cutoff.
+    double AvgCandidates(double) const;
+    /// \return Total number of grid cells.
+    int Ncells() const { return nx_ * ny_ * nz_; }
+  private:
+    /// Build grid from given/all atoms in coordinate array (and box) with given minimum cell width.
+    void Build(const double*, const int*, int, Box const*, double);
+    /// \return Index of cell in given dimension for coordinate; used for non-periodic grids.
+    inline int CellIdx(double, int) const;
+    /// \return Number of cells either side of a cell to search in given dimension for cutoff.
+    inline int CellReach(double, int) const;
+
+    const Frame* frame_;  ///< Frame grid was last built from; 0 if grid needs rebuild.
+    Matrix_3x3 recip_;    ///< Cart->Frac matrix if periodic.
+    double recipL_[3];    ///< Distances between unit cell faces if periodic.
+    double origin_[3];    ///< Bounding box minimum if not periodic.
+    double width_[3];     ///< Cell width in each dimension if not periodic.
+    int nx_;              ///< Number of cells in X (first unit cell vector) direction.
+    int ny_;              ///< Number of cells in Y (second unit cell vector) direction.
+    int nz_;              ///< Number of cells in Z (third unit cell vector) direction.
+    bool periodic_;       ///< True if grid wraps around the unit cell.
+    Iarray cellStart_;    ///< Index into atoms_ of first atom in each cell; size Ncells()+1.
+    Iarray atoms_;        ///< Atom indices, sorted by cell.
+    Iarray atomCell_;     ///< Cell of each gridded atom; used during build.
+};
+#endif
@@ -0,0 +1,61 @@
+#include "NonbondCutoff.h"
+#include "ArgList.h"
+#include "CpptrajStdio.h"
+
+NonbondCutoff::NonbondCutoff() :
+  type_(NONE),
+  cut_(0.0),
+  cut2_(0.0),
+  ron_(0.0),
+  ron2_(0.0),
+  swfac_(0.0),
+  rcinv_(0.0),
+  rc6inv_(0.0),
+  rc12inv_(0.0)
+{}
+
+// NonbondCutoff::GetArgs()
+int NonbondCutoff::GetArgs(ArgList& argIn) {
+  type_ = NONE;
+  if (!argIn.Contains("cut")) return 0;
+  cut_ = argIn.getKeyDouble("cut", 0.0);
+  if (cut_ <= 0.0) {
+    mprinterr("Error: Nonbond cutoff must be > 0.0\n");
+    return 1;
+  }
+  type_ = TRUNCATE;
+  if (argIn.hasKey("shift"))
+    type_ = SHIFT;
+  else if (argIn.Contains("switch")) {
+    type_ = SWITCH;
+    ron_ = argIn.getKeyDouble("switch", -1.0);
+    if (ron_ < 0.0 || ron_ >= cut_) {
+      mprinterr("Error: Switching distance must be >= 0.0 and < cutoff (%g)\n", cut_);
+      return 1;
+    }
+  }
+  cut2_ = cut_ * cut_;
+  ron2_ = ron_ * ron_;
+  if (type_ == SWITCH) {
+    double d = cut2_ - ron2_;
+    swfac_ = 1.0 / (d * d * d);
+  }
+  rcinv_ = 1.0 / cut_;
+  double rc2inv = rcinv_ * rcinv_;
+  rc6inv_ = rc2inv * rc2inv * rc2inv;
+  rc12inv_ = rc6inv_ * rc6inv_;
+  return 0;
+}
+
+// NonbondCutoff::PrintInfo()
+void NonbondCutoff::PrintInfo() const {
+  if (type_ == NONE) return;
+  mprintf("\tNonbond cutoff= %.4f Ang.", cut_);
+  if (type_ == TRUNCATE)
+    mprintf(" Energies are truncated at the cutoff.\n");
+  else if (type_ == SHIFT)
+    mprintf(" Energies are shifted to zero at the cutoff.\n");
+  else if (type_ == SWITCH)
+    mprintf(" Energies are switched to zero starting at %.4f Ang.\n", ron_);
+  mprintf("\tPairs are found with a cell list; coordinates are not imaged.\n");
+}
@@ -0,0 +1,70 @@
+#ifndef INC_NONBONDCUTOFF_H
+#define INC_NONBONDCUTOFF_H
+class ArgList;
+/// Modify pairwise LJ/Coulomb energies for a finite, non-periodic cutoff.
+/** Pairs beyond the cutoff contribute nothing. Inside the cutoff the
+  * energy may be used as-is (truncate), shifted so that it goes to zero
+  * at the cutoff (shift), or smoothly brought to zero between an inner
+  * distance and the cutoff with the CHARMM switching function (switch).
+  */
+class NonbondCutoff {
+  public:
+    enum Type { NONE = 0, TRUNCATE, SHIFT, SWITCH };
+    NonbondCutoff();
+    /// Keywords recognized by GetArgs()
+    static const char* Keywords() { return "[cut <rc> [shift | switch <ron>]]"; }
+    /// Set cutoff from arguments; no cutoff if 'cut' not present.
+    int GetArgs(ArgList&);
+    /// Print cutoff info to stdout.
+    void PrintInfo() const;
+    /// \return True if a cutoff is in use.
+    bool Active()    const { return type_ != NONE; }
+    /// \return Cutoff distance.
+    double Cut()     const { return cut_; }
+    /// \return Cutoff distance squared.
+    double Cut2()    const { return cut2_; }
+    /// \return LJ energy for given A, B, r^2; assumes r^2 < Cut2().
+    inline double Evdw(double, double, double) const;
+    /// \return Coulomb energy for given qiqj, r, r^2; assumes r^2 < Cut2().
+    inline double Eelec(double, double, double) const;
+  private:
+    /// \return CHARMM switching function value for given r^2.
+    inline double Switch(double) const;
+
+    Type type_;
+    double cut_;     ///< Cutoff distance.
+    double cut2_;    ///< Cutoff distance squared.
+    double ron_;     ///< Switching function inner distance.
+    double ron2_;    ///< Switching function inner distance squared.
+    double swfac_;   ///< 1 / (rc^2 - ron^2)^3
+    double rcinv_;   ///< 1 / rc
+    double rc6inv_;  ///< 1 / rc^6
+    double rc12inv_; ///< 1 / rc^12
+};
+// ----- INLINE FUNCTIONS ------------------------------------------------------
+double NonbondCutoff::Switch(double rij2) const {
+  if (rij2 <= ron2_) return 1.0;
+  double d = cut2_ - rij2;
+  return d * d * (cut2_ + 2.0*rij2 - 3.0*ron2_) * swfac_;
+}
+
+double NonbondCutoff::Evdw(double A, double B, double rij2) const {
+  double r2    = 1.0 / rij2;
+  double r6    = r2 * r2 * r2;
+  double e_vdw = A * r6 * r6 - B * r6; // (A/r^12)-(B/r^6)
+  if (type_ == SHIFT)
+    e_vdw -= (A * rc12inv_ - B * rc6inv_);
+  else if (type_ == SWITCH)
+    e_vdw *= Switch(rij2);
+  return e_vdw;
+}
+
+double NonbondCutoff::Eelec(double qiqj, double rij, double rij2) const {
+  double e_elec = qiqj / rij;
+  if (type_ == SHIFT)
+    e_elec -= qiqj * rcinv_;
+  else if (type_ == SWITCH)
+    e_elec *= Switch(rij2);
+  return e_elec;
+}
+#endif
@@ -17,9 +17,9 @@ class Stats {
 public:
   /// Default CONSTRUCTOR
   Stats() : n_(0.0), mean_(0.0), M2_(0.0) {}
-# ifdef MPI
   /// CONSTRUCTOR taking N, mean, and M2
   Stats(Float n, Float mean, Float m2) : n_(n), mean_(mean), M2_(m2) {}
+# ifdef MPI
   /// \return Internal M2 value
   Float M2()    const { return M2_; }; // Needed for MPI send 
 # endif
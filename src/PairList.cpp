@@ -105,50 +105,67 @@ void PairList::GridAtom(int atomIdx, Vec3 const& frac, Vec3 const& cart) {
     return;
   }
   cells_[idx].AddAtom( AtmType(atomIdx, cart) );
-  Frac_.push_back( frac );
 }
 
-/** Place selected atoms into grid cells. Convert to fractional coords, wrap
-  * into primary cell, then determine grid cell.
+/** Convert selected atoms to fractional coords and wrap into primary cell.
+  * Each atom is independent so this is done in parallel.
   */
-void PairList::GridUnitCell(Frame const& frmIn, Matrix_3x3 const& ucell,
-                             Matrix_3x3 const& recip, AtomMask const& maskIn)
+void PairList::WrapCoords(Frame const& frmIn, Matrix_3x3 const& ucell,
+                          Matrix_3x3 const& recip, AtomMask const& maskIn)
 {
-  // Clear any existing atoms in cells.
-  for (Carray::iterator cell = cells_.begin(); cell != cells_.end(); ++cell)
-    cell->ClearAtoms();
-  Frac_.clear();
-  Frac_.reserve( maskIn.Nselected() );
+  Frac_.resize( maskIn.Nselected() );
+  Cart_.resize( maskIn.Nselected() );
+  int idx;
   if (frmIn.BoxCrd().Type() == Box::ORTHO) {
     // Orthogonal imaging
-    for (AtomMask::const_iterator atom = maskIn.begin(); atom != maskIn.end(); ++atom)
+#   ifdef _OPENMP
+#   pragma omp parallel for
+#   endif
+    for (idx = 0; idx < maskIn.Nselected(); idx++)
     {
-      const double* XYZ = frmIn.XYZ(*atom);
+      const double* XYZ = frmIn.XYZ(maskIn[idx]);
       Vec3 fc( XYZ[0]*recip[0],    XYZ[1]*recip[4],    XYZ[2]*recip[8]   );
       Vec3 fcw(fc[0]-floor(fc[0]), fc[1]-floor(fc[1]), fc[2]-floor(fc[2]));
-      Vec3 ccw(fcw[0]*ucell[0],    fcw[1]*ucell[4],    fcw[2]*ucell[8]   );
-#     ifdef DEBUG_PAIRLIST
-      mprintf("DBG: o %6i fc=%7.3f%7.3f%7.3f  fcw=%7.3f%7.3f%7.3f  ccw=%7.3f%7.3f%7.3f\n",
-              *atom+1, fc[0], fc[1], fc[2], fcw[0], fcw[1], fcw[2], ccw[0], ccw[1], ccw[2]);
-#     endif
-      GridAtom( atom-maskIn.begin(), fcw, ccw );
+      Frac_[idx] = fcw;
+      Cart_[idx] = Vec3(fcw[0]*ucell[0], fcw[1]*ucell[4], fcw[2]*ucell[8]);
     }
   } else {
     // Non-orthogonal imaging
-    for (AtomMask::const_iterator atom = maskIn.begin(); atom != maskIn.end(); ++atom)
+#   ifdef _OPENMP
+#   pragma omp parallel for
+#   endif
+    for (idx = 0; idx < maskIn.Nselected(); idx++)
     {
-      Vec3 fc = recip * Vec3(frmIn.XYZ(*atom));
+      Vec3 fc = recip * Vec3(frmIn.XYZ(maskIn[idx]));
       Vec3 fcw(fc[0]-floor(fc[0]), fc[1]-floor(fc[1]), fc[2]-floor(fc[2]));
-      Vec3 ccw = ucell.TransposeMult( fcw );
-#     ifdef DEBUG_PAIRLIST
-      mprintf("DBG: n %6i fc=%7.3f%7.3f%7.3f  fcw=%7.3f%7.3f%7.3f  ccw=%7.3f%7.3f%7.3f\n",
-              *atom+1, fc[0], fc[1], fc[2], fcw[0], fcw[1], fcw[2], ccw[0], ccw[1], ccw[2]);
-#     endif
-      GridAtom( atom-maskIn.begin(), fcw, ccw );
+      Frac_[idx] = fcw;
+      Cart_[idx] = ucell.TransposeMult( fcw );
     }
   }
 }
 
+/** Place selected atoms into grid cells. Convert to fractional coords, wrap
+  * into primary cell, then determine grid cell. Atoms are added to cells
+  * in mask order.
+  */
+void PairList::GridUnitCell(Frame const& frmIn, Matrix_3x3 const& ucell,
+                             Matrix_3x3 const& recip, AtomMask const& maskIn)
+{
+  // Clear any existing atoms in cells.
+  for (Carray::iterator cell = cells_.begin(); cell != cells_.end(); ++cell)
+    cell->ClearAtoms();
+  WrapCoords(frmIn, ucell, recip, maskIn);
+  for (int idx = 0; idx != maskIn.Nselected(); idx++)
+  {
+#   ifdef DEBUG_PAIRLIST
+    mprintf("DBG: %6i fcw=%7.3f%7.3f%7.3f  ccw=%7.3f%7.3f%7.3f\n", maskIn[idx]+1,
+            Frac_[idx][0], Frac_[idx][1], Frac_[idx][2],
+            Cart_[idx][0], Cart_[idx][1], Cart_[idx][2]);
+#   endif
+    GridAtom( idx, Frac_[idx], Cart_[idx] );
+  }
+}
+
 // PairList::SetupGrids()
 /** Determine grid sizes. If this is the first time this routine is called
   * or the grid sizes have changed (re)allocate the grid and set up the
@@ -405,5 +422,6 @@ void PairList::PrintMemory() const {
   for (Carray::const_iterator cell = cells_.begin(); cell != cells_.end(); ++cell)
     total += cell->MemSize();
   total += ((Frac_.size() * sizeof(Vec3)) + sizeof(Varray));
+  total += ((Cart_.size() * sizeof(Vec3)) + sizeof(Varray));
   mprintf("\tTotal Grid memory: %s\n", ByteString(total, BYTE_DECIMAL).c_str());
 }
@@ -58,10 +58,13 @@ class PairList {
     void GridUnitCell(Frame const&, Matrix_3x3 const&, Matrix_3x3 const&, AtomMask const&);
     /// Calculate cell index based on given coords and add to cell
     inline void GridAtom(int, Vec3 const&, Vec3 const&);
+    /// Wrap selected atom coords into primary cell, fill Frac_ and Cart_
+    void WrapCoords(Frame const&, Matrix_3x3 const&, Matrix_3x3 const&, AtomMask const&);
 
     Carray cells_;            ///< Hold all cells in grid
     Vec3 translateVec_[18];   ///< Translate vector array
     Varray Frac_;             ///< Hold fractional coords back in primary cell.
+    Varray Cart_;             ///< Hold Cartesian coords back in primary cell.
     double cutList_;          ///< Direct space cutoff plus non-bond "skin"
     int debug_;
     int nGridX_;              ///< Number of grid cells in X direction.
@@ -17,6 +17,8 @@ class ReferenceAction {
     int SetRefMask(std::string const& m) { return refMask_.SetMaskString( m ); }
     /// \return String describing current reference mode.
     std::string RefModeString() const;
+    /// \return True if reference does not depend on the frames being processed.
+    bool FixedReference() const { return (refMode_ == FRAME && refCrd_ != 0 && !previous_); }
     /// Setup reference mask. Check that # selected reference atoms matches given # target atoms.
     int SetupRef(Topology const&, int);
     /// Peform necessary reference action based on mode
@@ -0,0 +1,148 @@
+#include <cmath> // sqrt, fabs
+#include "RmsdRoutines.h"
+
+// QCP_RMSD()
+/** Calculate minimum RMSD from covariance matrix R and E0 using the
+  * quaternion characteristic polynomial (QCP) method of Theobald (Acta
+  * Cryst. 2005, A61, 478-480; J. Comput. Chem. 2010, 31, 1561-1563). The
+  * largest eigenvalue of the 4x4 quaternion key matrix is found by
+  * Newton-Raphson on its characteristic polynomial, which is much cheaper
+  * than diagonalizing RtR when the rotation itself is not needed.
+  */
+double QCP_RMSD(const double* R, double E0, double total_mass)
+{
+  const double Sxx = R[0], Sxy = R[1], Sxz = R[2];
+  const double Syx = R[3], Syy = R[4], Syz = R[5];
+  const double Szx = R[6], Szy = R[7], Szz = R[8];
+
+  double Sxx2 = Sxx * Sxx;
+  double Syy2 = Syy * Syy;
+  double Szz2 = Szz * Szz;
+  double Sxy2 = Sxy * Sxy;
+  double Syz2 = Syz * Syz;
+  double Sxz2 = Sxz * Sxz;
+  double Syx2 = Syx * Syx;
+  double Szy2 = Szy * Szy;
+  double Szx2 = Szx * Szx;
+
+  double SyzSzymSyySzz2 = 2.0*(Syz*Szy - Syy*Szz);
+  double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+  // Coefficients of characteristic polynomial x^4 + C2 x^2 + C1 x + C0
+  double C2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+  double C1 =  8.0 * (Sxx*Syz*Szy + Syy*Szx*Sxz + Szz*Sxy*Syx -
+                      Sxx*Syy*Szz - Syz*Szx*Sxy - Szy*Syx*Sxz);
+
+  double SxzpSzx = Sxz + Szx;
+  double SyzpSzy = Syz + Szy;
+  double SxypSyx = Sxy + Syx;
+  double SyzmSzy = Syz - Szy;
+  double SxzmSzx = Sxz - Szx;
+  double SxymSyx = Sxy - Syx;
+  double SxxpSyy = Sxx + Syy;
+  double SxxmSyy = Sxx - Syy;
+  double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+  double C0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2
+    + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) * (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+    + (-(SxzpSzx)*(SyzmSzy)+(SxymSyx)*(SxxmSyy-Szz)) * (-(SxzmSzx)*(SyzpSzy)+(SxymSyx)*(SxxmSyy+Szz))
+    + (-(SxzpSzx)*(SyzpSzy)-(SxypSyx)*(SxxpSyy-Szz)) * (-(SxzmSzx)*(SyzmSzy)-(SxypSyx)*(SxxpSyy+Szz))
+    + (+(SxypSyx)*(SyzpSzy)+(SxzpSzx)*(SxxmSyy+Szz)) * (-(SxymSyx)*(SyzmSzy)+(SxzpSzx)*(SxxpSyy+Szz))
+    + (+(SxypSyx)*(SyzmSzy)+(SxzmSzx)*(SxxmSyy-Szz)) * (-(SxymSyx)*(SyzpSzy)+(SxzmSzx)*(SxxpSyy-Szz));
+
+  // Newton-Raphson for the largest eigenvalue, starting from upper bound E0.
+  double mxEigenV = E0;
+  for (int iter = 0; iter < 50; iter++) {
+    double oldg = mxEigenV;
+    double x2 = mxEigenV * mxEigenV;
+    double b = (x2 + C2) * mxEigenV;
+    double a = b + C1;
+    double denom = 2.0*x2*mxEigenV + b + a;
+    if (denom == 0.0) break;
+    mxEigenV -= (a*mxEigenV + C0) / denom;
+    if (fabs(mxEigenV - oldg) < fabs(1.0E-11 * mxEigenV)) break;
+  }
+  double rms_return = E0 - mxEigenV;
+  if (rms_return < 0.0) return 0.0;
+  return sqrt((2.0*rms_return)/total_mass);
+}
+
+// RMSD_PreCentered()
+/** Calculate best-fit RMSD between two coordinate arrays (X0 Y0 Z0 X1 ...)
+  * that have both already been centered at the origin. Neither array is
+  * modified, so the same coordinates can be used from multiple threads.
+  * \param tgt Target coordinates.
+  * \param ref Reference coordinates.
+  * \param mass Atom masses; if null no mass-weighting.
+  * \param ncoord Number of coordinates (# atoms * 3).
+  * \param total_mass Total mass (or # atoms if not mass-weighted).
+  */
+double RMSD_PreCentered(const double* tgt, const double* ref, const double* mass,
+                        int ncoord, double total_mass)
+{
+  double r0 = 0.0, r1 = 0.0, r2 = 0.0, r3 = 0.0, r4 = 0.0;
+  double r5 = 0.0, r6 = 0.0, r7 = 0.0, r8 = 0.0, ss = 0.0;
+  if (mass != 0) {
+    for (int i = 0; i < ncoord; i += 3, ++mass) {
+      double xt = tgt[i  ];
+      double yt = tgt[i+1];
+      double zt = tgt[i+2];
+      double xr = ref[i  ];
+      double yr = ref[i+1];
+      double zr = ref[i+2];
+      double w = *mass;
+      ss += w * ( (xt*xt)+(yt*yt)+(zt*zt)+(xr*xr)+(yr*yr)+(zr*zr) );
+      xt *= w;
+      yt *= w;
+      zt *= w;
+      r0 += xt*xr; r1 += xt*yr; r2 += xt*zr;
+      r3 += yt*xr; r4 += yt*yr; r5 += yt*zr;
+      r6 += zt*xr; r7 += zt*yr; r8 += zt*zr;
+    }
+  } else {
+    for (int i = 0; i < ncoord; i += 3) {
+      double xt = tgt[i  ];
+      double yt = tgt[i+1];
+      double zt = tgt[i+2];
+      double xr = ref[i  ];
+      double yr = ref[i+1];
+      double zr = ref[i+2];
+      ss += (xt*xt)+(yt*yt)+(zt*zt)+(xr*xr)+(yr*yr)+(zr*zr);
+      r0 += xt*xr; r1 += xt*yr; r2 += xt*zr;
+      r3 += yt*xr; r4 += yt*yr; r5 += yt*zr;
+      r6 += zt*xr; r7 += zt*yr; r8 += zt*zr;
+    }
+  }
+  double R[9] = { r0, r1, r2, r3, r4, r5, r6, r7, r8 };
+  return QCP_RMSD( R, 0.5 * ss, total_mass );
+}
+
+// RMSD_NoFit()
+/** Calculate RMSD between two coordinate arrays with no fitting.
+  * \param tgt Target coordinates.
+  * \param ref Reference coordinates.
+  * \param mass Atom masses; if null no mass-weighting.
+  * \param ncoord Number of coordinates (# atoms * 3).
+  * \param total_mass Total mass (or # atoms if not mass-weighted).
+  */
+double RMSD_NoFit(const double* tgt, const double* ref, const double* mass,
+                  int ncoord, double total_mass)
+{
+  double rms_return = 0.0;
+  if (mass != 0) {
+    for (int i = 0; i < ncoord; i += 3, ++mass) {
+      double xx = ref[i  ] - tgt[i  ];
+      double yy = ref[i+1] - tgt[i+1];
+      double zz = ref[i+2] - tgt[i+2];
+      rms_return += ((*mass) * (xx*xx + yy*yy + zz*zz));
+    }
+  } else {
+    for (int i = 0; i < ncoord; i += 3) {
+      double xx = ref[i  ] - tgt[i  ];
+      double yy = ref[i+1] - tgt[i+1];
+      double zz = ref[i+2] - tgt[i+2];
+      rms_return += (xx*xx + yy*yy + zz*zz);
+    }
+  }
+  if (rms_return < 0.0) return 0.0;
+  return sqrt(rms_return / total_mass);
+}
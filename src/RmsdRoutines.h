@@ -0,0 +1,12 @@
+#ifndef INC_RMSDROUTINES_H
+#define INC_RMSDROUTINES_H
+/*! \file RmsdRoutines.h
+    \brief A collection of routines used to calculate RMSD of coordinate arrays.
+ */
+/// \return Best-fit RMSD from 3x3 covariance matrix and E0 using QCP method.
+double QCP_RMSD(const double*, double, double);
+/// \return Best-fit RMSD between coordinate arrays already centered at origin.
+double RMSD_PreCentered(const double*, const double*, const double*, int, double);
+/// \return RMSD between coordinate arrays with no fitting.
+double RMSD_NoFit(const double*, const double*, const double*, int, double);
+#endif
@@ -0,0 +1,222 @@
+#ifndef INC_SPARSEGRID_H
+#define INC_SPARSEGRID_H
+#include <vector>
+#include <algorithm>
+/// Three-dimensional grid template with storage allocated in bricks on first write.
+/** The grid is divided into bricks of 8x8x8 voxels. A brick is only
+  * allocated when one of its voxels is written to; reading a voxel in an
+  * unallocated brick returns zero. Voxels in the padding of bricks at the
+  * upper grid edges are never written and are always zero.
+  * Linear indices (CalcIndex/ReverseIndex) are the same as for Grid<T>.
+  * Writes to different bricks may be done from different threads, but
+  * only one thread may write to any given brick at a time.
+  */
+template <class T> class SparseGrid {
+  public:
+    /// Brick dimensions.
+    enum BrickDim { BSHIFT = 3, BSIZE = 8, BMASK = 7, BVOXELS = 512 };
+    SparseGrid() : nx_(0), ny_(0), nz_(0), nelements_(0), bx_(0), by_(0), bz_(0) {}
+    ~SparseGrid() { clear(); }
+    SparseGrid( const SparseGrid& );
+    SparseGrid& operator=( const SparseGrid& );
+    /// \return Value at given linear index; zero if brick not allocated.
+    T operator[](size_t idx) const {
+      size_t x, y, z;
+      ReverseIndex( (long int)idx, x, y, z );
+      return element(x, y, z);
+    }
+    /// \return total number of grid points.
+    size_t size()                   const { return nelements_;  }
+    /// Set up grid for given X, Y, and Z dimensions. All bricks are deallocated.
+    int resize(size_t,size_t,size_t);
+    /// \return Size of X dimension.
+    size_t NX() const { return nx_; }
+    /// \return Size of Y dimension.
+    size_t NY() const { return ny_; }
+    /// \return Size of Z dimension.
+    size_t NZ() const { return nz_; }
+    /// Increment grid point by given value; allocates brick if needed.
+    long int incrementBy(size_t x, size_t y, size_t z, const T& eltIn) {
+      voxel(x, y, z) += eltIn;
+      return CalcIndex(x, y, z);
+    }
+    /// Set grid point to value; no brick is allocated to store zero.
+    void setGrid(size_t, size_t, size_t, const T&);
+    /// \return element at a specified grid point; zero if brick not allocated.
+    T element(size_t x, size_t y, size_t z) const {
+      const T* brick = bricks_[ brickIndex(x, y, z) ];
+      if (brick == 0) return T();
+      return brick[ voxelOffset(x, y, z) ];
+    }
+    /// \return Pointer to element at a specified grid point; 0 if brick not allocated.
+    const T* find(size_t x, size_t y, size_t z) const {
+      const T* brick = bricks_[ brickIndex(x, y, z) ];
+      if (brick == 0) return 0;
+      return brick + voxelOffset(x, y, z);
+    }
+    /// \return Reference to element at a specified grid point; allocates brick if needed.
+    T& voxel(size_t x, size_t y, size_t z) {
+      size_t b = brickIndex(x, y, z);
+      if (bricks_[b] == 0) AllocateBrick(b);
+      return bricks_[b][ voxelOffset(x, y, z) ];
+    }
+    /// Convert X, Y, and Z bin #s to index.
+    long int CalcIndex(size_t x, size_t y, size_t z) const {
+      return (long int)(x*(ny_*nz_))+(y*nz_)+z;
+    }
+    /// Convert linear index to X, Y, and Z bin indices.
+    void ReverseIndex(long int idx, size_t& x, size_t& y, size_t& z) const {
+      x = (size_t)idx / (ny_*nz_);
+      y = ((size_t)idx / nz_) % ny_;
+      z = (size_t)idx % nz_;
+    }
+    /// \return Position of given grid point in brick storage: brick index * BVOXELS + offset in brick.
+    size_t StorageIndex(size_t x, size_t y, size_t z) const {
+      return (brickIndex(x, y, z) << (3*BSHIFT)) | voxelOffset(x, y, z);
+    }
+    /// \return Total number of bricks.
+    size_t Nbricks() const { return bricks_.size(); }
+    /// \return Number of allocated bricks.
+    size_t NbricksAllocated() const;
+    /// \return Pointer to brick, 0 if not allocated.
+    T* Brick(size_t b)             { return bricks_[b]; }
+    const T* Brick(size_t b) const { return bricks_[b]; }
+    /// Allocate brick if not already allocated.
+    void AllocateBrick(size_t);
+    /// \return First voxel X, Y, and Z bin #s of given brick.
+    void BrickOrigin(size_t b, size_t& x, size_t& y, size_t& z) const {
+      x = (b / (by_*bz_)) << BSHIFT;
+      y = ((b / bz_) % by_) << BSHIFT;
+      z = (b % bz_) << BSHIFT;
+    }
+    /// \return Offset of voxel within brick given its X, Y, and Z offsets in the brick.
+    static size_t VoxelOffset(size_t i, size_t j, size_t k) {
+      return (i << (2*BSHIFT)) | (j << BSHIFT) | k;
+    }
+    /// Iterator over voxels of allocated bricks, including brick padding.
+    class iterator;
+    inline iterator begin();
+    inline iterator end();
+    /// \return memory usage in bytes
+    size_t DataSize() const {
+      return ( (7*sizeof(size_t)) + (bricks_.size() * sizeof(T*)) +
+               (NbricksAllocated() * BVOXELS * sizeof(T)) );
+    }
+  private:
+    typedef std::vector<T*> Barray;
+    /// \return Index of brick containing given grid point.
+    size_t brickIndex(size_t x, size_t y, size_t z) const {
+      return (((x >> BSHIFT) * by_) + (y >> BSHIFT)) * bz_ + (z >> BSHIFT);
+    }
+    /// \return Offset of given grid point within its brick.
+    static size_t voxelOffset(size_t x, size_t y, size_t z) {
+      return VoxelOffset(x & BMASK, y & BMASK, z & BMASK);
+    }
+    /// Deallocate all bricks.
+    void clear();
+
+    size_t nx_;        ///< Grid X dimension.
+    size_t ny_;        ///< Grid Y dimension.
+    size_t nz_;        ///< Grid Z dimension.
+    size_t nelements_; ///< Total number of grid points.
+    size_t bx_;        ///< Number of bricks in X dimension.
+    size_t by_;        ///< Number of bricks in Y dimension.
+    size_t bz_;        ///< Number of bricks in Z dimension.
+    Barray bricks_;    ///< Pointer to each brick, 0 if not allocated.
+};
+// ----- ITERATOR --------------------------------------------------------------
+template <class T> class SparseGrid<T>::iterator {
+  public:
+    iterator() : bricks_(0), bidx_(0), vidx_(0) {}
+    iterator(Barray* b, size_t bidx) : bricks_(b), bidx_(bidx), vidx_(0) { skip(); }
+    T& operator*() const { return (*bricks_)[bidx_][vidx_]; }
+    iterator& operator++() {
+      if (++vidx_ == (size_t)BVOXELS) {
+        vidx_ = 0;
+        ++bidx_;
+        skip();
+      }
+      return *this;
+    }
+    bool operator==(iterator const& rhs) const { return (bidx_==rhs.bidx_ && vidx_==rhs.vidx_); }
+    bool operator!=(iterator const& rhs) const { return (bidx_!=rhs.bidx_ || vidx_!=rhs.vidx_); }
+  private:
+    /// Advance to next allocated brick
+    void skip() { while (bidx_ < bricks_->size() && (*bricks_)[bidx_] == 0) ++bidx_; }
+
+    Barray* bricks_;
+    size_t bidx_; ///< Current brick
+    size_t vidx_; ///< Current voxel in brick
+};
+template <class T> typename SparseGrid<T>::iterator SparseGrid<T>::begin() {
+  return iterator(&bricks_, 0);
+}
+template <class T> typename SparseGrid<T>::iterator SparseGrid<T>::end() {
+  return iterator(&bricks_, bricks_.size());
+}
+// -----------------------------------------------------------------------------
+// COPY CONSTRUCTOR
+template <class T> SparseGrid<T>::SparseGrid(const SparseGrid& rhs) :
+  nx_(0), ny_(0), nz_(0), nelements_(0), bx_(0), by_(0), bz_(0)
+{
+  *this = rhs;
+}
+// ASSIGNMENT
+template <class T> SparseGrid<T>& SparseGrid<T>::operator=(const SparseGrid& rhs) {
+  if (this == &rhs) return *this;
+  clear();
+  nx_ = rhs.nx_;
+  ny_ = rhs.ny_;
+  nz_ = rhs.nz_;
+  nelements_ = rhs.nelements_;
+  bx_ = rhs.bx_;
+  by_ = rhs.by_;
+  bz_ = rhs.bz_;
+  bricks_.assign( rhs.bricks_.size(), (T*)0 );
+  for (size_t b = 0; b != bricks_.size(); b++) {
+    if (rhs.bricks_[b] != 0) {
+      bricks_[b] = new T[ BVOXELS ];
+      std::copy( rhs.bricks_[b], rhs.bricks_[b] + BVOXELS, bricks_[b] );
+    }
+  }
+  return *this;
+}
+// SparseGrid::clear()
+template <class T> void SparseGrid<T>::clear() {
+  for (typename Barray::iterator b = bricks_.begin(); b != bricks_.end(); ++b)
+    if (*b != 0) delete[] *b;
+  bricks_.clear();
+}
+// SparseGrid::resize()
+template <class T> int SparseGrid<T>::resize(size_t x, size_t y, size_t z) {
+  clear();
+  nx_ = x;
+  ny_ = y;
+  nz_ = z;
+  nelements_ = nx_ * ny_ * nz_;
+  bx_ = (nx_ + BMASK) >> BSHIFT;
+  by_ = (ny_ + BMASK) >> BSHIFT;
+  bz_ = (nz_ + BMASK) >> BSHIFT;
+  bricks_.assign( bx_ * by_ * bz_, (T*)0 );
+  return 0;
+}
+// SparseGrid::setGrid()
+template <class T> void SparseGrid<T>::setGrid(size_t x, size_t y, size_t z, const T& eltIn) {
+  if (bricks_[ brickIndex(x, y, z) ] == 0 && eltIn == T()) return;
+  voxel(x, y, z) = eltIn;
+}
+// SparseGrid::NbricksAllocated()
+template <class T> size_t SparseGrid<T>::NbricksAllocated() const {
+  size_t nalloc = 0;
+  for (typename Barray::const_iterator b = bricks_.begin(); b != bricks_.end(); ++b)
+    if (*b != 0) ++nalloc;
+  return nalloc;
+}
+// SparseGrid::AllocateBrick()
+template <class T> void SparseGrid<T>::AllocateBrick(size_t b) {
+  if (bricks_[b] == 0) {
+    bricks_[b] = new T[ BVOXELS ];
+    std::fill( bricks_[b], bricks_[b] + BVOXELS, T() );
+  }
+}
+#endif
@@ -15,6 +15,8 @@ class Timer {
     void Stop();
     double Elapsed();
     double Total() const { return total_; }
+    /// Add total time from given Timer to this one.
+    void AddTotal(Timer const& rhs) { total_ += rhs.total_; }
     void WriteTiming(int, const char*, double) const;
     void WriteTiming(int i, const char* h) const {
       return WriteTiming(i, h, 0.0);
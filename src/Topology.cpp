@@ -1087,6 +1087,22 @@ int Topology::SetupCharMask(CharMask &mask, Frame const& frame) const {
   return mask.SetupMask(atoms_, residues_, molecules_, frame.xAddress());
 }
 
+// Topology::SetupIntegerMask()
+int Topology::SetupIntegerMask(AtomMask &mask, Frame const& frame,
+                               MaskSelectionCache& cache) const
+{
+  if (frame.empty()) return mask.SetupMask(atoms_, residues_, molecules_, 0, cache);
+  return mask.SetupMask(atoms_, residues_, molecules_, frame.xAddress(), cache);
+}
+
+// Topology::SetupCharMask()
+int Topology::SetupCharMask(CharMask &mask, Frame const& frame,
+                            MaskSelectionCache& cache) const
+{
+  if (frame.empty()) return mask.SetupMask(atoms_, residues_, molecules_, 0, cache);
+  return mask.SetupMask(atoms_, residues_, molecules_, frame.xAddress(), cache);
+}
+
 //  Topology::ResnumsSelectedBy()
 std::vector<int> Topology::ResnumsSelectedBy(AtomMask const& mask) const {
   std::vector<int> resnums;
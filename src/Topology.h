@@ -153,6 +153,8 @@ class Topology {
     int SetupCharMask(CharMask &) const;
     int SetupIntegerMask(AtomMask &, Frame const&) const;
     int SetupCharMask(CharMask &, Frame const&) const;
+    int SetupIntegerMask(AtomMask &, Frame const&, MaskSelectionCache&) const;
+    int SetupCharMask(CharMask &, Frame const&, MaskSelectionCache&) const;
     /// \return Array of residue numbers selected by given atom mask
     std::vector<int> ResnumsSelectedBy(AtomMask const&) const;
     /// \return Array of molecule numbers selected by given atom mask
@@ -187,6 +187,8 @@ int Traj_AmberNetcdf::setupTrajout(FileName const& fname, Topology* trajParm,
 // Traj_AmberNetcdf::readFrame()
 /** Get the specified frame from amber netcdf file
   * Coords are a 1 dimensional array of format X1,Y1,Z1,X2,Y2,Z2,...
+  * Optional components (temperature, time, velocities, forces, replica
+  * indices/values) that are not needed are not read.
   */
 int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   start_[0] = set;
@@ -197,7 +199,7 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   count_[2] = 3;
 
   // Get temperature
-  if (TempVID_!=-1) {
+  if (TempVID_!=-1 && Needs(CoordinateInfo::TEMPERATURE)) {
     if ( NC::CheckErr(nc_get_vara_double(ncid_, TempVID_, start_, count_, frameIn.tAddress())) ) {
       mprinterr("Error: Getting replica temperature for frame %i.\n", set+1); 
       return 1;
@@ -206,7 +208,7 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   }
 
   // Get time
-  if (timeVID_!=-1) {
+  if (timeVID_!=-1 && Needs(CoordinateInfo::TIME)) {
     float time;
     if (NC::CheckErr(nc_get_vara_float(ncid_, timeVID_, start_, count_, &time))) {
       mprinterr("Error: Getting time for frame %i.\n", set + 1);
@@ -223,7 +225,7 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   FloatToDouble(frameIn.xAddress(), Coord_);
 
   // Read Velocities
-  if (velocityVID_ != -1) {
+  if (velocityVID_ != -1 && Needs(CoordinateInfo::VELOCITY)) {
     if ( NC::CheckErr(nc_get_vara_float(ncid_, velocityVID_, start_, count_, Coord_)) ) {
       mprinterr("Error: Getting velocities for frame %i\n", set+1);
       return 1;
@@ -232,7 +234,7 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   }
 
   // Read Forces
-  if (frcVID_ != -1) {
+  if (frcVID_ != -1 && Needs(CoordinateInfo::FORCE)) {
     if ( NC::CheckErr(nc_get_vara_float(ncid_, frcVID_, start_, count_, Coord_)) ) {
       mprinterr("Error: Getting forces for frame %i\n", set+1);
       return 1;
@@ -241,7 +243,7 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   }
 
   // Read indices. Input array must be allocated to be size remd_dimension.
-  if (indicesVID_!=-1) {
+  if (indicesVID_!=-1 && Needs(CoordinateInfo::REPLICA)) {
     count_[1] = remd_dimension_;
     if ( NC::CheckErr(nc_get_vara_int(ncid_, indicesVID_, start_, count_, frameIn.iAddress())) ) {
       mprinterr("Error: Getting replica indices for frame %i.\n", set+1);
@@ -252,8 +254,9 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
     //mprintf("\n");
   }
 
-  // Read REMD values.
-  ReadRemdValues(frameIn);
+  // Read REMD values. These may include temperature.
+  if (Needs(CoordinateInfo::REPLICA) || Needs(CoordinateInfo::TEMPERATURE))
+    ReadRemdValues(frameIn);
 
   // Read box info 
   if (cellLengthVID_ != -1) {
@@ -274,6 +277,132 @@ int Traj_AmberNetcdf::readFrame(int set, Frame& frameIn) {
   return 0;
 }
 
+// Traj_AmberNetcdf::readBlockFloat()
+int Traj_AmberNetcdf::readBlockFloat(int vid, size_t* bstart, size_t* bcount,
+                                     ptrdiff_t* bstride, const char* desc)
+{
+  if ( NC::CheckErr(nc_get_vars_float(ncid_, vid, bstart, bcount, bstride, &blockCrd_[0])) ) {
+    mprinterr("Error: Getting %s for frames %zu-%zu\n", desc, bstart[0]+1,
+              bstart[0] + (bcount[0]-1)*bstride[0] + 1);
+    return 1;
+  }
+  return 0;
+}
+
+// Traj_AmberNetcdf::readFrames()
+/** Get a block of frames from amber netcdf file. Coordinates, velocities,
+  * forces, time, temperature, and box are each read for all frames with a
+  * single strided hyperslab request. As in readFrame(), optional components
+  * that are not needed are not read.
+  */
+int Traj_AmberNetcdf::readFrames(int set, int nframes, int stride, FrameArray& frames) {
+  if (nframes < 1) return 0;
+  size_t bstart[3];
+  size_t bcount[3];
+  ptrdiff_t bstride[3];
+  bstart[0] = set;
+  bstart[1] = 0;
+  bstart[2] = 0;
+  bcount[0] = nframes;
+  bcount[1] = Ncatom();
+  bcount[2] = 3;
+  bstride[0] = stride;
+  bstride[1] = 1;
+  bstride[2] = 1;
+  size_t ncrd = (size_t)Ncatom3();
+  blockCrd_.resize( (size_t)nframes * ncrd );
+
+  // Get temperature
+  if (TempVID_!=-1 && Needs(CoordinateInfo::TEMPERATURE)) {
+    blockDbl_.resize( nframes );
+    if ( NC::CheckErr(nc_get_vars_double(ncid_, TempVID_, bstart, bcount, bstride,
+                                         &blockDbl_[0])) )
+    {
+      mprinterr("Error: Getting replica temperatures for frames starting at %i.\n", set+1);
+      return 1;
+    }
+    for (int n = 0; n != nframes; n++)
+      frames[n].SetTemperature( blockDbl_[n] );
+  }
+
+  // Get time
+  if (timeVID_!=-1 && Needs(CoordinateInfo::TIME)) {
+    if (readBlockFloat(timeVID_, bstart, bcount, bstride, "time")) return 1;
+    for (int n = 0; n != nframes; n++)
+      frames[n].SetTime( (double)blockCrd_[n] );
+  }
+
+  // Read Coords
+  if (readBlockFloat(coordVID_, bstart, bcount, bstride, "coordinates")) return 1;
+  for (int n = 0; n != nframes; n++)
+    FloatToDouble(frames[n].xAddress(), &blockCrd_[0] + n * ncrd);
+
+  // Read Velocities
+  if (velocityVID_ != -1 && Needs(CoordinateInfo::VELOCITY)) {
+    if (readBlockFloat(velocityVID_, bstart, bcount, bstride, "velocities")) return 1;
+    for (int n = 0; n != nframes; n++)
+      FloatToDouble(frames[n].vAddress(), &blockCrd_[0] + n * ncrd);
+  }
+
+  // Read Forces
+  if (frcVID_ != -1 && Needs(CoordinateInfo::FORCE)) {
+    if (readBlockFloat(frcVID_, bstart, bcount, bstride, "forces")) return 1;
+    for (int n = 0; n != nframes; n++)
+      FloatToDouble(frames[n].fAddress(), &blockCrd_[0] + n * ncrd);
+  }
+
+  // Read replica indices and REMD values one frame at a time.
+  // REMD values may include temperature.
+  bool readRemd = (Needs(CoordinateInfo::REPLICA) || Needs(CoordinateInfo::TEMPERATURE));
+  for (int n = 0; n != nframes && readRemd; n++) {
+    start_[0] = set + n * stride;
+    start_[1] = 0;
+    start_[2] = 0;
+    count_[0] = 1;
+    count_[1] = remd_dimension_;
+    count_[2] = 3;
+    if (indicesVID_!=-1 && Needs(CoordinateInfo::REPLICA)) {
+      if ( NC::CheckErr(nc_get_vara_int(ncid_, indicesVID_, start_, count_, frames[n].iAddress())) ) {
+        mprinterr("Error: Getting replica indices for frame %zu.\n", start_[0]+1);
+        return 1;
+      }
+    }
+    if (ReadRemdValues(frames[n])) return 1;
+  }
+
+  // Read box info 
+  if (cellLengthVID_ != -1) {
+    bcount[1] = 3;
+    blockDbl_.resize( (size_t)nframes * 3 );
+    if (NC::CheckErr(nc_get_vars_double(ncid_, cellLengthVID_, bstart, bcount, bstride,
+                                        &blockDbl_[0])))
+    {
+      mprinterr("Error: Getting cell lengths for frames starting at %i.\n", set+1);
+      return 1;
+    }
+    for (int n = 0; n != nframes; n++) {
+      double* box = frames[n].bAddress();
+      box[0] = blockDbl_[3*n  ];
+      box[1] = blockDbl_[3*n+1];
+      box[2] = blockDbl_[3*n+2];
+    }
+    if (NC::CheckErr(nc_get_vars_double(ncid_, cellAngleVID_, bstart, bcount, bstride,
+                                        &blockDbl_[0])))
+    {
+      mprinterr("Error: Getting cell angles for frames starting at %i.\n", set+1);
+      return 1;
+    }
+    for (int n = 0; n != nframes; n++) {
+      double* box = frames[n].bAddress();
+      box[3] = blockDbl_[3*n  ];
+      box[4] = blockDbl_[3*n+1];
+      box[5] = blockDbl_[3*n+2];
+    }
+  }
+
+  return 0;
+}
+
 // Traj_AmberNetcdf::readVelocity()
 int Traj_AmberNetcdf::readVelocity(int set, Frame& frameIn) {
   start_[0] = set;
@@ -283,7 +412,7 @@ int Traj_AmberNetcdf::readVelocity(int set, Frame& frameIn) {
   count_[1] = Ncatom();
   count_[2] = 3;
   // Read Velocities
-  if (velocityVID_ != -1) {
+  if (velocityVID_ != -1 && Needs(CoordinateInfo::VELOCITY)) {
     if ( NC::CheckErr(nc_get_vara_float(ncid_, velocityVID_, start_, count_, Coord_)) ) {
       mprinterr("Error: Getting velocities for frame %i\n", set+1);
       return 1;
@@ -302,7 +431,7 @@ int Traj_AmberNetcdf::readForce(int set, Frame& frameIn) {
   count_[1] = Ncatom();
   count_[2] = 3;
   // Read forces
-  if (frcVID_ != -1) {
+  if (frcVID_ != -1 && Needs(CoordinateInfo::FORCE)) {
     if ( NC::CheckErr(nc_get_vara_float(ncid_, frcVID_, start_, count_, Coord_)) ) {
       mprinterr("Error: Getting forces for frame %i\n", set+1);
       return 1;
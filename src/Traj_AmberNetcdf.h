@@ -2,6 +2,7 @@
 #define INC_TRAJ_AMBERNETCDF_H
 #ifdef BINTRAJ
 #include "TrajectoryIO.h"
+#include <cstddef> // ptrdiff_t
 #include "NetcdfFile.h"
 /// Reads and writes Amber Netcdf format trajectories. 
 class Traj_AmberNetcdf : public TrajectoryIO, private NetcdfFile {
@@ -18,6 +19,8 @@ class Traj_AmberNetcdf : public TrajectoryIO, private NetcdfFile {
     int openTrajin();
     void closeTraj();
     int readFrame(int,Frame&);
+    int readFrames(int,int,int,FrameArray&);
+    bool HasBlockRead() const { return true; }
     int readVelocity(int, Frame&);
     int readForce(int, Frame&);
     int writeFrame(int,Frame const&);
@@ -35,7 +38,12 @@ class Traj_AmberNetcdf : public TrajectoryIO, private NetcdfFile {
     void parallelCloseTraj();
 #   endif
   private:
+    /// Read float variable for a block of frames into blockCrd_.
+    int readBlockFloat(int, size_t*, size_t*, ptrdiff_t*, const char*);
+
     float *Coord_;        ///< Temporary array for converting double <-> single precision
+    std::vector<float> blockCrd_;  ///< Hold float data for a block of frames
+    std::vector<double> blockDbl_; ///< Hold double data for a block of frames
     FileName filename_;   ///< File name
     bool useVelAsCoords_; ///< If true read velocities in place of coordinates
     bool useFrcAsCoords_; ///< If true read forces in place of coordinates
@@ -1,7 +1,9 @@
 #include <cstdio> // sscanf
+#include <cstring> // strlen
 #include "Traj_CharmmCor.h"
 #include "StringRoutines.h"
 #include "CpptrajStdio.h"
+#include "FixedWidthRoutines.h"
 
 bool Traj_CharmmCor::ID_TrajFormat(CpptrajFile& fileIn) {
   // File must already be set up for read.
@@ -78,6 +80,16 @@ int Traj_CharmmCor::readFrame(int set, Frame& frameIn) {
   // Extended:
   // I10,    I10, 1X, A9, 1X,  A9,     3(F20.10), 1X, A9, 1X, A9,    F20.10
   // Should be positioned at first atom line.
+  // Coordinates are first read directly from their columns; if that fails
+  // (e.g. columns are not aligned) fall back to sscanf.
+  size_t xcol, xwidth;
+  if (extendedFmt_) {
+    xcol = 40;
+    xwidth = 20;
+  } else {
+    xcol = 20;
+    xwidth = 10;
+  }
   double* xptr = frameIn.xAddress();
   for (int at = 0; at != corAtom_; at++, xptr += 3) {
     const char* buffer = file_.NextLine();
@@ -86,7 +98,12 @@ int Traj_CharmmCor::readFrame(int set, Frame& frameIn) {
       return 1;
     }
     int ncrd;
-    if (extendedFmt_)
+    if (strlen(buffer) >= xcol + 3 * xwidth &&
+        FixedWidthToDouble(buffer + xcol,            xwidth, xptr[0]) &&
+        FixedWidthToDouble(buffer + xcol +   xwidth, xwidth, xptr[1]) &&
+        FixedWidthToDouble(buffer + xcol + 2*xwidth, xwidth, xptr[2]))
+      ncrd = 3;
+    else if (extendedFmt_)
       ncrd = sscanf(buffer, "%*10i%*10i%*10s%*10s%20lf%20lf%20lf", xptr, xptr+1, xptr+2);
     else
       ncrd = sscanf(buffer, "%*5i%*5i%*5s%*5s%10lf%10lf%10lf", xptr, xptr+1, xptr+2);
@@ -1,6 +1,6 @@
 // Traj_CharmmDcd
 #include <cmath>   // for cos, acos
-#include <cstring> // memset
+#include <cstring> // memset, memcpy
 #include "Traj_CharmmDcd.h"
 #include "Constants.h"
 #include "CpptrajStdio.h"
@@ -504,8 +504,16 @@ int Traj_CharmmDcd::ReadBox(double* box) {
   double boxtmp[6];
   if ( ReadBlock(48) < 0) return 1;
   file_.Read(boxtmp, sizeof(double)*6);
-  if (isBigEndian_) endian_swap8(boxtmp,6);
   if ( ReadBlock(-1) < 0) return 1;
+  BoxFromBuffer(box, boxtmp);
+  return 0;
+}
+
+/** Convert raw box record from DCD into unit cell lengths and angles.
+  * Raw record is byte-swapped in place if necessary.
+  */
+void Traj_CharmmDcd::BoxFromBuffer(double* box, double* boxtmp) const {
+  if (isBigEndian_) endian_swap8(boxtmp,6);
   if (charmmCellType_ == SHAPE) {
     Box::ShapeToUcell(box, boxtmp);
 /*
@@ -546,7 +554,6 @@ int Traj_CharmmDcd::ReadBox(double* box) {
       box[5] = boxtmp[1];
     }
   }
-  return 0;
 }
 
 // Traj_CharmmDcd::seekToFrame()
@@ -572,6 +579,12 @@ int Traj_CharmmDcd::readXYZ(double* xyzIn) {
   ReadBlock(-1);
   file_.Read(zcoord_, coordinate_size_);
   ReadBlock(-1);
+  xyzToFrame(xyzIn);
+  return 0;
+}
+
+/** Convert X|Y|Z coordinate arrays to given interleaved XYZ array. */
+void Traj_CharmmDcd::xyzToFrame(double* xyzIn) {
   // Swap little->big endian if necessary
   if (isBigEndian_) 
     endian_swap(xcoord_, dcdatom_*3);
@@ -582,7 +595,6 @@ int Traj_CharmmDcd::readXYZ(double* xyzIn) {
     *(xyz++) = (double)ycoord_[n];
     *(xyz++) = (double)zcoord_[n];
   }
-  return 0;
 }
 
 // Traj_CharmmDcd::readFrame()
@@ -595,6 +607,49 @@ int Traj_CharmmDcd::readFrame(int set, Frame& frameIn) {
   return readXYZ(frameIn.xAddress());
 }
 
+// Traj_CharmmDcd::readFrames()
+/** Read a block of frames. Each frame is read from the file with a single
+  * call (contiguous frames all at once) and the Fortran record markers are
+  * skipped in memory.
+  */
+int Traj_CharmmDcd::readFrames(int set, int nframes, int stride, FrameArray& frames) {
+  // First frame is a different size when fixed atoms are present.
+  if (frame1Bytes_ != frameNBytes_)
+    return TrajectoryIO::readFrames(set, nframes, stride, frames);
+  size_t nbytes = frameNBytes_;
+  if (stride == 1) nbytes *= (size_t)nframes;
+  blockBuf_.resize( nbytes );
+  double boxtmp[6];
+  for (int n = 0; n != nframes; n++, set += stride) {
+    const unsigned char* ptr = &blockBuf_[0];
+    if (stride == 1)
+      ptr += (size_t)n * frameNBytes_;
+    if (n == 0 || stride != 1) {
+      seekToFrame( set );
+      if (file_.Read(&blockBuf_[0], nbytes) != (int)nbytes) {
+        mprinterr("Error: Could not read DCD frame %i\n", set+1);
+        return 1;
+      }
+    }
+    // Load box info
+    if (boxBytes_ != 0) {
+      ptr += blockSize_;
+      memcpy(boxtmp, ptr, 6*sizeof(double));
+      ptr += 6*sizeof(double) + blockSize_;
+      BoxFromBuffer(frames[n].bAddress(), boxtmp);
+    }
+    // Load X, Y, and Z coordinates
+    float* crd = xcoord_;
+    for (int dim = 0; dim != 3; dim++, crd += dcdatom_) {
+      ptr += blockSize_;
+      memcpy(crd, ptr, coordinate_size_);
+      ptr += coordinate_size_ + blockSize_;
+    }
+    xyzToFrame(frames[n].xAddress());
+  }
+  return 0;
+}
+
 // Traj_CharmmDcd::readVelocity()
 int Traj_CharmmDcd::readVelocity(int set, Frame& frameIn) {
   seekToFrame( set );
@@ -32,6 +32,7 @@ class Traj_CharmmDcd : public TrajectoryIO {
     float* ycoord_;          ///< Pointer to start of Y coords in master coord array
     float* zcoord_;          ///< Pointer to start of Z coords in master coord array
     CpptrajFile file_;       ///< Input/Output file
+    std::vector<unsigned char> blockBuf_; ///< Raw bytes for block reads
 
     union headerbyte { unsigned char c[80]; int i[20]; float f[20]; };
     int ReadBlock(int);
@@ -39,9 +40,11 @@ class Traj_CharmmDcd : public TrajectoryIO {
     void AllocateCoords();
     int readDcdHeader();
     int ReadBox(double*);
+    void BoxFromBuffer(double*, double*) const;
     int writeDcdHeader();
     inline void seekToFrame(int);
     inline int readXYZ(double*);
+    inline void xyzToFrame(double*);
     void setFrameSizes();
 
     // Inherited functions
@@ -51,6 +54,8 @@ class Traj_CharmmDcd : public TrajectoryIO {
     int openTrajin();
     void closeTraj();
     int readFrame(int,Frame&);
+    int readFrames(int,int,int,FrameArray&);
+    bool HasBlockRead() const { return true; }
     int readVelocity(int,Frame&);
     int writeFrame(int,Frame const&);
     void Info();
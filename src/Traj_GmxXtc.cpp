@@ -189,6 +189,28 @@ int Traj_GmxXtc::readFrame(int set, Frame& frameIn) {
     mprinterr("Error: Could not seek in XTC file, frame %i\n", set+1);
     return 1;
   }
+  return readNextFrame(set, frameIn);
+}
+
+// Traj_GmxXtc::readFrames()
+/** Read a block of frames. When frames are contiguous only a single seek
+  * is needed for the whole block.
+  */
+int Traj_GmxXtc::readFrames(int set, int nframes, int stride, FrameArray& frames) {
+  for (int n = 0; n != nframes; n++, set += stride) {
+    if (n == 0 || stride != 1) {
+      if (xdr_seek(xd_, frameOffsets_[set], SEEK_SET) != 0) {
+        mprinterr("Error: Could not seek in XTC file, frame %i\n", set+1);
+        return 1;
+      }
+    }
+    if (readNextFrame(set, frames[n])) return 1;
+  }
+  return 0;
+}
+
+/** Read and decode XTC frame at the current file position. */
+int Traj_GmxXtc::readNextFrame(int set, Frame& frameIn) {
   float time;
   int step;
   int result = read_xtc(xd_, natoms_, &step, &time, box_, vec_, &prec_);
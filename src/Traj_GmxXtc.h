@@ -19,6 +19,10 @@ class Traj_GmxXtc : public TrajectoryIO {
     int openTrajin();
     void closeTraj();
     int readFrame(int,Frame&);
+#   ifndef NO_XDRFILE
+    int readFrames(int,int,int,FrameArray&);
+    bool HasBlockRead() const { return true; }
+#   endif
     int writeFrame(int,Frame const&);
     void Info();
     int readVelocity(int, Frame&);
@@ -36,6 +40,9 @@ class Traj_GmxXtc : public TrajectoryIO {
     void parallelCloseTraj();
 #   endif
 #   ifndef NO_XDRFILE
+    /// Read next frame at current file position.
+    int readNextFrame(int, Frame&);
+
     std::vector<off_t> frameOffsets_; ///< Frame offsets for reading
     XDRFILE* xd_; ///< Hold XDR file metadata
     rvec* vec_;   ///< Temporary location for holding XDR frame data
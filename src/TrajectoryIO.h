@@ -15,7 +15,7 @@
   */
 class TrajectoryIO : public BaseIOtype {
   public:
-    TrajectoryIO() : debug_(0) {}
+    TrajectoryIO() : debug_(0), needs_(CoordinateInfo::ALL_COMPONENTS) {}
     virtual ~TrajectoryIO() {} // virtual since this class is inherited.
     // -----------===== Inherited functions =====-----------
     /// \return true if file format matches trajectory type.
@@ -49,6 +49,20 @@ class TrajectoryIO : public BaseIOtype {
     virtual int readVelocity(int, Frame&) = 0;
     /// Read only force information from a trajectory.
     virtual int readForce(int, Frame&) = 0;
+    /// Read a block of frames from trajectory.
+    /** Read frames start, start+stride, ..., into the first count frames
+      * of the given array, which must already be set up. Formats that can
+      * read multiple frames more efficiently than one at a time should
+      * override this and HasBlockRead().
+      * \return 1 on error, 0 on success.
+      */
+    virtual int readFrames(int start, int count, int stride, FrameArray& frames) {
+      for (int n = 0; n != count; n++, start += stride)
+        if (readFrame(start, frames[n])) return 1;
+      return 0;
+    }
+    /// \return true if readFrames() is implemented natively for this format.
+    virtual bool HasBlockRead() const { return false; }
     /// Write a frame to trajectory
     /** Write to output trajectory. This routine is called from
       * TrajectoryFile::WriteFrame with the current action set number, not the 
@@ -97,8 +111,13 @@ class TrajectoryIO : public BaseIOtype {
 
     void SetDebug(int dIn)                       { debug_ = dIn;     }
     void SetTitle(std::string const& tIn)        { title_ = tIn;     }
+    /// Set optional Frame components (CoordinateInfo::ComponentType) that must be read.
+    /** Formats may skip reading any others; by default all are read. */
+    void SetComponentsNeeded(int n)              { needs_ = n;       }
   protected:
     void SetCoordInfo(CoordinateInfo const& cIn) { coordInfo_ = cIn; }
+    /// \return true if given optional Frame component must be read.
+    bool Needs(CoordinateInfo::ComponentType c) const { return ((needs_ & c) != 0); }
     int debug_;               ///< Trajectory debug level.
 #   ifdef MPI
     /// Sync up coordinate info etc.
@@ -107,5 +126,6 @@ class TrajectoryIO : public BaseIOtype {
   private:
     CoordinateInfo coordInfo_; ///< Metadata associated with coordinate Frame
     std::string title_;        ///< Set to trajectory title.
+    int needs_;                ///< Optional Frame components that must be read.
 }; 
 #endif
@@ -7,7 +7,7 @@
 /// Read in 1 frame at a time.
 class Trajin {
   public:
-    Trajin() : debug_(0) {}
+    Trajin() : debug_(0), prefetch_(0) {}
     virtual ~Trajin() {}
     virtual int SetupTrajRead(FileName const&, ArgList&, Topology*) = 0;
     virtual int ReadTrajFrame(int, Frame&) = 0;
@@ -15,10 +15,14 @@ class Trajin {
     virtual void EndTraj() = 0;
     virtual void PrintInfo(int) const = 0;
     virtual CoordinateInfo const& TrajCoordInfo() const = 0;
+    /// Set optional Frame components (CoordinateInfo::ComponentType) that must be read.
+    virtual void SetComponentsNeeded(int) {}
 
     inline int GetNextFrame(Frame&);
 
     InputTrajCommon const& Traj() const { return traj_; }
+    /// \return Number of frames to read ahead on a separate thread (0 = none).
+    int PrefetchDepth()               const { return prefetch_; }
 
     void SetDebug(int d)                { debug_ = d;         }
 #   ifdef MPI
@@ -31,6 +35,7 @@ class Trajin {
     InputTrajCommon& SetTraj() { return traj_; }
 
     int debug_;
+    int prefetch_; ///< Number of frames to read ahead during processing.
   private:
     InputTrajCommon traj_;
 };
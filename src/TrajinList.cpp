@@ -15,6 +15,7 @@ void TrajinList::Clear() {
   for (tListType::iterator traj = trajin_.begin(); traj != trajin_.end(); ++traj)
     delete *traj;
   trajin_.clear();
+  trajinArgs_.clear();
   for (eListType::iterator ens = ensemble_.begin(); ens != ensemble_.end(); ++ens)
     delete *ens;
   ensemble_.clear();
@@ -144,6 +145,9 @@ int TrajinList::AddTrajin(std::string const& fname, Topology* topIn, ArgList con
   Trajin* traj = 0;
   for (File::NameArray::const_iterator fn = fnames.begin(); fn != fnames.end(); ++fn) {
     ArgList args = trajin_args;
+    TrajinArgs tArgs;
+    tArgs.args_ = args;
+    tArgs.isRemd_ = isRemdtraj;
     if (isRemdtraj)
       traj = new Trajin_Multi();
     else
@@ -162,6 +166,7 @@ int TrajinList::AddTrajin(std::string const& fname, Topology* topIn, ArgList con
     if (args.CheckForMoreArgs()) return 1;
     // Add to trajin list and update # of frames.
     trajin_.push_back( traj );
+    trajinArgs_.push_back( tArgs );
     UpdateMaxFrames( traj->Traj() );
   }
   if (err > 0) return 1;
@@ -170,6 +175,33 @@ int TrajinList::AddTrajin(std::string const& fname, Topology* topIn, ArgList con
   return 0;
 }
 
+/** Set up a new input trajectory using the same file, topology, and arguments
+  * as the existing input trajectory at idx. The copy can be read independently
+  * of the original (e.g. by another thread). Output from setup is suppressed.
+  * It is up to the caller to free the returned trajectory.
+  */
+Trajin* TrajinList::CopyOfTrajin(unsigned int idx) const {
+  if (idx >= trajin_.size()) return 0;
+  Trajin* traj = 0;
+  if (trajinArgs_[idx].isRemd_)
+    traj = new Trajin_Multi();
+  else
+    traj = new Trajin_Single();
+  traj->SetDebug(debug_);
+  ArgList args = trajinArgs_[idx].args_;
+  SetWorldSilent( true );
+  int err = traj->SetupTrajRead( trajin_[idx]->Traj().Filename(), args,
+                                 trajin_[idx]->Traj().Parm() );
+  SetWorldSilent( false );
+  if (err != 0) {
+    mprinterr("Error: Could not set up copy of input trajectory '%s'.\n",
+              trajin_[idx]->Traj().Filename().full());
+    delete traj;
+    return 0;
+  }
+  return traj;
+}
+
 void TrajinList::List() const {
   if (!trajin_.empty()) {
     mprintf("\nINPUT TRAJECTORIES (%zu total):\n", trajin_.size());
@@ -15,6 +15,8 @@ class TrajinList {
     int AddTrajin(std::string const&, Topology*, ArgList const&);
     /// Add an ensemble to the list.
     int AddEnsembleIn(std::string const&, Topology*, ArgList const&);
+    /// \return A newly allocated, independently set up copy of specified input trajectory.
+    Trajin* CopyOfTrajin(unsigned int) const;
 
     typedef tListType::const_iterator trajin_it;
     trajin_it trajin_begin() const { return trajin_.begin(); }
@@ -39,7 +41,15 @@ class TrajinList {
   private:
     void UpdateMaxFrames(InputTrajCommon const&);
 
+    /// Hold arguments needed to set up a copy of an input trajectory.
+    struct TrajinArgs {
+      ArgList args_; ///< Trajectory arguments before setup.
+      bool isRemd_;  ///< True if trajectory is a REMD (Trajin_Multi) trajectory.
+    };
+    typedef std::vector<TrajinArgs> TAarray;
+
     tListType trajin_;
+    TAarray trajinArgs_; ///< Setup arguments for each trajectory in trajin_
     eListType ensemble_;
     int debug_;
     int maxframes_;
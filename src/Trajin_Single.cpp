@@ -3,7 +3,9 @@
 #include "CpptrajStdio.h"
 
 // CONSTRUCTOR
-Trajin_Single::Trajin_Single() : trajio_(0), velio_(0), frcio_(0) {}
+Trajin_Single::Trajin_Single() : trajio_(0), velio_(0), frcio_(0),
+  blockSize_(0), blockStart_(0), blockOffset_(1), blockCount_(0),
+  needs_(CoordinateInfo::ALL_COMPONENTS) {}
 
 // DESTRUCTOR
 Trajin_Single::~Trajin_Single() {
@@ -59,6 +61,17 @@ int Trajin_Single::SetupTrajRead(FileName const& tnameIn, ArgList& argIn,
   mprintf("\tReading '%s' as %s\n", Traj().Filename().full(), TrajectoryFile::FormatString(tformat));
   // Process format-specific read args
   if (trajio_->processReadArgs( argIn )) return 1;
+  // Max number of frames to read at once if format supports it.
+  blockSize_ = argIn.getKeyInt("readblock", 16);
+  // Number of frames to read ahead during processing.
+  prefetch_ = argIn.getKeyInt("prefetch", 0);
+  if (prefetch_ < 0) prefetch_ = 0;
+# ifndef _OPENMP
+  if (prefetch_ > 0) {
+    mprintf("Warning: 'prefetch' requires OpenMP; frames will not be read ahead.\n");
+    prefetch_ = 0;
+  }
+# endif
   // Set up the format for reading and get the number of frames.
   int nframes = trajio_->setupTrajin(Traj().Filename(), Traj().Parm());
   if (nframes == TrajectoryIO::TRAJIN_ERR) {
@@ -104,8 +117,23 @@ int Trajin_Single::SetupTrajRead(FileName const& tnameIn, ArgList& argIn,
     cInfo_.SetForce( true );
   }
 
-  if (debug_ > 0)
+  // Only read in blocks when the format does so natively, frame count is
+  // known, and no separate velocity/force files are being read.
+  if (!trajio_->HasBlockRead() || Traj().Counter().Stop() < 0 ||
+      velio_ != 0 || frcio_ != 0)
+    blockSize_ = 0;
+  else if (blockSize_ > 1) {
+    // Limit memory used by the block to roughly 64 MB of coordinates.
+    size_t frameBytes = (size_t)Traj().Parm()->Natom() * 3 * sizeof(double);
+    if (frameBytes > 0) {
+      size_t maxFrames = (64 * 1024 * 1024) / frameBytes;
+      if ((size_t)blockSize_ > maxFrames) blockSize_ = (int)maxFrames;
+    }
+  }
+  if (debug_ > 0) {
     cInfo_.PrintCoordInfo( Traj().Filename().base(), Traj().Parm()->c_str() );
+    if (blockSize_ > 1) mprintf("\tReading up to %i frames at a time.\n", blockSize_);
+  }
   return 0;
 }
 
@@ -125,6 +153,12 @@ int Trajin_Single::BeginTraj() {
      mprinterr("Error: Could not open mdfrc file.\n");
      return 1;
   }
+  // Allocate frames for block reads.
+  blockCount_ = 0;
+  if (blockSize_ > 1) {
+    block_.resize( blockSize_ );
+    if (block_.SetupFrames( Traj().Parm()->Atoms(), cInfo_ )) return 1;
+  }
   // Initialize counter.
   SetTraj().Counter().Begin();
   return 0;
@@ -134,15 +168,66 @@ void Trajin_Single::EndTraj() {
   trajio_->closeTraj();
   if (velio_ != 0) velio_->closeTraj();
   if (frcio_ != 0) frcio_->closeTraj();
+  block_.resize( 0 );
+  // Components needed only apply until the trajectory is closed.
+  SetComponentsNeeded( CoordinateInfo::ALL_COMPONENTS );
+}
+
+/** \return Position of given frame # in current block, -1 if not in block. */
+int Trajin_Single::BlockIndex(int idx) const {
+  int bidx = idx - blockStart_;
+  if (blockCount_ < 1 || bidx < 0 || (bidx % blockOffset_) != 0) return -1;
+  bidx /= blockOffset_;
+  if (bidx >= blockCount_) return -1;
+  return bidx;
+}
+
+/** Read up to blockSize_ frames beginning at the given frame using the
+  * current counter offset, not reading past the counter stop frame.
+  */
+int Trajin_Single::ReadBlock(int idx) {
+  int offset = Traj().Counter().Offset();
+  int nread = (Traj().Counter().Stop() - idx + offset - 1) / offset;
+  if (nread > blockSize_) nread = blockSize_;
+  blockCount_ = 0;
+  if (nread < 1) return 1;
+  if (trajio_->readFrames(idx, nread, offset, block_)) return 1;
+  blockStart_ = idx;
+  blockOffset_ = offset;
+  blockCount_ = nread;
+  return 0;
+}
+
+// Trajin_Single::SetComponentsNeeded()
+/** Any separate velocity/force files are not read at all if velocities/
+  * forces are not needed.
+  */
+void Trajin_Single::SetComponentsNeeded(int needsIn) {
+  needs_ = needsIn;
+  if (trajio_ != 0) trajio_->SetComponentsNeeded( needs_ );
+  if (velio_ != 0) velio_->SetComponentsNeeded( needs_ );
+  if (frcio_ != 0) frcio_->SetComponentsNeeded( needs_ );
+  // Any frames already read may be missing components now needed.
+  blockCount_ = 0;
 }
 
 // Trajin_Single::ReadTrajFrame()
 int Trajin_Single::ReadTrajFrame( int idx, Frame& frameIn ) {
+  if (blockSize_ > 1) {
+    // Frames being read in order are read in blocks. 
+    int bidx = BlockIndex( idx );
+    if (bidx < 0 && idx == Traj().Counter().Current()) {
+      if (ReadBlock( idx )) return 1;
+      bidx = 0;
+    }
+    if (bidx > -1 && frameIn.CopyFrame( block_[bidx] ) == 0)
+      return 0;
+  }
   if (trajio_->readFrame(idx, frameIn))
     return 1;
-  if (velio_ != 0 && velio_->readVelocity(idx, frameIn))
+  if (velio_ != 0 && (needs_ & CoordinateInfo::VELOCITY) && velio_->readVelocity(idx, frameIn))
     return 1;
-  if (frcio_ != 0 && frcio_->readForce(idx, frameIn))
+  if (frcio_ != 0 && (needs_ & CoordinateInfo::FORCE) && frcio_->readForce(idx, frameIn))
     return 1;
   //printf("DEBUG:\t%s:  current=%i  target=%i\n",trajName,idx,targetSet);
   return 0;
@@ -20,6 +20,8 @@ class Trajin_Single : public Trajin {
     void PrintInfo(int) const;
     /// \return trajectory metadata.
     CoordinateInfo const& TrajCoordInfo() const { return cInfo_; }
+    /// Set optional Frame components that must be read.
+    void SetComponentsNeeded(int);
     // ---------------------------------------------
     std::string const& Title() const { return trajio_->Title(); } //TODO Check for segfault
 #   ifdef MPI
@@ -29,10 +31,20 @@ class Trajin_Single : public Trajin {
 #   endif
   private:
     TrajectoryIO* SetupSeparateTraj(FileName const&, const char*) const;
+    /// \return Index into frame block of given frame #, -1 if not present.
+    inline int BlockIndex(int) const;
+    /// Read next block of frames starting at given frame #.
+    int ReadBlock(int);
 
     TrajectoryIO* trajio_; ///< Hold class that will interface with traj format.
     TrajectoryIO* velio_;  ///< Hold class that will interface with opt. mdvel file.
     TrajectoryIO* frcio_;  ///< Hold class taht will interface with opt. mdfrc file.
     CoordinateInfo cInfo_; ///< Hold coordinate metadata.
+    FrameArray block_;     ///< Hold frames read in blocks.
+    int blockSize_;        ///< Max # frames to read per block; < 2 means read frames singly.
+    int blockStart_;       ///< First frame # in current block.
+    int blockOffset_;      ///< Frame offset in current block.
+    int blockCount_;       ///< Number of frames in current block.
+    int needs_;            ///< Optional Frame components that must be read.
 };
 #endif
@@ -0,0 +1,93 @@
+#ifndef INC_VOXELARRAY_H
+#define INC_VOXELARRAY_H
+#include <vector>
+#include "SparseGrid.h"
+/// Array with one element per grid voxel, indexed by grid linear index.
+/** Elements are either stored contiguously, or in 8x8x8 bricks (see
+  * SparseGrid) that are only allocated when one of their voxels is first
+  * accessed for writing. Reading an element in an unallocated brick
+  * returns T(). Since converting a grid index to a brick position requires
+  * integer division, code that repeatedly accesses the same voxels can
+  * convert once with StorageIndex() and then use Element().
+  */
+template <class T> class VoxelArray {
+  public:
+    VoxelArray() : zero_(), sparse_(false) {}
+    /// Set up for grid with given X, Y, and Z dimensions; if 'sparse' store in bricks.
+    void Allocate(size_t, size_t, size_t, bool);
+    /// \return Reference to element at given index; allocates brick if needed.
+    T& operator[](size_t idx) {
+      if (!sparse_) return dense_[idx];
+      size_t x, y, z;
+      bricks_.ReverseIndex( (long int)idx, x, y, z );
+      return bricks_.voxel(x, y, z);
+    }
+    /// \return Element at given index; T() if brick not allocated.
+    const T& operator[](size_t idx) const {
+      if (!sparse_) return dense_[idx];
+      size_t x, y, z;
+      bricks_.ReverseIndex( (long int)idx, x, y, z );
+      const T* elt = bricks_.find(x, y, z);
+      if (elt == 0) return zero_;
+      return *elt;
+    }
+    /// \return Storage index of element at given index, for use with Element().
+    size_t StorageIndex(size_t idx) const {
+      if (!sparse_) return idx;
+      size_t x, y, z;
+      bricks_.ReverseIndex( (long int)idx, x, y, z );
+      return bricks_.StorageIndex(x, y, z);
+    }
+    /// \return Reference to element at given storage index; allocates brick if needed.
+    T& Element(size_t sidx) {
+      if (!sparse_) return dense_[sidx];
+      size_t b = sidx >> (3*SparseGrid<T>::BSHIFT);
+      T* brick = bricks_.Brick(b);
+      if (brick == 0) {
+        bricks_.AllocateBrick(b);
+        brick = bricks_.Brick(b);
+      }
+      return brick[ sidx & (SparseGrid<T>::BVOXELS-1) ];
+    }
+    /// Add elements of given array to this one; only bricks allocated in given array are allocated.
+    void Add(VoxelArray const&);
+    /// \return Number of allocated bricks.
+    size_t NbricksAllocated() const { return bricks_.NbricksAllocated(); }
+    /// \return Total number of bricks.
+    size_t Nbricks() const { return bricks_.Nbricks(); }
+  private:
+    std::vector<T> dense_; ///< Element storage if not sparse.
+    SparseGrid<T> bricks_; ///< Element storage if sparse.
+    T zero_;               ///< Returned for elements in unallocated bricks.
+    bool sparse_;          ///< If true store elements in bricks.
+};
+// -----------------------------------------------------------------------------
+// VoxelArray::Allocate()
+template <class T> void VoxelArray<T>::Allocate(size_t x, size_t y, size_t z, bool sparse) {
+  sparse_ = sparse;
+  if (sparse_) {
+    dense_.clear();
+    bricks_.resize(x, y, z);
+  } else {
+    bricks_.resize(0, 0, 0);
+    dense_.assign(x * y * z, T());
+  }
+}
+// VoxelArray::Add()
+template <class T> void VoxelArray<T>::Add(VoxelArray const& rhs) {
+  if (!sparse_) {
+    for (size_t idx = 0; idx != dense_.size(); idx++)
+      dense_[idx] += rhs.dense_[idx];
+  } else {
+    for (size_t b = 0; b != rhs.bricks_.Nbricks(); b++) {
+      const T* src = rhs.bricks_.Brick(b);
+      if (src != 0) {
+        bricks_.AllocateBrick(b);
+        T* dst = bricks_.Brick(b);
+        for (int v = 0; v != SparseGrid<T>::BVOXELS; v++)
+          dst[v] += src[v];
+      }
+    }
+  }
+}
+#endif